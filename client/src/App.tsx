@@ -5,21 +5,31 @@ import { useAuth } from "@/hooks/use-auth";
 import { ProfileProvider } from "@/contexts/profile-context";
 import * as React from "react";
 import Footer from "@/components/ui/footer";
-import Dashboard from "@/pages/dashboard";
-import Login from "@/pages/login";
-import Register from "@/pages/register";
-import Locations from "@/pages/locations";
-import StaffManagement from "@/pages/staff-management";
-import Scheduling from "@/pages/scheduling";
-import ViewCalendar from "@/pages/view-calendar";
-import Applicants from "@/pages/applicants";
-import ApplicantPortal from "@/pages/applicant-portal";
-import CashManagement from "@/pages/cash-management";
-import KnowledgeBase from "@/pages/knowledge-base";
-import Reports from "@/pages/reports";
-import NotFound from "@/pages/not-found";
-import RegistrationSuccess from "@/pages/registration-success";
-import ApplicantsTest from "@/pages/applicants-test";
+
+// Every page is its own chunk, loaded when its route first renders, so an applicant arriving
+// at /register from a QR code doesn't download the manager app. The applicant-facing pages
+// share one chunk (see vite.config.ts).
+const Dashboard = React.lazy(() => import("@/pages/dashboard"));
+const Login = React.lazy(() => import("@/pages/login"));
+const Register = React.lazy(() => import("@/pages/register"));
+const Locations = React.lazy(() => import("@/pages/locations"));
+const StaffManagement = React.lazy(() => import("@/pages/staff-management"));
+const Scheduling = React.lazy(() => import("@/pages/scheduling"));
+const ViewCalendar = React.lazy(() => import("@/pages/view-calendar"));
+const Applicants = React.lazy(() => import("@/pages/applicants"));
+const ApplicantPortal = React.lazy(() => import("@/pages/applicant-portal"));
+const CashManagement = React.lazy(() => import("@/pages/cash-management"));
+const KnowledgeBase = React.lazy(() => import("@/pages/knowledge-base"));
+const Reports = React.lazy(() => import("@/pages/reports"));
+const NotFound = React.lazy(() => import("@/pages/not-found"));
+const RegistrationSuccess = React.lazy(() => import("@/pages/registration-success"));
+const ApplicantsTest = React.lazy(() => import("@/pages/applicants-test"));
+
+const PageFallback = () => (
+  <div className="flex h-screen items-center justify-center">
+    <div className="h-12 w-12 animate-spin rounded-full border-b-2 border-t-2 border-primary"></div>
+  </div>
+);
 
 // Protected route component that only checks if user is authenticated
 const ProtectedRoute = ({ component: Component, ...rest }: any) => {
@@ -266,6 +276,7 @@ function App() {
         <div className="flex flex-col min-h-screen">
           <div className="flex-grow">
             <Router>
+              <React.Suspense fallback={<PageFallback />}>
               <Switch>
                 {/* PUBLIC ROUTES - accessible without authentication */}
                 <Route path="/login">
@@ -406,6 +417,7 @@ function App() {
               {/* Not found - should be the very last */}
               <Route component={NotFound} />
             </Switch>
+              </React.Suspense>
           </Router>
         </div>
         {/* Only show footer on non-login/register pages to avoid duplicating it */}
@@ -10,11 +10,13 @@ import {
 } from "@/components/ui/card";
 import { Button } from "@/components/ui/button";
 import { Skeleton } from "@/components/ui/skeleton";
-import { Applicant } from "@shared/schema";
+import { ApplicantPage } from "@shared/schema";
 
 interface ApplicantsSummaryProps {
   locationId?: number;
   limit?: number;
+  // Exact count from the dashboard summary; fetched (capped at one page) when not given
+  newCount?: number;
 }
 
 // Helper to format date relative to current time
@@ -38,24 +40,25 @@ const formatRelativeTime = (date: string | Date) => {
   }
 };
 
-export function ApplicantsSummary({ locationId, limit = 4 }: ApplicantsSummaryProps) {
-  // Fetch applicants, filtered by location if provided
-  const { data: applicants, isLoading } = useQuery<Applicant[]>({
-    queryKey: locationId 
-      ? ['/api/applicants/location', locationId] 
-      : ['/api/applicants'],
+export function ApplicantsSummary({ locationId, limit = 4, newCount }: ApplicantsSummaryProps) {
+  // The list endpoint is paginated newest first, so the first page is the recent list
+  const locationFilter = locationId ? `&locationId=${locationId}` : '';
+  const { data: recentPage, isLoading } = useQuery<ApplicantPage>({
+    queryKey: [`/api/applicants?limit=${limit}${locationFilter}`],
     enabled: true,
   });
+  // Count of new applicants, capped at one page
+  const { data: newPage } = useQuery<ApplicantPage>({
+    queryKey: [`/api/applicants?status=new&limit=100${locationFilter}`],
+    enabled: newCount === undefined,
+  });
 
-  // Get only the most recent applicants up to the limit
-  const recentApplicants = applicants
-    ? [...applicants]
-        .sort((a, b) => new Date(b.createdAt).getTime() - new Date(a.createdAt).getTime())
-        .slice(0, limit)
-    : [];
-
-  const totalApplicants = applicants?.length || 0;
-  const newApplicants = applicants?.filter(a => a.status === 'new').length || 0;
+  const recentApplicants = recentPage?.items ?? [];
+  const newApplicants = newCount !== undefined
+    ? newCount
+    : newPage
+      ? `${newPage.items.length}${newPage.nextCursor ? '+' : ''}`
+      : 0;
 
   if (isLoading) {
     return (
@@ -137,7 +140,7 @@ export function ApplicantsSummary({ locationId, limit = 4 }: ApplicantsSummaryPr
       <CardFooter className="bg-gray-50 px-4 py-4 sm:px-6">
         <div className="flex items-center justify-between">
           <div className="text-sm text-gray-500">
-            Showing {recentApplicants.length} of {totalApplicants} applicants
+            Showing the {recentApplicants.length} most recent applicants
           </div>
           <div>
             <Link href="/applicants">
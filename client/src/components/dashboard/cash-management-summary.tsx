@@ -1,4 +1,3 @@
-import { useQuery } from "@tanstack/react-query";
 import { Link } from "wouter";
 import { CheckCircle } from "lucide-react";
 import {
@@ -13,28 +12,17 @@ import {
   Alert, 
   AlertDescription 
 } from "@/components/ui/alert";
-import { CashCount } from "@shared/schema";
+import { DashboardSummary } from "@shared/schema";
 
 interface CashManagementSummaryProps {
-  locationId: number;
+  // Today's cash figures from the dashboard summary
+  cash: DashboardSummary["cash"] | undefined;
+  isLoading: boolean;
 }
 
-export function CashManagementSummary({ locationId }: CashManagementSummaryProps) {
-  const today = new Date();
-  const todayStr = today.toISOString().split('T')[0];
-  
-  // Fetch cash counts for today
-  const { data: cashCounts, isLoading } = useQuery<CashCount[]>({
-    queryKey: ['/api/cash-counts/location', locationId],
-    enabled: !!locationId,
-  });
-
-  // Get the most recent cash count
-  const latestCashCount = cashCounts
-    ? [...cashCounts]
-        .filter(count => new Date(count.countDate).toISOString().split('T')[0] === todayStr)
-        .sort((a, b) => new Date(b.createdAt).getTime() - new Date(a.createdAt).getTime())[0]
-    : undefined;
+export function CashManagementSummary({ cash, isLoading }: CashManagementSummaryProps) {
+  // The most recently entered count of today
+  const latestCashCount = cash?.latest ?? undefined;
 
   // Format the last update time
   const formatLastUpdateTime = () => {
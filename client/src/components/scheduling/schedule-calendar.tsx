@@ -1,4 +1,4 @@
-import { useEffect, useState } from "react";
+import { useEffect, useMemo, useState, type ReactNode } from "react";
 import { useLocation } from "wouter";
 import { useQuery, useMutation, useQueryClient } from "@tanstack/react-query";
 import { apiRequest } from "@/lib/queryClient";
@@ -43,12 +43,11 @@ import {
   SelectValue,
 } from "@/components/ui/select";
 import { useToast } from "@/hooks/use-toast";
+import { useScheduleUpdates, weekViewQueryKey } from "@/hooks/use-schedule-updates";
+import { useVirtualRows } from "@/hooks/use-virtual-rows";
 import { 
-  WeeklySchedule, 
-  Shift, 
-  Staff, 
-  User, 
-  Competency,
+  WeekView,
+  WeekViewShift,
   ScheduleTemplate
 } from "@shared/schema";
 
@@ -63,6 +62,27 @@ const DEFAULT_TIME_SLOTS = [
   "5:00 PM - 11:00 PM"
 ];
 
+// Cells holding more shifts than this scroll and only mount the cards in view
+const VIRTUALIZE_CELL_AFTER = 6;
+const SHIFT_CARD_HEIGHT = 64;
+
+const slotKey = (date: string, timeSlot: string) => `${date}|${timeSlot}`;
+
+function VirtualShiftList<T>({ items, renderItem }: { items: T[]; renderItem: (item: T) => ReactNode }) {
+  const rows = useVirtualRows(items.length, SHIFT_CARD_HEIGHT, 4);
+  return (
+    <div ref={rows.scrollRef} className="max-h-80 overflow-y-auto pr-1">
+      <div style={{ height: rows.paddingTop }} />
+      {rows.items.map(row => (
+        <div key={row.key} ref={rows.measureRef} data-index={row.index}>
+          {renderItem(items[row.index])}
+        </div>
+      ))}
+      <div style={{ height: rows.paddingBottom }} />
+    </div>
+  );
+}
+
 export function ScheduleCalendar({ 
   locationId,
   timeSlots = DEFAULT_TIME_SLOTS
@@ -89,43 +109,21 @@ export function ScheduleCalendar({
     return date.toISOString();
   };
 
-  // Fetch the weekly schedule for the current week
+  // Fetch the whole week (schedule, shifts, assigned staff, competencies) in one request
   const { 
-    data: weeklySchedule, 
+    data: weekView, 
     isLoading: isLoadingSchedule,
-    refetch: refetchSchedule
-  } = useQuery<WeeklySchedule>({
-    queryKey: ['/api/weekly-schedules/location', locationId, formatDateForApi(currentWeekStart)],
+    refetch: refetchWeekView
+  } = useQuery<WeekView>({
+    queryKey: weekViewQueryKey(locationId, currentWeekStart),
     enabled: !!locationId,
   });
 
-  // Fetch shifts for the weekly schedule
-  const { 
-    data: shifts,
-    isLoading: isLoadingShifts,
-    refetch: refetchShifts
-  } = useQuery<Shift[]>({
-    queryKey: ['/api/shifts/schedule', weeklySchedule?.id],
-    enabled: !!weeklySchedule?.id,
-  });
-
-  // Fetch staff members
-  const { data: staffMembers } = useQuery<Staff[]>({
-    queryKey: ['/api/staff/location', locationId],
-    enabled: !!locationId,
-  });
-
-  // Fetch users to get names
-  const { data: users } = useQuery<User[]>({
-    queryKey: ['/api/users'],
-    enabled: !!staffMembers,
-  });
+  // Apply shift edits from other devices to the cached week instead of refetching it
+  useScheduleUpdates(locationId, currentWeekStart);
 
-  // Fetch competencies
-  const { data: competencies } = useQuery<Competency[]>({
-    queryKey: ['/api/competencies/location', locationId],
-    enabled: !!locationId,
-  });
+  const weeklySchedule = weekView?.schedule ?? undefined;
+  const shifts = weekView?.shifts;
 
   // Fetch schedule templates
   const { data: templates } = useQuery<ScheduleTemplate[]>({
@@ -133,36 +131,37 @@ export function ScheduleCalendar({
     enabled: !!locationId,
   });
 
+  // Index the week once per change instead of scanning every shift for every cell
+  const staffNames = useMemo(() => new Map(weekView?.staff.map(s => [s.id, s.name])), [weekView?.staff]);
+  const competencyNames = useMemo(() => new Map(weekView?.competencies.map(c => [c.id, c.name])), [weekView?.competencies]);
+  const shiftsBySlot = useMemo(() => {
+    const bySlot = new Map<string, WeekViewShift[]>();
+    shifts?.forEach(shift => {
+      const shiftDate = typeof shift.date === 'string' 
+        ? format(parseISO(shift.date), 'yyyy-MM-dd')
+        : format(shift.date, 'yyyy-MM-dd');
+      const key = slotKey(shiftDate, shift.startTime + " - " + shift.endTime);
+      const slotShifts = bySlot.get(key);
+      if (slotShifts) slotShifts.push(shift);
+      else bySlot.set(key, [shift]);
+    });
+    return bySlot;
+  }, [shifts]);
+
   // Helper to get staff name
   const getStaffName = (staffId: number) => {
-    const staff = staffMembers?.find(s => s.id === staffId);
-    if (!staff) return `Staff #${staffId}`;
-    
-    const user = users?.find(u => u.id === staff.userId);
-    return user?.name || `Staff #${staffId}`;
+    return staffNames.get(staffId) || `Staff #${staffId}`;
   };
 
   // Helper to get competency name
-  const getCompetencyName = (competencyId?: number) => {
+  const getCompetencyName = (competencyId?: number | null) => {
     if (!competencyId) return null;
-    const competency = competencies?.find(c => c.id === competencyId);
-    return competency?.name || null;
+    return competencyNames.get(competencyId) || null;
   };
 
   // Get shifts for a specific day and time slot
   const getShiftsForSlot = (date: Date, timeSlot: string) => {
-    if (!shifts) return [];
-
-    const dateStr = format(date, 'yyyy-MM-dd');
-    
-    return shifts.filter(shift => {
-      const shiftDate = typeof shift.date === 'string' 
-        ? format(parseISO(shift.date), 'yyyy-MM-dd')
-        : format(shift.date, 'yyyy-MM-dd');
-      
-      return shiftDate === dateStr && 
-             shift.startTime + " - " + shift.endTime === timeSlot;
-    });
+    return shiftsBySlot.get(slotKey(format(date, 'yyyy-MM-dd'), timeSlot)) ?? [];
   };
 
   // Navigation functions
@@ -193,7 +192,7 @@ export function ScheduleCalendar({
         title: "Schedule Created",
         description: "New weekly schedule has been created.",
       });
-      refetchSchedule();
+      refetchWeekView();
     },
     onError: (error) => {
       toast({
@@ -207,12 +206,19 @@ export function ScheduleCalendar({
   // Apply template to schedule
   const applyTemplateMutation = useMutation({
     mutationFn: async (templateId: number) => {
-      // This would fetch template shifts and create new shifts for each day
-      // Simplified implementation here
-      return apiRequest('PUT', `/api/weekly-schedules/${weeklySchedule?.id}`, {
-        ...weeklySchedule,
-        templateId
+      // The server expands the template in the background; poll until the rollout finishes
+      const res = await apiRequest('POST', '/api/scheduling/template-rollouts', {
+        templateIds: [templateId],
+        fromWeekStart: currentWeekStart.toISOString(),
+        toWeekStart: currentWeekStart.toISOString(),
       });
+      let job = await res.json();
+      while (job.status === 'running') {
+        await new Promise(resolve => setTimeout(resolve, 500));
+        job = await (await apiRequest('GET', `/api/scheduling/template-rollouts/${job.id}`)).json();
+      }
+      if (job.status === 'failed') throw new Error(job.error || 'Template rollout failed');
+      return job;
     },
     onSuccess: async () => {
       toast({
@@ -220,8 +226,7 @@ export function ScheduleCalendar({
         description: "Schedule template has been applied.",
       });
       setShowTemplateDialog(false);
-      refetchSchedule();
-      refetchShifts();
+      refetchWeekView();
     },
     onError: (error) => {
       toast({
@@ -234,10 +239,10 @@ export function ScheduleCalendar({
 
   // Create schedule if none exists
   useEffect(() => {
-    if (locationId && !isLoadingSchedule && !weeklySchedule) {
+    if (locationId && !isLoadingSchedule && weekView && !weekView.schedule) {
       createScheduleMutation.mutate();
     }
-  }, [locationId, isLoadingSchedule, weeklySchedule]);
+  }, [locationId, isLoadingSchedule, weekView]);
 
   // Apply the selected template
   const handleApplyTemplate = () => {
@@ -358,30 +363,33 @@ export function ScheduleCalendar({
                     const slotShifts = getShiftsForSlot(day, timeSlot);
                     const bgColor = timeIndex === 0 ? "bg-blue-50 border-blue-200" : "bg-indigo-50 border-indigo-200";
                     const textColor = timeIndex === 0 ? "text-primary-700" : "text-indigo-700";
+                    const renderShift = (shift: WeekViewShift) => (
+                      <div 
+                        key={shift.id}
+                        className={`${bgColor} p-2 rounded-md border mb-2`}
+                        onClick={() => navigate(`/scheduling/edit/${shift.id}`)}
+                        role="button"
+                        tabIndex={0}
+                      >
+                        <div className={`font-medium ${textColor}`}>
+                          {shift.staffId ? getStaffName(shift.staffId) : 'Unassigned'}
+                        </div>
+                        <div className="text-xs text-gray-500">
+                          {shift.role} {shift.requiredCompetencyLevel ? 
+                            `(${getCompetencyName(shift.competencyId)?.charAt(0) || 'C'}${shift.requiredCompetencyLevel})` : ''}
+                        </div>
+                      </div>
+                    );
                     
                     return (
                       <TableCell 
                         key={`${timeSlot}-${day}`} 
                         className="px-6 py-4 whitespace-nowrap text-sm text-gray-500"
                       >
-                        {slotShifts.length > 0 ? (
-                          slotShifts.map(shift => (
-                            <div 
-                              key={shift.id}
-                              className={`${bgColor} p-2 rounded-md border mb-2`}
-                              onClick={() => navigate(`/scheduling/edit/${shift.id}`)}
-                              role="button"
-                              tabIndex={0}
-                            >
-                              <div className={`font-medium ${textColor}`}>
-                                {shift.staffId ? getStaffName(shift.staffId) : 'Unassigned'}
-                              </div>
-                              <div className="text-xs text-gray-500">
-                                {shift.role} {shift.requiredCompetencyLevel ? 
-                                  `(${getCompetencyName(shift.competencyId)?.charAt(0) || 'C'}${shift.requiredCompetencyLevel})` : ''}
-                              </div>
-                            </div>
-                          ))
+                        {slotShifts.length > VIRTUALIZE_CELL_AFTER ? (
+                          <VirtualShiftList items={slotShifts} renderItem={renderShift} />
+                        ) : slotShifts.length > 0 ? (
+                          slotShifts.map(renderShift)
                         ) : (
                           <Button 
                             variant="outline" 
@@ -111,7 +111,7 @@ export function Sidebar() {
             </span>
           </div>
           <p className="text-xs text-gray-600 mt-1">
-            {redisStatus?.connected ? 'Cache layer active' : 'Cache unavailable'}
+            {redisStatus?.connected ? 'Cache layer active' : 'Using in-process cache'}
           </p>
         </div>
       </nav>
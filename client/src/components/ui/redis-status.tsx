@@ -4,11 +4,17 @@ import { Badge } from './badge';
 
 interface RedisStatusData {
   connected: boolean;
+  // Which cache the server is using: Redis, or its in-process fallback
+  mode?: 'redis' | 'local';
   uptime: number;
   memory: {
     used: string;
     peak: string;
   };
+  stats?: {
+    hitRate: number | null;
+    evictedKeys: number;
+  };
   clients: number;
   version: string;
   error?: string;
@@ -86,8 +92,8 @@ export function RedisStatus() {
       <CardHeader className="pb-2">
         <CardTitle className="text-sm font-medium flex items-center justify-between">
           Redis Status
-          <Badge variant={status?.connected ? "default" : "destructive"}>
-            {status?.connected ? "Connected" : "Disconnected"}
+          <Badge variant={status?.mode === 'redis' ? "default" : status?.mode === 'local' ? "secondary" : "destructive"}>
+            {status?.mode === 'redis' ? "Connected" : status?.mode === 'local' ? "In-process cache" : "Disconnected"}
           </Badge>
         </CardTitle>
       </CardHeader>
@@ -109,6 +115,16 @@ export function RedisStatus() {
             <span className="text-gray-500">Version:</span>
             <div className="font-mono">{status?.version || 'N/A'}</div>
           </div>
+          <div>
+            <span className="text-gray-500">Hit rate:</span>
+            <div className="font-mono">
+              {status?.stats?.hitRate != null ? `${(status.stats.hitRate * 100).toFixed(1)}%` : 'N/A'}
+            </div>
+          </div>
+          <div>
+            <span className="text-gray-500">Evicted:</span>
+            <div className="font-mono">{status?.stats?.evictedKeys ?? 'N/A'}</div>
+          </div>
         </div>
         
         {status?.error && (
@@ -0,0 +1,95 @@
+import { useEffect } from "react";
+import { useQueryClient } from "@tanstack/react-query";
+import type { WeekView, WeekViewPatch, WeekViewShift } from "@shared/schema";
+
+const RECONNECT_DELAY = 3000;
+
+export function weekViewQueryKey(locationId: number, weekStart: Date) {
+  return [`/api/scheduling/week-view/${locationId}?weekStart=${encodeURIComponent(weekStart.toISOString())}`];
+}
+
+const shiftTime = (shift: WeekViewShift) => new Date(shift.date as unknown as string).getTime();
+
+function applyPatch(view: WeekView, patch: WeekViewPatch): WeekView | null {
+  // Patches for a schedule we don't have (e.g. created elsewhere) need a full reload
+  if (!view.schedule || view.schedule.id !== patch.scheduleId) return null;
+
+  if (patch.type === "shift:delete") {
+    return { ...view, shifts: view.shifts.filter(s => s.id !== patch.shiftId) };
+  }
+
+  const shifts = view.shifts.filter(s => s.id !== patch.shift.id);
+  shifts.push(patch.shift);
+  shifts.sort((a, b) => shiftTime(a) - shiftTime(b) || a.startTime.localeCompare(b.startTime));
+
+  const staff = patch.staff && !view.staff.some(s => s.id === patch.staff!.id)
+    ? [...view.staff, patch.staff]
+    : view.staff;
+  const competencies = patch.competency && !view.competencies.some(c => c.id === patch.competency!.id)
+    ? [...view.competencies, patch.competency]
+    : view.competencies;
+
+  return { ...view, shifts, staff, competencies };
+}
+
+// Subscribe to live shift patches for one location/week and apply them to the cached week view
+export function useScheduleUpdates(locationId: number, weekStart: Date) {
+  const queryClient = useQueryClient();
+  const weekStartIso = weekStart.toISOString();
+
+  useEffect(() => {
+    if (!locationId) return;
+
+    const queryKey = weekViewQueryKey(locationId, new Date(weekStartIso));
+    const protocol = window.location.protocol === "https:" ? "wss:" : "ws:";
+    let socket: WebSocket | null = null;
+    let reconnectTimer: ReturnType<typeof setTimeout> | undefined;
+    let closed = false;
+
+    const connect = () => {
+      socket = new WebSocket(`${protocol}//${window.location.host}/ws`);
+
+      socket.onopen = () => {
+        socket?.send(JSON.stringify({ type: "subscribe", locationId, weekStart: weekStartIso }));
+      };
+
+      socket.onmessage = (event) => {
+        let message: any;
+        try {
+          message = JSON.parse(event.data);
+        } catch {
+          return;
+        }
+        if (message.type !== "shift:upsert" && message.type !== "shift:delete") return;
+        if (message.locationId !== locationId) return;
+
+        const current = queryClient.getQueryData<WeekView>(queryKey);
+        if (!current) return;
+
+        const next = applyPatch(current, message as WeekViewPatch);
+        if (next) {
+          queryClient.setQueryData(queryKey, next);
+        } else {
+          queryClient.invalidateQueries({ queryKey });
+        }
+      };
+
+      socket.onclose = () => {
+        if (closed) return;
+        // Patches may have been missed while disconnected
+        reconnectTimer = setTimeout(() => {
+          queryClient.invalidateQueries({ queryKey });
+          connect();
+        }, RECONNECT_DELAY);
+      };
+    };
+
+    connect();
+
+    return () => {
+      closed = true;
+      clearTimeout(reconnectTimer);
+      socket?.close();
+    };
+  }, [locationId, weekStartIso, queryClient]);
+}
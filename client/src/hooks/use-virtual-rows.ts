@@ -0,0 +1,89 @@
+import { useCallback, useEffect, useRef, useState } from "react";
+
+export interface VirtualRow {
+  key: number;
+  index: number;
+  start: number;
+  end: number;
+}
+
+// First index whose row ends below `offset`; offsets[i] is where row i starts
+function findRow(offsets: number[], offset: number): number {
+  let low = 0;
+  let high = offsets.length - 2;
+  while (low < high) {
+    const mid = (low + high) >> 1;
+    if (offsets[mid + 1] <= offset) low = mid + 1;
+    else high = mid;
+  }
+  return Math.max(low, 0);
+}
+
+// Windowed rendering for long tables and lists: only rows in or near the scroll container's
+// viewport are mounted. Tables render `paddingTop`/`paddingBottom` as spacer rows so native
+// column layout keeps working; rows pass `measureRef` (with data-index) so variable heights
+// are measured instead of guessed. `scrollRef` is a callback ref, so a container that mounts
+// after the first render (behind a loading state) is still picked up.
+export function useVirtualRows<E extends HTMLElement = HTMLDivElement>(count: number, estimateSize: number, overscan = 8) {
+  const [scrollElement, setScrollElement] = useState<E | null>(null);
+  const [viewport, setViewport] = useState({ top: 0, height: 0 });
+  // Measured heights by row index; a new measurement re-renders so offsets are recomputed
+  const sizes = useRef(new Map<number, number>());
+  const [, setMeasured] = useState(0);
+
+  useEffect(() => {
+    if (!scrollElement) return;
+    let frame = 0;
+    const update = () => {
+      frame = 0;
+      setViewport({ top: scrollElement.scrollTop, height: scrollElement.clientHeight });
+    };
+    // At most one state update per frame however often scroll fires
+    const schedule = () => {
+      if (!frame) frame = requestAnimationFrame(update);
+    };
+    update();
+    scrollElement.addEventListener("scroll", schedule, { passive: true });
+    const observer = new ResizeObserver(schedule);
+    observer.observe(scrollElement);
+    return () => {
+      scrollElement.removeEventListener("scroll", schedule);
+      observer.disconnect();
+      if (frame) cancelAnimationFrame(frame);
+    };
+  }, [scrollElement]);
+
+  const measureRef = useCallback((element: HTMLElement | null) => {
+    if (!element) return;
+    const index = Number(element.dataset.index);
+    if (!Number.isInteger(index)) return;
+    const height = element.getBoundingClientRect().height;
+    if (height > 0 && sizes.current.get(index) !== height) {
+      sizes.current.set(index, height);
+      setMeasured(version => version + 1);
+    }
+  }, []);
+
+  const offsets = new Array<number>(count + 1);
+  offsets[0] = 0;
+  for (let i = 0; i < count; i++) {
+    offsets[i + 1] = offsets[i] + (sizes.current.get(i) ?? estimateSize);
+  }
+  const totalSize = offsets[count];
+
+  const items: VirtualRow[] = [];
+  if (count > 0) {
+    // Before the container has a height, mount enough rows to fill a typical screen
+    const height = viewport.height || estimateSize * overscan * 2;
+    const first = Math.max(findRow(offsets, viewport.top) - overscan, 0);
+    const last = Math.min(findRow(offsets, viewport.top + height) + overscan, count - 1);
+    for (let index = first; index <= last; index++) {
+      items.push({ key: index, index, start: offsets[index], end: offsets[index + 1] });
+    }
+  }
+
+  const paddingTop = items.length > 0 ? items[0].start : 0;
+  const paddingBottom = items.length > 0 ? totalSize - items[items.length - 1].end : 0;
+
+  return { scrollRef: setScrollElement, items, paddingTop, paddingBottom, measureRef };
+}
@@ -94,3 +94,22 @@ export function getInitials(name: string): string {
     .toUpperCase()
     .substring(0, 2);
 }
+
+// Widths the server renders for uploaded images and PDF previews (server/image-variants.ts)
+const UPLOAD_VARIANT_WIDTHS = [160, 480, 1280];
+const UPLOAD_DOWNLOAD_URL = /^\/api\/uploads\/download\/\d+$/;
+
+/**
+ * Resized rendition of an uploaded image or PDF; other URLs are returned unchanged
+ */
+export function uploadVariantUrl(url: string, width: number): string {
+  return UPLOAD_DOWNLOAD_URL.test(url) ? `${url}?w=${width}` : url;
+}
+
+/**
+ * srcSet over the server's renditions of an uploaded file, or undefined for other URLs
+ */
+export function uploadVariantSrcSet(url: string): string | undefined {
+  if (!UPLOAD_DOWNLOAD_URL.test(url)) return undefined;
+  return UPLOAD_VARIANT_WIDTHS.map(width => `${url}?w=${width} ${width}w`).join(", ");
+}
@@ -4,6 +4,7 @@ import { useLocation } from 'wouter';
 import { useToast } from '@/hooks/use-toast';
 import { useAuth } from '@/hooks/use-auth';
 import { apiRequest, queryClient } from '@/lib/queryClient';
+import { uploadVariantUrl } from '@/lib/utils';
 import { ExternalLink, File, Trash } from 'lucide-react';
 
 import { 
@@ -373,7 +374,21 @@ function ApplicantPortal() {
                   {documents.map((doc: any) => {
                     return doc ? (
                       <TableRow key={doc.id}>
-                        <TableCell className="font-medium">{doc.documentName}</TableCell>
+                        <TableCell className="font-medium">
+                          <div className="flex items-center gap-3">
+                            {(doc.fileType?.startsWith('image/') || doc.fileType === 'application/pdf') && (
+                              <img
+                                src={uploadVariantUrl(doc.documentUrl, 160)}
+                                alt=""
+                                loading="lazy"
+                                className="h-10 w-10 rounded object-cover border"
+                                // PDF previews may not be rendered yet
+                                onError={(e) => { e.currentTarget.style.display = 'none'; }}
+                              />
+                            )}
+                            {doc.documentName}
+                          </div>
+                        </TableCell>
                         <TableCell>{new Date(doc.uploadedAt).toLocaleDateString()}</TableCell>
                         <TableCell>
                           {doc.verified_at ? (
@@ -29,9 +29,10 @@ type Applicant = {
 
 export default function ApplicantsTest() {
   // Fetch applicants
-  const { data: applicants, isLoading, error } = useQuery<Applicant[]>({
-    queryKey: ['/api/applicants'],
+  const { data, isLoading, error } = useQuery<{ items: Applicant[]; nextCursor: string | null }>({
+    queryKey: ['/api/applicants?limit=100'],
   });
+  const applicants = data?.items;
 
   // Helper function to get status badge style
   const getStatusBadge = (status: string) => {
@@ -1,11 +1,12 @@
-import { useState } from "react";
-import { useQuery, useMutation, useQueryClient } from "@tanstack/react-query";
+import { useEffect, useMemo, useState } from "react";
+import { useQuery, useInfiniteQuery, useMutation, useQueryClient } from "@tanstack/react-query";
 import { useLocation } from "wouter";
 import { apiRequest } from "@/lib/queryClient";
 import { Sidebar } from "@/components/ui/sidebar";
 import { MobileNavbar } from "@/components/ui/mobile-navbar";
 import { Header } from "@/components/ui/header";
 import { Button } from "@/components/ui/button";
+import { Input } from "@/components/ui/input";
 import { Card, CardContent, CardHeader, CardTitle } from "@/components/ui/card";
 import { 
   Table, 
@@ -35,17 +36,22 @@ import { Badge } from "@/components/ui/badge";
 import { PlusCircle, FileText, Trash2, UserCheck, UserX, Mail, Phone, ExternalLink, QrCode } from "lucide-react";
 import { printQRCode } from "@/lib/qr-code";
 import { useToast } from "@/hooks/use-toast";
-import { Applicant, Location, Staff } from "@shared/schema";
+import { Applicant, ApplicantListItem, ApplicantPage, Location, Staff } from "@shared/schema";
 import { useAuth } from "@/hooks/use-auth";
+import { useVirtualRows } from "@/hooks/use-virtual-rows";
 import { format } from "date-fns";
 
+const PAGE_SIZE = 50;
+
 export default function Applicants() {
   const [showForm, setShowForm] = useState(false);
-  const [selectedApplicant, setSelectedApplicant] = useState<Applicant | null>(null);
+  const [selectedApplicant, setSelectedApplicant] = useState<ApplicantListItem | null>(null);
   const [deleteDialogOpen, setDeleteDialogOpen] = useState(false);
   const [hireDialogOpen, setHireDialogOpen] = useState(false);
   const [selectedLocation, setSelectedLocation] = useState<number | null>(null);
   const [selectedStatus, setSelectedStatus] = useState<string | null>(null);
+  const [searchText, setSearchText] = useState("");
+  const [search, setSearch] = useState("");
   const [, setLocation] = useLocation();
   const navigate = (to: string) => setLocation(to);
   const { toast } = useToast();
@@ -56,26 +62,56 @@ export default function Applicants() {
   const isManager = user?.role === "manager";
   const isFloorManager = user?.role === "floor_manager";
 
-  // Fetch applicants
-  const { data: applicants, isLoading } = useQuery<Applicant[]>({
-    queryKey: ['/api/applicants'],
+  // Debounce the name/email search so typing doesn't fire a request per keystroke
+  useEffect(() => {
+    const timer = setTimeout(() => setSearch(searchText.trim()), 300);
+    return () => clearTimeout(timer);
+  }, [searchText]);
+
+  // Fetch applicants page by page; filtering happens on the server
+  const filters = { locationId: selectedLocation, status: selectedStatus, q: search };
+  const {
+    data,
+    isLoading,
+    fetchNextPage,
+    hasNextPage,
+    isFetchingNextPage,
+  } = useInfiniteQuery<ApplicantPage>({
+    queryKey: ['/api/applicants', filters],
+    initialPageParam: null as string | null,
+    queryFn: async ({ pageParam }) => {
+      const params = new URLSearchParams({ limit: String(PAGE_SIZE) });
+      if (filters.locationId) params.set('locationId', String(filters.locationId));
+      if (filters.status) params.set('status', filters.status);
+      if (filters.q) params.set('q', filters.q);
+      if (pageParam) params.set('cursor', pageParam as string);
+      const res = await apiRequest('GET', `/api/applicants?${params}`);
+      return res.json();
+    },
+    getNextPageParam: (lastPage) => lastPage.nextCursor,
+  });
+  const applicants = data?.pages.flatMap(page => page.items);
+  const applicantRows = useVirtualRows(applicants?.length ?? 0, 81);
+
+  // Scrolling near the end of what's loaded pulls in the next page
+  const lastVisibleRow = applicantRows.items[applicantRows.items.length - 1]?.index ?? -1;
+  useEffect(() => {
+    if (hasNextPage && !isFetchingNextPage && applicants && lastVisibleRow >= applicants.length - 5) {
+      fetchNextPage();
+    }
+  }, [lastVisibleRow, applicants?.length, hasNextPage, isFetchingNextPage, fetchNextPage]);
+
+  // The list projection is slim; load the full record when editing
+  const { data: applicantDetails } = useQuery<Applicant>({
+    queryKey: [`/api/applicants/${selectedApplicant?.id}`],
+    enabled: showForm && !!selectedApplicant,
   });
 
   // Fetch locations
   const { data: locations } = useQuery<Location[]>({
     queryKey: ['/api/locations'],
   });
-
-  // Filter applicants based on selected location and status
-  const filteredApplicants = applicants?.filter(applicant => {
-    if (selectedLocation && applicant.locationId !== selectedLocation) {
-      return false;
-    }
-    if (selectedStatus && applicant.status !== selectedStatus) {
-      return false;
-    }
-    return true;
-  });
+  const locationsById = useMemo(() => new Map(locations?.map(l => [l.id, l])), [locations]);
 
   // Delete mutation
   const deleteMutation = useMutation({
@@ -146,13 +182,13 @@ export default function Applicants() {
   });
 
   // Handle delete applicant
-  const handleDelete = (applicant: Applicant) => {
+  const handleDelete = (applicant: ApplicantListItem) => {
     setSelectedApplicant(applicant);
     setDeleteDialogOpen(true);
   };
 
   // Handle hire applicant
-  const handleHire = (applicant: Applicant) => {
+  const handleHire = (applicant: ApplicantListItem) => {
     setSelectedApplicant(applicant);
     setHireDialogOpen(true);
   };
@@ -245,10 +281,14 @@ export default function Applicants() {
                 >
                   Back to Applicants
                 </Button>
-                <ApplicantForm 
-                  applicant={selectedApplicant || undefined} 
-                  isEditing={!!selectedApplicant} 
-                />
+                {selectedApplicant && !applicantDetails ? (
+                  <p>Loading applicant...</p>
+                ) : (
+                  <ApplicantForm 
+                    applicant={selectedApplicant ? applicantDetails : undefined} 
+                    isEditing={!!selectedApplicant} 
+                  />
+                )}
               </div>
             ) : (
               // Show applicants list
@@ -276,6 +316,21 @@ export default function Applicants() {
                 </div>
 
                 <div className="mb-6 flex flex-col sm:flex-row gap-4">
+                  <Card className="w-full sm:w-auto">
+                    <CardContent className="p-4">
+                      <div className="flex items-center justify-between gap-2">
+                        <label htmlFor="applicant-search" className="text-sm font-medium text-gray-700">Search:</label>
+                        <Input
+                          id="applicant-search"
+                          className="w-[220px]"
+                          placeholder="Name or email"
+                          value={searchText}
+                          onChange={(e) => setSearchText(e.target.value)}
+                        />
+                      </div>
+                    </CardContent>
+                  </Card>
+
                   <Card className="w-full sm:w-auto">
                     <CardContent className="p-4">
                       <div className="flex items-center justify-between">
@@ -334,7 +389,9 @@ export default function Applicants() {
                       <div className="flex justify-center py-4">
                         <p>Loading applicants...</p>
                       </div>
-                    ) : filteredApplicants && filteredApplicants.length > 0 ? (
+                    ) : applicants && applicants.length > 0 ? (
+                      <>
+                      <div ref={applicantRows.scrollRef} className="max-h-[70vh] overflow-auto">
                       <Table>
                         <TableHeader>
                           <TableRow>
@@ -347,11 +404,15 @@ export default function Applicants() {
                           </TableRow>
                         </TableHeader>
                         <TableBody>
-                          {filteredApplicants.map((applicant) => {
-                            const location = locations?.find(l => l.id === applicant.locationId);
+                          {applicantRows.paddingTop > 0 && (
+                            <tr aria-hidden style={{ height: applicantRows.paddingTop }} />
+                          )}
+                          {applicantRows.items.map((row) => {
+                            const applicant = applicants[row.index];
+                            const location = applicant.locationId ? locationsById.get(applicant.locationId) : undefined;
                             
                             return (
-                              <TableRow key={applicant.id}>
+                              <TableRow key={applicant.id} ref={applicantRows.measureRef} data-index={row.index}>
                                 <TableCell className="font-medium">
                                   {applicant.name}
                                   {location && (
@@ -436,8 +497,24 @@ export default function Applicants() {
                               </TableRow>
                             );
                           })}
+                          {applicantRows.paddingBottom > 0 && (
+                            <tr aria-hidden style={{ height: applicantRows.paddingBottom }} />
+                          )}
                         </TableBody>
                       </Table>
+                      </div>
+                      {hasNextPage && (
+                        <div className="flex justify-center pt-4">
+                          <Button
+                            variant="outline"
+                            onClick={() => fetchNextPage()}
+                            disabled={isFetchingNextPage}
+                          >
+                            {isFetchingNextPage ? "Loading..." : "Load more"}
+                          </Button>
+                        </div>
+                      )}
+                      </>
                     ) : (
                       <div className="text-center py-6">
                         <p className="text-gray-500">No applicants found</p>
@@ -35,7 +35,7 @@ import { Alert, AlertDescription } from "@/components/ui/alert";
 import { CashCountForm } from "@/components/cash/cash-count-form";
 import { PlusCircle, Pencil, Trash2, DollarSign, CalendarRange, Download, CheckCircle, AlertCircle } from "lucide-react";
 import { useToast } from "@/hooks/use-toast";
-import { CashCount, Location } from "@shared/schema";
+import { CashCount, CashSummaryBucket, Location } from "@shared/schema";
 import { useAuth } from "@/hooks/use-auth";
 import { format } from "date-fns";
 import { formatCurrency } from "@/lib/utils";
@@ -148,42 +148,25 @@ export default function CashManagement() {
     setSelectedLocation(locationId);
   };
 
-  // Calculate daily totals
-  const calculateDailyTotals = () => {
-    if (!filteredCashCounts || filteredCashCounts.length === 0) {
-      return {
-        cashTotal: 0,
-        cardTotal: 0,
-        totalSales: 0,
-        discrepancyTotal: 0
-      };
-    }
-    
-    return filteredCashCounts.reduce((totals, count) => {
-      // Skip opening counts to avoid double counting floats
-      if (count.countType === "opening") {
-        return totals;
-      }
-      
-      const cashAmount = Number(count.cashAmount) - (count.countType === "closing" ? Number(count.floatAmount) : 0);
-      const cardAmount = Number(count.cardAmount);
-      const discrepancy = Number(count.discrepancy || 0);
-      
-      return {
-        cashTotal: totals.cashTotal + cashAmount,
-        cardTotal: totals.cardTotal + cardAmount,
-        totalSales: totals.totalSales + cashAmount + cardAmount,
-        discrepancyTotal: totals.discrepancyTotal + discrepancy
-      };
-    }, {
-      cashTotal: 0,
-      cardTotal: 0,
-      totalSales: 0,
-      discrepancyTotal: 0
-    });
-  };
+  // Daily totals come pre-aggregated from the server's cash rollups. The key sits under
+  // '/api/cash-counts' so invalidating the counts also refreshes the totals.
+  const summaryDay = formatDateForApi(selectedDate);
+  const { data: dailySummary } = useQuery<{ buckets: CashSummaryBucket[] }>({
+    queryKey: ['/api/cash-counts', 'summary', summaryDay, selectedLocation],
+    queryFn: async () => {
+      const params = new URLSearchParams({ from: summaryDay, to: summaryDay, groupBy: 'total' });
+      if (selectedLocation) params.set('locationIds', String(selectedLocation));
+      const res = await apiRequest('GET', `/api/cash-counts/summary?${params}`);
+      return res.json();
+    },
+  });
 
-  const dailyTotals = calculateDailyTotals();
+  const dailyTotals = dailySummary?.buckets[0] ?? {
+    cashTotal: 0,
+    cardTotal: 0,
+    totalSales: 0,
+    discrepancyTotal: 0
+  };
 
   // If not a manager or floor manager, redirect to dashboard
   if (!isLoading && !isManager && !isFloorManager) {
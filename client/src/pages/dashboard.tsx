@@ -19,6 +19,7 @@ import { Button } from "@/components/ui/button";
 import { useLocation } from "wouter";
 import { useAuth } from "@/hooks/use-auth";
 import { useToast } from "@/hooks/use-toast";
+import { DashboardSummary } from "@shared/schema";
 
 
 export default function Dashboard() {
@@ -75,32 +76,16 @@ export default function Dashboard() {
     }
   };
 
-  // Fetch statistics data
-  const { data: staffStats } = useQuery({
-    queryKey: ['/api/staff/location', selectedLocation],
+  // All KPIs are computed server side and come back in one small payload
+  const { data: summary, isLoading: isLoadingSummary } = useQuery<DashboardSummary>({
+    queryKey: [`/api/dashboard/summary/${selectedLocation}`],
     enabled: !!selectedLocation,
   });
 
-  const { data: shiftsStats } = useQuery({
-    queryKey: ['/api/shifts'],
-    enabled: !!selectedLocation,
-  });
-
-  const { data: applicantsStats } = useQuery({
-    queryKey: ['/api/applicants/status/new'],
-  });
-
-  // Count data
-  const totalStaff = staffStats?.length || 0;
-  const shiftsThisWeek = shiftsStats?.length || 0;
-  const hoursScheduled = shiftsStats?.reduce((total, shift) => {
-    // Calculate hours between start and end time (simplified)
-    const startHour = parseInt(shift.startTime.split(":")[0]);
-    const endHour = parseInt(shift.endTime.split(":")[0]);
-    const hours = endHour - startHour;
-    return total + hours;
-  }, 0) || 0;
-  const newApplicants = applicantsStats?.length || 0;
+  const totalStaff = summary?.staff.total ?? 0;
+  const shiftsThisWeek = summary?.shifts.total ?? 0;
+  const hoursScheduled = summary?.shifts.hoursScheduled ?? 0;
+  const newApplicants = summary?.applicants.byStatus.new ?? 0;
 
   // Handle location change from header
   const handleLocationChange = (locationId: number) => {
@@ -226,10 +211,13 @@ export default function Dashboard() {
               
               {/* Applicants Summary and Cash Management */}
               <div className="lg:col-span-1 space-y-6">
-                <ApplicantsSummary locationId={selectedLocation || undefined} />
+                <ApplicantsSummary
+                  locationId={selectedLocation || undefined}
+                  newCount={summary?.applicants.byStatus.new}
+                />
                 
                 {selectedLocation > 0 && (
-                  <CashManagementSummary locationId={selectedLocation} />
+                  <CashManagementSummary cash={summary?.cash} isLoading={isLoadingSummary} />
                 )}
               </div>
             </div>
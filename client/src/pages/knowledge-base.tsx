@@ -1,5 +1,5 @@
-import { useState } from "react";
-import { useQuery, useMutation, useQueryClient } from "@tanstack/react-query";
+import { useEffect, useState } from "react";
+import { useQuery, useInfiniteQuery, useMutation, useQueryClient } from "@tanstack/react-query";
 import { useLocation } from "wouter";
 import { apiRequest } from "@/lib/queryClient";
 import { Sidebar } from "@/components/ui/sidebar";
@@ -33,15 +33,17 @@ import {
 } from "@/components/ui/select";
 import { PlusCircle, FileText, BookOpen, Trash2, Edit, Search } from "lucide-react";
 import { useToast } from "@/hooks/use-toast";
-import { KbArticle, KbCategory, Location } from "@shared/schema";
+import { KbArticle, KbArticleSummary, KbCategory, KbSearchPage, Location } from "@shared/schema";
 import { useAuth } from "@/hooks/use-auth";
 import { format } from "date-fns";
+import { uploadVariantSrcSet, uploadVariantUrl } from "@/lib/utils";
 import { Input } from "@/components/ui/input";
 
 export default function KnowledgeBase() {
   const [selectedCategory, setSelectedCategory] = useState<number | null>(null);
   const [selectedLocation, setSelectedLocation] = useState<number | null>(null);
   const [searchQuery, setSearchQuery] = useState<string>("");
+  const [search, setSearch] = useState<string>("");
   const [showArticleForm, setShowArticleForm] = useState(false);
   const [showCategoryForm, setShowCategoryForm] = useState(false);
   const [selectedArticle, setSelectedArticle] = useState<KbArticle | null>(null);
@@ -71,10 +73,14 @@ export default function KnowledgeBase() {
     queryKey: ['/api/locations'],
   });
 
-  // Fetch articles based on selected category
-  const { data: articles, isLoading: loadingArticles } = useQuery<KbArticle[]>({
-    queryKey: ['/api/kb-articles/category', selectedCategory],
+  // Fetch the selected category's articles: titles and excerpts only, the body loads on open
+  const { data: articles, isLoading: loadingArticles } = useQuery<KbArticleSummary[]>({
+    queryKey: ['/api/kb/articles', { categoryId: selectedCategory }],
     enabled: !!selectedCategory,
+    queryFn: async () => {
+      const res = await apiRequest('GET', `/api/kb/articles?categoryId=${selectedCategory}`);
+      return res.json();
+    },
   });
 
   // Filter categories based on selected location
@@ -85,14 +91,45 @@ export default function KnowledgeBase() {
     return true;
   });
 
-  // Filter articles based on search query
-  const filteredArticles = articles?.filter(article => {
-    if (searchQuery && !article.title.toLowerCase().includes(searchQuery.toLowerCase()) && 
-        !article.content.toLowerCase().includes(searchQuery.toLowerCase())) {
-      return false;
-    }
-    return true;
+  // Debounce the search so typing doesn't fire a request per keystroke
+  useEffect(() => {
+    const timer = setTimeout(() => setSearch(searchQuery.trim()), 300);
+    return () => clearTimeout(timer);
+  }, [searchQuery]);
+
+  // Search runs on the server (ranked full-text within the category); hits carry a snippet,
+  // not the article body
+  const {
+    data: searchData,
+    isLoading: searching,
+    fetchNextPage: fetchMoreHits,
+    hasNextPage: hasMoreHits,
+  } = useInfiniteQuery<KbSearchPage>({
+    queryKey: ['/api/kb/search', { q: search, categoryId: selectedCategory }],
+    enabled: !!selectedCategory && search.length > 0,
+    initialPageParam: 0,
+    queryFn: async ({ pageParam }) => {
+      const params = new URLSearchParams({ q: search, categoryId: String(selectedCategory), offset: String(pageParam) });
+      const res = await apiRequest('GET', `/api/kb/search?${params}`);
+      return res.json();
+    },
+    getNextPageParam: (lastPage) => lastPage.nextOffset,
   });
+  const searchHits = search ? searchData?.pages.flatMap(page => page.items) : undefined;
+
+  const openArticle = async (id: number) => {
+    try {
+      const res = await apiRequest('GET', `/api/kb/articles/${id}`);
+      setSelectedArticle(await res.json());
+    } catch (error) {
+      console.error('Error loading article:', error);
+      toast({
+        title: "Error",
+        description: "Failed to load article. Please try again.",
+        variant: "destructive",
+      });
+    }
+  };
 
   // Delete mutation for articles
   const deleteArticleMutation = useMutation({
@@ -102,7 +139,8 @@ export default function KnowledgeBase() {
     onSuccess: async () => {
       // Invalidate queries
       await queryClient.invalidateQueries({ queryKey: ['/api/kb-articles'] });
-      await queryClient.invalidateQueries({ queryKey: ['/api/kb-articles/category', selectedCategory] });
+      await queryClient.invalidateQueries({ queryKey: ['/api/kb/articles'] });
+      await queryClient.invalidateQueries({ queryKey: ['/api/kb/search'] });
       
       toast({
         title: "Article Deleted",
@@ -189,7 +227,14 @@ export default function KnowledgeBase() {
             <div className="grid grid-cols-1 sm:grid-cols-2 md:grid-cols-3 gap-4">
               {article.images.map((img, idx) => (
                 <div key={idx} className="border rounded overflow-hidden">
-                  <img src={img} alt={`Image ${idx + 1}`} className="w-full h-auto" />
+                  <img
+                    src={uploadVariantUrl(img, 480)}
+                    srcSet={uploadVariantSrcSet(img)}
+                    sizes="(min-width: 768px) 33vw, (min-width: 640px) 50vw, 100vw"
+                    loading="lazy"
+                    alt={`Image ${idx + 1}`}
+                    className="w-full h-auto"
+                  />
                 </div>
               ))}
             </div>
@@ -373,18 +418,52 @@ export default function KnowledgeBase() {
                             <div className="py-6 text-center">Loading articles...</div>
                           ) : selectedArticle ? (
                             <ArticleView article={selectedArticle} />
-                          ) : filteredArticles && filteredArticles.length > 0 ? (
+                          ) : search ? (
+                            searching ? (
+                              <div className="py-6 text-center">Searching...</div>
+                            ) : searchHits && searchHits.length > 0 ? (
+                              <div className="space-y-4">
+                                <div className="grid grid-cols-1 sm:grid-cols-2 md:grid-cols-1 lg:grid-cols-2 gap-4">
+                                  {searchHits.map(hit => (
+                                    <Card
+                                      key={hit.id}
+                                      className="cursor-pointer hover:shadow-md transition-shadow"
+                                      onClick={() => openArticle(hit.id)}
+                                    >
+                                      <CardContent className="p-4">
+                                        <h3 className="font-medium mb-1 truncate">{hit.title}</h3>
+                                        {/* The snippet is escaped server-side; its only markup is <mark> */}
+                                        <p
+                                          className="text-sm text-gray-500 line-clamp-2"
+                                          dangerouslySetInnerHTML={{ __html: hit.snippet }}
+                                        />
+                                      </CardContent>
+                                    </Card>
+                                  ))}
+                                </div>
+                                {hasMoreHits && (
+                                  <div className="text-center">
+                                    <Button variant="outline" onClick={() => fetchMoreHits()}>Load more</Button>
+                                  </div>
+                                )}
+                              </div>
+                            ) : (
+                              <div className="py-10 text-center">
+                                <p className="text-gray-500">No articles match "{search}"</p>
+                              </div>
+                            )
+                          ) : articles && articles.length > 0 ? (
                             <div className="grid grid-cols-1 sm:grid-cols-2 md:grid-cols-1 lg:grid-cols-2 gap-4">
-                              {filteredArticles.map(article => (
+                              {articles.map(article => (
                                 <Card 
                                   key={article.id} 
                                   className="cursor-pointer hover:shadow-md transition-shadow"
-                                  onClick={() => setSelectedArticle(article)}
+                                  onClick={() => openArticle(article.id)}
                                 >
                                   <CardContent className="p-4">
                                     <h3 className="font-medium mb-1 truncate">{article.title}</h3>
                                     <p className="text-sm text-gray-500 line-clamp-2">
-                                      {article.content.substring(0, 100)}...
+                                      {article.excerpt}...
                                     </p>
                                   </CardContent>
                                 </Card>
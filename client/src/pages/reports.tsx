@@ -21,11 +21,19 @@ import {
   SelectTrigger,
   SelectValue,
 } from "@/components/ui/select";
+import {
+  DropdownMenu,
+  DropdownMenuContent,
+  DropdownMenuItem,
+  DropdownMenuLabel,
+  DropdownMenuSeparator,
+  DropdownMenuTrigger,
+} from "@/components/ui/dropdown-menu";
 import { useAuth } from "@/hooks/use-auth";
 import { BarChart, LineChart, PieChart, Download, Calendar, FilePieChart } from "lucide-react";
 import { useQuery } from "@tanstack/react-query";
 import { Location } from "@shared/schema";
-import { format, subDays, startOfWeek, endOfWeek, startOfMonth, endOfMonth } from "date-fns";
+import { format, subDays, startOfWeek, endOfWeek, startOfMonth, endOfMonth, startOfYear, endOfYear } from "date-fns";
 
 export default function Reports() {
   const [selectedLocation, setSelectedLocation] = useState<number>(0);
@@ -74,6 +82,22 @@ export default function Reports() {
     }
   };
 
+  // Streaming exports cover the selected timeframe and location (all locations when none is picked)
+  const exportUrl = (kind: "shifts" | "cash-counts" | "applicants", fileFormat: "csv" | "ndjson" = "csv") => {
+    const [from, to] =
+      selectedTimeframe === "daily" ? [today, today]
+      : selectedTimeframe === "monthly" ? [monthStart, monthEnd]
+      : selectedTimeframe === "yearly" ? [startOfYear(today), endOfYear(today)]
+      : [weekStart, weekEnd];
+    const params = new URLSearchParams({
+      from: format(from, "yyyy-MM-dd"),
+      to: format(to, "yyyy-MM-dd"),
+      format: fileFormat,
+    });
+    if (defaultLocationId > 0) params.set("locationIds", String(defaultLocationId));
+    return `/api/exports/${kind}?${params}`;
+  };
+
   // Placeholder data for reports
   const salesData = {
     daily: [1200, 1500, 1800, 2100, 1900, 1700, 1600],
@@ -121,10 +145,30 @@ export default function Reports() {
                 </p>
               </div>
               <div className="mt-4 sm:mt-0">
-                <Button variant="outline">
-                  <Download className="h-4 w-4 mr-2" />
-                  Export Report
-                </Button>
+                <DropdownMenu>
+                  <DropdownMenuTrigger asChild>
+                    <Button variant="outline">
+                      <Download className="h-4 w-4 mr-2" />
+                      Export Report
+                    </Button>
+                  </DropdownMenuTrigger>
+                  <DropdownMenuContent align="end">
+                    <DropdownMenuLabel>CSV for the selected timeframe</DropdownMenuLabel>
+                    <DropdownMenuItem asChild>
+                      <a href={exportUrl("shifts")} download>Shifts</a>
+                    </DropdownMenuItem>
+                    <DropdownMenuItem asChild>
+                      <a href={exportUrl("cash-counts")} download>Cash counts</a>
+                    </DropdownMenuItem>
+                    <DropdownMenuItem asChild>
+                      <a href={exportUrl("applicants")} download>Applicants</a>
+                    </DropdownMenuItem>
+                    <DropdownMenuSeparator />
+                    <DropdownMenuItem asChild>
+                      <a href={exportUrl("shifts", "ndjson")} download>Shifts (NDJSON)</a>
+                    </DropdownMenuItem>
+                  </DropdownMenuContent>
+                </DropdownMenu>
               </div>
             </div>
 
@@ -1,4 +1,4 @@
-import { useState } from "react";
+import { useMemo, useState } from "react";
 import { useQuery, useMutation, useQueryClient } from "@tanstack/react-query";
 import { useLocation } from "wouter";
 import { apiRequest } from "@/lib/queryClient";
@@ -38,6 +38,7 @@ import { PlusCircle, Pencil, Trash2, UserPlus, Award, Clock } from "lucide-react
 import { useToast } from "@/hooks/use-toast";
 import { Staff, User, StaffCompetency, Competency, Location } from "@shared/schema";
 import { useAuth } from "@/hooks/use-auth";
+import { useVirtualRows } from "@/hooks/use-virtual-rows";
 
 export default function StaffManagement() {
   const [activeTab, setActiveTab] = useState("staff");
@@ -78,38 +79,16 @@ export default function StaffManagement() {
     queryKey: ['/api/locations'],
   });
 
-  // For each staff member, fetch their competencies
-  const staffWithCompetencies = staffMembers?.map(staff => {
-    // Filter by location if needed
-    if (selectedLocation && staff.locationId !== selectedLocation) {
-      return null;
-    }
-
-    // Get staff competencies
-    const { data: staffCompetencies } = useQuery<StaffCompetency[]>({
-      queryKey: ['/api/staff-competencies/staff', staff.id],
-      enabled: !!staff.id,
-    });
-
-    // Get user details
-    const user = users?.find(u => u.id === staff.userId);
-
-    // Get location details
-    const location = locations?.find(l => l.id === staff.locationId);
-
-    // Get competency details for each staff competency
-    const competenciesWithDetails = staffCompetencies?.map(sc => ({
-      ...sc,
-      competencyDetails: competencies?.find(c => c.id === sc.competencyId)
-    }));
+  // Filter by location; per-row details (competencies) are loaded by the rows that are on screen
+  const visibleStaff = useMemo(
+    () => staffMembers?.filter(staff => !selectedLocation || staff.locationId === selectedLocation) ?? [],
+    [staffMembers, selectedLocation],
+  );
+  const usersById = useMemo(() => new Map(users?.map(u => [u.id, u])), [users]);
+  const locationsById = useMemo(() => new Map(locations?.map(l => [l.id, l])), [locations]);
+  const competenciesById = useMemo(() => new Map(competencies?.map(c => [c.id, c])), [competencies]);
 
-    return {
-      ...staff,
-      user,
-      location,
-      competencies: competenciesWithDetails,
-    };
-  }).filter(Boolean);
+  const staffRows = useVirtualRows(visibleStaff.length, 73);
 
   // Delete mutation for staff
   const deleteStaffMutation = useMutation({
@@ -207,18 +186,6 @@ export default function StaffManagement() {
     return null;
   }
 
-  // Format competency badge style based on level
-  const getCompetencyBadgeStyle = (level: number) => {
-    switch (level) {
-      case 5: return "bg-green-100 text-green-800 border-green-200";
-      case 4: return "bg-blue-100 text-blue-800 border-blue-200";
-      case 3: return "bg-indigo-100 text-indigo-800 border-indigo-200";
-      case 2: return "bg-amber-100 text-amber-800 border-amber-200";
-      case 1: return "bg-orange-100 text-orange-800 border-orange-200";
-      default: return "bg-gray-100 text-gray-800 border-gray-200";
-    }
-  };
-
   return (
     <div className="flex h-screen overflow-hidden">
       {/* Sidebar for larger screens */}
@@ -319,7 +286,8 @@ export default function StaffManagement() {
                           <div className="flex justify-center py-4">
                             <p>Loading staff members...</p>
                           </div>
-                        ) : staffWithCompetencies && staffWithCompetencies.length > 0 ? (
+                        ) : visibleStaff.length > 0 ? (
+                          <div ref={staffRows.scrollRef} className="max-h-[70vh] overflow-auto">
                           <Table>
                             <TableHeader>
                               <TableRow>
@@ -332,79 +300,33 @@ export default function StaffManagement() {
                               </TableRow>
                             </TableHeader>
                             <TableBody>
-                              {staffWithCompetencies.map((staff) => (
-                                <TableRow key={staff.id}>
-                                  <TableCell>
-                                    <div className="flex items-center">
-                                      <Avatar className="h-8 w-8 mr-2">
-                                        <AvatarImage src={`https://ui-avatars.com/api/?name=${staff.user?.name || 'Staff Member'}`} />
-                                        <AvatarFallback>{staff.user?.name?.charAt(0) || 'S'}</AvatarFallback>
-                                      </Avatar>
-                                      <div>
-                                        <div className="font-medium">{staff.user?.name || `Staff #${staff.id}`}</div>
-                                        <div className="text-sm text-gray-500">{staff.user?.email}</div>
-                                      </div>
-                                    </div>
-                                  </TableCell>
-                                  <TableCell>{staff.position}</TableCell>
-                                  <TableCell>{staff.location?.name || `Location #${staff.locationId}`}</TableCell>
-                                  <TableCell>
-                                    <div className="flex flex-wrap gap-1">
-                                      {staff.competencies?.map(sc => (
-                                        <Badge 
-                                          key={sc.id}
-                                          variant="outline"
-                                          className={getCompetencyBadgeStyle(sc.level)}
-                                        >
-                                          {sc.competencyDetails?.name || "Competency"} {sc.level}
-                                        </Badge>
-                                      ))}
-                                      {(!staff.competencies || staff.competencies.length === 0) && (
-                                        <span className="text-sm text-gray-500">No competencies assigned</span>
-                                      )}
-                                    </div>
-                                  </TableCell>
-                                  <TableCell>
-                                    <div className="flex items-center">
-                                      <Clock className="h-4 w-4 mr-1 text-gray-400" />
-                                      <span className="text-sm">{staff.wantedHours} hrs/week</span>
-                                    </div>
-                                  </TableCell>
-                                  <TableCell className="text-right">
-                                    <div className="flex justify-end space-x-2">
-                                      <Button
-                                        variant="outline"
-                                        size="sm"
-                                        onClick={() => handleEditStaff(staff)}
-                                      >
-                                        <Pencil className="h-4 w-4" />
-                                        <span className="sr-only">Edit</span>
-                                      </Button>
-                                      {isManager && (
-                                        <Button
-                                          variant="outline"
-                                          size="sm"
-                                          className="text-red-500 hover:text-red-600"
-                                          onClick={() => handleDeleteStaff(staff)}
-                                        >
-                                          <Trash2 className="h-4 w-4" />
-                                          <span className="sr-only">Delete</span>
-                                        </Button>
-                                      )}
-                                      <Button
-                                        variant="outline"
-                                        size="sm"
-                                        onClick={() => navigate(`/staff-management/competencies/assign/${staff.id}`)}
-                                      >
-                                        <Award className="h-4 w-4" />
-                                        <span className="sr-only">Assign Competency</span>
-                                      </Button>
-                                    </div>
-                                  </TableCell>
-                                </TableRow>
-                              ))}
+                              {staffRows.paddingTop > 0 && (
+                                <tr aria-hidden style={{ height: staffRows.paddingTop }} />
+                              )}
+                              {staffRows.items.map((row) => {
+                                const staff = visibleStaff[row.index];
+                                return (
+                                  <StaffRow
+                                    key={staff.id}
+                                    index={row.index}
+                                    measureRef={staffRows.measureRef}
+                                    staff={staff}
+                                    user={usersById.get(staff.userId)}
+                                    location={locationsById.get(staff.locationId)}
+                                    competenciesById={competenciesById}
+                                    canDelete={isManager}
+                                    onEdit={() => handleEditStaff(staff)}
+                                    onDelete={() => handleDeleteStaff(staff)}
+                                    onAssign={() => navigate(`/staff-management/competencies/assign/${staff.id}`)}
+                                  />
+                                );
+                              })}
+                              {staffRows.paddingBottom > 0 && (
+                                <tr aria-hidden style={{ height: staffRows.paddingBottom }} />
+                              )}
                             </TableBody>
                           </Table>
+                          </div>
                         ) : (
                           <div className="text-center py-6">
                             <p className="text-gray-500">No staff members found</p>
@@ -541,3 +463,108 @@ export default function StaffManagement() {
     </div>
   );
 }
+
+// Format competency badge style based on level
+function getCompetencyBadgeStyle(level: number) {
+  switch (level) {
+    case 5: return "bg-green-100 text-green-800 border-green-200";
+    case 4: return "bg-blue-100 text-blue-800 border-blue-200";
+    case 3: return "bg-indigo-100 text-indigo-800 border-indigo-200";
+    case 2: return "bg-amber-100 text-amber-800 border-amber-200";
+    case 1: return "bg-orange-100 text-orange-800 border-orange-200";
+    default: return "bg-gray-100 text-gray-800 border-gray-200";
+  }
+}
+
+interface StaffRowProps {
+  index: number;
+  measureRef: (element: HTMLTableRowElement | null) => void;
+  staff: Staff;
+  user?: User;
+  location?: Location;
+  competenciesById: Map<number, Competency>;
+  canDelete: boolean;
+  onEdit: () => void;
+  onDelete: () => void;
+  onAssign: () => void;
+}
+
+// One staff table row; its competencies are fetched only while the row is rendered
+function StaffRow({ index, measureRef, staff, user, location, competenciesById, canDelete, onEdit, onDelete, onAssign }: StaffRowProps) {
+  const { data: staffCompetencies } = useQuery<StaffCompetency[]>({
+    queryKey: ['/api/staff-competencies/staff', staff.id],
+    enabled: !!staff.id,
+  });
+
+  return (
+    <TableRow ref={measureRef} data-index={index}>
+      <TableCell>
+        <div className="flex items-center">
+          <Avatar className="h-8 w-8 mr-2">
+            <AvatarImage src={`https://ui-avatars.com/api/?name=${user?.name || 'Staff Member'}`} />
+            <AvatarFallback>{user?.name?.charAt(0) || 'S'}</AvatarFallback>
+          </Avatar>
+          <div>
+            <div className="font-medium">{user?.name || `Staff #${staff.id}`}</div>
+            <div className="text-sm text-gray-500">{user?.email}</div>
+          </div>
+        </div>
+      </TableCell>
+      <TableCell>{staff.position}</TableCell>
+      <TableCell>{location?.name || `Location #${staff.locationId}`}</TableCell>
+      <TableCell>
+        <div className="flex flex-wrap gap-1">
+          {staffCompetencies?.map(sc => (
+            <Badge
+              key={sc.id}
+              variant="outline"
+              className={getCompetencyBadgeStyle(sc.level)}
+            >
+              {competenciesById.get(sc.competencyId)?.name || "Competency"} {sc.level}
+            </Badge>
+          ))}
+          {(!staffCompetencies || staffCompetencies.length === 0) && (
+            <span className="text-sm text-gray-500">No competencies assigned</span>
+          )}
+        </div>
+      </TableCell>
+      <TableCell>
+        <div className="flex items-center">
+          <Clock className="h-4 w-4 mr-1 text-gray-400" />
+          <span className="text-sm">{staff.wantedHours} hrs/week</span>
+        </div>
+      </TableCell>
+      <TableCell className="text-right">
+        <div className="flex justify-end space-x-2">
+          <Button
+            variant="outline"
+            size="sm"
+            onClick={onEdit}
+          >
+            <Pencil className="h-4 w-4" />
+            <span className="sr-only">Edit</span>
+          </Button>
+          {canDelete && (
+            <Button
+              variant="outline"
+              size="sm"
+              className="text-red-500 hover:text-red-600"
+              onClick={onDelete}
+            >
+              <Trash2 className="h-4 w-4" />
+              <span className="sr-only">Delete</span>
+            </Button>
+          )}
+          <Button
+            variant="outline"
+            size="sm"
+            onClick={onAssign}
+          >
+            <Award className="h-4 w-4" />
+            <span className="sr-only">Assign Competency</span>
+          </Button>
+        </div>
+      </TableCell>
+    </TableRow>
+  );
+}
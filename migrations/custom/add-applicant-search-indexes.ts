@@ -0,0 +1,58 @@
+import { pool } from '../../server/db';
+import { fileURLToPath } from 'url';
+
+async function runMigration() {
+  const client = await pool.connect();
+
+  try {
+    await client.query('BEGIN');
+
+    // Trigram operator classes for the name/email search
+    await client.query(`CREATE EXTENSION IF NOT EXISTS pg_trgm;`);
+
+    // Keyset pagination walks (created_at, id) newest first, optionally within a location/status
+    console.log('Creating applicant list indexes...');
+    await client.query(`
+      CREATE INDEX IF NOT EXISTS applicants_location_status_created_idx
+        ON applicants (location_id, status, created_at DESC, id DESC);
+    `);
+    await client.query(`
+      CREATE INDEX IF NOT EXISTS applicants_created_idx
+        ON applicants (created_at DESC, id DESC);
+    `);
+
+    console.log('Creating applicant search indexes...');
+    await client.query(`
+      CREATE INDEX IF NOT EXISTS applicants_name_trgm_idx ON applicants USING gin (name gin_trgm_ops);
+    `);
+    await client.query(`
+      CREATE INDEX IF NOT EXISTS applicants_email_trgm_idx ON applicants USING gin (email gin_trgm_ops);
+    `);
+
+    await client.query('COMMIT');
+  } catch (error) {
+    await client.query('ROLLBACK');
+    console.error('Migration failed:', error);
+    throw error;
+  } finally {
+    client.release();
+  }
+}
+
+// For ESM, check if this is the main module
+const __filename = fileURLToPath(import.meta.url);
+const isMainModule = process.argv[1] === __filename;
+
+if (isMainModule) {
+  runMigration()
+    .then(() => {
+      console.log('Migration completed successfully');
+      process.exit(0);
+    })
+    .catch((error) => {
+      console.error('Migration failed:', error);
+      process.exit(1);
+    });
+}
+
+export default runMigration;
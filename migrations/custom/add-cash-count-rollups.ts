@@ -0,0 +1,77 @@
+import { pool } from '../../server/db';
+import { fileURLToPath } from 'url';
+
+async function runMigration() {
+  const client = await pool.connect();
+
+  try {
+    await client.query('BEGIN');
+
+    console.log('Creating cash_count_rollups table...');
+    await client.query(`
+      CREATE TABLE IF NOT EXISTS cash_count_rollups (
+        location_id INTEGER NOT NULL REFERENCES locations(id),
+        day DATE NOT NULL,
+        count_type TEXT NOT NULL,
+        entries INTEGER NOT NULL DEFAULT 0,
+        cash_total NUMERIC(14, 2) NOT NULL DEFAULT 0,
+        card_total NUMERIC(14, 2) NOT NULL DEFAULT 0,
+        float_total NUMERIC(14, 2) NOT NULL DEFAULT 0,
+        expected_total NUMERIC(14, 2) NOT NULL DEFAULT 0,
+        discrepancy_total NUMERIC(14, 2) NOT NULL DEFAULT 0,
+        PRIMARY KEY (location_id, day, count_type)
+      );
+    `);
+    await client.query(`
+      CREATE INDEX IF NOT EXISTS cash_count_rollups_day_idx ON cash_count_rollups(day);
+    `);
+
+    // Rebuild from the raw counts; from here on the storage layer keeps it current.
+    // Lock cash_counts so no write slips in between the rebuild and the commit.
+    console.log('Backfilling cash_count_rollups...');
+    await client.query('LOCK TABLE cash_counts IN SHARE MODE');
+    await client.query('DELETE FROM cash_count_rollups');
+    await client.query(`
+      INSERT INTO cash_count_rollups
+        (location_id, day, count_type, entries, cash_total, card_total, float_total, expected_total, discrepancy_total)
+      SELECT
+        location_id,
+        count_date::date,
+        count_type,
+        COUNT(*),
+        SUM(cash_amount),
+        SUM(card_amount),
+        SUM(float_amount),
+        COALESCE(SUM(expected_amount), 0),
+        COALESCE(SUM(discrepancy), 0)
+      FROM cash_counts
+      GROUP BY location_id, count_date::date, count_type;
+    `);
+
+    await client.query('COMMIT');
+  } catch (error) {
+    await client.query('ROLLBACK');
+    console.error('Migration failed:', error);
+    throw error;
+  } finally {
+    client.release();
+  }
+}
+
+// For ESM, check if this is the main module
+const __filename = fileURLToPath(import.meta.url);
+const isMainModule = process.argv[1] === __filename;
+
+if (isMainModule) {
+  runMigration()
+    .then(() => {
+      console.log('Migration completed successfully');
+      process.exit(0);
+    })
+    .catch((error) => {
+      console.error('Migration failed:', error);
+      process.exit(1);
+    });
+}
+
+export default runMigration;
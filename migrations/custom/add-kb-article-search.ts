@@ -0,0 +1,60 @@
+import { pool } from '../../server/db';
+import { fileURLToPath } from 'url';
+
+async function runMigration() {
+  const client = await pool.connect();
+
+  try {
+    await client.query('BEGIN');
+
+    // Title weighs more than body; 'simple' (no stemming) because articles are written in
+    // whatever language each venue uses. Generated, so every insert/update keeps it current.
+    console.log('Adding search_vector to kb_articles...');
+    await client.query(`
+      ALTER TABLE kb_articles
+        ADD COLUMN IF NOT EXISTS search_vector tsvector
+        GENERATED ALWAYS AS (
+          setweight(to_tsvector('simple', coalesce(title, '')), 'A') ||
+          setweight(to_tsvector('simple', coalesce(content, '')), 'B')
+        ) STORED;
+    `);
+
+    console.log('Creating kb article search indexes...');
+    await client.query(`
+      CREATE INDEX IF NOT EXISTS kb_articles_search_idx ON kb_articles USING gin (search_vector);
+    `);
+    // Location scoping joins through the category
+    await client.query(`
+      CREATE INDEX IF NOT EXISTS kb_articles_category_idx ON kb_articles (category_id);
+    `);
+    await client.query(`
+      CREATE INDEX IF NOT EXISTS kb_categories_location_idx ON kb_categories (location_id);
+    `);
+
+    await client.query('COMMIT');
+  } catch (error) {
+    await client.query('ROLLBACK');
+    console.error('Migration failed:', error);
+    throw error;
+  } finally {
+    client.release();
+  }
+}
+
+// For ESM, check if this is the main module
+const __filename = fileURLToPath(import.meta.url);
+const isMainModule = process.argv[1] === __filename;
+
+if (isMainModule) {
+  runMigration()
+    .then(() => {
+      console.log('Migration completed successfully');
+      process.exit(0);
+    })
+    .catch((error) => {
+      console.error('Migration failed:', error);
+      process.exit(1);
+    });
+}
+
+export default runMigration;
@@ -0,0 +1,74 @@
+import { pool } from '../../server/db';
+import { fileURLToPath } from 'url';
+
+// Range index over the time span of each shift, so overlap lookups per staff member are GiST
+// range scans instead of parsing every row's text times. The expression must stay identical to
+// shiftPeriod() in shared/schema.ts, which is what the queries use.
+//
+// start_time/end_time stay text: the API speaks "HH:MM" and a time column would come back as
+// "HH:MM:SS". The expression is immutable, so nothing has to be kept in sync on write.
+//
+// Once existing double bookings are cleaned up, the check can move into Postgres entirely:
+//   ALTER TABLE shifts ADD CONSTRAINT shifts_no_double_booking
+//     EXCLUDE USING gist (staff_id WITH =, (<period expression>) WITH &&) WHERE (staff_id IS NOT NULL);
+export const SHIFT_PERIOD = `tsrange(
+  date + make_interval(hours => split_part(start_time, ':', 1)::int, mins => split_part(start_time, ':', 2)::int),
+  date + make_interval(hours => split_part(end_time, ':', 1)::int, mins => split_part(end_time, ':', 2)::int)
+    + CASE WHEN make_interval(hours => split_part(end_time, ':', 1)::int, mins => split_part(end_time, ':', 2)::int)
+             <= make_interval(hours => split_part(start_time, ':', 1)::int, mins => split_part(start_time, ':', 2)::int)
+      THEN interval '1 day' ELSE interval '0' END,
+  '[)'
+)`;
+
+async function runMigration() {
+  const client = await pool.connect();
+
+  try {
+    await client.query('BEGIN');
+
+    // Integer equality inside a GiST index needs the btree_gist operator classes
+    console.log('Enabling btree_gist...');
+    await client.query(`CREATE EXTENSION IF NOT EXISTS btree_gist;`);
+
+    // Rows the expression cannot parse would fail the index build; report them instead
+    const { rows: malformed } = await client.query(`
+      SELECT id, start_time, end_time FROM shifts
+      WHERE start_time !~ '^\\d{1,2}:\\d{2}' OR end_time !~ '^\\d{1,2}:\\d{2}'
+      LIMIT 20;
+    `);
+    if (malformed.length > 0) {
+      throw new Error(`Shifts with malformed times, fix them first: ${malformed.map(row => row.id).join(', ')}`);
+    }
+
+    console.log('Creating shifts_staff_period_idx...');
+    await client.query(`
+      CREATE INDEX IF NOT EXISTS shifts_staff_period_idx ON shifts USING gist (staff_id, (${SHIFT_PERIOD}));
+    `);
+
+    await client.query('COMMIT');
+  } catch (error) {
+    await client.query('ROLLBACK');
+    console.error('Migration failed:', error);
+    throw error;
+  } finally {
+    client.release();
+  }
+}
+
+// For ESM, check if this is the main module
+const __filename = fileURLToPath(import.meta.url);
+const isMainModule = process.argv[1] === __filename;
+
+if (isMainModule) {
+  runMigration()
+    .then(() => {
+      console.log('Migration completed successfully');
+      process.exit(0);
+    })
+    .catch((error) => {
+      console.error('Migration failed:', error);
+      process.exit(1);
+    });
+}
+
+export default runMigration;
@@ -0,0 +1,42 @@
+import { pool } from '../../server/db';
+import { fileURLToPath } from 'url';
+
+async function runMigration() {
+  const client = await pool.connect();
+
+  try {
+    await client.query('BEGIN');
+
+    // Reference counting for content-addressed blobs looks rows up by hash
+    console.log('Indexing uploaded_files.content_hash...');
+    await client.query(`
+      CREATE INDEX IF NOT EXISTS uploaded_files_content_hash_idx ON uploaded_files(content_hash);
+    `);
+
+    await client.query('COMMIT');
+  } catch (error) {
+    await client.query('ROLLBACK');
+    console.error('Migration failed:', error);
+    throw error;
+  } finally {
+    client.release();
+  }
+}
+
+// For ESM, check if this is the main module
+const __filename = fileURLToPath(import.meta.url);
+const isMainModule = process.argv[1] === __filename;
+
+if (isMainModule) {
+  runMigration()
+    .then(() => {
+      console.log('Migration completed successfully');
+      process.exit(0);
+    })
+    .catch((error) => {
+      console.error('Migration failed:', error);
+      process.exit(1);
+    });
+}
+
+export default runMigration;
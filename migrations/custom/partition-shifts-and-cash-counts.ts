@@ -0,0 +1,194 @@
+import type { PoolClient } from '@neondatabase/serverless';
+import { pool } from '../../server/db';
+import { fileURLToPath } from 'url';
+import { SHIFT_PERIOD } from './add-shift-period-index';
+import {
+  HOT_SCHEMA, ARCHIVE_SCHEMA, PARTITIONED_TABLES, createMonthPartition, isPartitioned, monthStart, addMonths,
+  parseMonth, primaryKeyName, type PartitionedTable,
+} from '../../server/partitions';
+
+// Rebuild shifts and cash_counts as tables range-partitioned by month (see server/partitions.ts
+// for the layout), so date-bounded queries only touch the months they cover and old months can
+// move to the archive tier without rewriting the hot ones. Rows are copied under an exclusive
+// lock in one transaction; ids keep coming from the existing sequences.
+//
+// Postgres requires the partition key in every unique constraint, so the primary keys become
+// (id, date) and (id, count_date). Ids are still unique: only the sequence assigns them.
+
+// Created on the partitioned parents, so every monthly partition gets its own copy
+const HOT_INDEXES: Record<string, string[]> = {
+  shifts: [
+    `CREATE INDEX shifts_schedule_date_idx ON shifts (schedule_id, date)`,
+    `CREATE INDEX shifts_staff_date_idx ON shifts (staff_id, date)`,
+    `CREATE INDEX shifts_staff_period_idx ON shifts USING gist (staff_id, (${SHIFT_PERIOD}))`,
+  ],
+  cash_counts: [
+    `CREATE INDEX cash_counts_location_date_idx ON cash_counts (location_id, count_date)`,
+  ],
+};
+
+// Same names drizzle-kit gives them, so db:push sees nothing to change
+const FOREIGN_KEYS: Record<string, string[]> = {
+  shifts: [
+    `ADD CONSTRAINT shifts_schedule_id_weekly_schedules_id_fk FOREIGN KEY (schedule_id) REFERENCES weekly_schedules(id)`,
+    `ADD CONSTRAINT shifts_staff_id_staff_id_fk FOREIGN KEY (staff_id) REFERENCES staff(id)`,
+    `ADD CONSTRAINT shifts_competency_id_competencies_id_fk FOREIGN KEY (competency_id) REFERENCES competencies(id)`,
+  ],
+  cash_counts: [
+    `ADD CONSTRAINT cash_counts_location_id_locations_id_fk FOREIGN KEY (location_id) REFERENCES locations(id)`,
+    `ADD CONSTRAINT cash_counts_verified_by_users_id_fk FOREIGN KEY (verified_by) REFERENCES users(id)`,
+    `ADD CONSTRAINT cash_counts_created_by_users_id_fk FOREIGN KEY (created_by) REFERENCES users(id)`,
+  ],
+};
+
+// Future months get partitions up front; the maintenance job extends this as time passes
+const MONTHS_AHEAD = 3;
+
+async function partitionTable(client: PoolClient, spec: PartitionedTable) {
+  const { table, key } = spec;
+  const legacy = `${table}_unpartitioned`;
+
+  await client.query(`LOCK TABLE ${table} IN ACCESS EXCLUSIVE MODE`);
+  const { rows: [range] } = await client.query(`
+    SELECT to_char(date_trunc('month', min(${key})), 'YYYY-MM-DD') AS first, count(*)::int AS rows FROM ${table}
+  `);
+  const { rows: [{ sequence }] } = await client.query(`SELECT pg_get_serial_sequence($1, 'id') AS sequence`, [table]);
+
+  // Free the names (the table's, and its indexes', which share the relation namespace)
+  console.log(`Renaming ${table} to ${legacy}...`);
+  await client.query(`ALTER TABLE ${table} RENAME TO ${legacy}`);
+  await client.query(`ALTER INDEX IF EXISTS ${table}_pkey RENAME TO ${legacy}_pkey`);
+  if (table === 'shifts') {
+    await client.query(`DROP INDEX IF EXISTS shifts_staff_period_idx`);
+  }
+
+  console.log(`Creating partitioned ${table}...`);
+  await client.query(`
+    CREATE TABLE ${table} (
+      LIKE ${legacy} INCLUDING DEFAULTS INCLUDING CONSTRAINTS,
+      CONSTRAINT ${primaryKeyName(spec)} PRIMARY KEY (id, ${key})
+    ) PARTITION BY RANGE (${key})
+  `);
+  await client.query(`CREATE TABLE ${HOT_SCHEMA}.${table}_default PARTITION OF ${table} DEFAULT`);
+
+  const current = monthStart(new Date());
+  let month = range.first ? parseMonth(range.first) : current;
+  let partitions = 0;
+  for (; month <= addMonths(current, MONTHS_AHEAD); month = addMonths(month, 1)) {
+    await createMonthPartition(client, spec, month);
+    partitions++;
+  }
+  console.log(`Created ${partitions} monthly partitions of ${table}`);
+
+  console.log(`Copying ${range.rows} rows into ${table}...`);
+  await client.query(`INSERT INTO ${table} SELECT * FROM ${legacy}`);
+
+  // Hand the sequence to the new column, or dropping the old table would drop it too
+  if (sequence) {
+    await client.query(`ALTER SEQUENCE ${sequence} OWNED BY ${table}.id`);
+  }
+  await client.query(`DROP TABLE ${legacy}`);
+
+  for (const foreignKey of FOREIGN_KEYS[table]) {
+    await client.query(`ALTER TABLE ${table} ${foreignKey}`);
+  }
+  console.log(`Creating indexes on ${table}...`);
+  for (const statement of HOT_INDEXES[table]) {
+    await client.query(statement);
+  }
+}
+
+async function createArchiveTier(client: PoolClient, spec: PartitionedTable) {
+  const { table, key } = spec;
+
+  // Columns only: archived months are never written by the application
+  await client.query(`
+    CREATE TABLE IF NOT EXISTS ${ARCHIVE_SCHEMA}.${table} (LIKE ${table}) PARTITION BY RANGE (${key})
+  `);
+  for (const columns of spec.archiveIndexes) {
+    const name = `${table}_archive_${columns.replace(/[()\s]/g, '').replace(/,/g, '_')}_idx`;
+    await client.query(`CREATE INDEX IF NOT EXISTS ${name} ON ${ARCHIVE_SCHEMA}.${table} ${columns}`);
+  }
+
+  // Reports over any range read these; conditions on the key prune partitions in both branches
+  await client.query(`
+    CREATE OR REPLACE VIEW ${table}_history AS
+      SELECT * FROM ${table}
+      UNION ALL
+      SELECT * FROM ${ARCHIVE_SCHEMA}.${table}
+  `);
+}
+
+async function runMigration() {
+  const client = await pool.connect();
+
+  try {
+    await client.query('BEGIN');
+
+    await client.query(`CREATE EXTENSION IF NOT EXISTS btree_gist;`);
+    await client.query(`CREATE SCHEMA IF NOT EXISTS ${HOT_SCHEMA};`);
+    await client.query(`CREATE SCHEMA IF NOT EXISTS ${ARCHIVE_SCHEMA};`);
+
+    for (const spec of PARTITIONED_TABLES) {
+      if (await isPartitioned(client, spec.table)) {
+        console.log(`${spec.table} is already partitioned`);
+        // Earlier runs left Postgres' default <table>_pkey name
+        await client.query(`
+          DO $$ BEGIN
+            IF EXISTS (SELECT 1 FROM pg_constraint WHERE conname = '${spec.table}_pkey' AND conrelid = '${spec.table}'::regclass) THEN
+              ALTER TABLE ${spec.table} RENAME CONSTRAINT ${spec.table}_pkey TO ${primaryKeyName(spec)};
+            END IF;
+          END $$;
+        `);
+      } else {
+        await partitionTable(client, spec);
+      }
+      await createArchiveTier(client, spec);
+    }
+
+    console.log('Creating archive.archived_periods...');
+    await client.query(`
+      CREATE TABLE IF NOT EXISTS ${ARCHIVE_SCHEMA}.archived_periods (
+        table_name TEXT NOT NULL,
+        period_start DATE NOT NULL,
+        row_count BIGINT NOT NULL,
+        access_method TEXT NOT NULL,
+        archived_at TIMESTAMP NOT NULL DEFAULT now(),
+        PRIMARY KEY (table_name, period_start)
+      );
+    `);
+
+    // Week lookups per location; weekly_schedules stays small enough not to need partitioning
+    console.log('Creating weekly_schedules_location_week_idx...');
+    await client.query(`
+      CREATE INDEX IF NOT EXISTS weekly_schedules_location_week_idx ON weekly_schedules(location_id, week_start_date);
+    `);
+
+    await client.query('COMMIT');
+  } catch (error) {
+    await client.query('ROLLBACK');
+    console.error('Migration failed:', error);
+    throw error;
+  } finally {
+    client.release();
+  }
+}
+
+// For ESM, check if this is the main module
+const __filename = fileURLToPath(import.meta.url);
+const isMainModule = process.argv[1] === __filename;
+
+if (isMainModule) {
+  runMigration()
+    .then(() => {
+      console.log('Migration completed successfully');
+      console.log('Months past the archive horizon move to the archive tier on the next storage.partitions job');
+      process.exit(0);
+    })
+    .catch((error) => {
+      console.error('Migration failed:', error);
+      process.exit(1);
+    });
+}
+
+export default runMigration;
@@ -0,0 +1,132 @@
+// Per-call overhead of the prepared statement registry versus building the same query each time.
+//
+//   npm run bench:prepared -- --iterations=2000
+//
+// "build" times only the Drizzle query builder and SQL rendering (no database), "execute" times
+// full round trips against DATABASE_URL. Both variants run the identical SQL, so the execute
+// difference is builder overhead plus Postgres parse/plan time saved by named statements.
+import { eq, and, gte, lt, asc } from 'drizzle-orm';
+import { db } from '../server/db';
+import { preparedStatements } from '../server/prepared-statements';
+import { Histogram, logLinearBuckets } from '../server/histogram';
+import { users, staff, shifts, weeklySchedules, competencies } from '@shared/schema';
+
+const WEEK_MS = 7 * 24 * 60 * 60 * 1000;
+
+function parseArgs() {
+  const args = new Map<string, string>();
+  for (const arg of process.argv.slice(2)) {
+    const match = /^--([^=]+)(?:=(.*))?$/.exec(arg);
+    if (match) args.set(match[1], match[2] ?? 'true');
+  }
+  const iterations = parseInt(args.get('iterations') ?? '', 10);
+  return { iterations: Number.isFinite(iterations) && iterations > 0 ? iterations : 1000 };
+}
+
+interface Case {
+  name: string;
+  build: () => { toSQL(): unknown };
+  dynamic: () => Promise<unknown>;
+  prepared: () => Promise<unknown>;
+}
+
+async function measure(iterations: number, fn: () => Promise<unknown> | unknown) {
+  const histogram = new Histogram(logLinearBuckets(0.001, 1000, 8));
+  // Warm up JIT and the pool's connections (and their prepared statements)
+  for (let i = 0; i < Math.min(100, iterations); i++) await fn();
+  for (let i = 0; i < iterations; i++) {
+    const start = process.hrtime.bigint();
+    await fn();
+    histogram.observe(Number(process.hrtime.bigint() - start) / 1000000);
+  }
+  const snapshot = histogram.snapshot();
+  return { meanUs: Math.round((histogram.sum / histogram.count) * 1000), p50Us: Math.round(snapshot.p50Ms * 1000), p99Us: Math.round(snapshot.p99Ms * 1000) };
+}
+
+async function main() {
+  const { iterations } = parseArgs();
+
+  // Real keys where the database has them, so the lookups return rows
+  const [user] = await db.select().from(users).limit(1);
+  const [staffMember] = await db.select().from(staff).limit(1);
+  const [schedule] = await db.select().from(weeklySchedules).limit(1);
+  const userId = user?.id ?? 1;
+  const username = user?.username ?? 'admin';
+  const locationId = staffMember?.locationId ?? schedule?.locationId ?? 1;
+  const weekStart = schedule?.weekStartDate ?? new Date();
+  const weekEnd = new Date(weekStart.getTime() + WEEK_MS);
+  const statements = preparedStatements();
+
+  const weekViewQuery = () => db
+    .select({
+      schedule: weeklySchedules,
+      shift: shifts,
+      staffMember: { id: staff.id, userId: staff.userId, position: staff.position },
+      userName: users.name,
+      competency: { id: competencies.id, name: competencies.name },
+    })
+    .from(weeklySchedules)
+    .leftJoin(shifts, eq(shifts.scheduleId, weeklySchedules.id))
+    .leftJoin(staff, eq(staff.id, shifts.staffId))
+    .leftJoin(users, eq(users.id, staff.userId))
+    .leftJoin(competencies, eq(competencies.id, shifts.competencyId))
+    .where(and(
+      eq(weeklySchedules.locationId, locationId),
+      gte(weeklySchedules.weekStartDate, weekStart),
+      lt(weeklySchedules.weekStartDate, weekEnd)
+    ))
+    .orderBy(asc(weeklySchedules.id), asc(shifts.date), asc(shifts.startTime));
+
+  const cases: Case[] = [
+    {
+      name: 'userById',
+      build: () => db.select().from(users).where(eq(users.id, userId)),
+      dynamic: () => db.select().from(users).where(eq(users.id, userId)),
+      prepared: () => statements.userById.execute({ id: userId }),
+    },
+    {
+      name: 'userByUsername',
+      build: () => db.select().from(users).where(eq(users.username, username)),
+      dynamic: () => db.select().from(users).where(eq(users.username, username)),
+      prepared: () => statements.userByUsername.execute({ username }),
+    },
+    {
+      name: 'staffByLocation',
+      build: () => db.select().from(staff).where(eq(staff.locationId, locationId)),
+      dynamic: () => db.select().from(staff).where(eq(staff.locationId, locationId)),
+      prepared: () => statements.staffByLocation.execute({ locationId }),
+    },
+    {
+      name: 'weekViewRows',
+      build: weekViewQuery,
+      dynamic: weekViewQuery,
+      prepared: () => statements.weekViewRows.execute({
+        locationId,
+        weekStart: weekStart.toISOString(),
+        weekEnd: weekEnd.toISOString(),
+      }),
+    },
+  ];
+
+  const cell = (value: string | number, width: number) => String(value).padStart(width);
+  console.log(`${iterations} iterations per variant (times in microseconds)\n`);
+  console.log('query'.padEnd(18) + cell('build', 10) + cell('dynamic mean', 15) + cell('p99', 8) + cell('prepared mean', 15) + cell('p99', 8) + cell('saved', 8));
+  for (const c of cases) {
+    const build = await measure(iterations * 10, () => c.build().toSQL());
+    const dynamic = await measure(iterations, c.dynamic);
+    const prepared = await measure(iterations, c.prepared);
+    console.log(
+      c.name.padEnd(18) +
+      cell(build.meanUs, 10) +
+      cell(dynamic.meanUs, 15) + cell(dynamic.p99Us, 8) +
+      cell(prepared.meanUs, 15) + cell(prepared.p99Us, 8) +
+      cell(dynamic.meanUs - prepared.meanUs, 8),
+    );
+  }
+  process.exit(0);
+}
+
+main().catch((error) => {
+  console.error('Prepared statement benchmark failed:', error);
+  process.exit(1);
+});
@@ -0,0 +1,206 @@
+// Benchmark target: seeds a synthetic dataset through the storage layer, then serves the real
+// routes on an ephemeral port. Spawned by scripts/benchmark.ts (which picks the storage backend
+// through STORAGE_BACKEND); not meant to be run directly.
+import express from 'express';
+import crypto from 'crypto';
+import fs from 'fs';
+import bcrypt from 'bcryptjs';
+import { registerRoutes } from '../server/routes';
+import { storage } from '../server/storage';
+import { blobTempPath, commitBlob } from '../server/blob-store';
+import { instrumentRequests } from '../server/metrics';
+import { initRedis } from '../server/redis';
+import { seedPermissionCatalog } from '../server/authorization';
+import { BENCH_PASSWORD, READY_MARKER, type BenchFixtures, type DatasetSize } from './benchmark-shared';
+
+// Small deterministic PRNG so runs with the same --seed draw the same value sequence
+function mulberry32(seed: number) {
+  return () => {
+    seed |= 0;
+    seed = (seed + 0x6d2b79f5) | 0;
+    let t = Math.imul(seed ^ (seed >>> 15), 1 | seed);
+    t = (t + Math.imul(t ^ (t >>> 7), 61 | t)) ^ t;
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+// Run fn over items with bounded parallelism (seeding thousands of rows one by one is slow,
+// all at once would exhaust the pool)
+async function inBatches<T, R>(items: T[], parallelism: number, fn: (item: T, index: number) => Promise<R>): Promise<R[]> {
+  const results: R[] = new Array(items.length);
+  let next = 0;
+  await Promise.all(Array.from({ length: Math.min(parallelism, items.length) }, async () => {
+    while (next < items.length) {
+      const index = next++;
+      results[index] = await fn(items[index], index);
+    }
+  }));
+  return results;
+}
+
+const range = (n: number) => Array.from({ length: n }, (_, i) => i);
+
+function mondayUtc(date: Date): Date {
+  const monday = new Date(Date.UTC(date.getUTCFullYear(), date.getUTCMonth(), date.getUTCDate()));
+  monday.setUTCDate(monday.getUTCDate() - ((monday.getUTCDay() + 6) % 7));
+  return monday;
+}
+
+const APPLICANT_STATUSES = ['new', 'contacted', 'interviewed', 'hired', 'rejected'] as const;
+const SHIFT_TIMES = [['07:00', '15:00'], ['09:00', '17:00'], ['11:00', '19:00'], ['15:00', '23:00']];
+
+async function seed(size: DatasetSize): Promise<BenchFixtures> {
+  const started = Date.now();
+  const random = mulberry32(size.seed);
+  const pick = <T>(items: T[]) => items[Math.floor(random() * items.length)];
+  const runId = `${size.seed}-${Date.now().toString(36)}`;
+  const passwordHash = await bcrypt.hash(BENCH_PASSWORD, 10);
+  const money = (min: number, max: number) => (min + random() * (max - min)).toFixed(2);
+
+  const locations = await inBatches(range(size.locations), 4, (i) =>
+    storage.createLocation({ name: `Bench ${runId} #${i + 1}`, address: `${i + 1} Benchmark Street` }));
+  const locationIds = locations.map(location => location.id);
+
+  // Virtual users log in as managers spread over the locations
+  const managers = await inBatches(range(size.users), 8, (i) => storage.createUser({
+    username: `bench-${runId}-manager-${i}`,
+    password: passwordHash,
+    email: `bench-${runId}-manager-${i}@example.com`,
+    name: `Bench Manager ${i}`,
+    role: 'manager',
+    locationId: locationIds[i % locationIds.length],
+  }));
+  const ownerId = managers[0].id;
+
+  const currentWeek = mondayUtc(new Date());
+  const weekStarts = range(size.weeks).map((w) => {
+    const weekStart = new Date(currentWeek);
+    weekStart.setUTCDate(weekStart.getUTCDate() + 7 * w);
+    return weekStart;
+  });
+
+  const shiftIds: number[] = [];
+  for (const locationId of locationIds) {
+    const competencies = await inBatches(range(size.competenciesPerLocation), 4, (i) =>
+      storage.createCompetency({ name: `Competency ${i + 1}`, locationId, createdBy: ownerId }));
+
+    const staffMembers = await inBatches(range(size.staffPerLocation), 8, async (i) => {
+      const user = await storage.createUser({
+        username: `bench-${runId}-l${locationId}-staff-${i}`,
+        password: passwordHash,
+        email: `bench-${runId}-l${locationId}-staff-${i}@example.com`,
+        name: `Crew ${locationId}-${i}`,
+        role: 'crew_member',
+        locationId,
+      });
+      return storage.createStaff({ userId: user.id, locationId, position: 'Crew', wantedHours: pick([16, 24, 32, 40]) });
+    });
+
+    await inBatches(staffMembers.flatMap(member => competencies.map(competency => ({ member, competency }))), 8,
+      ({ member, competency }) => storage.createStaffCompetency({
+        staffId: member.id,
+        competencyId: competency.id,
+        level: Math.floor(random() * 6),
+      }));
+
+    for (const weekStart of weekStarts) {
+      const schedule = await storage.createWeeklySchedule({ locationId, weekStartDate: weekStart, isPublished: true });
+      const shifts = await inBatches(range(7 * size.shiftsPerDay), 8, (i) => {
+        const date = new Date(weekStart);
+        date.setUTCDate(date.getUTCDate() + Math.floor(i / size.shiftsPerDay));
+        const [startTime, endTime] = pick(SHIFT_TIMES);
+        const competency = competencies.length > 0 ? pick(competencies) : undefined;
+        return storage.createShift({
+          scheduleId: schedule.id,
+          staffId: random() < 0.8 && staffMembers.length > 0 ? pick(staffMembers).id : null,
+          date,
+          startTime,
+          endTime,
+          role: 'Crew',
+          competencyId: competency?.id ?? null,
+          requiredCompetencyLevel: competency ? 1 + Math.floor(random() * 3) : null,
+        });
+      });
+      shiftIds.push(...shifts.map(shift => shift.id));
+    }
+
+    for (const day of range(size.cashDays)) {
+      const countDate = new Date(currentWeek);
+      countDate.setUTCDate(countDate.getUTCDate() - day);
+      for (const countType of ['opening', 'closing'] as const) {
+        await storage.createCashCount({
+          locationId,
+          countType,
+          countDate,
+          cashAmount: countType === 'opening' ? '200.00' : money(800, 2500),
+          cardAmount: countType === 'opening' ? '0.00' : money(1500, 6000),
+          floatAmount: '200.00',
+          expectedAmount: null,
+          discrepancy: countType === 'opening' ? '0.00' : money(-5, 5),
+          createdBy: ownerId,
+        });
+      }
+    }
+  }
+
+  await inBatches(range(size.applicants), 8, (i) => storage.createApplicant({
+    name: `Applicant ${runId} ${i}`,
+    email: `bench-${runId}-applicant-${i}@example.com`,
+    phone: `+31 6${String(10000000 + i).slice(-8)}`,
+    status: pick([...APPLICANT_STATUSES]),
+    locationId: pick(locationIds),
+  }));
+
+  // Documents go through the content-addressed blob store exactly like streamed uploads
+  const files = await inBatches(range(size.documents), 4, async (i) => {
+    const body = crypto.randomBytes(64 * 1024 + Math.floor(random() * 512 * 1024));
+    const sha256 = crypto.createHash('sha256').update(body).digest('hex');
+    const tempPath = blobTempPath();
+    await fs.promises.writeFile(tempPath, body);
+    const blob = await commitBlob(tempPath, sha256);
+    return storage.createUploadedFile({
+      filename: sha256,
+      originalName: `bench-document-${i}.pdf`,
+      mimeType: 'application/pdf',
+      size: body.length,
+      path: blob.path,
+      contentHash: sha256,
+      uploadedBy: ownerId,
+    });
+  });
+
+  return {
+    password: BENCH_PASSWORD,
+    usernames: managers.map(manager => manager.username),
+    locationIds,
+    weekStarts: weekStarts.map(weekStart => weekStart.toISOString()),
+    shiftIds,
+    fileIds: files.map(file => file.id),
+    seedMs: Date.now() - started,
+  };
+}
+
+async function main() {
+  const size = JSON.parse(process.env.BENCH_DATASET || '{}') as DatasetSize;
+
+  const app = express();
+  app.use(express.json({ limit: '1mb' }));
+  app.use(express.urlencoded({ extended: true, limit: '1mb' }));
+  app.use(instrumentRequests);
+  const server = await registerRoutes(app);
+  initRedis();
+  await seedPermissionCatalog();
+
+  const fixtures = await seed(size);
+
+  server.listen(0, '127.0.0.1', () => {
+    const address = server.address();
+    const port = typeof address === 'object' && address ? address.port : 0;
+    process.stdout.write(`${READY_MARKER}${JSON.stringify({ port, fixtures })}\n`);
+  });
+}
+
+main().catch((error) => {
+  console.error('Benchmark server failed:', error);
+  process.exit(1);
+});
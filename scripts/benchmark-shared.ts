@@ -0,0 +1,30 @@
+// Types and constants shared by the benchmark driver and the server process it spawns
+
+export interface DatasetSize {
+  locations: number;
+  staffPerLocation: number;
+  competenciesPerLocation: number;
+  weeks: number;
+  shiftsPerDay: number;
+  applicants: number;
+  cashDays: number;
+  documents: number;
+  // One manager account per virtual user
+  users: number;
+  seed: number;
+}
+
+export interface BenchFixtures {
+  password: string;
+  usernames: string[];
+  locationIds: number[];
+  weekStarts: string[];
+  shiftIds: number[];
+  fileIds: number[];
+  seedMs: number;
+}
+
+// Line the driver waits for before it starts generating load
+export const READY_MARKER = 'BENCH_READY ';
+
+export const BENCH_PASSWORD = 'bench-password';
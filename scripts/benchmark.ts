@@ -0,0 +1,274 @@
+// Load test for the core API flows.
+//
+//   npm run bench -- --storage=both --concurrency=20 --iterations=50
+//
+// For each storage backend a server process is spawned (scripts/benchmark-server.ts) that seeds
+// a synthetic dataset and serves the real routes. Virtual users then repeat
+// login -> /api/auth/me -> week view -> shift edit -> applicant list -> document download,
+// and throughput plus p50/p99 are reported per step.
+//
+// --json=FILE writes the results; --baseline=FILE compares p99 against an earlier run and
+// exits non-zero when a step regressed by more than --tolerance (default 0.2 = 20%). Any failed
+// request also makes the run exit non-zero.
+//
+// The database backend writes its dataset into DATABASE_URL: point it at a scratch database.
+import { spawn, type ChildProcess } from 'child_process';
+import fs from 'fs';
+import { Histogram, logLinearBuckets } from '../server/histogram';
+import { READY_MARKER, type BenchFixtures, type DatasetSize } from './benchmark-shared';
+
+const STEPS = ['login', 'me', 'weekView', 'shiftEdit', 'applicantList', 'documentDownload'] as const;
+type Step = typeof STEPS[number];
+type Backend = 'database' | 'memory';
+
+interface StepResult {
+  count: number;
+  errors: number;
+  rps: number;
+  p50Ms: number;
+  p99Ms: number;
+  maxMs: number;
+}
+
+type BackendResult = { seedMs: number; wallMs: number } & Record<Step, StepResult>;
+
+function parseArgs() {
+  const args = new Map<string, string>();
+  for (const arg of process.argv.slice(2)) {
+    const match = /^--([^=]+)(?:=(.*))?$/.exec(arg);
+    if (match) args.set(match[1], match[2] ?? 'true');
+  }
+  const int = (name: string, fallback: number) => {
+    const value = parseInt(args.get(name) ?? '', 10);
+    return Number.isFinite(value) && value >= 0 ? value : fallback;
+  };
+
+  const storageArg = args.get('storage') ?? 'both';
+  const backends: Backend[] = storageArg === 'both' ? ['database', 'memory']
+    : storageArg === 'memory' || storageArg === 'mem' ? ['memory']
+    : ['database'];
+  const concurrency = Math.max(1, int('concurrency', 10));
+
+  const dataset: DatasetSize = {
+    locations: Math.max(1, int('locations', 3)),
+    staffPerLocation: int('staff', 25),
+    competenciesPerLocation: int('competencies', 6),
+    weeks: Math.max(1, int('weeks', 4)),
+    shiftsPerDay: Math.max(1, int('shifts-per-day', 10)),
+    applicants: int('applicants', 2000),
+    cashDays: int('cash-days', 90),
+    documents: Math.max(1, int('documents', 20)),
+    users: concurrency,
+    seed: int('seed', 1),
+  };
+
+  return {
+    backends,
+    dataset,
+    concurrency,
+    iterations: Math.max(1, int('iterations', 30)),
+    json: args.get('json'),
+    baseline: args.get('baseline'),
+    tolerance: Number(args.get('tolerance') ?? 0.2),
+  };
+}
+
+function startServer(backend: Backend, dataset: DatasetSize): Promise<{ child: ChildProcess; port: number; fixtures: BenchFixtures }> {
+  return new Promise((resolve, reject) => {
+    const child = spawn(process.execPath, ['--import', 'tsx', 'scripts/benchmark-server.ts'], {
+      env: {
+        ...process.env,
+        STORAGE_BACKEND: backend,
+        // Keep session writes out of the comparison unless explicitly requested
+        SESSION_STORE: process.env.SESSION_STORE || 'memory',
+        LOG_LEVEL: process.env.LOG_LEVEL || 'warn',
+        BENCH_DATASET: JSON.stringify(dataset),
+      },
+      stdio: ['ignore', 'pipe', 'inherit'],
+    });
+
+    let buffered = '';
+    child.stdout!.on('data', (chunk: Buffer) => {
+      buffered += chunk.toString();
+      let newline: number;
+      while ((newline = buffered.indexOf('\n')) >= 0) {
+        const line = buffered.slice(0, newline);
+        buffered = buffered.slice(newline + 1);
+        if (line.startsWith(READY_MARKER)) {
+          const { port, fixtures } = JSON.parse(line.slice(READY_MARKER.length));
+          resolve({ child, port, fixtures });
+        }
+      }
+    });
+    child.on('exit', (code) => reject(new Error(`Benchmark server (${backend}) exited with code ${code} before it was ready`)));
+  });
+}
+
+// The session cookie is marked Secure; the server trusts one proxy hop, so claim HTTPS
+const BASE_HEADERS = { 'x-forwarded-proto': 'https' };
+
+async function runVirtualUser(
+  base: string,
+  fixtures: BenchFixtures,
+  user: number,
+  iterations: number,
+  histograms: Record<Step, Histogram>,
+  errors: Record<Step, number>,
+) {
+  const username = fixtures.usernames[user];
+  const locationId = fixtures.locationIds[user % fixtures.locationIds.length];
+  let cookie = '';
+
+  const timed = async (step: Step, path: string, init: RequestInit = {}) => {
+    const start = process.hrtime.bigint();
+    try {
+      const res = await fetch(base + path, {
+        ...init,
+        headers: { ...BASE_HEADERS, ...(cookie ? { cookie } : {}), ...(init.headers as Record<string, string>) },
+      });
+      // Read the whole body so the timing covers the transfer, not just the headers
+      await res.arrayBuffer();
+      if (!res.ok) errors[step]++;
+      return res;
+    } catch {
+      errors[step]++;
+      return null;
+    } finally {
+      histograms[step].observe(Number(process.hrtime.bigint() - start) / 1000000);
+    }
+  };
+
+  for (let i = 0; i < iterations; i++) {
+    cookie = '';
+    const login = await timed('login', '/api/auth/login', {
+      method: 'POST',
+      headers: { 'content-type': 'application/json' },
+      body: JSON.stringify({ username, password: fixtures.password }),
+    });
+    const sessionCookie = login?.headers.getSetCookie().find(value => value.startsWith('crewplots.sid='));
+    cookie = sessionCookie ? sessionCookie.split(';')[0] : '';
+
+    await timed('me', '/api/auth/me');
+
+    const weekStart = fixtures.weekStarts[i % fixtures.weekStarts.length];
+    await timed('weekView', `/api/scheduling/week-view/${locationId}?weekStart=${encodeURIComponent(weekStart)}`);
+
+    const shiftId = fixtures.shiftIds[(user * iterations + i) % fixtures.shiftIds.length];
+    await timed('shiftEdit', `/api/shifts/${shiftId}`, {
+      method: 'PUT',
+      headers: { 'content-type': 'application/json' },
+      body: JSON.stringify({ notes: `bench ${user}-${i}` }),
+    });
+
+    await timed('applicantList', `/api/applicants?limit=50&locationId=${locationId}`);
+
+    const fileId = fixtures.fileIds[(user + i) % fixtures.fileIds.length];
+    await timed('documentDownload', `/api/uploads/download/${fileId}`);
+  }
+}
+
+async function runBackend(backend: Backend, options: ReturnType<typeof parseArgs>): Promise<BackendResult> {
+  console.log(`\n[${backend}] seeding dataset...`);
+  const { child, port, fixtures } = await startServer(backend, options.dataset);
+  console.log(`[${backend}] seeded in ${(fixtures.seedMs / 1000).toFixed(1)}s; ${options.concurrency} virtual users x ${options.iterations} iterations`);
+
+  const buckets = logLinearBuckets(0.5, 32768, 4);
+  const histograms = Object.fromEntries(STEPS.map(step => [step, new Histogram(buckets)])) as Record<Step, Histogram>;
+  const errors = Object.fromEntries(STEPS.map(step => [step, 0])) as Record<Step, number>;
+  const base = `http://127.0.0.1:${port}`;
+
+  const started = process.hrtime.bigint();
+  try {
+    await Promise.all(Array.from({ length: options.concurrency }, (_, user) =>
+      runVirtualUser(base, fixtures, user, options.iterations, histograms, errors)));
+  } finally {
+    child.removeAllListeners('exit');
+    child.kill();
+  }
+  const wallMs = Number(process.hrtime.bigint() - started) / 1000000;
+
+  const result = { seedMs: fixtures.seedMs, wallMs } as BackendResult;
+  for (const step of STEPS) {
+    const histogram = histograms[step];
+    const snapshot = histogram.snapshot();
+    result[step] = {
+      count: histogram.count,
+      errors: errors[step],
+      rps: Math.round((histogram.count / (wallMs / 1000)) * 10) / 10,
+      p50Ms: snapshot.p50Ms,
+      p99Ms: snapshot.p99Ms,
+      maxMs: snapshot.maxMs,
+    };
+  }
+  return result;
+}
+
+function printResults(results: Partial<Record<Backend, BackendResult>>) {
+  const backends = Object.keys(results) as Backend[];
+  const cell = (value: string | number, width: number) => String(value).padStart(width);
+  console.log('\n' + 'step'.padEnd(18) + backends.map(b => cell(`${b} rps`, 14) + cell('p50', 9) + cell('p99', 9) + cell('errors', 8)).join(''));
+  for (const step of STEPS) {
+    let line = step.padEnd(18);
+    for (const backend of backends) {
+      const r = results[backend]![step];
+      line += cell(r.rps, 14) + cell(`${r.p50Ms}ms`, 9) + cell(`${r.p99Ms}ms`, 9) + cell(r.errors, 8);
+    }
+    console.log(line);
+  }
+}
+
+// Regressions against an earlier --json run; only p99 is gated, throughput varies too much by host
+function compareWithBaseline(results: Partial<Record<Backend, BackendResult>>, baselinePath: string, tolerance: number): string[] {
+  const baseline = JSON.parse(fs.readFileSync(baselinePath, 'utf8')) as Partial<Record<Backend, BackendResult>>;
+  const regressions: string[] = [];
+  for (const backend of Object.keys(results) as Backend[]) {
+    const before = baseline[backend];
+    if (!before) continue;
+    for (const step of STEPS) {
+      const was = before[step]?.p99Ms;
+      const now = results[backend]![step].p99Ms;
+      if (was && now > was * (1 + tolerance)) {
+        regressions.push(`${backend} ${step}: p99 ${was}ms -> ${now}ms`);
+      }
+    }
+  }
+  return regressions;
+}
+
+async function main() {
+  const options = parseArgs();
+  const results: Partial<Record<Backend, BackendResult>> = {};
+  for (const backend of options.backends) {
+    results[backend] = await runBackend(backend, options);
+  }
+
+  printResults(results);
+  if (options.json) {
+    fs.writeFileSync(options.json, JSON.stringify(results, null, 2));
+    console.log(`\nResults written to ${options.json}`);
+  }
+
+  const failedSteps = (Object.keys(results) as Backend[])
+    .flatMap(backend => STEPS.filter(step => results[backend]![step].errors > 0).map(step => `${backend} ${step}`));
+  if (failedSteps.length > 0) {
+    console.error(`\nSteps with errors: ${failedSteps.join(', ')}`);
+  }
+
+  let regressed = false;
+  if (options.baseline) {
+    const regressions = compareWithBaseline(results, options.baseline, options.tolerance);
+    regressed = regressions.length > 0;
+    if (regressed) {
+      console.error(`\np99 regressions beyond ${Math.round(options.tolerance * 100)}%:\n  ${regressions.join('\n  ')}`);
+    } else {
+      console.log(`\nNo p99 regressions beyond ${Math.round(options.tolerance * 100)}% against ${options.baseline}`);
+    }
+  }
+  // Failed requests skew the timings, so a run with errors never passes
+  process.exit(failedSteps.length > 0 || regressed ? 1 : 0);
+}
+
+main().catch((error) => {
+  console.error('Benchmark failed:', error);
+  process.exit(1);
+});
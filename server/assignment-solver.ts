@@ -0,0 +1,169 @@
+// Pure assignment solver for open shifts. Everything is index-based over typed arrays so the
+// problem can be posted to a worker thread cheaply and solved without touching the database.
+
+export type UnfilledReason = 'no_qualified_staff' | 'all_qualified_busy' | 'hours_exhausted';
+
+export interface AssignmentProblem {
+  staffCount: number;
+  competencyCount: number;
+  // staffCount x competencyCount, row-major; -1 where the staff member has no assessment
+  levels: Int8Array;
+  // Minutes per staff member the week should aim for
+  targetMinutes: Int32Array;
+  shiftCount: number;
+  // Minutes since week start
+  shiftStart: Int32Array;
+  shiftEnd: Int32Array;
+  // Index into the competency axis, -1 when the shift has no competency requirement
+  shiftCompetency: Int16Array;
+  shiftMinLevel: Int8Array;
+  // Staff index already assigned to the shift, -1 for open shifts
+  shiftAssigned: Int32Array;
+  // Allow exceeding targetMinutes when nobody under target is available
+  allowOvertime: boolean;
+}
+
+export interface AssignmentSolution {
+  // Staff index per shift; only open shifts change
+  assigned: Int32Array;
+  unfilled: { shift: number; reason: UnfilledReason }[];
+}
+
+// How many single-swap repair passes to attempt for shifts the greedy pass couldn't fill
+const MAX_REPAIR_PASSES = 2;
+
+export function solveAssignments(problem: AssignmentProblem): AssignmentSolution {
+  const { staffCount, competencyCount, levels, targetMinutes, shiftCount, shiftStart, shiftEnd,
+    shiftCompetency, shiftMinLevel, shiftAssigned, allowOvertime } = problem;
+
+  const assigned = Int32Array.from(shiftAssigned);
+  const workedMinutes = new Int32Array(staffCount);
+  // Per staff list of shift indices they hold, for overlap checks
+  const busy: number[][] = Array.from({ length: staffCount }, () => []);
+
+  for (let sh = 0; sh < shiftCount; sh++) {
+    const st = assigned[sh];
+    if (st >= 0) {
+      busy[st].push(sh);
+      workedMinutes[st] += shiftEnd[sh] - shiftStart[sh];
+    }
+  }
+
+  const qualifies = (st: number, sh: number) => {
+    const c = shiftCompetency[sh];
+    if (c < 0) return true;
+    return levels[st * competencyCount + c] >= shiftMinLevel[sh];
+  };
+
+  const overlaps = (st: number, sh: number, ignore = -1) => {
+    const start = shiftStart[sh];
+    const end = shiftEnd[sh];
+    for (const other of busy[st]) {
+      if (other !== ignore && shiftStart[other] < end && start < shiftEnd[other]) return true;
+    }
+    return false;
+  };
+
+  const fitsHours = (st: number, sh: number, freedMinutes = 0) =>
+    allowOvertime || workedMinutes[st] - freedMinutes + shiftEnd[sh] - shiftStart[sh] <= targetMinutes[st];
+
+  const place = (st: number, sh: number) => {
+    assigned[sh] = st;
+    busy[st].push(sh);
+    workedMinutes[st] += shiftEnd[sh] - shiftStart[sh];
+  };
+
+  const release = (st: number, sh: number) => {
+    assigned[sh] = -1;
+    const list = busy[st];
+    list.splice(list.indexOf(sh), 1);
+    workedMinutes[st] -= shiftEnd[sh] - shiftStart[sh];
+  };
+
+  // Eligible staff per open shift (competency only) drives the fill order: most constrained first
+  const open: number[] = [];
+  const eligible: number[][] = new Array(shiftCount);
+  for (let sh = 0; sh < shiftCount; sh++) {
+    if (assigned[sh] >= 0) continue;
+    const list: number[] = [];
+    for (let st = 0; st < staffCount; st++) {
+      if (qualifies(st, sh)) list.push(st);
+    }
+    eligible[sh] = list;
+    open.push(sh);
+  }
+  open.sort((a, b) => eligible[a].length - eligible[b].length || shiftStart[a] - shiftStart[b]);
+
+  // Prefer whoever is furthest below target, then the least over-qualified, to keep
+  // high-level staff free for shifts only they can cover
+  const pick = (sh: number): number => {
+    let best = -1;
+    let bestDeficit = -Infinity;
+    let bestSurplus = Infinity;
+    const c = shiftCompetency[sh];
+    for (const st of eligible[sh]) {
+      if (overlaps(st, sh) || !fitsHours(st, sh)) continue;
+      const target = targetMinutes[st] || 1;
+      const deficit = (target - workedMinutes[st]) / target;
+      const surplus = c < 0 ? 0 : levels[st * competencyCount + c] - shiftMinLevel[sh];
+      if (deficit > bestDeficit || (deficit === bestDeficit && surplus < bestSurplus)) {
+        best = st;
+        bestDeficit = deficit;
+        bestSurplus = surplus;
+      }
+    }
+    return best;
+  };
+
+  let pending: number[] = [];
+  for (const sh of open) {
+    const st = pick(sh);
+    if (st >= 0) {
+      place(st, sh);
+    } else {
+      pending.push(sh);
+    }
+  }
+
+  // Repair: for an unfilled shift A, find a qualified X who holds a proposed shift B that
+  // some other Y can take, then move B to Y and give A to X. Existing assignments never move.
+  for (let pass = 0; pass < MAX_REPAIR_PASSES && pending.length > 0; pass++) {
+    const stillPending: number[] = [];
+    for (const a of pending) {
+      let repaired = false;
+      for (const x of eligible[a]) {
+        for (const b of busy[x].slice()) {
+          if (shiftAssigned[b] >= 0) continue;
+          const blocksA = shiftStart[b] < shiftEnd[a] && shiftStart[a] < shiftEnd[b];
+          const freed = shiftEnd[b] - shiftStart[b];
+          if (overlaps(x, a, b) || !fitsHours(x, a, freed)) continue;
+          if (!blocksA && fitsHours(x, a)) continue; // x was free for a already; not a swap case
+
+          release(x, b);
+          const y = pick(b);
+          if (y >= 0 && y !== x) {
+            place(y, b);
+            place(x, a);
+            repaired = true;
+            break;
+          }
+          place(x, b);
+        }
+        if (repaired) break;
+      }
+      if (!repaired) stillPending.push(a);
+    }
+    pending = stillPending;
+  }
+
+  const unfilled = pending.map((sh) => {
+    let reason: UnfilledReason = 'no_qualified_staff';
+    if (eligible[sh].length > 0) {
+      const anyFree = eligible[sh].some(st => !overlaps(st, sh));
+      reason = anyFree ? 'hours_exhausted' : 'all_qualified_busy';
+    }
+    return { shift: sh, reason };
+  });
+
+  return { assigned, unfilled };
+}
@@ -0,0 +1,12 @@
+import { parentPort } from 'worker_threads';
+import { solveAssignments, type AssignmentProblem } from './assignment-solver';
+
+// Worker entry: one problem in, one solution out
+parentPort?.on('message', (problem: AssignmentProblem) => {
+  try {
+    const solution = solveAssignments(problem);
+    parentPort!.postMessage({ ok: true, solution }, [solution.assigned.buffer]);
+  } catch (error) {
+    parentPort!.postMessage({ ok: false, error: error instanceof Error ? error.message : String(error) });
+  }
+});
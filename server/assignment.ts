@@ -0,0 +1,162 @@
+import { Worker } from 'worker_threads';
+import { storage } from './storage';
+import type { AssignmentProblem, AssignmentSolution } from './assignment-solver';
+import type { AutoAssignProposal, WeekViewShift } from '@shared/schema';
+
+const DAY_MINUTES = 24 * 60;
+const SOLVE_TIMEOUT_MS = parseInt(process.env.AUTO_ASSIGN_TIMEOUT_MS || '10000', 10);
+
+// In dev this module runs from server/*.ts under tsx; in production both files are bundled into dist/
+const workerUrl = new URL(
+  import.meta.url.endsWith('.ts') ? './assignment-worker.ts' : './assignment-worker.js',
+  import.meta.url,
+);
+
+const toMinutes = (time: string) => {
+  const [hours, minutes] = time.split(':').map(Number);
+  return (hours || 0) * 60 + (minutes || 0);
+};
+
+function runSolver(problem: AssignmentProblem): Promise<AssignmentSolution> {
+  return new Promise((resolve, reject) => {
+    const worker = new Worker(workerUrl);
+    const timer = setTimeout(() => {
+      worker.terminate();
+      reject(new Error(`Assignment solver timed out after ${SOLVE_TIMEOUT_MS}ms`));
+    }, SOLVE_TIMEOUT_MS);
+
+    worker.once('message', (message: { ok: boolean; solution?: AssignmentSolution; error?: string }) => {
+      clearTimeout(timer);
+      worker.terminate();
+      if (message.ok) {
+        resolve(message.solution!);
+      } else {
+        reject(new Error(message.error));
+      }
+    });
+    worker.once('error', (error) => {
+      clearTimeout(timer);
+      reject(error);
+    });
+
+    worker.postMessage(problem);
+  });
+}
+
+// Propose staff for every open shift in a location's week. Nothing is written; the caller
+// reviews the diff and applies it through the regular shift endpoints.
+export async function proposeAssignments(
+  locationId: number,
+  weekStart: Date,
+  options: { allowOvertime?: boolean } = {},
+): Promise<AutoAssignProposal> {
+  const [weekView, staffList, staffCompetencyList] = await Promise.all([
+    storage.getWeekView(locationId, weekStart),
+    storage.getStaffByLocation(locationId),
+    storage.getStaffCompetenciesByLocation(locationId),
+  ]);
+
+  const emptyProposal = (shiftsOpen: number): AutoAssignProposal => ({
+    scheduleId: weekView.schedule?.id ?? null,
+    assignments: [],
+    unfilled: [],
+    staffHours: [],
+    stats: { openShifts: shiftsOpen, filled: 0, solveMs: 0 },
+  });
+  if (!weekView.schedule || weekView.shifts.length === 0) return emptyProposal(0);
+
+  // Dense indices for the solver's arrays
+  const staffIndex = new Map<number, number>();
+  staffList.forEach((s, i) => staffIndex.set(s.id, i));
+  const competencyIndex = new Map<number, number>();
+  for (const sc of staffCompetencyList) {
+    if (!competencyIndex.has(sc.competencyId)) competencyIndex.set(sc.competencyId, competencyIndex.size);
+  }
+  for (const shift of weekView.shifts) {
+    if (shift.competencyId && !competencyIndex.has(shift.competencyId)) {
+      competencyIndex.set(shift.competencyId, competencyIndex.size);
+    }
+  }
+
+  const staffCount = staffList.length;
+  const competencyCount = competencyIndex.size;
+  const levels = new Int8Array(staffCount * competencyCount).fill(-1);
+  for (const sc of staffCompetencyList) {
+    const st = staffIndex.get(sc.staffId);
+    if (st !== undefined) levels[st * competencyCount + competencyIndex.get(sc.competencyId)!] = sc.level;
+  }
+
+  // Shifts held by staff from another location stay as they are and don't enter the problem
+  const shiftList: WeekViewShift[] = weekView.shifts.filter(s => !s.staffId || staffIndex.has(s.staffId));
+  const shiftCount = shiftList.length;
+  const weekStartMs = new Date(weekView.schedule.weekStartDate).getTime();
+  const shiftStart = new Int32Array(shiftCount);
+  const shiftEnd = new Int32Array(shiftCount);
+  const shiftCompetency = new Int16Array(shiftCount).fill(-1);
+  const shiftMinLevel = new Int8Array(shiftCount);
+  const shiftAssigned = new Int32Array(shiftCount).fill(-1);
+
+  shiftList.forEach((shift, i) => {
+    const dayOffset = Math.round((new Date(shift.date).getTime() - weekStartMs) / 60000 / DAY_MINUTES) * DAY_MINUTES;
+    const start = dayOffset + toMinutes(shift.startTime);
+    let end = dayOffset + toMinutes(shift.endTime);
+    if (end <= start) end += DAY_MINUTES; // overnight shift
+    shiftStart[i] = start;
+    shiftEnd[i] = end;
+    if (shift.competencyId) {
+      shiftCompetency[i] = competencyIndex.get(shift.competencyId)!;
+      shiftMinLevel[i] = shift.requiredCompetencyLevel ?? 0;
+    }
+    if (shift.staffId) shiftAssigned[i] = staffIndex.get(shift.staffId)!;
+  });
+
+  const openShifts = shiftAssigned.reduce((n, st) => n + (st === -1 ? 1 : 0), 0);
+  if (openShifts === 0 || staffCount === 0) {
+    const proposal = emptyProposal(openShifts);
+    proposal.unfilled = shiftList
+      .filter((_, i) => shiftAssigned[i] === -1)
+      .map(shift => ({ shiftId: shift.id, reason: 'no_qualified_staff' as const }));
+    return proposal;
+  }
+
+  const started = process.hrtime.bigint();
+  const solution = await runSolver({
+    staffCount,
+    competencyCount,
+    levels,
+    targetMinutes: Int32Array.from(staffList, s => s.wantedHours * 60),
+    shiftCount,
+    shiftStart,
+    shiftEnd,
+    shiftCompetency,
+    shiftMinLevel,
+    shiftAssigned,
+    allowOvertime: !!options.allowOvertime,
+  });
+  const solveMs = Number(process.hrtime.bigint() - started) / 1e6;
+
+  const currentMinutes = new Array(staffCount).fill(0);
+  const proposedMinutes = new Array(staffCount).fill(0);
+  const assignments: AutoAssignProposal['assignments'] = [];
+  shiftList.forEach((shift, i) => {
+    const minutes = shiftEnd[i] - shiftStart[i];
+    if (shiftAssigned[i] >= 0) currentMinutes[shiftAssigned[i]] += minutes;
+    const st = solution.assigned[i];
+    if (st < 0) return;
+    proposedMinutes[st] += minutes;
+    if (shiftAssigned[i] === -1) assignments.push({ shiftId: shift.id, staffId: staffList[st].id });
+  });
+
+  return {
+    scheduleId: weekView.schedule.id,
+    assignments,
+    unfilled: solution.unfilled.map(u => ({ shiftId: shiftList[u.shift].id, reason: u.reason })),
+    staffHours: staffList.map((s, i) => ({
+      staffId: s.id,
+      wantedHours: s.wantedHours,
+      currentHours: Math.round(currentMinutes[i] / 6) / 10,
+      proposedHours: Math.round(proposedMinutes[i] / 6) / 10,
+    })),
+    stats: { openShifts, filled: assignments.length, solveMs: Math.round(solveMs * 10) / 10 },
+  };
+}
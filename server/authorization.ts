@@ -0,0 +1,140 @@
+import type { Request } from 'express';
+import { storage, type PermissionSeed } from './storage';
+import { isPermissionSetStale, rolePermissionsChangedAt } from './permission-epochs';
+
+// A user's effective permissions, compiled from user_locations + role_permissions (and the
+// legacy users.role column) and kept in the session. Each set is a bitset indexed by
+// permission id packed into 32-bit words, so a check is an array read and a mask.
+export interface CompiledPermissions {
+  compiledAt: number;
+  // Granted at every location (the legacy administrator role)
+  global: number[];
+  // Keyed by location id
+  locations: Record<string, number[]>;
+}
+
+function setBit(words: number[], bit: number) {
+  const index = bit >>> 5;
+  while (words.length <= index) words.push(0);
+  words[index] |= 1 << (bit & 31);
+}
+
+function testBit(words: number[] | undefined, bit: number): boolean {
+  return words !== undefined && ((words[bit >>> 5] ?? 0) & (1 << (bit & 31))) !== 0;
+}
+
+export async function compileUserPermissions(userId: number): Promise<CompiledPermissions> {
+  // Stamped before reading so a change committed mid-compile still marks the result stale
+  const compiled: CompiledPermissions = { compiledAt: Date.now(), global: [], locations: {} };
+  const user = await storage.getUser(userId);
+  if (!user) return compiled;
+
+  const [rolePermissionIds, locationGrants] = await Promise.all([
+    storage.getRolePermissionIdsByName(user.role),
+    storage.getUserLocationPermissionIds(userId),
+  ]);
+
+  const grant = (locationId: number, permissionId: number) => {
+    setBit(compiled.locations[locationId] ??= [], permissionId);
+  };
+
+  if (user.role === 'administrator') {
+    rolePermissionIds.forEach(permissionId => setBit(compiled.global, permissionId));
+  } else if (user.locationId) {
+    rolePermissionIds.forEach(permissionId => grant(user.locationId!, permissionId));
+  }
+  for (const { locationId, permissionId } of locationGrants) {
+    grant(locationId, permissionId);
+  }
+  return compiled;
+}
+
+// Permissions checked by requirePermission. Each is granted on creation to the legacy roles
+// that passed the checkRole list it replaced; after that role_permissions is the source of truth.
+const STAFF_MANAGERS = ['administrator', 'manager', 'floor_manager'];
+const SCHEDULERS = ['administrator', 'manager', 'crew_manager', 'floor_manager'];
+
+export const PERMISSION_CATALOG: PermissionSeed[] = [
+  { name: 'schedule.view', description: 'View week schedules and shift coverage, and receive live shift updates', roles: SCHEDULERS },
+  { name: 'schedule.edit', description: 'Create, change and auto-assign shifts and roll out templates', roles: SCHEDULERS },
+  { name: 'cash.summary', description: 'Read cash count summaries', roles: STAFF_MANAGERS },
+  { name: 'export.run', description: 'Download shift, cash count and applicant exports', roles: STAFF_MANAGERS },
+];
+
+// Run at startup; safe to repeat and to race with other workers
+export function seedPermissionCatalog(): Promise<void> {
+  return storage.seedPermissions(PERMISSION_CATALOG);
+}
+
+// Permission names resolve to bit positions through an in-process copy of the permissions
+// table, reloaded after role changes or (at most every 30s) when an unknown name turns up
+const CATALOG_RETRY_MS = 30000;
+let catalog: { loadedAt: number; ids: Map<string, number> } | null = null;
+let catalogLoad: Promise<Map<string, number>> | null = null;
+
+function loadCatalog(): Promise<Map<string, number>> {
+  if (!catalogLoad) {
+    const loadedAt = Date.now();
+    catalogLoad = storage.getPermissions()
+      .then((rows) => {
+        const ids = new Map(rows.map(row => [row.name, row.id] as const));
+        catalog = { loadedAt, ids };
+        return ids;
+      })
+      .finally(() => {
+        catalogLoad = null;
+      });
+  }
+  return catalogLoad;
+}
+
+async function permissionBit(name: string): Promise<number | undefined> {
+  if (catalog && catalog.loadedAt > rolePermissionsChangedAt()) {
+    const id = catalog.ids.get(name);
+    if (id !== undefined || Date.now() - catalog.loadedAt < CATALOG_RETRY_MS) return id;
+  }
+  return (await loadCatalog()).get(name);
+}
+
+// The session's compiled set, recompiled only when missing or stale
+export async function sessionPermissions(req: Request): Promise<CompiledPermissions> {
+  const current = req.session.authz;
+  if (current && !isPermissionSetStale(req.user!.id, current.compiledAt)) return current;
+
+  const compiled = await compileUserPermissions(req.user!.id);
+  req.session.authz = compiled;
+  return compiled;
+}
+
+// Without a location the check passes if the permission is held at any location
+export function hasPermission(compiled: CompiledPermissions, bit: number, locationId?: number): boolean {
+  if (testBit(compiled.global, bit)) return true;
+  if (locationId !== undefined) return testBit(compiled.locations[locationId], bit);
+  return Object.values(compiled.locations).some(words => testBit(words, bit));
+}
+
+export async function userCan(req: Request, permission: string, locationId?: number): Promise<boolean> {
+  if (!req.user) return false;
+  const [compiled, bit] = await Promise.all([sessionPermissions(req), permissionBit(permission)]);
+  return bit !== undefined && hasPermission(compiled, bit, locationId);
+}
+
+// Locations where the user holds the permission. null means every location (a global grant).
+export async function permittedLocationIds(req: Request, permission: string): Promise<number[] | null> {
+  const [compiled, bit] = await Promise.all([sessionPermissions(req), permissionBit(permission)]);
+  if (bit === undefined) return [];
+  if (testBit(compiled.global, bit)) return null;
+  return Object.keys(compiled.locations)
+    .filter(locationId => testBit(compiled.locations[locationId], bit))
+    .map(Number);
+}
+
+// Locations a user may read data for: their own plus any user_locations grant. null means every
+// location (administrators).
+export async function accessibleLocationIds(req: Request): Promise<number[] | null> {
+  if (req.user!.role === 'administrator') return null;
+  const [user, compiled] = await Promise.all([storage.getUser(req.user!.id), sessionPermissions(req)]);
+  const ids = new Set(Object.keys(compiled.locations).map(Number));
+  if (user?.locationId) ids.add(user.locationId);
+  return Array.from(ids);
+}
@@ -0,0 +1,90 @@
+import fs from 'fs';
+import path from 'path';
+import { sql } from 'drizzle-orm';
+import { storage, type DbTransaction } from './storage';
+import { db } from './db';
+
+// Content-addressed file store: every body is stored once under its SHA-256, fanned out by
+// the first two hex characters so no single directory grows unbounded
+const BLOB_DIR = path.join(process.cwd(), 'uploads', 'blobs');
+const TEMP_DIR = path.join(BLOB_DIR, 'tmp');
+
+fs.mkdirSync(TEMP_DIR, { recursive: true });
+
+export function blobPath(sha256: string): string {
+  return path.join(BLOB_DIR, sha256.slice(0, 2), sha256);
+}
+
+// Derived files (resized images, document previews) sit next to their source blob, so
+// deduplicated uploads share them and they go when the blob goes
+export function blobVariantPath(sha256: string, variant: string): string {
+  return `${blobPath(sha256)}.${variant}`;
+}
+
+// Where in-flight uploads are written before their hash is known
+export function blobTempPath(): string {
+  return path.join(TEMP_DIR, `${Date.now()}-${Math.round(Math.random() * 1E9)}.part`);
+}
+
+// Whether a blob stays is decided under a per-hash lock: storing a blob together with the row
+// that references it, and releasing it once no row does, never interleave. Otherwise a release
+// could count no rows and delete bytes a deduplicated upload was about to point at. The lock is
+// a transaction-scoped advisory lock, and work gets that transaction so its row count or insert
+// runs on the connection already held rather than waiting on a second one from the pool. The
+// in-process chain keeps same-hash work in one worker from each holding a connection while it
+// waits, and is the whole lock for STORAGE_BACKEND=memory.
+const BLOB_LOCK = 'blob';
+const blobLocks = new Map<string, Promise<unknown>>();
+
+export async function withBlobLock<T>(sha256: string, work: (tx?: DbTransaction) => Promise<T>): Promise<T> {
+  const previous = blobLocks.get(sha256) ?? Promise.resolve();
+  const current = previous.catch(() => {}).then(() => withAdvisoryLock(sha256, work));
+  blobLocks.set(sha256, current);
+  try {
+    return await current;
+  } finally {
+    if (blobLocks.get(sha256) === current) blobLocks.delete(sha256);
+  }
+}
+
+function withAdvisoryLock<T>(sha256: string, work: (tx?: DbTransaction) => Promise<T>): Promise<T> {
+  if (process.env.STORAGE_BACKEND === 'memory') return work();
+  return db.transaction(async (tx) => {
+    await tx.execute(sql`SELECT pg_advisory_xact_lock(hashtext(${BLOB_LOCK}), hashtext(${sha256}))`);
+    return work(tx);
+  });
+}
+
+// Move a fully written temp file into the store. If the same content is already stored the
+// temp file is discarded and the existing blob is reused.
+export async function commitBlob(tempPath: string, sha256: string): Promise<{ path: string; deduplicated: boolean }> {
+  const target = blobPath(sha256);
+  await fs.promises.mkdir(path.dirname(target), { recursive: true });
+
+  try {
+    await fs.promises.access(target);
+    await fs.promises.unlink(tempPath);
+    return { path: target, deduplicated: true };
+  } catch {
+    await fs.promises.rename(tempPath, target);
+    return { path: target, deduplicated: false };
+  }
+}
+
+// Delete a blob once no uploaded_files row references it any more
+export function releaseBlob(sha256: string): Promise<void> {
+  return withBlobLock(sha256, async (tx) => {
+    if (await storage.countUploadedFilesByContentHash(sha256, tx) > 0) return;
+    await removeBlob(sha256);
+  });
+}
+
+async function removeBlob(sha256: string): Promise<void> {
+  const target = blobPath(sha256);
+  await fs.promises.unlink(target).catch(() => {});
+
+  const dir = path.dirname(target);
+  const variants = (await fs.promises.readdir(dir).catch(() => [] as string[]))
+    .filter(name => name.startsWith(`${sha256}.`));
+  await Promise.all(variants.map(name => fs.promises.unlink(path.join(dir, name)).catch(() => {})));
+}
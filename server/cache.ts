@@ -0,0 +1,53 @@
+import { cacheGet, cacheSetTagged, cacheInvalidateTags } from './redis';
+import { recordCacheLookup } from './metrics';
+
+// Read-through cache for storage lookups, shared across Node instances through Redis.
+// Entries are tagged with the entities they contain so writes can invalidate precisely;
+// when Redis is unavailable every call falls straight through to the loader.
+
+const DEFAULT_TTL = parseInt(process.env.STORAGE_CACHE_TTL || '300', 10); // seconds
+const KEY_PREFIX = 'storage:';
+
+export const cacheTags = {
+  user: (id: number) => `user:${id}`,
+  location: (id: number) => `location:${id}`,
+  locations: () => 'locations',
+  staff: (id: number) => `staff:${id}`,
+  staffByLocation: (locationId: number) => `location:${locationId}:staff`,
+  competency: (id: number) => `competency:${id}`,
+  competenciesByLocation: (locationId: number) => `location:${locationId}:competencies`,
+  schedule: (id: number) => `schedule:${id}`,
+  schedulesByLocation: (locationId: number) => `location:${locationId}:schedules`,
+  shift: (id: number) => `shift:${id}`,
+  applicant: (id: number) => `applicant:${id}`,
+  applicantDocuments: (applicantId: number) => `applicant:${applicantId}:documents`,
+  // Cached dashboard KPIs, dropped by any staff, applicant, shift or cash count write at the location
+  dashboard: (locationId: number) => `location:${locationId}:dashboard`,
+};
+
+export async function readThrough<T>(
+  key: string,
+  loader: () => Promise<T>,
+  tagsFor: (value: NonNullable<T>) => string[],
+  ttl: number = DEFAULT_TTL,
+): Promise<T> {
+  const cacheKey = KEY_PREFIX + key;
+  const cached = await cacheGet(cacheKey);
+  // Hit ratios are tracked per entity kind (the key up to its first colon)
+  recordCacheLookup(key.split(':', 1)[0], cached !== null);
+  if (cached !== null) {
+    return cached as T;
+  }
+
+  const value = await loader();
+
+  // Misses are not cached, so a later create is visible without invalidation
+  if (value !== undefined && value !== null) {
+    void cacheSetTagged(cacheKey, value, tagsFor(value as NonNullable<T>), ttl);
+  }
+  return value;
+}
+
+export async function invalidateTags(...tags: string[]): Promise<void> {
+  await cacheInvalidateTags(tags);
+}
@@ -0,0 +1,95 @@
+import type { CashCount, CashCountRollup, CashSummaryBucket, CashSummaryQuery } from "@shared/schema";
+
+// Amounts are summed as integer cents so merging thousands of rollups never drifts
+const toCents = (value: string | number | null | undefined) => Math.round(Number(value || 0) * 100);
+const fromCents = (cents: number) => (cents / 100).toFixed(2);
+
+export type CashRollupKey = Pick<CashCountRollup, "locationId" | "day" | "countType">;
+export type CashRollupDelta = CashCountRollup;
+
+export function cashRollupDay(countDate: Date): string {
+  return new Date(countDate).toISOString().slice(0, 10);
+}
+
+export const cashRollupKey = (key: CashRollupKey) => `${key.locationId}:${key.day}:${key.countType}`;
+
+// Contribution of one cash count to its rollup row; sign -1 removes it again
+export function cashRollupDelta(count: CashCount, sign: 1 | -1): CashRollupDelta {
+  return {
+    locationId: count.locationId,
+    day: cashRollupDay(count.countDate),
+    countType: count.countType,
+    entries: sign,
+    cashTotal: fromCents(sign * toCents(count.cashAmount)),
+    cardTotal: fromCents(sign * toCents(count.cardAmount)),
+    floatTotal: fromCents(sign * toCents(count.floatAmount)),
+    expectedTotal: fromCents(sign * toCents(count.expectedAmount)),
+    discrepancyTotal: fromCents(sign * toCents(count.discrepancy)),
+  };
+}
+
+// Add a delta onto an existing rollup row (in-memory storage)
+export function addCashRollup(existing: CashCountRollup | undefined, delta: CashRollupDelta): CashCountRollup {
+  if (!existing) return { ...delta };
+  return {
+    ...existing,
+    entries: existing.entries + delta.entries,
+    cashTotal: fromCents(toCents(existing.cashTotal) + toCents(delta.cashTotal)),
+    cardTotal: fromCents(toCents(existing.cardTotal) + toCents(delta.cardTotal)),
+    floatTotal: fromCents(toCents(existing.floatTotal) + toCents(delta.floatTotal)),
+    expectedTotal: fromCents(toCents(existing.expectedTotal) + toCents(delta.expectedTotal)),
+    discrepancyTotal: fromCents(toCents(existing.discrepancyTotal) + toCents(delta.discrepancyTotal)),
+  };
+}
+
+function periodFor(day: string, groupBy: CashSummaryQuery["groupBy"]): string {
+  if (groupBy === "day") return day;
+  if (groupBy === "month") return day.slice(0, 7);
+  if (groupBy === "total") return "total";
+  // ISO week, starting Monday
+  const date = new Date(`${day}T00:00:00Z`);
+  date.setUTCDate(date.getUTCDate() - ((date.getUTCDay() + 6) % 7));
+  return date.toISOString().slice(0, 10);
+}
+
+// Merge daily rollup rows into report buckets
+export function mergeCashRollups(rollups: CashCountRollup[], query: CashSummaryQuery): CashSummaryBucket[] {
+  const buckets = new Map<string, {
+    period: string;
+    locationId: number | null;
+    entries: { opening: number; midday: number; closing: number };
+    cash: number;
+    card: number;
+    discrepancy: number;
+  }>();
+
+  for (const rollup of rollups) {
+    const period = periodFor(rollup.day, query.groupBy);
+    const locationId = query.byLocation ? rollup.locationId : null;
+    const key = `${period}:${locationId ?? "all"}`;
+    let bucket = buckets.get(key);
+    if (!bucket) {
+      bucket = { period, locationId, entries: { opening: 0, midday: 0, closing: 0 }, cash: 0, card: 0, discrepancy: 0 };
+      buckets.set(key, bucket);
+    }
+
+    bucket.entries[rollup.countType] += rollup.entries;
+    // Opening counts only establish the float; they'd double count if summed
+    if (rollup.countType === "opening") continue;
+    bucket.cash += toCents(rollup.cashTotal) - (rollup.countType === "closing" ? toCents(rollup.floatTotal) : 0);
+    bucket.card += toCents(rollup.cardTotal);
+    bucket.discrepancy += toCents(rollup.discrepancyTotal);
+  }
+
+  return Array.from(buckets.values())
+    .sort((a, b) => a.period.localeCompare(b.period) || (a.locationId ?? 0) - (b.locationId ?? 0))
+    .map((bucket) => ({
+      period: bucket.period,
+      locationId: bucket.locationId,
+      entries: bucket.entries,
+      cashTotal: bucket.cash / 100,
+      cardTotal: bucket.card / 100,
+      totalSales: (bucket.cash + bucket.card) / 100,
+      discrepancyTotal: bucket.discrepancy / 100,
+    }));
+}
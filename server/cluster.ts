@@ -0,0 +1,106 @@
+import cluster, { type Worker } from 'cluster';
+import os from 'os';
+import { createLogger } from './logger';
+
+// Cluster mode: the primary forks N workers that share the listening socket, restarts crashed
+// ones and performs rolling restarts. Workers hold no state the others need: sessions live in
+// the session store, caches and shift notifications go through Redis.
+//
+//   CLUSTER_WORKERS=4 | auto   (falls back to WEB_CONCURRENCY; unset or 1 = single process)
+//   kill -HUP <primary pid>    rolling restart, one worker at a time
+//   kill -TERM <primary pid>   drain every worker and exit
+
+const clusterLog = createLogger('cluster');
+
+const SHUTDOWN_TIMEOUT_MS = parseInt(process.env.CLUSTER_SHUTDOWN_TIMEOUT_MS || '', 10) || 30000;
+const MAX_RESTART_DELAY_MS = 30000;
+// A worker that stays up this long resets its crash backoff
+const STABLE_UPTIME_MS = 60000;
+
+export function clusterWorkerCount(): number {
+  const configured = (process.env.CLUSTER_WORKERS || process.env.WEB_CONCURRENCY || '').trim().toLowerCase();
+  if (process.env.NODE_ENV === 'development' || !configured) return 1;
+  if (configured === 'auto') return os.availableParallelism();
+  const count = parseInt(configured, 10);
+  return Number.isFinite(count) && count > 1 ? count : 1;
+}
+
+export function runPrimary(workerCount: number) {
+  if ((process.env.SESSION_STORE || '').toLowerCase() === 'memory') {
+    clusterLog.warn('SESSION_STORE=memory is per process; logins will not carry over between workers');
+  }
+  clusterLog.info(`primary ${process.pid} starting ${workerCount} workers`);
+
+  let shuttingDown = false;
+  let restartDelayMs = 1000;
+  const retiring = new Set<Worker>();
+  const startedAt = new Map<Worker, number>();
+
+  const fork = () => {
+    const worker = cluster.fork();
+    startedAt.set(worker, Date.now());
+    return worker;
+  };
+
+  for (let i = 0; i < workerCount; i++) fork();
+
+  cluster.on('exit', (worker, code, signal) => {
+    const uptime = Date.now() - (startedAt.get(worker) ?? Date.now());
+    startedAt.delete(worker);
+    if (retiring.delete(worker) || shuttingDown) return;
+
+    // Crashed: replace it, backing off when workers keep dying right after boot
+    restartDelayMs = uptime > STABLE_UPTIME_MS ? 1000 : Math.min(restartDelayMs * 2, MAX_RESTART_DELAY_MS);
+    clusterLog.error(`worker ${worker.process.pid} exited (${signal || code}); restarting in ${restartDelayMs}ms`);
+    setTimeout(() => { if (!shuttingDown) fork(); }, restartDelayMs);
+  });
+
+  // Ask a worker to drain (it closes its server and sockets on 'disconnect'), kill it if it hangs
+  const retire = (worker: Worker) => new Promise<void>((resolve) => {
+    retiring.add(worker);
+    const timer = setTimeout(() => worker.kill('SIGKILL'), SHUTDOWN_TIMEOUT_MS);
+    worker.once('exit', () => {
+      clearTimeout(timer);
+      resolve();
+    });
+    worker.disconnect();
+  });
+
+  let restarting = false;
+  const rollingRestart = async () => {
+    if (restarting || shuttingDown) return;
+    restarting = true;
+    clusterLog.info('rolling restart');
+    try {
+      for (const worker of Object.values(cluster.workers ?? {})) {
+        if (!worker || retiring.has(worker) || shuttingDown) continue;
+        // Bring the replacement up before the old worker stops accepting connections
+        const replacement = fork();
+        const listening = await new Promise<boolean>((resolve) => {
+          replacement.once('listening', () => resolve(true));
+          replacement.once('exit', () => resolve(false));
+        });
+        if (!listening) {
+          clusterLog.error('replacement worker failed to start; aborting rolling restart');
+          break;
+        }
+        await retire(worker);
+      }
+    } finally {
+      restarting = false;
+    }
+  };
+
+  const shutdown = async (signal: string) => {
+    if (shuttingDown) return;
+    shuttingDown = true;
+    clusterLog.info(`${signal} received, stopping workers`);
+    await Promise.all(Object.values(cluster.workers ?? {}).filter((w): w is Worker => !!w).map(retire));
+    process.exit(0);
+  };
+
+  process.on('SIGHUP', () => void rollingRestart());
+  process.on('SIGUSR2', () => void rollingRestart());
+  process.on('SIGTERM', () => void shutdown('SIGTERM'));
+  process.on('SIGINT', () => void shutdown('SIGINT'));
+}
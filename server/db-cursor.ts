@@ -0,0 +1,43 @@
+import type { SQL } from 'drizzle-orm';
+import { PgDialect } from 'drizzle-orm/pg-core';
+import { types } from '@neondatabase/serverless';
+import { reportingPool } from './db';
+
+const dialect = new PgDialect();
+
+// Raw rows skip drizzle's column mapping, and pg's default parser reads timestamp without time
+// zone as local time. The stored values are UTC (the storage layer binds ISO strings), so parse
+// them the way drizzle's timestamp columns do.
+const TIMESTAMP_OID = 1114;
+const queryTypes = {
+  getTypeParser: (oid: number, format?: any) =>
+    oid === TIMESTAMP_OID ? (value: string) => new Date(`${value}+0000`) : types.getTypeParser(oid, format),
+};
+
+// Stream a query's rows in chunks through a server-side cursor on the reporting pool, so an
+// export of any size holds one chunk in memory at a time. Rows come back with the column
+// aliases used in the query. Stopping the iteration early (client went away) closes the cursor.
+export async function* cursorChunks<T>(query: SQL, chunkSize = 1000): AsyncGenerator<T[]> {
+  const { sql: text, params } = dialect.sqlToQuery(query);
+  const client = await reportingPool.connect();
+  let committed = false;
+  let broken: Error | undefined;
+  try {
+    // A cursor only lives inside a transaction; the whole export reads one snapshot
+    await client.query('BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY');
+    await client.query(`DECLARE export_cursor NO SCROLL CURSOR FOR ${text}`, params);
+    while (true) {
+      const { rows } = await client.query({ text: `FETCH ${chunkSize} FROM export_cursor`, types: queryTypes });
+      if (rows.length > 0) yield rows as T[];
+      if (rows.length < chunkSize) break;
+    }
+    await client.query('COMMIT');
+    committed = true;
+  } finally {
+    if (!committed) {
+      // Early return or failure; a connection whose rollback fails is not reused
+      await client.query('ROLLBACK').catch((error: Error) => { broken = error; });
+    }
+    client.release(broken);
+  }
+}
@@ -1,7 +1,10 @@
 import { Pool, neonConfig } from '@neondatabase/serverless';
 import { drizzle } from 'drizzle-orm/neon-serverless';
 import ws from "ws";
+import { AsyncResource } from "async_hooks";
 import * as schema from "@shared/schema";
+import { Histogram } from "./histogram";
+import { recordDbQuery, currentRequestScope } from "./metrics";
 
 // Configure Neon database to use websockets
 neonConfig.webSocketConstructor = ws;
@@ -12,20 +15,166 @@ if (!process.env.DATABASE_URL) {
   );
 }
 
-// Create an optimized connection pool with aggressive settings for better performance
-export const pool = new Pool({ 
-  connectionString: process.env.DATABASE_URL,
-  max: 3, // Reduce pool size to minimize overhead
-  idleTimeoutMillis: 10000, // Close idle clients faster
-  connectionTimeoutMillis: 5000, // Faster timeout for quicker error detection
-  maxUses: 500, // Keep connections longer to reduce setup overhead
-});
-
-// Add connection event listeners for better debugging
-pool.on('error', (err) => {
-  console.error('Unexpected database pool error:', err);
-  // Don't crash the server, just log the error
-});
+// Separate pools per workload so a slow report or a burst of session writes
+// can't take every connection away from interactive requests (logins, schedules)
+export type PoolWorkload = 'oltp' | 'session' | 'reporting';
+
+interface PoolMetrics {
+  acquireLatency: Histogram;
+  acquired: number;
+  timeouts: number;
+  errors: number;
+}
+
+interface ManagedPool {
+  pool: Pool;
+  max: number;
+  metrics: PoolMetrics;
+}
+
+const envInt = (name: string, fallback: number) => {
+  const value = parseInt(process.env[name] || '', 10);
+  return Number.isFinite(value) && value > 0 ? value : fallback;
+};
+
+const POOL_DEFAULTS: Record<PoolWorkload, { max: number; connectionTimeoutMillis: number }> = {
+  oltp: { max: envInt('DB_POOL_OLTP_MAX', 3), connectionTimeoutMillis: envInt('DB_POOL_OLTP_TIMEOUT_MS', 5000) },
+  session: { max: envInt('DB_POOL_SESSION_MAX', 1), connectionTimeoutMillis: envInt('DB_POOL_SESSION_TIMEOUT_MS', 3000) },
+  reporting: { max: envInt('DB_POOL_REPORTING_MAX', 1), connectionTimeoutMillis: envInt('DB_POOL_REPORTING_TIMEOUT_MS', 15000) },
+};
+
+const INSTRUMENTED = Symbol('instrumented');
+
+// Time every query a pooled client runs. Clients are reused, so each is wrapped only once.
+function instrumentClient(client: any, workload: PoolWorkload) {
+  if (client[INSTRUMENTED]) return;
+  client[INSTRUMENTED] = true;
+  const originalQuery = client.query.bind(client) as (...args: any[]) => any;
+
+  client.query = (...args: any[]) => {
+    const start = process.hrtime.bigint();
+    const scope = currentRequestScope();
+    let recorded = false;
+    const record = (err?: unknown) => {
+      if (recorded) return;
+      recorded = true;
+      recordDbQuery(workload, Number(process.hrtime.bigint() - start) / 1000000, !!err, scope);
+    };
+
+    // Callback style (pool.query uses this internally)
+    const last = args.length - 1;
+    if (typeof args[last] === 'function') {
+      const callback = args[last];
+      args[last] = (err: unknown, ...rest: unknown[]) => {
+        record(err);
+        callback(err, ...rest);
+      };
+      return originalQuery(...args);
+    }
+
+    const result = originalQuery(...args);
+    if (result && typeof result.then === 'function') {
+      result.then(() => record(), (err: unknown) => record(err));
+    } else if (result && typeof result.once === 'function') {
+      // Submittables such as cursors report completion through events
+      result.once('end', () => record());
+      result.once('error', (err: unknown) => record(err));
+    }
+    return result;
+  };
+}
+
+// Wrap pool.connect (also used internally by pool.query) to time how long callers wait for a client
+function instrumentPool(pool: Pool, metrics: PoolMetrics, workload: PoolWorkload) {
+  const originalConnect = pool.connect.bind(pool) as (...args: any[]) => any;
+
+  const record = (start: bigint, err?: Error) => {
+    metrics.acquireLatency.observe(Number(process.hrtime.bigint() - start) / 1000000);
+    if (!err) {
+      metrics.acquired++;
+    } else if (/timeout/i.test(err.message)) {
+      metrics.timeouts++;
+    } else {
+      metrics.errors++;
+    }
+  };
+
+  (pool as any).connect = (callback?: (err: Error | undefined, client?: any, done?: any) => void) => {
+    const start = process.hrtime.bigint();
+    if (callback) {
+      // A released client is handed to the next waiter from inside the releaser's callback;
+      // bind so pool.query's follow-up client.query still runs in (and counts toward) the
+      // caller's request
+      return originalConnect(AsyncResource.bind((err: Error | undefined, client: any, done: any) => {
+        record(start, err);
+        if (client) instrumentClient(client, workload);
+        callback(err, client, done);
+      }));
+    }
+    return originalConnect().then(
+      (client: any) => {
+        record(start);
+        instrumentClient(client, workload);
+        return client;
+      },
+      (err: Error) => {
+        record(start, err);
+        throw err;
+      },
+    );
+  };
+}
+
+function createPool(workload: PoolWorkload): ManagedPool {
+  const { max, connectionTimeoutMillis } = POOL_DEFAULTS[workload];
+  const pool = new Pool({
+    connectionString: process.env.DATABASE_URL,
+    max,
+    idleTimeoutMillis: 10000, // Close idle clients faster
+    connectionTimeoutMillis,
+    maxUses: 500, // Keep connections longer to reduce setup overhead
+  });
+
+  // Add connection event listeners for better debugging
+  pool.on('error', (err) => {
+    console.error(`Unexpected database pool error (${workload}):`, err);
+    // Don't crash the server, just log the error
+  });
+
+  const metrics: PoolMetrics = { acquireLatency: new Histogram(), acquired: 0, timeouts: 0, errors: 0 };
+  instrumentPool(pool, metrics, workload);
+  return { pool, max, metrics };
+}
+
+const pools: Record<PoolWorkload, ManagedPool> = {
+  oltp: createPool('oltp'),
+  session: createPool('session'),
+  reporting: createPool('reporting'),
+};
+
+// Interactive queries (auth lookups, scheduling, uploads metadata)
+export const pool = pools.oltp.pool;
+// Session store reads/writes
+export const sessionPool = pools.session.pool;
+// Long-running aggregate and export queries
+export const reportingPool = pools.reporting.pool;
+
+export function getPoolStats() {
+  return (Object.keys(pools) as PoolWorkload[]).map((workload) => {
+    const { pool, max, metrics } = pools[workload];
+    return {
+      workload,
+      max,
+      total: pool.totalCount,
+      idle: pool.idleCount,
+      waiting: pool.waitingCount,
+      acquired: metrics.acquired,
+      timeouts: metrics.timeouts,
+      errors: metrics.errors,
+      acquireLatency: metrics.acquireLatency.snapshot(),
+    };
+  });
+}
 
 // Add connection health check function
 export const checkDatabaseConnection = async () => {
@@ -43,8 +192,9 @@ export const checkDatabaseConnection = async () => {
   }
 };
 
-// Create drizzle ORM instance
+// Create drizzle ORM instances
 export const db = drizzle(pool, { schema });
+export const reportingDb = drizzle(reportingPool, { schema });
 
 // Initial connection check (don't block server startup)
 checkDatabaseConnection()
@@ -57,4 +207,4 @@ checkDatabaseConnection()
   })
   .catch(err => {
     console.error('❌ Error checking database connection:', err);
-  });
\ No newline at end of file
+  });
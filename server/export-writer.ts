@@ -0,0 +1,85 @@
+import type { Request, Response } from 'express';
+import { once } from 'events';
+import zlib from 'zlib';
+import type { Writable } from 'stream';
+
+// Writes chunked export rows to the response as CSV or NDJSON. Each chunk is serialised and
+// written once; when the socket (or gzip) buffer is full the next chunk is not read until it
+// drains, so memory stays at about one chunk whatever the export size.
+
+export type ExportFormat = 'csv' | 'ndjson';
+
+function csvValue(value: unknown): string {
+  if (value === null || value === undefined) return '';
+  let text = value instanceof Date ? value.toISOString() : String(value);
+  // Keep spreadsheet apps from evaluating user-entered text as a formula
+  if (typeof value === 'string' && /^[=+\-@\t\r]/.test(text) && !/^-?\d+(\.\d+)?$/.test(text)) {
+    text = `'${text}`;
+  }
+  return /[",\r\n]/.test(text) ? `"${text.replace(/"/g, '""')}"` : text;
+}
+
+export async function writeExport<T extends Record<string, unknown>>(
+  req: Request,
+  res: Response,
+  options: { filename: string; format: ExportFormat; columns: (keyof T & string)[]; chunks: AsyncIterable<T[]> },
+): Promise<void> {
+  const { filename, format, columns, chunks } = options;
+
+  // Run the query before committing to a 200: if it fails here the route still answers with a
+  // normal error response rather than a CSV header and a cut connection
+  const iterator = chunks[Symbol.asyncIterator]();
+  let next = await iterator.next();
+
+  let closed = false;
+  res.on('close', () => { closed = true; });
+
+  res.setHeader('Content-Type', format === 'csv' ? 'text/csv; charset=utf-8' : 'application/x-ndjson; charset=utf-8');
+  res.setHeader('Content-Disposition', `attachment; filename="${filename}.${format}"`);
+  res.setHeader('Cache-Control', 'no-store');
+  res.vary('Accept-Encoding');
+
+  // Compress on the fly; the browser decodes it transparently and saves the plain file
+  let out: Writable = res;
+  let gzip: zlib.Gzip | undefined;
+  if (req.acceptsEncodings('gzip', 'identity') === 'gzip') {
+    res.setHeader('Content-Encoding', 'gzip');
+    gzip = zlib.createGzip({ level: 6 });
+    gzip.pipe(res);
+    out = gzip;
+  }
+
+  const write = async (text: string) => {
+    if (!out.write(text)) await Promise.race([once(out, 'drain'), once(res, 'close')]);
+  };
+
+  try {
+    if (format === 'csv') {
+      // BOM so Excel opens UTF-8 names correctly
+      await write('\uFEFF' + columns.join(',') + '\r\n');
+    }
+    while (!next.done && !closed) {
+      const rows = next.value;
+      const text = format === 'csv'
+        ? rows.map(row => columns.map(column => csvValue(row[column])).join(',')).join('\r\n') + '\r\n'
+        : rows.map(row => JSON.stringify(row)).join('\n') + '\n';
+      await write(text);
+      if (!closed) next = await iterator.next();
+    }
+    out.end();
+  } catch (error) {
+    gzip?.unpipe(res);
+    gzip?.destroy();
+    if (!res.headersSent) {
+      // Nothing sent yet: let the route answer with a normal error response
+      ['Content-Type', 'Content-Disposition', 'Content-Encoding'].forEach(header => res.removeHeader(header));
+      throw error;
+    }
+    // Mid-stream; cutting the connection is the only way left to signal the failure
+    console.error(`Export ${filename} failed:`, error);
+    res.destroy(error as Error);
+  } finally {
+    // Stopped early (client went away, write failed): closes the cursor
+    if (!next.done) await iterator.return?.(undefined).catch(() => {});
+  }
+}
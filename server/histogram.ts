@@ -0,0 +1,89 @@
+// Fixed-bucket latency histogram (milliseconds). Cheap enough to record on every
+// operation; percentiles are estimated from the bucket boundaries.
+
+export const DEFAULT_LATENCY_BUCKETS = [1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000];
+
+// HDR-style log-linear boundaries: each power of two between min and max is split into
+// subBuckets equal steps, so relative error stays bounded (~1/subBuckets) at every scale
+export function logLinearBuckets(minMs: number, maxMs: number, subBuckets: number): number[] {
+  const buckets: number[] = [];
+  for (let base = minMs; base < maxMs; base *= 2) {
+    for (let i = 0; i < subBuckets; i++) {
+      buckets.push(Math.round((base + (base * i) / subBuckets) * 1000) / 1000);
+    }
+  }
+  buckets.push(maxMs);
+  return buckets;
+}
+
+export class Histogram {
+  readonly buckets: number[];
+  private counts: number[];
+  private total = 0;
+  private sumMs = 0;
+  private maxMs = 0;
+
+  constructor(buckets: number[] = DEFAULT_LATENCY_BUCKETS) {
+    this.buckets = buckets;
+    // Last slot is the +Inf bucket
+    this.counts = new Array(buckets.length + 1).fill(0);
+  }
+
+  observe(ms: number): void {
+    // First bucket whose upper bound is >= ms (binary search; log-linear layouts are long)
+    let lo = 0;
+    let hi = this.buckets.length;
+    while (lo < hi) {
+      const mid = (lo + hi) >>> 1;
+      if (ms > this.buckets[mid]) lo = mid + 1;
+      else hi = mid;
+    }
+    this.counts[lo]++;
+    this.total++;
+    this.sumMs += ms;
+    if (ms > this.maxMs) this.maxMs = ms;
+  }
+
+  get count(): number {
+    return this.total;
+  }
+
+  get sum(): number {
+    return this.sumMs;
+  }
+
+  // Upper bound of the bucket containing the given quantile (0..1)
+  percentile(q: number): number {
+    if (this.total === 0) return 0;
+    const rank = Math.ceil(q * this.total);
+    let seen = 0;
+    for (let i = 0; i < this.counts.length; i++) {
+      seen += this.counts[i];
+      if (seen >= rank) {
+        return i < this.buckets.length ? Math.min(this.buckets[i], this.maxMs) : this.maxMs;
+      }
+    }
+    return this.maxMs;
+  }
+
+  // Cumulative counts per bucket upper bound, Prometheus style
+  cumulative(): { le: number; count: number }[] {
+    let running = 0;
+    return this.counts.map((c, i) => {
+      running += c;
+      return { le: i < this.buckets.length ? this.buckets[i] : Infinity, count: running };
+    });
+  }
+
+  snapshot() {
+    return {
+      count: this.total,
+      sumMs: Math.round(this.sumMs * 100) / 100,
+      maxMs: Math.round(this.maxMs * 100) / 100,
+      p50Ms: this.percentile(0.5),
+      p90Ms: this.percentile(0.9),
+      p99Ms: this.percentile(0.99),
+      buckets: this.cumulative().map(b => ({ le: b.le === Infinity ? "+Inf" : b.le, count: b.count })),
+    };
+  }
+}
@@ -0,0 +1,120 @@
+import fs from 'fs';
+import { execFile } from 'child_process';
+import { promisify } from 'util';
+import { blobTempPath, blobVariantPath } from './blob-store';
+import type { UploadedFile } from '@shared/schema';
+
+// Resized WebP/AVIF renditions of uploaded images and of the first page of uploaded PDFs,
+// written next to the source blob as "<sha256>.w<width>.<format>". They are generated by the
+// upload.variants job and picked by width and Accept header when a download asks for ?w=.
+
+const execFileAsync = promisify(execFile);
+
+// Thumbnail, list/card preview, full-width view
+export const VARIANT_WIDTHS = [160, 480, 1280];
+
+// In order of preference when the client accepts both
+export const VARIANT_FORMATS = ['avif', 'webp'] as const;
+export type VariantFormat = typeof VARIANT_FORMATS[number];
+
+// libvips save options, appended to the output filename
+const SAVE_OPTIONS: Record<VariantFormat, string> = {
+  avif: '[Q=50]',
+  webp: '[Q=75]',
+};
+
+const IMAGE_TYPES = ['image/jpeg', 'image/png', 'image/gif', 'image/webp'];
+const PDF_TYPE = 'application/pdf';
+
+export function hasVariants(mimeType: string): boolean {
+  return IMAGE_TYPES.includes(mimeType) || mimeType === PDF_TYPE;
+}
+
+const variantName = (width: number, format: VariantFormat) => `w${width}.${format}`;
+
+// Render page one of a PDF to a PNG at the largest variant width. Needs poppler's pdftoppm on
+// the PATH; without it PDFs simply get no previews.
+async function renderPdfPreview(source: string): Promise<string | null> {
+  const prefix = blobTempPath();
+  try {
+    await execFileAsync('pdftoppm', [
+      '-png', '-f', '1', '-l', '1', '-singlefile',
+      '-scale-to', String(VARIANT_WIDTHS[VARIANT_WIDTHS.length - 1]),
+      source, prefix,
+    ], { timeout: 30000 });
+    return `${prefix}.png`;
+  } catch (error) {
+    if ((error as NodeJS.ErrnoException).code === 'ENOENT') return null;
+    throw error;
+  }
+}
+
+// Resize with the libvips CLI. `vips thumbnail` decodes with shrink-on-load, applies EXIF
+// orientation and, with --size down, never enlarges; the output format follows the suffix.
+// Returns false when vips isn't on the PATH.
+async function renderVariant(source: string, target: string, width: number, format: VariantFormat): Promise<boolean> {
+  try {
+    await execFileAsync('vips', [
+      'thumbnail', source, `${target}${SAVE_OPTIONS[format]}`, String(width), '--size', 'down',
+    ], { timeout: 60000 });
+    return true;
+  } catch (error) {
+    if ((error as NodeJS.ErrnoException).code === 'ENOENT') return false;
+    throw error;
+  }
+}
+
+// Write every missing variant of the file's blob; existing ones (from an identical upload) are kept
+export async function generateVariants(file: UploadedFile): Promise<{ created: string[]; skipped?: string }> {
+  if (!file.contentHash || !hasVariants(file.mimeType)) return { created: [], skipped: 'unsupported' };
+  const sha256 = file.contentHash;
+
+  const missing = VARIANT_WIDTHS.flatMap(width => VARIANT_FORMATS.map(format => ({ width, format })))
+    .filter(({ width, format }) => !fs.existsSync(blobVariantPath(sha256, variantName(width, format))));
+  if (missing.length === 0) return { created: [] };
+
+  const source = file.mimeType === PDF_TYPE ? await renderPdfPreview(file.path) : file.path;
+  if (!source) return { created: [], skipped: 'pdftoppm unavailable' };
+
+  try {
+    const created: string[] = [];
+    for (const { width, format } of missing) {
+      // vips picks the saver from the suffix, so the temp name carries it
+      const temp = `${blobTempPath()}.${format}`;
+      try {
+        if (!(await renderVariant(source, temp, width, format))) return { created, skipped: 'vips unavailable' };
+        await fs.promises.rename(temp, blobVariantPath(sha256, variantName(width, format)));
+      } catch (error) {
+        await fs.promises.unlink(temp).catch(() => {});
+        throw error;
+      }
+      created.push(variantName(width, format));
+    }
+    return { created };
+  } finally {
+    if (source !== file.path) await fs.promises.unlink(source).catch(() => {});
+  }
+}
+
+export interface ChosenVariant {
+  path: string;
+  width: number;
+  format: VariantFormat;
+  stat: fs.Stats;
+}
+
+// The smallest variant at least `width` wide (the largest when none is) in the best format the
+// client accepts; null while the variants don't exist yet or for files that never get any
+export async function chooseVariant(file: UploadedFile, width: number, accept: string | undefined, format?: VariantFormat): Promise<ChosenVariant | null> {
+  if (!file.contentHash || !hasVariants(file.mimeType)) return null;
+
+  const formats = format ? [format] : VARIANT_FORMATS.filter(f => accept?.includes(`image/${f}`));
+  const chosenWidth = VARIANT_WIDTHS.find(w => w >= width) ?? VARIANT_WIDTHS[VARIANT_WIDTHS.length - 1];
+
+  for (const candidate of formats) {
+    const path = blobVariantPath(file.contentHash, variantName(chosenWidth, candidate));
+    const stat = await fs.promises.stat(path).catch(() => null);
+    if (stat) return { path, width: chosenWidth, format: candidate, stat };
+  }
+  return null;
+}
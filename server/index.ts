@@ -2,6 +2,19 @@ import express, { type Request, Response, NextFunction } from "express";
 import { registerRoutes } from "./routes";
 import { setupVite, serveStatic, log } from "./vite";
 import { redisSupervisor } from "./redis-supervisor";
+import { initRedis, reconnectRedisNow } from "./redis";
+import { createLogger } from "./logger";
+import { instrumentRequests } from "./metrics";
+import cluster from "cluster";
+import type { Server } from "http";
+import { clusterWorkerCount, runPrimary } from "./cluster";
+import { closeAllWebSockets } from "./ws-handler";
+import { initPreparedStatements } from "./prepared-statements";
+import { jobQueue } from "./job-queue";
+import { schedulePartitionMaintenance } from "./jobs";
+import { seedPermissionCatalog } from "./authorization";
+
+const httpLog = createLogger("express");
 
 const app = express();
 
@@ -23,6 +36,9 @@ if (process.env.NODE_ENV === 'development') {
   });
 }
 
+// Per-route latency, byte and DB query metrics (served at /metrics)
+app.use(instrumentRequests);
+
 // Streamlined request logging middleware for better performance
 app.use((req, res, next) => {
   // Skip logging for non-API requests to reduce overhead
@@ -34,15 +50,43 @@ app.use((req, res, next) => {
 
   res.on("finish", () => {
     const duration = Number(process.hrtime.bigint() - start) / 1000000; // Convert to milliseconds
-    log(`${req.method} ${req.path} ${res.statusCode} in ${duration.toFixed(0)}ms`);
+    httpLog.info(`${req.method} ${req.path} ${res.statusCode} in ${duration.toFixed(0)}ms`);
   });
 
   next();
 });
 
-(async () => {
+// Stop accepting connections, let in-flight requests finish, then exit. In a cluster the
+// primary triggers this by disconnecting the worker (rolling restart / shutdown).
+function drainAndExit(server: Server) {
+  let draining = false;
+  return () => {
+    if (draining) return;
+    draining = true;
+    log(`worker ${process.pid} draining`);
+    // Running jobs get to finish; anything still active when the timeout hits is requeued by
+    // another worker once its lease expires
+    const jobsStopped = jobQueue.stop();
+    server.close(() => void jobsStopped.finally(() => process.exit(0)));
+    closeAllWebSockets();
+    server.closeIdleConnections();
+    setTimeout(() => process.exit(0), parseInt(process.env.CLUSTER_SHUTDOWN_TIMEOUT_MS || '', 10) || 30000).unref();
+  };
+}
+
+async function startServer() {
+  // The embedded Redis boots in the background (a no-op with an external REDIS_URL); in a
+  // cluster the primary supervises it instead
+  if (!cluster.isWorker) {
+    redisSupervisor.onReady(reconnectRedisNow);
+    redisSupervisor.start();
+  }
+
   const server = await registerRoutes(app);
 
+  // requirePermission fails closed on unknown permissions, so create any missing ones before serving
+  await seedPermissionCatalog().catch((error) => console.error("Permission catalog seed error:", error));
+
   app.use((err: any, _req: Request, res: Response, _next: NextFunction) => {
     const status = err.status || err.statusCode || 500;
     const message = err.message || "Internal Server Error";
@@ -60,9 +104,17 @@ app.use((req, res, next) => {
     serveStatic(app);
   }
 
-  // Redis supervisor temporarily disabled - investigating jemalloc compatibility issue
-  console.log('Redis supervisor disabled until jemalloc memory issue is resolved');
-  // const redisStarted = await redisSupervisor.start();
+  // Connect the shared storage cache in the background; until (and whenever) Redis is not
+  // ready or healthy the cache runs on an in-process LRU
+  initRedis();
+
+  // Build the hot-path statements now rather than on the first request that needs them
+  if (process.env.STORAGE_BACKEND !== 'memory') initPreparedStatements();
+
+  // Background job workers (JOB_WORKERS=off leaves this process enqueue-only)
+  jobQueue.start();
+  // Monthly partitions ahead of time, closed months to the archive tier
+  schedulePartitionMaintenance();
 
   // ALWAYS serve the app on port 5000
   // this serves both the API and the client.
@@ -75,4 +127,18 @@ app.use((req, res, next) => {
   }, () => {
     log(`serving on port ${port}`);
   });
-})();
+
+  if (cluster.isWorker) {
+    const drain = drainAndExit(server);
+    process.on('disconnect', drain);
+    process.on('SIGTERM', drain);
+  }
+}
+
+const workerCount = clusterWorkerCount();
+if (workerCount > 1 && cluster.isPrimary) {
+  runPrimary(workerCount);
+  redisSupervisor.start();
+} else {
+  startServer();
+}
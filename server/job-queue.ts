@@ -0,0 +1,481 @@
+import { randomUUID } from 'crypto';
+import { EventEmitter } from 'events';
+import { redisClient, isRedisReady, reviveDates } from './redis';
+
+// Background jobs on the shared Redis client. Every job type gets a waiting list, an
+// active list and a delayed set; workers claim jobs atomically together with a lease that they
+// keep extending, so a job held by a crashed process returns to the queue once its lease runs
+// out. Failures are retried with exponential backoff up to the type's attempt limit, and each
+// process runs at most `concurrency` jobs of a type at a time. Delivery is at least once, so
+// handlers must be safe to run again.
+//
+// Jobs are only as durable as the Redis behind them. The embedded server (redis-supervisor.ts)
+// runs without persistence, so its queued jobs are lost when it restarts: enqueued work is best
+// effort there. Point REDIS_URL at a server with AOF enabled when jobs must survive restarts.
+//
+// When Redis is not ready at enqueue time the job runs in this process instead (same retries and
+// limits, not durable), so the app keeps working without Redis just like the storage cache.
+
+const PREFIX = 'jobs:';
+const POLL_MS = parseInt(process.env.JOB_POLL_MS || '500', 10);
+const LEASE_MS = parseInt(process.env.JOB_LEASE_MS || '30000', 10);
+// Finished jobs stay queryable this long so a polling client always sees the final state
+const FINISHED_TTL_S = parseInt(process.env.JOB_FINISHED_TTL_S || '3600', 10);
+// Ids of recent failures kept per type for introspection
+const FAILED_HISTORY = 100;
+
+export type JobStatus = 'waiting' | 'active' | 'delayed' | 'completed' | 'failed';
+
+export interface JobRecord<P = unknown, R = unknown> {
+  id: string;
+  type: string;
+  payload: P;
+  status: JobStatus;
+  attempts: number;
+  maxAttempts: number;
+  progress?: { done: number; total: number };
+  result?: R;
+  error?: string;
+  createdAt: Date;
+  startedAt?: Date;
+  finishedAt?: Date;
+  // When a delayed retry becomes due
+  runAt?: Date;
+  // 'redis' jobs survive restarts of this process (and of Redis, if it persists); 'local' ones ran
+  // in-process because Redis was unavailable
+  backend: 'redis' | 'local';
+}
+
+export interface JobContext<P> {
+  job: JobRecord<P>;
+  progress(done: number, total: number): void;
+  // Aborts with a JobTimeoutError at the type's timeout; long handlers should check it
+  signal: AbortSignal;
+}
+
+export interface JobOptions {
+  concurrency?: number;
+  attempts?: number;
+  // First retry delay; doubles on every further attempt
+  backoffMs?: number;
+  timeoutMs?: number;
+}
+
+interface JobDefinition<P, R> {
+  type: string;
+  handler: (payload: P, context: JobContext<P>) => Promise<R>;
+  concurrency: number;
+  attempts: number;
+  backoffMs: number;
+  timeoutMs: number;
+}
+
+export class JobTimeoutError extends Error {
+  constructor(type: string, timeoutMs: number) {
+    super(`Job ${type} timed out after ${timeoutMs}ms`);
+  }
+}
+
+const keys = {
+  record: (id: string) => `${PREFIX}record:${id}`,
+  lease: (id: string) => `${PREFIX}lease:${id}`,
+  waiting: (type: string) => `${PREFIX}waiting:${type}`,
+  active: (type: string) => `${PREFIX}active:${type}`,
+  delayed: (type: string) => `${PREFIX}delayed:${type}`,
+  failed: (type: string) => `${PREFIX}failed:${type}`,
+  stats: (type: string) => `${PREFIX}stats:${type}`,
+};
+
+// Move the oldest waiting job to active and take its lease in one step, so the stall reaper
+// never sees a claimed job without a lease
+const CLAIM_SCRIPT = `
+local id = redis.call('RPOPLPUSH', KEYS[1], KEYS[2])
+if id then redis.call('SET', ARGV[1] .. id, ARGV[2], 'PX', ARGV[3]) end
+return id`;
+
+// Promote due retries to the front of the waiting list
+const PROMOTE_SCRIPT = `
+local due = redis.call('ZRANGEBYSCORE', KEYS[1], '-inf', ARGV[1], 'LIMIT', 0, 100)
+for _, id in ipairs(due) do
+  redis.call('ZREM', KEYS[1], id)
+  redis.call('RPUSH', KEYS[2], id)
+end
+return #due`;
+
+// Requeue an active job whose lease expired (its worker died or lost Redis)
+const REAP_SCRIPT = `
+if redis.call('EXISTS', ARGV[1] .. ARGV[2]) == 0 and redis.call('LREM', KEYS[1], 1, ARGV[2]) > 0 then
+  redis.call('RPUSH', KEYS[2], ARGV[2])
+  return 1
+end
+return 0`;
+
+const serialize = (job: JobRecord) => JSON.stringify(job);
+const parse = (raw: string | null) => (raw ? JSON.parse(raw, reviveDates) as JobRecord : null);
+
+const sleep = (ms: number) => new Promise(resolve => setTimeout(resolve, ms));
+
+function retryDelay(definition: JobDefinition<any, any>, attempts: number): number {
+  // Jitter over the upper half of the exponential step keeps retries of a burst from lining up
+  const step = definition.backoffMs * 2 ** (attempts - 1);
+  return Math.round(step / 2 + Math.random() * step / 2);
+}
+
+// The timeout aborts the handler's signal rather than abandoning the handler: an attempt only
+// ends once its handler has settled, so a retry never runs alongside a stale attempt. A handler
+// that ignores the signal keeps its slot (and its lease) until it finishes.
+async function execute<P, R>(definition: JobDefinition<P, R>, job: JobRecord<P, R>, onProgress: () => void): Promise<R> {
+  const controller = new AbortController();
+  const timer = setTimeout(
+    () => controller.abort(new JobTimeoutError(definition.type, definition.timeoutMs)),
+    definition.timeoutMs,
+  );
+  try {
+    return await definition.handler(job.payload, {
+      job,
+      progress(done, total) {
+        job.progress = { done, total };
+        onProgress();
+      },
+      signal: controller.signal,
+    });
+  } finally {
+    clearTimeout(timer);
+  }
+}
+
+class JobQueue {
+  private definitions = new Map<string, JobDefinition<any, any>>();
+  // In-process jobs (Redis unavailable at enqueue time), by id
+  private localJobs = new Map<string, JobRecord>();
+  private localActive = new Map<string, number>();
+  private localWaiting = new Map<string, JobRecord[]>();
+  private counters = new Map<string, { completed: number; failed: number; retried: number }>();
+  private wake = new EventEmitter();
+  private running = false;
+  private inflight = new Set<Promise<void>>();
+  private timers: NodeJS.Timeout[] = [];
+  private owner = `${process.pid}:${randomUUID()}`;
+
+  constructor() {
+    this.wake.setMaxListeners(0);
+  }
+
+  define<P, R>(type: string, handler: JobDefinition<P, R>['handler'], options: JobOptions = {}) {
+    const definition: JobDefinition<P, R> = {
+      type,
+      handler,
+      concurrency: options.concurrency ?? 2,
+      attempts: options.attempts ?? 3,
+      backoffMs: options.backoffMs ?? 1000,
+      timeoutMs: options.timeoutMs ?? 60000,
+    };
+    this.definitions.set(type, definition);
+    this.counters.set(type, { completed: 0, failed: 0, retried: 0 });
+    if (this.running) this.startType(definition);
+    return {
+      type,
+      enqueue: (payload: P) => this.enqueue<P, R>(definition, payload),
+    };
+  }
+
+  private async enqueue<P, R>(definition: JobDefinition<P, R>, payload: P): Promise<JobRecord<P, R>> {
+    const job: JobRecord<P, R> = {
+      id: randomUUID(),
+      type: definition.type,
+      payload,
+      status: 'waiting',
+      attempts: 0,
+      maxAttempts: definition.attempts,
+      createdAt: new Date(),
+      backend: 'redis',
+    };
+
+    if (isRedisReady()) {
+      try {
+        await redisClient.multi()
+          .set(keys.record(job.id), serialize(job))
+          .lpush(keys.waiting(definition.type), job.id)
+          .exec();
+        this.wake.emit(definition.type);
+        return { ...job };
+      } catch (error) {
+        console.error(`Job enqueue error (${definition.type}), running in-process:`, error);
+      }
+    }
+
+    job.backend = 'local';
+    this.localJobs.set(job.id, job);
+    this.pruneLocalJobs();
+    this.runLocal(definition, job);
+    return { ...job };
+  }
+
+  async getJob<P = unknown, R = unknown>(id: string): Promise<JobRecord<P, R> | undefined> {
+    const local = this.localJobs.get(id);
+    if (local) return { ...local } as JobRecord<P, R>;
+    if (!isRedisReady()) return undefined;
+    try {
+      return (parse(await redisClient.get(keys.record(id))) ?? undefined) as JobRecord<P, R> | undefined;
+    } catch (error) {
+      console.error('Job lookup error:', error);
+      return undefined;
+    }
+  }
+
+  // Queue depth and outcomes per type; counts in Redis cover every instance, `process` only this one
+  async stats() {
+    const redisReady = isRedisReady();
+    return Promise.all(Array.from(this.definitions.values()).map(async (definition) => {
+      const type = definition.type;
+      let shared: Record<string, number | string[]> | null = null;
+      if (redisReady) {
+        try {
+          const [waiting, active, delayed, totals, recentFailures] = await Promise.all([
+            redisClient.llen(keys.waiting(type)),
+            redisClient.llen(keys.active(type)),
+            redisClient.zcard(keys.delayed(type)),
+            redisClient.hgetall(keys.stats(type)),
+            redisClient.lrange(keys.failed(type), 0, 9),
+          ]);
+          shared = {
+            waiting,
+            active,
+            delayed,
+            completed: Number(totals.completed || 0),
+            failed: Number(totals.failed || 0),
+            recentFailures,
+          };
+        } catch (error) {
+          console.error('Job stats error:', error);
+        }
+      }
+      return {
+        type,
+        concurrency: definition.concurrency,
+        attempts: definition.attempts,
+        redis: shared,
+        process: {
+          localActive: this.localActive.get(type) ?? 0,
+          localWaiting: this.localWaiting.get(type)?.length ?? 0,
+          ...this.counters.get(type)!,
+        },
+      };
+    }));
+  }
+
+  // Start consuming Redis jobs in this process (JOB_WORKERS=off leaves that to other instances)
+  start() {
+    if (this.running || process.env.JOB_WORKERS === 'off') return;
+    this.running = true;
+    this.definitions.forEach(definition => this.startType(definition));
+    this.timers.push(setInterval(() => void this.promoteDelayed(), Math.min(POLL_MS, 1000)));
+    this.timers.push(setInterval(() => void this.reapStalled(), LEASE_MS));
+    this.timers.forEach(timer => timer.unref());
+  }
+
+  // Stop claiming and wait (bounded) for jobs in flight; anything unfinished is requeued by the
+  // lease once this process is gone
+  async stop(timeoutMs = 10000) {
+    if (!this.running) return;
+    this.running = false;
+    this.timers.forEach(timer => clearInterval(timer));
+    this.timers = [];
+    this.wake.emit('stop');
+    await Promise.race([Promise.allSettled(Array.from(this.inflight)), sleep(timeoutMs)]);
+  }
+
+  private startType(definition: JobDefinition<any, any>) {
+    for (let slot = 0; slot < definition.concurrency; slot++) {
+      const loop = this.consume(definition);
+      this.inflight.add(loop);
+      loop.finally(() => this.inflight.delete(loop));
+    }
+  }
+
+  private async consume(definition: JobDefinition<any, any>) {
+    while (this.running) {
+      let id: string | null = null;
+      if (isRedisReady()) {
+        try {
+          id = await redisClient.eval(
+            CLAIM_SCRIPT, 2, keys.waiting(definition.type), keys.active(definition.type),
+            `${PREFIX}lease:`, this.owner, LEASE_MS,
+          ) as string | null;
+        } catch (error) {
+          console.error(`Job claim error (${definition.type}):`, error);
+        }
+      }
+      if (!id) {
+        await this.idle(definition.type);
+        continue;
+      }
+      await this.processRedisJob(definition, id).catch((error) => {
+        console.error(`Job processing error (${definition.type} ${id}):`, error);
+      });
+    }
+  }
+
+  // Sleep until the poll interval passes or a job of this type is enqueued locally
+  private idle(type: string) {
+    return new Promise<void>((resolve) => {
+      const done = () => {
+        clearTimeout(timer);
+        this.wake.off(type, done);
+        this.wake.off('stop', done);
+        resolve();
+      };
+      const timer = setTimeout(done, POLL_MS);
+      this.wake.once(type, done);
+      this.wake.once('stop', done);
+    });
+  }
+
+  private async processRedisJob(definition: JobDefinition<any, any>, id: string) {
+    const job = parse(await redisClient.get(keys.record(id)));
+    if (!job) {
+      await redisClient.multi().lrem(keys.active(definition.type), 1, id).del(keys.lease(id)).exec();
+      return;
+    }
+
+    job.status = 'active';
+    job.attempts++;
+    job.startedAt = new Date();
+    job.runAt = undefined;
+    await redisClient.set(keys.record(id), serialize(job));
+
+    const heartbeat = setInterval(() => {
+      redisClient.pexpire(keys.lease(id), LEASE_MS).catch(() => {});
+    }, LEASE_MS / 3);
+    let lastProgressSave = 0;
+
+    try {
+      job.result = await execute(definition, job, () => {
+        if (Date.now() - lastProgressSave < 500) return;
+        lastProgressSave = Date.now();
+        redisClient.set(keys.record(id), serialize(job)).catch(() => {});
+      });
+      job.status = 'completed';
+      job.error = undefined;
+      job.finishedAt = new Date();
+      this.counters.get(definition.type)!.completed++;
+      await redisClient.multi()
+        .set(keys.record(id), serialize(job), 'EX', FINISHED_TTL_S)
+        .lrem(keys.active(definition.type), 1, id)
+        .del(keys.lease(id))
+        .hincrby(keys.stats(definition.type), 'completed', 1)
+        .exec();
+    } catch (error) {
+      job.error = error instanceof Error ? error.message : String(error);
+      const multi = redisClient.multi().lrem(keys.active(definition.type), 1, id).del(keys.lease(id));
+      if (job.attempts < job.maxAttempts) {
+        job.status = 'delayed';
+        job.runAt = new Date(Date.now() + retryDelay(definition, job.attempts));
+        this.counters.get(definition.type)!.retried++;
+        multi.set(keys.record(id), serialize(job)).zadd(keys.delayed(definition.type), job.runAt.getTime(), id);
+      } else {
+        job.status = 'failed';
+        job.finishedAt = new Date();
+        this.counters.get(definition.type)!.failed++;
+        console.error(`Job ${definition.type} ${id} failed after ${job.attempts} attempts:`, error);
+        multi.set(keys.record(id), serialize(job), 'EX', FINISHED_TTL_S)
+          .hincrby(keys.stats(definition.type), 'failed', 1)
+          .lpush(keys.failed(definition.type), id)
+          .ltrim(keys.failed(definition.type), 0, FAILED_HISTORY - 1);
+      }
+      await multi.exec();
+    } finally {
+      clearInterval(heartbeat);
+    }
+  }
+
+  private async promoteDelayed() {
+    if (!isRedisReady()) return;
+    for (const type of Array.from(this.definitions.keys())) {
+      try {
+        const promoted = await redisClient.eval(PROMOTE_SCRIPT, 2, keys.delayed(type), keys.waiting(type), Date.now()) as number;
+        if (promoted > 0) this.wake.emit(type);
+      } catch (error) {
+        console.error(`Job promotion error (${type}):`, error);
+      }
+    }
+  }
+
+  private async reapStalled() {
+    if (!isRedisReady()) return;
+    for (const type of Array.from(this.definitions.keys())) {
+      try {
+        const ids = await redisClient.lrange(keys.active(type), 0, -1);
+        for (const id of ids) {
+          const requeued = await redisClient.eval(REAP_SCRIPT, 2, keys.active(type), keys.waiting(type), `${PREFIX}lease:`, id) as number;
+          if (requeued) console.warn(`Job ${type} ${id} lost its worker, requeued`);
+        }
+      } catch (error) {
+        console.error(`Job reaper error (${type}):`, error);
+      }
+    }
+  }
+
+  // In-process fallback: FIFO per type under the same concurrency limit
+  private runLocal(definition: JobDefinition<any, any>, job: JobRecord) {
+    let waiting = this.localWaiting.get(definition.type);
+    if (!waiting) {
+      waiting = [];
+      this.localWaiting.set(definition.type, waiting);
+    }
+    waiting.push(job);
+    this.drainLocal(definition);
+  }
+
+  private drainLocal(definition: JobDefinition<any, any>) {
+    const waiting = this.localWaiting.get(definition.type)!;
+    while (waiting.length > 0 && (this.localActive.get(definition.type) ?? 0) < definition.concurrency) {
+      const job = waiting.shift()!;
+      this.localActive.set(definition.type, (this.localActive.get(definition.type) ?? 0) + 1);
+      job.status = 'active';
+      job.attempts++;
+      job.startedAt = new Date();
+      job.runAt = undefined;
+
+      execute(definition, job, () => {})
+        .then((result) => {
+          job.status = 'completed';
+          job.result = result;
+          job.error = undefined;
+          job.finishedAt = new Date();
+          this.counters.get(definition.type)!.completed++;
+        })
+        .catch((error) => {
+          job.error = error instanceof Error ? error.message : String(error);
+          if (job.attempts < job.maxAttempts) {
+            job.status = 'delayed';
+            job.runAt = new Date(Date.now() + retryDelay(definition, job.attempts));
+            this.counters.get(definition.type)!.retried++;
+            setTimeout(() => this.runLocal(definition, job), job.runAt.getTime() - Date.now()).unref();
+          } else {
+            job.status = 'failed';
+            job.finishedAt = new Date();
+            this.counters.get(definition.type)!.failed++;
+            console.error(`Job ${definition.type} ${job.id} failed after ${job.attempts} attempts:`, error);
+          }
+        })
+        .finally(() => {
+          this.localActive.set(definition.type, this.localActive.get(definition.type)! - 1);
+          this.drainLocal(definition);
+        });
+    }
+  }
+
+  private pruneLocalJobs() {
+    const cutoff = Date.now() - FINISHED_TTL_S * 1000;
+    this.localJobs.forEach((job, id) => {
+      if (job.finishedAt && job.finishedAt.getTime() < cutoff) this.localJobs.delete(id);
+    });
+  }
+}
+
+export const jobQueue = new JobQueue();
+
+export function defineJob<P, R>(type: string, handler: JobDefinition<P, R>['handler'], options?: JobOptions) {
+  return jobQueue.define<P, R>(type, handler, options);
+}
@@ -0,0 +1,107 @@
+import fs from 'fs';
+import crypto from 'crypto';
+import { pipeline } from 'stream/promises';
+import { storage } from './storage';
+import { defineJob } from './job-queue';
+import { generateVariants } from './image-variants';
+import { createLogger } from './logger';
+import type { PartitionMaintenanceResult } from './partitions';
+import type { TemplateRollout, TemplateRolloutResult } from '@shared/schema';
+
+// Background job types. Every process that imports this module can run them; enqueueing from a
+// route returns as soon as the job is recorded.
+
+const partitionLog = createLogger('partitions');
+
+// Leading bytes of the binary types we accept; text and Office formats aren't sniffed
+const MAGIC_BYTES: Record<string, Buffer[]> = {
+  'image/jpeg': [Buffer.from([0xff, 0xd8, 0xff])],
+  'image/png': [Buffer.from([0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a])],
+  'image/gif': [Buffer.from('GIF87a'), Buffer.from('GIF89a')],
+  'image/webp': [Buffer.from('RIFF')],
+  'application/pdf': [Buffer.from('%PDF-')],
+};
+
+export type UploadVerification = {
+  fileId: number;
+  hashMatches: boolean;
+  sizeMatches: boolean;
+  // null when the declared type has no signature to check
+  typeMatches: boolean | null;
+};
+
+// Re-read a stored upload: the blob must still hash to its content address, match the recorded
+// size and start with the signature of the MIME type the client declared
+export const verifyUploadJob = defineJob<{ fileId: number }, UploadVerification | null>(
+  'upload.verify',
+  async ({ fileId }) => {
+    const file = await storage.getUploadedFile(fileId);
+    if (!file) return null;
+
+    const hash = crypto.createHash('sha256');
+    let size = 0;
+    let head = Buffer.alloc(0);
+    await pipeline(fs.createReadStream(file.path), async function* (source: AsyncIterable<Buffer>) {
+      for await (const chunk of source) {
+        if (head.length < 16) head = Buffer.concat([head, chunk.subarray(0, 16 - head.length)]);
+        hash.update(chunk);
+        size += chunk.length;
+      }
+    });
+
+    const signatures = MAGIC_BYTES[file.mimeType];
+    const verification: UploadVerification = {
+      fileId,
+      hashMatches: !file.contentHash || hash.digest('hex') === file.contentHash,
+      sizeMatches: size === file.size,
+      typeMatches: signatures ? signatures.some(signature => head.subarray(0, signature.length).equals(signature)) : null,
+    };
+    if (!verification.hashMatches || !verification.sizeMatches || verification.typeMatches === false) {
+      console.warn('Upload failed verification:', verification);
+    }
+    return verification;
+  },
+  { concurrency: 2, attempts: 3, backoffMs: 2000 },
+);
+
+// Resized WebP/AVIF renditions and PDF first-page previews; CPU-bound, so one at a time per process
+export const imageVariantsJob = defineJob<{ fileId: number }, { created: string[]; skipped?: string } | null>(
+  'upload.variants',
+  async ({ fileId }) => {
+    const file = await storage.getUploadedFile(fileId);
+    return file ? generateVariants(file) : null;
+  },
+  { concurrency: 1, attempts: 2, backoffMs: 5000, timeoutMs: 2 * 60 * 1000 },
+);
+
+// Bulk schedule generation from templates. Rollouts of a location are serialized and skip the
+// schedules and shifts that already exist, so a retry creates nothing twice; a timed-out attempt
+// stops at its next batch and rolls back before the retry starts.
+export const templateRolloutJob = defineJob<TemplateRollout, TemplateRolloutResult>(
+  'schedule.rollout',
+  async (rollout, { progress, signal }) => storage.instantiateTemplates(rollout, progress, signal),
+  { concurrency: 1, attempts: 3, backoffMs: 5000, timeoutMs: 10 * 60 * 1000 },
+);
+
+// Monthly partition upkeep for shifts and cash_counts: creates the coming months' partitions and
+// moves months past the archive horizon to the archive tier (see partitions.ts)
+export const partitionMaintenanceJob = defineJob<Record<string, never>, PartitionMaintenanceResult>(
+  'storage.partitions',
+  async () => {
+    const result = await storage.maintainPartitions();
+    if (result.archived.length > 0) partitionLog.info('archived closed periods', { archived: result.archived });
+    return result;
+  },
+  { concurrency: 1, attempts: 3, backoffMs: 60000, timeoutMs: 30 * 60 * 1000 },
+);
+
+const PARTITION_MAINTENANCE_INTERVAL_MS = 6 * 60 * 60 * 1000;
+
+// Enqueue now and every few hours. Every server process may call this: the job only does work in
+// whichever run holds the advisory lock, and a pass with nothing to do is a handful of lookups.
+export function schedulePartitionMaintenance() {
+  if (process.env.STORAGE_BACKEND === 'memory') return;
+  const enqueue = () => void partitionMaintenanceJob.enqueue({}).catch(console.error);
+  enqueue();
+  setInterval(enqueue, PARTITION_MAINTENANCE_INTERVAL_MS).unref();
+}
@@ -0,0 +1,119 @@
+import type { KbArticle } from '@shared/schema';
+
+// Knowledge base full-text search helpers shared by both storage backends. Tokenising mirrors
+// Postgres' 'simple' configuration (lowercased words, no stemming) so the in-memory index and
+// the kb_articles.search_vector column match the same articles for the same query.
+
+const WORD = /[\p{L}\p{N}]+/gu;
+const MAX_QUERY_TERMS = 8;
+
+// Same weights as ts_rank_cd's defaults for the A (title) and B (content) labels
+const TITLE_WEIGHT = 1.0;
+const CONTENT_WEIGHT = 0.4;
+
+export function searchTerms(text: string): string[] {
+  return text.toLowerCase().match(WORD) ?? [];
+}
+
+// Distinct terms of a query, in order; the last one is matched as a prefix (type-ahead)
+export function queryTerms(q: string): string[] {
+  return Array.from(new Set(searchTerms(q))).slice(0, MAX_QUERY_TERMS);
+}
+
+// tsquery text for to_tsquery('simple', ...). Terms only contain letters and digits, so
+// nothing in them can be read as tsquery syntax.
+export function toPrefixTsQuery(terms: string[]): string {
+  return terms.map((term, i) => (i === terms.length - 1 ? `${term}:*` : term)).join(' & ');
+}
+
+export function escapeHtml(text: string): string {
+  return text.replace(/&/g, '&amp;').replace(/</g, '&lt;').replace(/>/g, '&gt;');
+}
+
+// ts_headline options used by DatabaseStorage; buildSnippet approximates the same output
+export const HEADLINE_OPTIONS = 'StartSel=<mark>, StopSel=</mark>, MaxWords=35, MinWords=15, MaxFragments=2, FragmentDelimiter=" … "';
+
+const SNIPPET_WORDS = 35;
+
+// Escaped excerpt of the content around the first match, matches wrapped in <mark>
+export function buildSnippet(content: string, terms: string[]): string {
+  const matches = (word: string) => {
+    const lower = word.toLowerCase();
+    return terms.some((term, i) => (i === terms.length - 1 ? lower.startsWith(term) : lower === term));
+  };
+  const words = content.split(/\s+/).filter(Boolean);
+  const first = words.findIndex(word => (word.match(WORD) ?? []).some(matches));
+  const start = Math.max(0, Math.min(first < 0 ? 0 : first - 5, words.length - SNIPPET_WORDS));
+  return words.slice(start, start + SNIPPET_WORDS)
+    .map(word => escapeHtml(word).replace(/[\p{L}\p{N}]+/gu, token => (matches(token) ? `<mark>${token}</mark>` : token)))
+    .join(' ');
+}
+
+// Inverted index for MemStorage: term -> article -> weighted term frequency.
+// Ranking follows ts_rank_cd with normalization 1 (score divided by 1 + log(length)).
+export class KbSearchIndex {
+  private postings = new Map<string, Map<number, number>>();
+  private articleTerms = new Map<number, { terms: string[]; length: number }>();
+
+  add(article: KbArticle) {
+    this.remove(article.id);
+    const weights = new Map<string, number>();
+    const titleTerms = searchTerms(article.title);
+    const contentTerms = searchTerms(article.content);
+    titleTerms.forEach(term => weights.set(term, (weights.get(term) ?? 0) + TITLE_WEIGHT));
+    contentTerms.forEach(term => weights.set(term, (weights.get(term) ?? 0) + CONTENT_WEIGHT));
+
+    weights.forEach((weight, term) => {
+      let posting = this.postings.get(term);
+      if (!posting) {
+        posting = new Map();
+        this.postings.set(term, posting);
+      }
+      posting.set(article.id, weight);
+    });
+    this.articleTerms.set(article.id, { terms: Array.from(weights.keys()), length: titleTerms.length + contentTerms.length });
+  }
+
+  remove(articleId: number) {
+    const entry = this.articleTerms.get(articleId);
+    if (!entry) return;
+    for (const term of entry.terms) {
+      const posting = this.postings.get(term);
+      if (!posting) continue;
+      posting.delete(articleId);
+      if (posting.size === 0) this.postings.delete(term);
+    }
+    this.articleTerms.delete(articleId);
+  }
+
+  // Articles containing every term (the last as a prefix), best first
+  search(terms: string[], include: (articleId: number) => boolean): { id: number; rank: number }[] {
+    if (terms.length === 0) return [];
+
+    const exact = terms.slice(0, -1).map(term => this.postings.get(term));
+    if (exact.some(posting => !posting)) return [];
+    const prefix = terms[terms.length - 1];
+    const prefixScores = new Map<number, number>();
+    this.postings.forEach((posting, term) => {
+      if (!term.startsWith(prefix)) return;
+      posting.forEach((weight, id) => prefixScores.set(id, (prefixScores.get(id) ?? 0) + weight));
+    });
+
+    // Walk the smallest candidate set and probe the others
+    const sets: Map<number, number>[] = [...(exact as Map<number, number>[]), prefixScores];
+    const [smallest, ...rest] = sets.sort((a, b) => a.size - b.size);
+    const hits: { id: number; rank: number }[] = [];
+    smallest.forEach((weight, id) => {
+      let score = weight;
+      for (const set of rest) {
+        const other = set.get(id);
+        if (other === undefined) return;
+        score += other;
+      }
+      if (!include(id)) return;
+      const length = this.articleTerms.get(id)?.length ?? 0;
+      hits.push({ id, rank: score / (1 + Math.log(1 + length)) });
+    });
+    return hits.sort((a, b) => b.rank - a.rank || b.id - a.id);
+  }
+}
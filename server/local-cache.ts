@@ -0,0 +1,104 @@
+// In-process LRU standing in for the Redis cache while Redis is unreachable or unhealthy.
+// Values are held serialized, so readers get fresh copies just as they would from Redis and
+// the byte budget is simple to enforce. Nothing here is shared between processes: in cluster
+// mode another worker's invalidations don't reach this cache, so entry lifetimes are capped
+// well below the normal cache TTL to bound how stale a read can be.
+
+const MAX_ENTRIES = parseInt(process.env.LOCAL_CACHE_MAX_ENTRIES || '5000', 10);
+const MAX_BYTES = parseInt(process.env.LOCAL_CACHE_MAX_BYTES || String(16 * 1024 * 1024), 10);
+const MAX_TTL_S = parseInt(process.env.LOCAL_CACHE_MAX_TTL_S || '30', 10);
+
+interface Entry {
+  value: string;
+  expiresAt: number;
+  tags: string[];
+}
+
+export class LocalCache {
+  // Map insertion order doubles as LRU order
+  private entries = new Map<string, Entry>();
+  private tagKeys = new Map<string, Set<string>>();
+  private bytes = 0;
+  private hits = 0;
+  private misses = 0;
+  private evictions = 0;
+
+  get(key: string): string | null {
+    const entry = this.entries.get(key);
+    if (!entry || entry.expiresAt <= Date.now()) {
+      if (entry) this.remove(key);
+      this.misses++;
+      return null;
+    }
+    this.entries.delete(key);
+    this.entries.set(key, entry);
+    this.hits++;
+    return entry.value;
+  }
+
+  set(key: string, value: string, ttlSeconds: number, tags: string[] = []) {
+    this.remove(key);
+    // Larger than the whole budget: not worth evicting everything else for
+    if (value.length > MAX_BYTES) return;
+
+    this.entries.set(key, { value, expiresAt: Date.now() + Math.min(ttlSeconds, MAX_TTL_S) * 1000, tags });
+    this.bytes += value.length;
+    for (const tag of tags) {
+      let keys = this.tagKeys.get(tag);
+      if (!keys) {
+        keys = new Set();
+        this.tagKeys.set(tag, keys);
+      }
+      keys.add(key);
+    }
+
+    while (this.entries.size > MAX_ENTRIES || this.bytes > MAX_BYTES) {
+      this.remove(this.entries.keys().next().value!);
+      this.evictions++;
+    }
+  }
+
+  delete(key: string) {
+    this.remove(key);
+  }
+
+  invalidateTags(tags: string[]) {
+    for (const tag of tags) {
+      this.tagKeys.get(tag)?.forEach(key => this.remove(key));
+      this.tagKeys.delete(tag);
+    }
+  }
+
+  clear() {
+    this.entries.clear();
+    this.tagKeys.clear();
+    this.bytes = 0;
+  }
+
+  stats() {
+    const lookups = this.hits + this.misses;
+    return {
+      entries: this.entries.size,
+      bytes: this.bytes,
+      maxEntries: MAX_ENTRIES,
+      maxBytes: MAX_BYTES,
+      maxTtlSeconds: MAX_TTL_S,
+      hits: this.hits,
+      misses: this.misses,
+      hitRate: lookups > 0 ? this.hits / lookups : null,
+      evictions: this.evictions,
+    };
+  }
+
+  private remove(key: string) {
+    const entry = this.entries.get(key);
+    if (!entry) return;
+    this.entries.delete(key);
+    this.bytes -= entry.value.length;
+    for (const tag of entry.tags) {
+      const keys = this.tagKeys.get(tag);
+      keys?.delete(key);
+      if (keys?.size === 0) this.tagKeys.delete(tag);
+    }
+  }
+}
@@ -0,0 +1,158 @@
+import fs from 'fs';
+
+// Structured logging. Lines are queued and written to stdout in one batch per event-loop turn,
+// so logging never blocks a request on terminal or pipe I/O.
+//
+//   LOG_LEVEL    trace | debug | info | warn | error | silent (default: info, debug in development)
+//   LOG_MODULES  per-module overrides, e.g. "auth:debug,ws:warn,*:info"
+//   LOG_FORMAT   json | pretty (default: pretty in development, json otherwise)
+
+const LEVELS = { trace: 10, debug: 20, info: 30, warn: 40, error: 50, silent: Infinity } as const;
+
+export type LogLevel = keyof typeof LEVELS;
+export type LogFields = Record<string, unknown>;
+
+const isDevelopment = process.env.NODE_ENV === 'development';
+
+function parseLevel(value: string | undefined, fallback: LogLevel): LogLevel {
+  const level = value?.trim().toLowerCase();
+  return level && level in LEVELS ? level as LogLevel : fallback;
+}
+
+let defaultLevel = parseLevel(process.env.LOG_LEVEL, isDevelopment ? 'debug' : 'info');
+const moduleLevels = new Map<string, LogLevel>();
+for (const entry of (process.env.LOG_MODULES || '').split(',')) {
+  const [name, level] = entry.split(':').map(part => part.trim());
+  if (!name || !level) continue;
+  if (name === '*') defaultLevel = parseLevel(level, defaultLevel);
+  else moduleLevels.set(name, parseLevel(level, defaultLevel));
+}
+
+const format = process.env.LOG_FORMAT === 'json' || (process.env.LOG_FORMAT !== 'pretty' && !isDevelopment)
+  ? 'json'
+  : 'pretty';
+
+// Field names whose values never reach the output, at any depth
+const REDACTED_KEYS = new Set([
+  'session', 'cookie', 'cookies', 'password', 'authorization', 'token', 'passport', 'secret', 'sessiondata',
+]);
+const MAX_DEPTH = 4;
+
+function sanitize(value: unknown, depth: number): unknown {
+  if (value instanceof Error) {
+    return { name: value.name, message: value.message, stack: value.stack };
+  }
+  if (value === null || typeof value !== 'object') return value;
+  if (value instanceof Date) return value.toISOString();
+  if (depth >= MAX_DEPTH) return '[truncated]';
+  if (Array.isArray(value)) return value.map(item => sanitize(item, depth + 1));
+
+  const result: Record<string, unknown> = {};
+  for (const [key, item] of Object.entries(value)) {
+    result[key] = REDACTED_KEYS.has(key.toLowerCase()) ? '[redacted]' : sanitize(item, depth + 1);
+  }
+  return result;
+}
+
+// Output queue. When stdout can't keep up the queue is capped and the overflow is counted
+// rather than buffered without bound.
+const MAX_QUEUED_LINES = 10000;
+let queue: string[] = [];
+let dropped = 0;
+let flushScheduled = false;
+let waitingForDrain = false;
+
+function flush() {
+  flushScheduled = false;
+  if (waitingForDrain || queue.length === 0) return;
+  if (dropped > 0) {
+    queue.push(formatLine('warn', 'logger', `dropped ${dropped} log lines while output was backed up`));
+    dropped = 0;
+  }
+  const chunk = queue.join('');
+  queue = [];
+  if (!process.stdout.write(chunk)) {
+    waitingForDrain = true;
+    process.stdout.once('drain', () => {
+      waitingForDrain = false;
+      scheduleFlush();
+    });
+  }
+}
+
+function scheduleFlush() {
+  if (flushScheduled) return;
+  flushScheduled = true;
+  setImmediate(flush);
+}
+
+function enqueue(line: string) {
+  if (queue.length >= MAX_QUEUED_LINES) {
+    dropped++;
+    return;
+  }
+  queue.push(line);
+  scheduleFlush();
+}
+
+// Whatever is still queued at exit is written synchronously so crash context isn't lost
+process.on('exit', () => {
+  if (queue.length > 0) {
+    try {
+      fs.writeSync(1, queue.join(''));
+    } catch {}
+  }
+});
+
+function prettyTime() {
+  return new Date().toLocaleTimeString('en-US', {
+    hour: 'numeric',
+    minute: '2-digit',
+    second: '2-digit',
+    hour12: true,
+  });
+}
+
+function formatLine(level: LogLevel, module: string, message: string, fields?: LogFields): string {
+  const clean = fields ? sanitize(fields, 0) as LogFields : undefined;
+  if (format === 'json') {
+    return JSON.stringify({ time: new Date().toISOString(), level, module, msg: message, ...clean }) + '\n';
+  }
+  const suffix = clean && Object.keys(clean).length > 0 ? ` ${JSON.stringify(clean)}` : '';
+  const tag = level === 'info' ? '' : ` ${level.toUpperCase()}`;
+  return `${prettyTime()} [${module}]${tag} ${message}${suffix}\n`;
+}
+
+export interface LoggerOptions {
+  // Fraction of trace/debug/info lines kept (warnings and errors are never sampled)
+  sampleRate?: number;
+}
+
+export interface Logger {
+  trace(message: string, fields?: LogFields): void;
+  debug(message: string, fields?: LogFields): void;
+  info(message: string, fields?: LogFields): void;
+  warn(message: string, fields?: LogFields): void;
+  error(message: string, fields?: LogFields): void;
+  enabled(level: LogLevel): boolean;
+}
+
+export function createLogger(module: string, options: LoggerOptions = {}): Logger {
+  const threshold = LEVELS[moduleLevels.get(module) ?? defaultLevel];
+  const sampleRate = options.sampleRate ?? 1;
+
+  const write = (level: LogLevel) => (message: string, fields?: LogFields) => {
+    if (LEVELS[level] < threshold) return;
+    if (LEVELS[level] < LEVELS.warn && sampleRate < 1 && Math.random() >= sampleRate) return;
+    enqueue(formatLine(level, module, message, fields));
+  };
+
+  return {
+    trace: write('trace'),
+    debug: write('debug'),
+    info: write('info'),
+    warn: write('warn'),
+    error: write('error'),
+    enabled: (level) => LEVELS[level] >= threshold,
+  };
+}
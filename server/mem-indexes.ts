@@ -0,0 +1,162 @@
+// Secondary indexes for MemStorage. An IndexedTable behaves like the Map<number, T> it replaces
+// (get/set/delete/values/size) and keeps every registered index in step on each write, so
+// lookups by foreign key, unique field or date range don't scan the whole table.
+
+interface RowIndex<T> {
+  add(row: T): void;
+  remove(row: T): void;
+}
+
+// Equality lookups on one derived key (foreign keys, unique fields). Rows whose key is
+// null or undefined are not indexed.
+export class HashIndex<T extends { id: number }, K> implements RowIndex<T> {
+  private buckets = new Map<K, Map<number, T>>();
+
+  constructor(private keyOf: (row: T) => K | null | undefined) {}
+
+  add(row: T) {
+    const key = this.keyOf(row);
+    if (key === null || key === undefined) return;
+    let bucket = this.buckets.get(key);
+    if (!bucket) {
+      bucket = new Map();
+      this.buckets.set(key, bucket);
+    }
+    bucket.set(row.id, row);
+  }
+
+  remove(row: T) {
+    const key = this.keyOf(row);
+    if (key === null || key === undefined) return;
+    const bucket = this.buckets.get(key);
+    if (!bucket) return;
+    bucket.delete(row.id);
+    if (bucket.size === 0) this.buckets.delete(key);
+  }
+
+  find(key: K): T[] {
+    const bucket = this.buckets.get(key);
+    return bucket ? Array.from(bucket.values()) : [];
+  }
+
+  first(key: K): T | undefined {
+    const bucket = this.buckets.get(key);
+    return bucket ? bucket.values().next().value : undefined;
+  }
+
+  count(key: K): number {
+    return this.buckets.get(key)?.size ?? 0;
+  }
+}
+
+// Range lookups on a numeric sort key (timestamps) within a group (usually a location).
+// Each group is kept sorted by (sortKey, id); writes are a binary search plus a splice.
+export class SortedIndex<T extends { id: number }, G> implements RowIndex<T> {
+  private groups = new Map<G, { keys: number[]; ids: number[]; rows: T[] }>();
+
+  constructor(private groupOf: (row: T) => G, private sortKeyOf: (row: T) => number) {}
+
+  // First position whose (key, id) is >= the given pair
+  private static lowerBound(keys: number[], ids: number[], key: number, id: number): number {
+    let lo = 0;
+    let hi = keys.length;
+    while (lo < hi) {
+      const mid = (lo + hi) >>> 1;
+      if (keys[mid] < key || (keys[mid] === key && ids[mid] < id)) lo = mid + 1;
+      else hi = mid;
+    }
+    return lo;
+  }
+
+  add(row: T) {
+    const group = this.groupOf(row);
+    let entries = this.groups.get(group);
+    if (!entries) {
+      entries = { keys: [], ids: [], rows: [] };
+      this.groups.set(group, entries);
+    }
+    const key = this.sortKeyOf(row);
+    const at = SortedIndex.lowerBound(entries.keys, entries.ids, key, row.id);
+    entries.keys.splice(at, 0, key);
+    entries.ids.splice(at, 0, row.id);
+    entries.rows.splice(at, 0, row);
+  }
+
+  remove(row: T) {
+    const group = this.groupOf(row);
+    const entries = this.groups.get(group);
+    if (!entries) return;
+    const key = this.sortKeyOf(row);
+    const at = SortedIndex.lowerBound(entries.keys, entries.ids, key, row.id);
+    if (entries.ids[at] !== row.id) return;
+    entries.keys.splice(at, 1);
+    entries.ids.splice(at, 1);
+    entries.rows.splice(at, 1);
+    if (entries.keys.length === 0) this.groups.delete(group);
+  }
+
+  // Rows in the group with from <= sortKey <= to, ascending
+  range(group: G, from: number, to: number): T[] {
+    const entries = this.groups.get(group);
+    if (!entries) return [];
+    const start = SortedIndex.lowerBound(entries.keys, entries.ids, from, -Infinity);
+    const end = SortedIndex.lowerBound(entries.keys, entries.ids, to, Infinity);
+    return entries.rows.slice(start, end);
+  }
+
+  // Every row in the group, ascending
+  all(group: G): T[] {
+    return this.groups.get(group)?.rows.slice() ?? [];
+  }
+}
+
+export class IndexedTable<T extends { id: number }> {
+  private rows = new Map<number, T>();
+  private indexes: RowIndex<T>[] = [];
+
+  hashIndex<K>(keyOf: (row: T) => K | null | undefined): HashIndex<T, K> {
+    return this.register(new HashIndex<T, K>(keyOf));
+  }
+
+  sortedIndex<G>(groupOf: (row: T) => G, sortKeyOf: (row: T) => number): SortedIndex<T, G> {
+    return this.register(new SortedIndex<T, G>(groupOf, sortKeyOf));
+  }
+
+  private register<I extends RowIndex<T>>(index: I): I {
+    this.rows.forEach(row => index.add(row));
+    this.indexes.push(index);
+    return index;
+  }
+
+  get(id: number): T | undefined {
+    return this.rows.get(id);
+  }
+
+  has(id: number): boolean {
+    return this.rows.has(id);
+  }
+
+  get size(): number {
+    return this.rows.size;
+  }
+
+  values(): IterableIterator<T> {
+    return this.rows.values();
+  }
+
+  // Insert or replace; the previous version of the row is unindexed first
+  set(id: number, row: T): this {
+    const previous = this.rows.get(id);
+    if (previous) this.indexes.forEach(index => index.remove(previous));
+    this.rows.set(id, row);
+    this.indexes.forEach(index => index.add(row));
+    return this;
+  }
+
+  delete(id: number): boolean {
+    const previous = this.rows.get(id);
+    if (!previous) return false;
+    this.indexes.forEach(index => index.remove(previous));
+    return this.rows.delete(id);
+  }
+}
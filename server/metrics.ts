@@ -0,0 +1,224 @@
+import { AsyncLocalStorage } from 'async_hooks';
+import type { Request, RequestHandler, Response } from 'express';
+import { Histogram, logLinearBuckets } from './histogram';
+import type { getPoolStats } from './db';
+
+// In-process request instrumentation, exposed in Prometheus text format at /metrics.
+// Requests are keyed by their route template (/api/shifts/:id), never the raw path, so
+// series stay bounded no matter which ids clients ask for.
+
+const REQUEST_BUCKETS = logLinearBuckets(0.5, 32768, 4);
+// Routes beyond this are folded into one series rather than growing without bound
+const MAX_ROUTES = 300;
+
+interface RouteMetrics {
+  method: string;
+  route: string;
+  latency: Histogram;
+  statuses: Map<string, number>;
+  bytesIn: number;
+  bytesOut: number;
+  dbQueries: number;
+  dbMs: number;
+}
+
+export interface RequestScope {
+  dbQueries: number;
+  dbMs: number;
+}
+
+const routes = new Map<string, RouteMetrics>();
+const dbTotals = new Map<string, { queries: number; ms: number; errors: number }>();
+const cacheLookups = new Map<string, { hits: number; misses: number }>();
+const requestScope = new AsyncLocalStorage<RequestScope>();
+
+function routeTemplate(req: Request): string {
+  if (!req.route) return 'unmatched';
+  const path = Array.isArray(req.route.path) ? req.route.path.join('|') : String(req.route.path);
+  return (req.baseUrl + path) || '/';
+}
+
+function routeMetrics(method: string, route: string): RouteMetrics {
+  let key = `${method} ${route}`;
+  let metrics = routes.get(key);
+  if (metrics) return metrics;
+
+  if (routes.size >= MAX_ROUTES) {
+    route = 'other';
+    key = `${method} other`;
+    metrics = routes.get(key);
+    if (metrics) return metrics;
+  }
+  metrics = {
+    method,
+    route,
+    latency: new Histogram(REQUEST_BUCKETS),
+    statuses: new Map(),
+    bytesIn: 0,
+    bytesOut: 0,
+    dbQueries: 0,
+    dbMs: 0,
+  };
+  routes.set(key, metrics);
+  return metrics;
+}
+
+function chunkLength(chunk: unknown, encoding?: unknown): number {
+  if (!chunk || typeof chunk === 'function') return 0;
+  if (typeof chunk === 'string') return Buffer.byteLength(chunk, typeof encoding === 'string' ? encoding as BufferEncoding : 'utf8');
+  return (chunk as Buffer).length ?? 0;
+}
+
+// Count body bytes as they are written, including streamed responses without Content-Length
+function countResponseBytes(res: Response): () => number {
+  let bytes = 0;
+  const write = res.write.bind(res) as (...args: any[]) => boolean;
+  const end = res.end.bind(res) as (...args: any[]) => Response;
+  (res as any).write = (chunk: unknown, ...rest: unknown[]) => {
+    bytes += chunkLength(chunk, rest[0]);
+    return write(chunk, ...rest);
+  };
+  (res as any).end = (chunk?: unknown, ...rest: unknown[]) => {
+    bytes += chunkLength(chunk, rest[0]);
+    return end(chunk, ...rest);
+  };
+  return () => bytes;
+}
+
+export const instrumentRequests: RequestHandler = (req, res, next) => {
+  if (!req.path.startsWith('/api')) return next();
+
+  const start = process.hrtime.bigint();
+  const scope: RequestScope = { dbQueries: 0, dbMs: 0 };
+  const bytesOut = countResponseBytes(res);
+
+  res.on('finish', () => {
+    const metrics = routeMetrics(req.method, routeTemplate(req));
+    metrics.latency.observe(Number(process.hrtime.bigint() - start) / 1000000);
+    const status = `${Math.floor(res.statusCode / 100)}xx`;
+    metrics.statuses.set(status, (metrics.statuses.get(status) ?? 0) + 1);
+    metrics.bytesIn += parseInt(req.get('content-length') || '0', 10) || 0;
+    metrics.bytesOut += bytesOut();
+    metrics.dbQueries += scope.dbQueries;
+    metrics.dbMs += scope.dbMs;
+  });
+
+  requestScope.run(scope, next);
+};
+
+// The request a query belongs to. Read when the query is issued: driver callbacks and socket
+// events run in the connection's async context, not the caller's.
+export function currentRequestScope(): RequestScope | undefined {
+  return requestScope.getStore();
+}
+
+// Called by the pool instrumentation in db.ts for every completed query, with the scope captured
+// when it was issued
+export function recordDbQuery(workload: string, ms: number, failed: boolean, scope: RequestScope | undefined): void {
+  let totals = dbTotals.get(workload);
+  if (!totals) {
+    totals = { queries: 0, ms: 0, errors: 0 };
+    dbTotals.set(workload, totals);
+  }
+  totals.queries++;
+  totals.ms += ms;
+  if (failed) totals.errors++;
+
+  if (scope) {
+    scope.dbQueries++;
+    scope.dbMs += ms;
+  }
+}
+
+export function recordCacheLookup(cache: string, hit: boolean): void {
+  let lookups = cacheLookups.get(cache);
+  if (!lookups) {
+    lookups = { hits: 0, misses: 0 };
+    cacheLookups.set(cache, lookups);
+  }
+  if (hit) lookups.hits++;
+  else lookups.misses++;
+}
+
+const escapeLabel = (value: string) => value.replace(/\\/g, '\\\\').replace(/"/g, '\\"').replace(/\n/g, '\\n');
+
+const labels = (pairs: Record<string, string | number>) =>
+  '{' + Object.entries(pairs).map(([key, value]) => `${key}="${escapeLabel(String(value))}"`).join(',') + '}';
+
+const formatNumber = (value: number) => (value === Infinity ? '+Inf' : String(Math.round(value * 1000) / 1000));
+
+export function renderMetrics(pools: ReturnType<typeof getPoolStats>): string {
+  const lines: string[] = [];
+  const family = (name: string, type: string, help: string) => {
+    lines.push(`# HELP ${name} ${help}`, `# TYPE ${name} ${type}`);
+  };
+  const sortedRoutes = Array.from(routes.values()).sort((a, b) => a.route.localeCompare(b.route) || a.method.localeCompare(b.method));
+
+  family('http_request_duration_ms', 'histogram', 'Request latency by route template');
+  for (const m of sortedRoutes) {
+    const base = { method: m.method, route: m.route };
+    for (const bucket of m.latency.cumulative()) {
+      lines.push(`http_request_duration_ms_bucket${labels({ ...base, le: formatNumber(bucket.le) })} ${bucket.count}`);
+    }
+    lines.push(`http_request_duration_ms_sum${labels(base)} ${formatNumber(m.latency.sum)}`);
+    lines.push(`http_request_duration_ms_count${labels(base)} ${m.latency.count}`);
+  }
+
+  family('http_requests_total', 'counter', 'Requests by route template and status class');
+  for (const m of sortedRoutes) {
+    m.statuses.forEach((count, status) => {
+      lines.push(`http_requests_total${labels({ method: m.method, route: m.route, status })} ${count}`);
+    });
+  }
+
+  family('http_request_bytes_total', 'counter', 'Request body bytes (Content-Length)');
+  for (const m of sortedRoutes) lines.push(`http_request_bytes_total${labels({ method: m.method, route: m.route })} ${m.bytesIn}`);
+
+  family('http_response_bytes_total', 'counter', 'Response body bytes written');
+  for (const m of sortedRoutes) lines.push(`http_response_bytes_total${labels({ method: m.method, route: m.route })} ${m.bytesOut}`);
+
+  family('http_request_db_queries_total', 'counter', 'Database queries issued while serving the route');
+  for (const m of sortedRoutes) lines.push(`http_request_db_queries_total${labels({ method: m.method, route: m.route })} ${m.dbQueries}`);
+
+  family('http_request_db_time_ms_total', 'counter', 'Database time spent while serving the route');
+  for (const m of sortedRoutes) lines.push(`http_request_db_time_ms_total${labels({ method: m.method, route: m.route })} ${formatNumber(m.dbMs)}`);
+
+  family('db_queries_total', 'counter', 'Database queries by pool');
+  dbTotals.forEach((totals, workload) => lines.push(`db_queries_total${labels({ pool: workload })} ${totals.queries}`));
+  family('db_query_errors_total', 'counter', 'Failed database queries by pool');
+  dbTotals.forEach((totals, workload) => lines.push(`db_query_errors_total${labels({ pool: workload })} ${totals.errors}`));
+  family('db_query_time_ms_total', 'counter', 'Database query time by pool');
+  dbTotals.forEach((totals, workload) => lines.push(`db_query_time_ms_total${labels({ pool: workload })} ${formatNumber(totals.ms)}`));
+
+  family('db_pool_connections', 'gauge', 'Pool clients by state');
+  for (const p of pools) {
+    lines.push(`db_pool_connections${labels({ pool: p.workload, state: 'total' })} ${p.total}`);
+    lines.push(`db_pool_connections${labels({ pool: p.workload, state: 'idle' })} ${p.idle}`);
+    lines.push(`db_pool_connections${labels({ pool: p.workload, state: 'waiting' })} ${p.waiting}`);
+  }
+  family('db_pool_acquire_timeouts_total', 'counter', 'Pool acquire timeouts');
+  for (const p of pools) lines.push(`db_pool_acquire_timeouts_total${labels({ pool: p.workload })} ${p.timeouts}`);
+
+  family('cache_lookups_total', 'counter', 'Read-through cache lookups by result');
+  cacheLookups.forEach((lookups, cache) => {
+    lines.push(`cache_lookups_total${labels({ cache, result: 'hit' })} ${lookups.hits}`);
+    lines.push(`cache_lookups_total${labels({ cache, result: 'miss' })} ${lookups.misses}`);
+  });
+
+  return lines.join('\n') + '\n';
+}
+
+// Per-route percentiles for quick checks without a Prometheus server
+export function routeLatencySummary() {
+  return Array.from(routes.values())
+    .sort((a, b) => b.latency.count - a.latency.count)
+    .map((m) => {
+      const { buckets: _buckets, ...latency } = m.latency.snapshot();
+      return {
+        method: m.method,
+        route: m.route,
+        ...latency,
+        dbQueriesPerRequest: m.latency.count ? Math.round((m.dbQueries / m.latency.count) * 100) / 100 : 0,
+      };
+    });
+}
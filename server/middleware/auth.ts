@@ -1,11 +1,16 @@
 import { Request, Response, NextFunction } from "express";
 import { storage } from "../storage";
-import { User } from "@shared/schema";
+import { SafeUser } from "@shared/schema";
+import { userCan, type CompiledPermissions } from "../authorization";
+import { createLogger } from "../logger";
+
+// Runs on every authenticated request, so keep only a sample of its routine lines
+const authLog = createLogger("auth", { sampleRate: 0.01 });
 
 declare global {
     namespace Express {
         interface Request {
-            user?: User;
+            user?: SafeUser;
         }
     }
 }
@@ -14,19 +19,15 @@ declare module 'express-session' {
     interface SessionData {
         userId?: number;
         loggedIn?: boolean;
+        authz?: CompiledPermissions;
     }
 }
 
 export const authenticateUser = async (req: Request, res: Response, next: NextFunction): Promise<void> => {
     try {
-        console.log("Auth middleware - Checking authentication");
-        console.log("Auth middleware - isAuthenticated:", req.isAuthenticated());
-        console.log("Auth middleware - Session:", req.session);
-        console.log("Auth middleware - User:", req.user ? `Found: ${req.user.username}` : 'None');
-        
         // When using passport, we can simply use isAuthenticated() method
         if (!req.isAuthenticated()) {
-            console.log("Not authenticated with Passport");
+            authLog.debug("Not authenticated with Passport", { path: req.path });
             res.status(401).json({ message: "Unauthorized - Please log in" });
             return;
         }
@@ -34,7 +35,7 @@ export const authenticateUser = async (req: Request, res: Response, next: NextFu
         // Passport already attaches the user to req.user
         // We just need to verify it's valid
         if (!req.user || !req.user.id) {
-            console.log("Invalid user object in session");
+            authLog.warn("Invalid user object in session", { path: req.path });
             req.logout((err) => {
                 if (err) {
                     console.error("Error logging out:", err);
@@ -44,7 +45,7 @@ export const authenticateUser = async (req: Request, res: Response, next: NextFu
             return;
         }
 
-        console.log("User authenticated successfully:", req.user.username);
+        authLog.trace("User authenticated", { userId: req.user.id, path: req.path });
         // User is already attached to the request by Passport
         next();
     } catch (error) {
@@ -72,4 +73,47 @@ export const checkRole = (allowedRoles: string[]) => {
             res.status(500).json({ message: "Authorization error" });
         }
     };
-};
\ No newline at end of file
+};
+
+// Fine-grained check against the session's compiled permission set; locationOf picks the
+// location the request acts on (omit it to accept the permission at any location)
+export const requirePermission = (permission: string, locationOf?: (req: Request) => number | undefined) => {
+    return async (req: Request, res: Response, next: NextFunction): Promise<void> => {
+        try {
+            if (!req.user) {
+                res.status(401).json({ message: "Unauthorized - Please log in" });
+                return;
+            }
+
+            if (!await userCan(req, permission, locationOf?.(req))) {
+                res.status(403).json({ message: "Forbidden - Insufficient permissions" });
+                return;
+            }
+
+            next();
+        } catch (error) {
+            console.error("Authorization error:", error);
+            res.status(500).json({ message: "Authorization error" });
+        }
+    };
+};
+
+// Guard for internal diagnostics endpoints: loopback callers, callers presenting
+// INTERNAL_METRICS_TOKEN, or an authenticated administrator
+export const requireInternalAccess = (req: Request, res: Response, next: NextFunction): void => {
+    const token = process.env.INTERNAL_METRICS_TOKEN;
+    const remote = req.socket.remoteAddress || '';
+    const isLoopback = remote === '127.0.0.1' || remote === '::1' || remote === '::ffff:127.0.0.1';
+
+    if (isLoopback && !req.headers['x-forwarded-for']) {
+        return next();
+    }
+    if (token && req.get('x-internal-token') === token) {
+        return next();
+    }
+    if (req.isAuthenticated?.() && req.user?.role === 'administrator') {
+        return next();
+    }
+
+    res.status(403).json({ message: "Forbidden - Internal endpoint" });
+};
@@ -0,0 +1,262 @@
+import type { PoolClient } from '@neondatabase/serverless';
+import { pool } from './db';
+
+// Monthly range partitions of shifts (on date) and cash_counts (on count_date), and the archive
+// tier closed months move to. Set up by migrations/custom/partition-shifts-and-cash-counts.ts;
+// the storage.partitions job (see jobs.ts) then keeps a few months of partitions ahead of time
+// and archives months older than the horizon.
+//
+//   partitions.<table>_YYYY_MM   hot monthly partitions of public.<table>
+//   partitions.<table>_default   rows outside every monthly partition; kept near empty
+//   archive.<table>_YYYY_MM      closed months, compacted and read-only, under archive.<table>
+//   <table>_history              view over both, for reports and ranges past the horizon
+//
+// Partitions live outside the public schema so drizzle-kit push never sees them. A column added
+// to a parent table has to be added to archive.<table> too, and the history views recreated.
+//
+//   ARCHIVE_AFTER_MONTHS=12   months kept hot, not counting the current one
+
+const envInt = (name: string, fallback: number) => {
+  const value = parseInt(process.env[name] || '', 10);
+  return Number.isFinite(value) && value > 0 ? value : fallback;
+};
+
+export const HOT_SCHEMA = 'partitions';
+export const ARCHIVE_SCHEMA = 'archive';
+
+const ARCHIVE_AFTER_MONTHS = envInt('ARCHIVE_AFTER_MONTHS', 12);
+// Partitions created ahead of the current month, so inserts never land in the default partition
+const MONTHS_AHEAD = 3;
+// DETACH/ATTACH need short exclusive locks on the parent; give up rather than queue behind a
+// long report while every request queues behind us. The job retries.
+const LOCK_TIMEOUT = '5s';
+const MAINTENANCE_LOCK = 'partition-maintenance';
+
+export interface PartitionedTable {
+  table: string;
+  key: string;
+  // Indexes of the archive parent: what reports over old months filter on
+  archiveIndexes: string[];
+  // Row order of an archived month, so rows read together sit together
+  archiveOrder: string;
+}
+
+export const PARTITIONED_TABLES: PartitionedTable[] = [
+  { table: 'shifts', key: 'date', archiveIndexes: ['(schedule_id, date)', '(staff_id, date)'], archiveOrder: 'schedule_id, date, id' },
+  { table: 'cash_counts', key: 'count_date', archiveIndexes: ['(location_id, count_date)'], archiveOrder: 'location_id, count_date, id' },
+];
+
+// Months are UTC, like the ISO timestamps the storage layer binds
+export function monthStart(date: Date): Date {
+  return new Date(Date.UTC(date.getUTCFullYear(), date.getUTCMonth(), 1));
+}
+
+export function addMonths(month: Date, months: number): Date {
+  return new Date(Date.UTC(month.getUTCFullYear(), month.getUTCMonth() + months, 1));
+}
+
+const bound = (month: Date) => month.toISOString().slice(0, 10);
+
+// A YYYY-MM-DD day from SQL (to_char, never a timestamp: pg would read that as local time) to the
+// UTC start of its month
+export function parseMonth(day: string): Date {
+  return monthStart(new Date(`${day}T00:00:00.000Z`));
+}
+
+// drizzle-kit's name for the (id, key) primary key, so db:push sees nothing to change
+export function primaryKeyName(spec: PartitionedTable): string {
+  return `${spec.table}_id_${spec.key}_pk`;
+}
+
+export function partitionName(table: string, month: Date): string {
+  return `${table}_${month.getUTCFullYear()}_${String(month.getUTCMonth() + 1).padStart(2, '0')}`;
+}
+
+function parsePartitionMonth(name: string): Date | null {
+  const match = /_(\d{4})_(\d{2})$/.exec(name);
+  return match ? new Date(Date.UTC(Number(match[1]), Number(match[2]) - 1, 1)) : null;
+}
+
+// First month still entirely in the hot tier. Queries whose range starts earlier read the
+// *_history views, which are correct either way, archived yet or not.
+export function archiveHorizon(now = new Date()): Date {
+  return addMonths(monthStart(now), -ARCHIVE_AFTER_MONTHS);
+}
+
+export async function isPartitioned(client: PoolClient, table: string): Promise<boolean> {
+  const { rows } = await client.query(
+    `SELECT 1 FROM pg_partitioned_table WHERE partrelid = to_regclass($1)`,
+    [`public.${table}`]
+  );
+  return rows.length > 0;
+}
+
+async function relationExists(client: PoolClient, name: string): Promise<boolean> {
+  const { rows } = await client.query(`SELECT to_regclass($1) IS NOT NULL AS exists`, [name]);
+  return rows[0].exists;
+}
+
+// Create and attach one month's hot partition. Rows that already landed in the default partition
+// for that month move over first, or the attach would fail its validation scan. Expects to run
+// inside the caller's transaction; returns false when the partition already exists.
+export async function createMonthPartition(client: PoolClient, spec: PartitionedTable, month: Date): Promise<boolean> {
+  const name = `${HOT_SCHEMA}.${partitionName(spec.table, month)}`;
+  if (await relationExists(client, name)) return false;
+
+  const from = bound(month);
+  const to = bound(addMonths(month, 1));
+  await client.query(`CREATE TABLE ${name} (LIKE ${spec.table} INCLUDING DEFAULTS INCLUDING CONSTRAINTS)`);
+  await client.query(`
+    WITH moved AS (
+      DELETE FROM ${HOT_SCHEMA}.${spec.table}_default WHERE ${spec.key} >= $1 AND ${spec.key} < $2 RETURNING *
+    )
+    INSERT INTO ${name} SELECT * FROM moved
+  `, [from, to]);
+  await client.query(`ALTER TABLE ${spec.table} ATTACH PARTITION ${name} FOR VALUES FROM ('${from}') TO ('${to}')`);
+  return true;
+}
+
+// Columnar storage (Citus / Hydra) when the server has it, otherwise a compacted heap
+async function archiveAccessMethod(client: PoolClient): Promise<'columnar' | 'heap'> {
+  const { rows } = await client.query(`SELECT 1 FROM pg_am WHERE amname = 'columnar'`);
+  return rows.length > 0 ? 'columnar' : 'heap';
+}
+
+export interface ArchivedPeriod {
+  table: string;
+  month: string;
+  rows: number;
+  accessMethod: string;
+}
+
+// Move one closed month to the archive tier: detach the hot partition, rewrite its rows (plus any
+// in the default partition for that month) into a fresh archive table in read order, and attach
+// that under archive.<table>. One transaction, so the history views never miss or double a row.
+// Rows written for an already archived month end up in the default partition; a later run
+// appends them to the existing archive table.
+async function archiveMonth(client: PoolClient, spec: PartitionedTable, month: Date, accessMethod: string): Promise<ArchivedPeriod> {
+  const hot = `${HOT_SCHEMA}.${partitionName(spec.table, month)}`;
+  const cold = `${ARCHIVE_SCHEMA}.${partitionName(spec.table, month)}`;
+  const from = bound(month);
+  const to = bound(addMonths(month, 1));
+
+  // Explicit column list: archive.<table> is matched by name, not by position
+  const { rows: [{ columns }] } = await client.query(`
+    SELECT string_agg(quote_ident(column_name), ', ' ORDER BY ordinal_position) AS columns
+    FROM information_schema.columns WHERE table_schema = $1 AND table_name = $2
+  `, [ARCHIVE_SCHEMA, spec.table]);
+
+  const appending = await relationExists(client, cold);
+  if (!appending) {
+    await client.query(`
+      CREATE TABLE ${cold} (LIKE ${ARCHIVE_SCHEMA}.${spec.table})
+      ${accessMethod === 'columnar' ? 'USING columnar' : 'WITH (fillfactor = 100)'}
+    `);
+  }
+
+  let rowCount = 0;
+  if (await relationExists(client, hot)) {
+    await client.query(`ALTER TABLE ${spec.table} DETACH PARTITION ${hot}`);
+    const copied = await client.query(`INSERT INTO ${cold} (${columns}) SELECT ${columns} FROM ${hot} ORDER BY ${spec.archiveOrder}`);
+    rowCount += copied.rowCount ?? 0;
+    await client.query(`DROP TABLE ${hot}`);
+  }
+  const stray = await client.query(`
+    WITH moved AS (
+      DELETE FROM ${HOT_SCHEMA}.${spec.table}_default WHERE ${spec.key} >= $1 AND ${spec.key} < $2 RETURNING *
+    )
+    INSERT INTO ${cold} (${columns}) SELECT ${columns} FROM moved ORDER BY ${spec.archiveOrder}
+  `, [from, to]);
+  rowCount += stray.rowCount ?? 0;
+
+  if (!appending) {
+    await client.query(`ALTER TABLE ${ARCHIVE_SCHEMA}.${spec.table} ATTACH PARTITION ${cold} FOR VALUES FROM ('${from}') TO ('${to}')`);
+  }
+  await client.query(`
+    INSERT INTO ${ARCHIVE_SCHEMA}.archived_periods (table_name, period_start, row_count, access_method)
+    VALUES ($1, $2, $3, $4)
+    ON CONFLICT (table_name, period_start)
+    DO UPDATE SET row_count = archived_periods.row_count + EXCLUDED.row_count, archived_at = now()
+  `, [spec.table, from, rowCount, accessMethod]);
+
+  return { table: spec.table, month: from, rows: rowCount, accessMethod };
+}
+
+// Hot months older than the horizon, from partition names and stray default-partition rows
+async function closedMonths(client: PoolClient, spec: PartitionedTable, horizon: Date): Promise<Date[]> {
+  const { rows: partitions } = await client.query(`
+    SELECT c.relname FROM pg_inherits i JOIN pg_class c ON c.oid = i.inhrelid
+    WHERE i.inhparent = to_regclass($1)
+  `, [`public.${spec.table}`]);
+  const { rows: stray } = await client.query(`
+    SELECT DISTINCT to_char(date_trunc('month', ${spec.key}), 'YYYY-MM-DD') AS month FROM ${HOT_SCHEMA}.${spec.table}_default
+    WHERE ${spec.key} < $1
+  `, [bound(horizon)]);
+
+  const months = new Map<number, Date>();
+  for (const { relname } of partitions) {
+    const month = parsePartitionMonth(relname);
+    if (month && month < horizon) months.set(month.getTime(), month);
+  }
+  for (const { month } of stray) {
+    const start = parseMonth(month);
+    months.set(start.getTime(), start);
+  }
+  return Array.from(months.values()).sort((a, b) => a.getTime() - b.getTime());
+}
+
+async function inTransaction<T>(client: PoolClient, work: () => Promise<T>): Promise<T> {
+  await client.query('BEGIN');
+  try {
+    await client.query(`SET LOCAL lock_timeout = '${LOCK_TIMEOUT}'`);
+    const result = await work();
+    await client.query('COMMIT');
+    return result;
+  } catch (error) {
+    await client.query('ROLLBACK');
+    throw error;
+  }
+}
+
+export interface PartitionMaintenanceResult {
+  skipped?: string;
+  created: string[];
+  archived: ArchivedPeriod[];
+}
+
+// Idempotent and safe to run from several processes at once: only the holder of the advisory
+// lock does anything. Each month is its own transaction, so a lock timeout on one leaves the
+// months before it done and the rest for the retry.
+export async function maintainPartitions(now = new Date()): Promise<PartitionMaintenanceResult> {
+  const result: PartitionMaintenanceResult = { created: [], archived: [] };
+  const client = await pool.connect();
+  let locked = false;
+  try {
+    if (!(await isPartitioned(client, PARTITIONED_TABLES[0].table))) {
+      return { ...result, skipped: 'not partitioned; run migrations/custom/partition-shifts-and-cash-counts.ts' };
+    }
+    const { rows: [lock] } = await client.query(`SELECT pg_try_advisory_lock(hashtext($1)) AS locked`, [MAINTENANCE_LOCK]);
+    locked = lock.locked;
+    if (!locked) return { ...result, skipped: 'running elsewhere' };
+
+    const current = monthStart(now);
+    const horizon = archiveHorizon(now);
+    const accessMethod = await archiveAccessMethod(client);
+
+    for (const spec of PARTITIONED_TABLES) {
+      for (let ahead = 0; ahead <= MONTHS_AHEAD; ahead++) {
+        const month = addMonths(current, ahead);
+        if (await inTransaction(client, () => createMonthPartition(client, spec, month))) {
+          result.created.push(partitionName(spec.table, month));
+        }
+      }
+      for (const month of await closedMonths(client, spec, horizon)) {
+        result.archived.push(await inTransaction(client, () => archiveMonth(client, spec, month, accessMethod)));
+      }
+    }
+    return result;
+  } finally {
+    if (locked) await client.query(`SELECT pg_advisory_unlock(hashtext($1))`, [MAINTENANCE_LOCK]).catch(() => {});
+    client.release();
+  }
+}
@@ -0,0 +1,52 @@
+import { subscribeChannel, publishChannel } from './redis';
+
+// Change stamps for authorization data. Compiled permission sets record when they were built;
+// any set built before the last role_permissions change, or before the last change to its
+// user's locations or role, is stale and gets recompiled on its next check. Stamps are shared
+// with other instances over Redis pub/sub so checks themselves never leave the process.
+
+const CHANNEL = 'authz:changed';
+
+// Sessions compiled by an earlier process may predate changes this one never heard about
+let rolesChangedAt = Date.now();
+const usersChangedAt = new Map<number, number>();
+
+type EpochMessage = { scope: 'roles'; at: number } | { scope: 'user'; userId: number; at: number };
+
+function apply(message: EpochMessage) {
+  if (message.scope === 'roles') {
+    rolesChangedAt = Math.max(rolesChangedAt, message.at);
+  } else {
+    usersChangedAt.set(message.userId, Math.max(usersChangedAt.get(message.userId) ?? 0, message.at));
+  }
+}
+
+function publish(message: EpochMessage) {
+  apply(message);
+  void publishChannel(CHANNEL, JSON.stringify(message));
+}
+
+export function markRolePermissionsChanged(): void {
+  publish({ scope: 'roles', at: Date.now() });
+}
+
+export function markUserPermissionsChanged(userId: number): void {
+  publish({ scope: 'user', userId, at: Date.now() });
+}
+
+export function rolePermissionsChangedAt(): number {
+  return rolesChangedAt;
+}
+
+export function isPermissionSetStale(userId: number, compiledAt: number): boolean {
+  return compiledAt <= rolesChangedAt || compiledAt <= (usersChangedAt.get(userId) ?? 0);
+}
+
+subscribeChannel(
+  CHANNEL,
+  (raw) => apply(JSON.parse(raw) as EpochMessage),
+  // Changes may have been published while we weren't listening, so treat every (re)connect as one
+  () => {
+    rolesChangedAt = Date.now();
+  },
+);
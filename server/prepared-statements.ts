@@ -0,0 +1,124 @@
+import { eq, and, gte, lt, asc, sql, getTableColumns } from 'drizzle-orm';
+import { db } from './db';
+import {
+  users, locations, competencies, staff, shifts, shiftsHistory, weeklySchedules, uploadedFiles,
+  roles, rolePermissions, userLocations,
+} from '@shared/schema';
+
+// Named prepared statements for the hottest DatabaseStorage lookups (auth, scheduling, uploads).
+// Each is built once, so the Drizzle query builder and SQL rendering run at startup instead of
+// per call, and Postgres parses and plans it once per connection instead of per execution.
+//
+// DB_PREPARED_STATEMENTS=off keeps the builder caching but sends unnamed statements, for
+// poolers that can't track named statements across transactions.
+
+const serverSide = !/^(0|false|off|no)$/i.test(process.env.DB_PREPARED_STATEMENTS || '');
+const named = (name: string) => (serverSide ? name : '');
+const param = (name: string) => sql.placeholder(name);
+
+// Every user column but the password hash: these rows are cached and become req.user
+export const { password: _password, ...userColumns } = getTableColumns(users);
+
+// One location's schedules starting in [weekStart, weekEnd) with their shifts, the assigned staff
+// and the competencies; `source` is shifts or, for archived weeks, the shifts_history view
+function weekViewRows(source: typeof shifts, name: string) {
+  return db
+    .select({
+      schedule: weeklySchedules,
+      shift: source,
+      staffMember: {
+        id: staff.id,
+        userId: staff.userId,
+        position: staff.position,
+      },
+      userName: users.name,
+      competency: {
+        id: competencies.id,
+        name: competencies.name,
+      },
+    })
+    .from(weeklySchedules)
+    .leftJoin(source, eq(source.scheduleId, weeklySchedules.id))
+    .leftJoin(staff, eq(staff.id, source.staffId))
+    .leftJoin(users, eq(users.id, staff.userId))
+    .leftJoin(competencies, eq(competencies.id, source.competencyId))
+    .where(and(
+      eq(weeklySchedules.locationId, param('locationId')),
+      // Bound as ISO strings (what the column encoder would produce for a Date)
+      gte(weeklySchedules.weekStartDate, sql`${param('weekStart')}::timestamp`),
+      lt(weeklySchedules.weekStartDate, sql`${param('weekEnd')}::timestamp`)
+    ))
+    .orderBy(asc(weeklySchedules.id), asc(source.date), asc(source.startTime))
+    .prepare(named(name));
+}
+
+function buildStatements() {
+  return {
+    // Auth
+    userById: db.select(userColumns).from(users)
+      .where(eq(users.id, param('id')))
+      .prepare(named('user_by_id')),
+    userByUsername: db.select(userColumns).from(users)
+      .where(eq(users.username, param('username')))
+      .prepare(named('user_by_username')),
+    userByEmail: db.select(userColumns).from(users)
+      .where(eq(users.email, param('email')))
+      .prepare(named('user_by_email')),
+    userPasswordHash: db.select({ password: users.password }).from(users)
+      .where(eq(users.id, param('id')))
+      .prepare(named('user_password_hash')),
+    rolePermissionIdsByName: db.select({ permissionId: rolePermissions.permissionId })
+      .from(rolePermissions)
+      .innerJoin(roles, eq(roles.id, rolePermissions.roleId))
+      .where(eq(roles.name, param('roleName')))
+      .prepare(named('role_permission_ids_by_name')),
+    userLocationPermissionIds: db.select({ locationId: userLocations.locationId, permissionId: rolePermissions.permissionId })
+      .from(userLocations)
+      .innerJoin(rolePermissions, eq(rolePermissions.roleId, userLocations.roleId))
+      .where(eq(userLocations.userId, param('userId')))
+      .prepare(named('user_location_permission_ids')),
+
+    // Scheduling
+    locationById: db.select().from(locations)
+      .where(eq(locations.id, param('id')))
+      .prepare(named('location_by_id')),
+    competencyById: db.select().from(competencies)
+      .where(eq(competencies.id, param('id')))
+      .prepare(named('competency_by_id')),
+    staffById: db.select().from(staff)
+      .where(eq(staff.id, param('id')))
+      .prepare(named('staff_by_id')),
+    staffByLocation: db.select().from(staff)
+      .where(eq(staff.locationId, param('locationId')))
+      .prepare(named('staff_by_location')),
+    staffByUser: db.select().from(staff)
+      .where(eq(staff.userId, param('userId')))
+      .prepare(named('staff_by_user')),
+    shiftById: db.select().from(shifts)
+      .where(eq(shifts.id, param('id')))
+      .prepare(named('shift_by_id')),
+    shiftsBySchedule: db.select().from(shifts)
+      .where(eq(shifts.scheduleId, param('scheduleId')))
+      .prepare(named('shifts_by_schedule')),
+    // Week view: the schedule row is repeated for every shift; see DatabaseStorage.loadWeekView
+    weekViewRows: weekViewRows(shifts, 'week_view_rows'),
+    // Weeks before the archive horizon, whose shifts may have moved to the archive tier
+    weekViewHistoryRows: weekViewRows(shiftsHistory as unknown as typeof shifts, 'week_view_history_rows'),
+
+    // Uploads
+    uploadedFileById: db.select().from(uploadedFiles)
+      .where(eq(uploadedFiles.id, param('id')))
+      .prepare(named('uploaded_file_by_id')),
+  };
+}
+
+let registry: ReturnType<typeof buildStatements> | null = null;
+
+export function preparedStatements() {
+  return (registry ??= buildStatements());
+}
+
+// Called once at startup so the first requests don't pay for building the registry
+export function initPreparedStatements() {
+  preparedStatements();
+}
@@ -1,155 +1,289 @@
 import { spawn, ChildProcess } from 'child_process';
 import { existsSync, mkdirSync, writeFileSync } from 'fs';
+import net from 'net';
 import path from 'path';
+import { createLogger } from './logger';
 
-export class RedisSupervisor {
-  private redisProcess: ChildProcess | null = null;
-  private isStarting = false;
-  private restartCount = 0;
-  private maxRestarts = 0; // Disable restarts until we find a working solution
+// Runs the bundled redis-server as a child of this process when no external Redis is
+// configured. Start-up never blocks the HTTP server: the cache works from the in-process LRU
+// (see redis.ts) until the readiness probe passes, and again whenever the child dies or stops
+// answering, while the supervisor restarts it with exponential backoff.
+//
+//   REDIS_EMBEDDED=off                 never spawn (also implied by REDIS_URL / REDIS_PRIVATE_URL)
+//   REDIS_EMBEDDED_MAXMEMORY=32mb      memory cap of the embedded server
+//
+// In cluster mode only the primary supervises; workers connect to it like any other Redis.
 
-  constructor() {
-    // Handle graceful shutdown
-    process.on('SIGTERM', () => this.stop());
-    process.on('SIGINT', () => this.stop());
-    process.on('exit', () => this.stop());
-  }
+const supervisorLog = createLogger('redis-supervisor');
 
-  async start(): Promise<boolean> {
-    if (this.isStarting || this.redisProcess) {
-      console.log('Redis already starting or running');
-      return true;
-    }
+const REDIS_BINARY = './Redis-replit/bin/redis-server';
+const LOGS_DIR = './redis-logs';
+const PORT = 6379;
+const HOST = '127.0.0.1';
+const MAX_MEMORY = process.env.REDIS_EMBEDDED_MAXMEMORY || '32mb';
 
-    this.isStarting = true;
-    
-    try {
-      // Ensure directories exist
-      const logsDir = './redis-logs';
-      if (!existsSync(logsDir)) {
-        mkdirSync(logsDir, { recursive: true });
-      }
+const READY_TIMEOUT_MS = 10000;
+const PROBE_INTERVAL_MS = 50;
+const HEALTH_CHECK_MS = 5000;
+// Consecutive failed health probes before a running child is considered hung and killed
+const HEALTH_FAILURE_THRESHOLD = 3;
+const MIN_RESTART_DELAY_MS = 1000;
+const MAX_RESTART_DELAY_MS = 60000;
+// A child that stays healthy this long resets the backoff and the failure count
+const STABLE_UPTIME_MS = 60000;
+// Consecutive failed starts after which the supervisor gives up until the next deploy
+const MAX_CONSECUTIVE_FAILURES = 10;
+
+export type SupervisorState = 'disabled' | 'starting' | 'ready' | 'backoff' | 'failed' | 'external' | 'stopped';
 
-      // Create Redis config optimized for memory constraints
-      const configPath = path.join(logsDir, 'redis-app.conf');
-      const redisConfig = `
-# Redis Configuration for Application Integration - Memory Optimized
-port 6379
-bind 127.0.0.1
+const sleep = (ms: number) => new Promise(resolve => setTimeout(resolve, ms));
+
+// Inline PING over a plain socket, independent of the shared ioredis client and its backoff
+function probe(timeoutMs: number): Promise<boolean> {
+  return new Promise((resolve) => {
+    const socket = net.createConnection({ host: HOST, port: PORT });
+    const done = (ok: boolean) => {
+      socket.destroy();
+      resolve(ok);
+    };
+    socket.setTimeout(timeoutMs, () => done(false));
+    socket.once('error', () => done(false));
+    socket.once('connect', () => socket.write('PING\r\n'));
+    socket.once('data', (data) => done(data.toString().startsWith('+PONG')));
+  });
+}
+
+// No persistence (the embedded server is a cache and a job broker that tolerates loss) so a
+// cold start has nothing to load. Keys without a TTL (queued jobs) are never evicted.
+function writeConfig(): string {
+  mkdirSync(LOGS_DIR, { recursive: true });
+  const configPath = path.join(LOGS_DIR, 'redis-app.conf');
+  writeFileSync(configPath, `
+port ${PORT}
+bind ${HOST}
 protected-mode no
 daemonize no
-pidfile ${logsDir}/redis-app.pid
-logfile ${logsDir}/redis-app.log
+pidfile ${LOGS_DIR}/redis-app.pid
+logfile ${LOGS_DIR}/redis-app.log
 loglevel notice
 save ""
 appendonly no
 timeout 0
 tcp-keepalive 60
-maxmemory 32mb
-maxmemory-policy allkeys-lru
-# Memory optimization settings
+maxmemory ${MAX_MEMORY}
+maxmemory-policy volatile-lru
+# jemalloc's background purge thread is what crashed under this sandbox's kernel
+jemalloc-bg-thread no
+activedefrag no
 hash-max-ziplist-entries 512
 hash-max-ziplist-value 64
 list-max-ziplist-size -2
 set-max-intset-entries 512
 zset-max-ziplist-entries 128
 zset-max-ziplist-value 64
-`;
-      
-      writeFileSync(configPath, redisConfig);
-
-      // Try the original Redis binary with different configuration
-      const redisBinary = './Redis-replit/bin/redis-server';
-      
-      console.log('Starting Redis as application subprocess...');
-      this.redisProcess = spawn(redisBinary, [configPath], {
-        stdio: ['ignore', 'pipe', 'pipe'],
-        detached: false, // Keep as child process of Node.js
-        env: {
-          ...process.env,
-          LD_PRELOAD: '', // Disable jemalloc preloading
-          MALLOC_ARENA_MAX: '1' // Limit memory arenas
-        }
-      });
+`);
+  return configPath;
+}
 
-      // Handle Redis output
-      this.redisProcess.stdout?.on('data', (data) => {
-        console.log(`Redis: ${data.toString().trim()}`);
-      });
+export class RedisSupervisor {
+  private redisProcess: ChildProcess | null = null;
+  private state: SupervisorState = 'stopped';
+  private consecutiveFailures = 0;
+  private restarts = 0;
+  private restartDelayMs = MIN_RESTART_DELAY_MS;
+  private readyAt: number | null = null;
+  private nextRestartAt: number | null = null;
+  private lastExit: { code: number | null; signal: string | null; at: Date } | null = null;
+  private failedProbes = 0;
+  private healthTimer: NodeJS.Timeout | null = null;
+  private restartTimer: NodeJS.Timeout | null = null;
+  private readyListeners = new Set<() => void>();
 
-      this.redisProcess.stderr?.on('data', (data) => {
-        console.error(`Redis Error: ${data.toString().trim()}`);
-      });
+  constructor() {
+    // Never leave the child behind; 'exit' handlers must be synchronous, which kill() is
+    process.on('exit', () => this.redisProcess?.kill('SIGTERM'));
+  }
 
-      // Handle Redis process events
-      this.redisProcess.on('spawn', () => {
-        console.log(`Redis process spawned with PID: ${this.redisProcess?.pid}`);
-        this.isStarting = false;
-        this.restartCount = 0;
-      });
+  enabled(): boolean {
+    return process.env.REDIS_EMBEDDED !== 'off' &&
+      !process.env.REDIS_URL && !process.env.REDIS_PRIVATE_URL &&
+      existsSync(REDIS_BINARY);
+  }
 
-      this.redisProcess.on('error', (error) => {
-        console.error('Redis process error:', error);
-        this.isStarting = false;
-        this.attemptRestart();
-      });
+  // Called every time the embedded server (re)starts answering
+  onReady(listener: () => void) {
+    this.readyListeners.add(listener);
+  }
 
-      this.redisProcess.on('exit', (code, signal) => {
-        console.log(`Redis process exited with code ${code}, signal ${signal}`);
-        this.redisProcess = null;
-        this.isStarting = false;
-        
-        if (code !== 0 && this.restartCount < this.maxRestarts) {
-          console.log(`Redis unexpected exit, attempting restart...`);
-          this.attemptRestart();
-        }
-      });
+  // Returns at once; the child is spawned and probed in the background
+  start(): void {
+    if (this.state !== 'stopped') return;
+    if (!this.enabled()) {
+      this.state = 'disabled';
+      return;
+    }
 
-      // Wait a moment for Redis to start
-      await new Promise(resolve => setTimeout(resolve, 1000));
-      
-      return this.redisProcess !== null;
-      
+    // Signals would otherwise kill this process without running 'exit' handlers
+    for (const signal of ['SIGTERM', 'SIGINT'] as const) {
+      if (process.listenerCount(signal) === 0) {
+        process.once(signal, () => {
+          this.stop();
+          process.exit(0);
+        });
+      }
+    }
+
+    this.state = 'starting';
+    void this.launch();
+    this.healthTimer = setInterval(() => void this.checkHealth(), HEALTH_CHECK_MS);
+    this.healthTimer.unref();
+  }
+
+  private async launch() {
+    this.state = 'starting';
+    this.nextRestartAt = null;
+
+    // A server already on the port (left over from a previous run, or started by hand) is reused
+    if (await probe(200)) {
+      supervisorLog.info(`reusing Redis already listening on ${HOST}:${PORT}`);
+      this.state = 'external';
+      this.readyAt = Date.now();
+      this.readyListeners.forEach(listener => listener());
+      return;
+    }
+
+    let child: ChildProcess;
+    try {
+      child = spawn(REDIS_BINARY, [writeConfig()], {
+        stdio: ['ignore', 'ignore', 'pipe'],
+        detached: false,
+        env: { ...process.env, LD_PRELOAD: '', MALLOC_ARENA_MAX: '1' },
+      });
     } catch (error) {
-      console.error('Failed to start Redis:', error);
-      this.isStarting = false;
-      return false;
+      supervisorLog.error('failed to spawn redis-server', { error: error instanceof Error ? error.message : String(error) });
+      this.scheduleRestart();
+      return;
+    }
+    this.redisProcess = child;
+
+    child.stderr?.on('data', (data) => supervisorLog.warn(data.toString().trim()));
+    child.once('error', (error) => supervisorLog.error('redis-server process error', { error: error.message }));
+    child.once('exit', (code, signal) => {
+      if (this.redisProcess !== child) return;
+      this.redisProcess = null;
+      this.readyAt = null;
+      this.lastExit = { code, signal, at: new Date() };
+      if (this.state === 'stopped') return;
+      supervisorLog.error(`redis-server exited (${signal || code})`);
+      this.scheduleRestart();
+    });
+
+    const deadline = Date.now() + READY_TIMEOUT_MS;
+    while (Date.now() < deadline && this.redisProcess === child) {
+      if (await probe(PROBE_INTERVAL_MS * 4)) {
+        this.state = 'ready';
+        this.readyAt = Date.now();
+        this.failedProbes = 0;
+        supervisorLog.info(`redis-server ready (pid ${child.pid})`);
+        this.readyListeners.forEach(listener => listener());
+        return;
+      }
+      await sleep(PROBE_INTERVAL_MS);
+    }
+
+    if (this.redisProcess === child) {
+      supervisorLog.error(`redis-server not ready after ${READY_TIMEOUT_MS}ms`);
+      // The exit handler schedules the restart
+      child.kill('SIGKILL');
     }
   }
 
-  private attemptRestart() {
-    if (this.restartCount >= this.maxRestarts) {
-      console.error(`Redis failed to restart ${this.maxRestarts} times, giving up`);
+  private scheduleRestart() {
+    if (this.state === 'stopped' || this.restartTimer) return;
+
+    const stable = this.readyAt !== null && Date.now() - this.readyAt > STABLE_UPTIME_MS;
+    if (stable) {
+      this.consecutiveFailures = 0;
+      this.restartDelayMs = MIN_RESTART_DELAY_MS;
+    }
+    this.consecutiveFailures++;
+    if (this.consecutiveFailures > MAX_CONSECUTIVE_FAILURES) {
+      supervisorLog.error(`redis-server failed ${MAX_CONSECUTIVE_FAILURES} times in a row; staying on the in-process cache`);
+      this.state = 'failed';
       return;
     }
 
-    this.restartCount++;
-    console.log(`Attempting Redis restart ${this.restartCount}/${this.maxRestarts}...`);
-    
-    setTimeout(() => {
-      this.start();
-    }, 2000 * this.restartCount); // Exponential backoff
+    this.state = 'backoff';
+    const delay = this.restartDelayMs;
+    this.restartDelayMs = Math.min(this.restartDelayMs * 2, MAX_RESTART_DELAY_MS);
+    this.nextRestartAt = Date.now() + delay;
+    supervisorLog.info(`restarting redis-server in ${delay}ms`);
+    this.restartTimer = setTimeout(() => {
+      this.restartTimer = null;
+      this.restarts++;
+      void this.launch();
+    }, delay);
+    this.restartTimer.unref();
   }
 
-  stop(): void {
+  // A child that is alive but stops answering is killed so the restart path takes over
+  private async checkHealth() {
+    if (this.state !== 'ready' && this.state !== 'external') return;
+    if (await probe(1000)) {
+      this.failedProbes = 0;
+      if (this.readyAt !== null && Date.now() - this.readyAt > STABLE_UPTIME_MS) {
+        this.consecutiveFailures = 0;
+        this.restartDelayMs = MIN_RESTART_DELAY_MS;
+      }
+      return;
+    }
+
+    this.failedProbes++;
+    if (this.failedProbes < HEALTH_FAILURE_THRESHOLD) return;
+    this.failedProbes = 0;
     if (this.redisProcess) {
-      console.log('Stopping Redis subprocess...');
-      this.redisProcess.kill('SIGTERM');
-      
-      // Force kill after timeout
+      supervisorLog.error('redis-server stopped answering; killing it');
+      this.redisProcess.kill('SIGKILL');
+    } else {
+      // The reused server went away: start our own
+      this.readyAt = null;
+      this.scheduleRestart();
+    }
+  }
+
+  stop(): void {
+    this.state = 'stopped';
+    if (this.healthTimer) clearInterval(this.healthTimer);
+    if (this.restartTimer) clearTimeout(this.restartTimer);
+    this.healthTimer = null;
+    this.restartTimer = null;
+
+    const child = this.redisProcess;
+    if (child) {
+      supervisorLog.info('stopping redis-server');
+      child.kill('SIGTERM');
       setTimeout(() => {
-        if (this.redisProcess && !this.redisProcess.killed) {
-          console.log('Force killing Redis subprocess...');
-          this.redisProcess.kill('SIGKILL');
-        }
-      }, 5000);
-      
+        if (child.exitCode === null && child.signalCode === null) child.kill('SIGKILL');
+      }, 5000).unref();
       this.redisProcess = null;
     }
   }
 
+  status() {
+    return {
+      state: this.state,
+      pid: this.redisProcess?.pid ?? null,
+      uptimeSeconds: this.readyAt === null ? 0 : Math.floor((Date.now() - this.readyAt) / 1000),
+      restarts: this.restarts,
+      consecutiveFailures: this.consecutiveFailures,
+      nextRestartAt: this.nextRestartAt === null ? null : new Date(this.nextRestartAt),
+      lastExit: this.lastExit,
+      maxMemory: MAX_MEMORY,
+    };
+  }
+
   isRunning(): boolean {
-    return this.redisProcess !== null && !this.redisProcess.killed;
+    return this.state === 'ready' || this.state === 'external';
   }
 
   getPid(): number | undefined {
@@ -158,4 +292,4 @@ zset-max-ziplist-value 64
 }
 
 // Export singleton instance
-export const redisSupervisor = new RedisSupervisor();
\ No newline at end of file
+export const redisSupervisor = new RedisSupervisor();
@@ -1,21 +1,50 @@
-import { createClient } from 'redis';
+import Redis from 'ioredis';
+import { LocalCache } from './local-cache';
+import { createLogger } from './logger';
 
 const redisUrl = process.env.REDIS_URL || process.env.REDIS_PRIVATE_URL || 'redis://localhost:6379';
 
-export const redisClient = createClient({
-  url: redisUrl,
+// Key prefix for tag sets used by tag-based cache invalidation
+const TAG_PREFIX = 'cache:tag:';
+
+// A command Redis hasn't answered by then fails, so a hung server can't stall requests
+const COMMAND_TIMEOUT_MS = parseInt(process.env.REDIS_COMMAND_TIMEOUT_MS || '1000', 10);
+const HEALTH_CHECK_MS = parseInt(process.env.REDIS_HEALTH_CHECK_MS || '5000', 10);
+// Consecutive failed pings before the cache stops using Redis
+const HEALTH_FAILURE_THRESHOLD = 2;
+
+// Fail fast while disconnected: callers treat Redis as an optional cache, so queueing
+// commands until a connection appears would only add latency to every request. Reconnects
+// stay frequent so an embedded server restarted by the supervisor is picked up quickly.
+export const redisClient = new Redis(redisUrl, {
+  lazyConnect: true,
+  enableOfflineQueue: false,
+  maxRetriesPerRequest: 1,
+  commandTimeout: COMMAND_TIMEOUT_MS,
+  retryStrategy: (times) => Math.min(times * 250, 5000),
 });
 
+let lastErrorMessage = '';
+
 redisClient.on('error', (err) => {
-  // Silently handle Redis connection errors to prevent app crashes
-  console.warn('Redis connection issue (app continues normally):', err.message);
+  // Silently handle Redis connection errors to prevent app crashes (log each distinct error once)
+  if (err.message !== lastErrorMessage) {
+    lastErrorMessage = err.message;
+    console.warn('Redis connection issue (app continues normally):', err.message);
+  }
 });
 
-redisClient.on('connect', () => {
+redisClient.on('ready', () => {
+  lastErrorMessage = '';
   console.log('Redis Client Connected');
 });
 
+export function isRedisReady(): boolean {
+  return redisClient.status === 'ready';
+}
+
 export async function initRedis() {
+  startHealthCheck();
   try {
     await redisClient.connect();
     console.log('Redis connected successfully');
@@ -26,6 +55,16 @@ export async function initRedis() {
   }
 }
 
+// Retry now instead of waiting out the reconnect backoff (the supervisor calls this once an
+// embedded server it started answers)
+export function reconnectRedisNow() {
+  if (redisClient.status === 'wait' || redisClient.status === 'end') {
+    redisClient.connect().catch(() => {});
+  } else if (redisClient.status === 'reconnecting') {
+    redisClient.disconnect(true);
+  }
+}
+
 export async function testRedisConnection() {
   try {
     await redisClient.ping();
@@ -35,10 +74,157 @@ export async function testRedisConnection() {
   }
 }
 
+// Revive ISO timestamps so cached rows keep their Date fields. Only keys known to hold Dates
+// (the schema's timestamp columns, job records and job payloads): free text that happens to
+// look like a timestamp, a KB body or a note, stays a string.
+const DATE_KEYS = new Set([
+  'createdAt', 'updatedAt', 'date', 'weekStartDate', 'countDate', 'uploadedAt', 'verifiedAt', 'assessedAt', 'expire',
+  'startedAt', 'finishedAt', 'runAt',
+  'fromWeekStart', 'toWeekStart',
+]);
+const ISO_DATE = /^\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}(\.\d+)?Z$/;
+
+export function reviveDates(key: string, value: any) {
+  return typeof value === 'string' && DATE_KEYS.has(key) && ISO_DATE.test(value) ? new Date(value) : value;
+}
+
+// Cache reads and writes go to Redis while it is connected and answering pings, and to an
+// in-process LRU otherwise. Invalidations made while degraded can't reach Redis, so they are
+// remembered and replayed before the cache switches back; until then reads stay local.
+const localCache = new LocalCache();
+const cacheLog = createLogger('cache');
+// Beyond this many missed tags the replay drops every tagged entry instead
+const MAX_MISSED_TAGS = 10000;
+
+let healthy = true;
+let failedPings = 0;
+let recovering = false;
+// Until the first connection the cache is local like any other outage
+let degradedSince: number | null = Date.now();
+const missed = { keys: new Set<string>(), tags: new Set<string>(), overflow: false };
+let healthTimer: NodeJS.Timeout | null = null;
+
+// Degraded periods only end once recover() has replayed what Redis missed
+function cacheOnRedis(): boolean {
+  return isRedisReady() && healthy && degradedSince === null;
+}
+
+function markDegraded() {
+  if (degradedSince === null) {
+    degradedSince = Date.now();
+    cacheLog.warn('Cache degraded to in-process LRU');
+  }
+}
+
+// Apply the invalidations Redis missed, then hand reads back to it
+async function recover() {
+  if (recovering || !isRedisReady() || !healthy || degradedSince === null) return;
+  recovering = true;
+  try {
+    let replayedKeys = 0;
+    let replayedTags = 0;
+    // Invalidations arriving mid-replay are still recorded as missed, so drain until none are left
+    while (missed.keys.size > 0 || missed.tags.size > 0 || missed.overflow) {
+      const keys = Array.from(missed.keys);
+      const tags = Array.from(missed.tags);
+      const overflow = missed.overflow;
+      missed.keys.clear();
+      missed.tags.clear();
+      missed.overflow = false;
+
+      if (overflow) {
+        const stream = redisClient.scanStream({ match: TAG_PREFIX + '*', count: 500 });
+        for await (const tagKeys of stream as AsyncIterable<string[]>) {
+          if (tagKeys.length > 0) tags.push(...tagKeys.map(tagKey => tagKey.slice(TAG_PREFIX.length)));
+        }
+      }
+      if (keys.length > 0) await redisClient.del(...keys);
+      for (let i = 0; i < tags.length; i += 500) {
+        await invalidateTagsOnRedis(tags.slice(i, i + 500));
+      }
+      replayedKeys += keys.length;
+      replayedTags += tags.length;
+    }
+
+    localCache.clear();
+    cacheLog.info('Cache using Redis again', {
+      degradedSeconds: Math.round((Date.now() - degradedSince) / 1000),
+      replayedKeys,
+      replayedTags,
+    });
+    degradedSince = null;
+  } catch (error) {
+    console.error('Redis cache recovery error:', error);
+    // Keep what wasn't replayed; the next health check retries
+    missed.overflow = true;
+  } finally {
+    recovering = false;
+  }
+}
+
+async function checkHealth() {
+  if (!isRedisReady()) {
+    markDegraded();
+    return;
+  }
+  try {
+    await redisClient.ping();
+    failedPings = 0;
+    healthy = true;
+  } catch {
+    failedPings++;
+    if (failedPings >= HEALTH_FAILURE_THRESHOLD) healthy = false;
+  }
+  if (!healthy) markDegraded();
+  else if (degradedSince !== null) await recover();
+}
+
+function startHealthCheck() {
+  if (healthTimer) return;
+  healthTimer = setInterval(() => void checkHealth(), HEALTH_CHECK_MS);
+  healthTimer.unref();
+}
+
+redisClient.on('ready', () => {
+  failedPings = 0;
+  healthy = true;
+  void recover();
+});
+redisClient.on('close', markDegraded);
+
+function rememberMissed(keys: string[], tags: string[]) {
+  markDegraded();
+  keys.forEach(key => missed.keys.add(key));
+  tags.forEach(tag => missed.tags.add(tag));
+  if (missed.keys.size + missed.tags.size > MAX_MISSED_TAGS) {
+    missed.keys.clear();
+    missed.tags.clear();
+    missed.overflow = true;
+  }
+}
+
+export function cacheMode(): 'redis' | 'local' {
+  return cacheOnRedis() ? 'redis' : 'local';
+}
+
+export function cacheStats() {
+  return {
+    mode: cacheMode(),
+    healthy,
+    degradedSince: degradedSince === null ? null : new Date(degradedSince),
+    pendingInvalidations: missed.overflow ? 'all' : missed.keys.size + missed.tags.size,
+    local: localCache.stats(),
+  };
+}
+
 export async function cacheGet(key: string) {
+  if (!cacheOnRedis()) {
+    const value = localCache.get(key);
+    return value ? JSON.parse(value, reviveDates) : null;
+  }
   try {
     const value = await redisClient.get(key);
-    return value ? JSON.parse(value) : null;
+    return value ? JSON.parse(value, reviveDates) : null;
   } catch (error) {
     console.error('Redis get error:', error);
     return null;
@@ -46,8 +232,12 @@ export async function cacheGet(key: string) {
 }
 
 export async function cacheSet(key: string, value: any, ttl: number = 3600) {
+  if (!cacheOnRedis()) {
+    localCache.set(key, JSON.stringify(value), ttl);
+    return true;
+  }
   try {
-    await redisClient.setEx(key, ttl, JSON.stringify(value));
+    await redisClient.set(key, JSON.stringify(value), 'EX', ttl);
     return true;
   } catch (error) {
     console.error('Redis set error:', error);
@@ -56,11 +246,117 @@ export async function cacheSet(key: string, value: any, ttl: number = 3600) {
 }
 
 export async function cacheDel(key: string) {
+  localCache.delete(key);
+  if (!cacheOnRedis()) {
+    rememberMissed([key], []);
+    return true;
+  }
   try {
     await redisClient.del(key);
     return true;
   } catch (error) {
     console.error('Redis delete error:', error);
+    rememberMissed([key], []);
+    return false;
+  }
+}
+
+// Store a value and register its key under each tag so it can be invalidated by entity
+export async function cacheSetTagged(key: string, value: any, tags: string[], ttl: number = 3600) {
+  if (!cacheOnRedis()) {
+    localCache.set(key, JSON.stringify(value), ttl, tags);
+    return true;
+  }
+  try {
+    const multi = redisClient.multi().set(key, JSON.stringify(value), 'EX', ttl);
+    for (const tag of tags) {
+      multi.sadd(TAG_PREFIX + tag, key).expire(TAG_PREFIX + tag, ttl);
+    }
+    await multi.exec();
+    return true;
+  } catch (error) {
+    console.error('Redis tagged set error:', error);
+    return false;
+  }
+}
+
+async function invalidateTagsOnRedis(tags: string[]) {
+  const tagKeys = tags.map(tag => TAG_PREFIX + tag);
+  const members = await Promise.all(tagKeys.map(tagKey => redisClient.smembers(tagKey)));
+  const keys = Array.from(new Set(members.flat()));
+  await redisClient.del(...keys, ...tagKeys);
+}
+
+// Delete every key registered under any of the given tags, along with the tag sets
+export async function cacheInvalidateTags(tags: string[]) {
+  if (tags.length === 0) return false;
+  localCache.invalidateTags(tags);
+  if (!cacheOnRedis()) {
+    rememberMissed([], tags);
+    return true;
+  }
+  try {
+    await invalidateTagsOnRedis(tags);
+    return true;
+  } catch (error) {
+    console.error('Redis tag invalidation error:', error);
+    rememberMissed([], tags);
+    return false;
+  }
+}
+
+// Pub/sub shared by every in-process subscriber. A subscribed ioredis connection can't issue
+// regular commands, so one dedicated connection carries all channels and is opened the first
+// time the main client becomes ready. Publishing while Redis is down is a no-op: callers
+// always deliver locally first, so single-process setups work without Redis.
+type ChannelHandler = (message: string) => void;
+
+const channelHandlers = new Map<string, Set<ChannelHandler>>();
+const reconnectHandlers = new Set<() => void>();
+const subscriberClient = redisClient.duplicate({ lazyConnect: true });
+let subscriberConnected = false;
+
+subscriberClient.on('error', () => {}); // connection problems are already reported by the main client
+subscriberClient.on('message', (channel, message) => {
+  channelHandlers.get(channel)?.forEach((handler) => {
+    try {
+      handler(message);
+    } catch (error) {
+      console.error(`Redis message handler error (${channel}):`, error);
+    }
+  });
+});
+// Messages published while we weren't listening are lost; let subscribers resync
+subscriberClient.on('ready', () => {
+  subscriberConnected = true;
+  reconnectHandlers.forEach(handler => handler());
+});
+
+redisClient.on('ready', () => {
+  if (subscriberClient.status !== 'wait') return;
+  subscriberClient.connect()
+    .then(() => (channelHandlers.size > 0 ? subscriberClient.subscribe(...Array.from(channelHandlers.keys())) : undefined))
+    .catch(() => {});
+});
+
+export function subscribeChannel(channel: string, handler: ChannelHandler, onReconnect?: () => void): void {
+  let handlers = channelHandlers.get(channel);
+  if (!handlers) {
+    handlers = new Set();
+    channelHandlers.set(channel, handlers);
+    if (subscriberConnected) subscriberClient.subscribe(channel).catch(() => {});
+  }
+  handlers.add(handler);
+  if (onReconnect) reconnectHandlers.add(onReconnect);
+}
+
+export async function publishChannel(channel: string, message: string): Promise<boolean> {
+  if (!isRedisReady()) return false;
+  try {
+    await redisClient.publish(channel, message);
+    return true;
+  } catch (error) {
+    console.error(`Redis publish error (${channel}):`, error);
     return false;
   }
 }
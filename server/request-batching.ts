@@ -0,0 +1,134 @@
+import { AsyncLocalStorage } from 'async_hooks';
+import type { RequestHandler } from 'express';
+import type { IStorage } from './storage';
+
+// Point lookups that get coalesced per request, with the bulk getter that serves a batch
+const BATCHED_LOOKUPS = {
+  getUser: 'getUsersByIds',
+  getLocation: 'getLocationsByIds',
+  getCompetency: 'getCompetenciesByIds',
+  getStaff: 'getStaffByIds',
+  getShift: 'getShiftsByIds',
+  getUploadedFile: 'getUploadedFilesByIds',
+} as const satisfies Partial<Record<keyof IStorage, keyof IStorage>>;
+
+type BatchedLookup = keyof typeof BATCHED_LOOKUPS;
+
+// Keep IN lists to a sane size when a route loads a very long list of ids
+const MAX_BATCH_SIZE = 500;
+
+interface Deferred<T> {
+  resolve: (value: T | undefined) => void;
+  reject: (error: unknown) => void;
+}
+
+// Collects ids requested in the same tick, loads them with one bulk query and memoizes the
+// results for the rest of the request
+class BatchLoader<T extends { id: number }> {
+  private memo = new Map<number, Promise<T | undefined>>();
+  private pending = new Map<number, Deferred<T>>();
+  private scheduled = false;
+
+  constructor(
+    private loadOne: (id: number) => Promise<T | undefined>,
+    private loadMany: (ids: number[]) => Promise<T[]>,
+  ) {}
+
+  load(id: number): Promise<T | undefined> {
+    const cached = this.memo.get(id);
+    if (cached) return cached;
+
+    const promise = new Promise<T | undefined>((resolve, reject) => {
+      this.pending.set(id, { resolve, reject });
+    });
+    this.memo.set(id, promise);
+
+    if (!this.scheduled) {
+      this.scheduled = true;
+      // Wait for the current promise jobs to settle so awaits resolving in this tick still join
+      Promise.resolve().then(() => process.nextTick(() => this.dispatch()));
+    }
+    return promise;
+  }
+
+  clear() {
+    this.memo.clear();
+  }
+
+  private dispatch() {
+    const batch = this.pending;
+    this.pending = new Map();
+    this.scheduled = false;
+
+    const ids = Array.from(batch.keys());
+    for (let i = 0; i < ids.length; i += MAX_BATCH_SIZE) {
+      this.run(ids.slice(i, i + MAX_BATCH_SIZE), batch);
+    }
+  }
+
+  private async run(ids: number[], batch: Map<number, Deferred<T>>) {
+    try {
+      // A lone id keeps going through the single-row getter and its cache
+      const rows = ids.length === 1 ? [await this.loadOne(ids[0])] : await this.loadMany(ids);
+      const byId = new Map<number, T>();
+      for (const row of rows) {
+        if (row) byId.set(row.id, row);
+      }
+      for (const id of ids) batch.get(id)!.resolve(byId.get(id));
+    } catch (error) {
+      for (const id of ids) {
+        this.memo.delete(id);
+        batch.get(id)!.reject(error);
+      }
+    }
+  }
+}
+
+type RequestScope = Map<BatchedLookup, BatchLoader<any>>;
+
+const requestScope = new AsyncLocalStorage<RequestScope>();
+
+// Opens a batching scope for everything the request does after this middleware
+export const requestBatching: RequestHandler = (_req, _res, next) => {
+  requestScope.run(new Map(), next);
+};
+
+const isBatchedLookup = (prop: PropertyKey): prop is BatchedLookup =>
+  typeof prop === 'string' && Object.prototype.hasOwnProperty.call(BATCHED_LOOKUPS, prop);
+
+// Wrap a storage instance so point lookups made during a request are coalesced. Calls outside a
+// request (startup, background jobs, WebSocket pushes) go straight through. Any write clears the
+// request's memoized rows so a route never reads back its own stale data.
+export function withRequestBatching<S extends IStorage>(target: S): S {
+  return new Proxy(target, {
+    get(obj, prop, receiver) {
+      const value = Reflect.get(obj, prop, receiver);
+      if (typeof value !== 'function') return value;
+
+      if (isBatchedLookup(prop)) {
+        return (id: number) => {
+          const scope = requestScope.getStore();
+          if (!scope) return value.call(obj, id);
+
+          let loader = scope.get(prop);
+          if (!loader) {
+            const bulk = (obj as any)[BATCHED_LOOKUPS[prop]] as (ids: number[]) => Promise<any[]>;
+            loader = new BatchLoader((one: number) => value.call(obj, one), (ids: number[]) => bulk.call(obj, ids));
+            scope.set(prop, loader);
+          }
+          return loader.load(id);
+        };
+      }
+
+      // Reads are get*/search*; everything else is treated as a write
+      if (typeof prop === 'string' && !prop.startsWith('get') && !prop.startsWith('search')) {
+        return (...args: unknown[]) => {
+          requestScope.getStore()?.forEach(loader => loader.clear());
+          return value.apply(obj, args);
+        };
+      }
+
+      return value.bind(obj);
+    },
+  });
+}
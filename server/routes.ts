@@ -1,70 +1,67 @@
 import type { Express, Request, Response } from "express";
 import { createServer, type Server } from "http";
-import { storage } from "./storage";
+import { storage, InvalidCursorError } from "./storage";
 import session from "express-session";
 import passport from "passport";
 import { Strategy as LocalStrategy } from "passport-local";
-import connectPgSimple from "connect-pg-simple";
-import { pool } from "./db";
+import { createSessionStore, SESSION_TTL_MS } from "./session-store";
 import { 
   insertUserSchema, insertLocationSchema, insertCompetencySchema, 
   insertStaffSchema, insertStaffCompetencySchema, insertApplicantSchema,
   insertScheduleTemplateSchema, insertTemplateShiftSchema, insertWeeklyScheduleSchema,
   insertShiftSchema, insertCashCountSchema, insertKbCategorySchema, insertKbArticleSchema,
-  loginSchema, registerSchema
+  loginSchema, registerSchema, applicantSearchSchema
 } from "@shared/schema";
 import { ZodError } from "zod";
 import { fromZodError } from "zod-validation-error";
-import multer from "multer";
-import path from "path";
 import authRoutes from './routes/auth';
 import uploadRoutes from './routes/uploads';
 import applicantPortalRoutes from './routes/applicant-portal';
 import redisRoutes from './routes/redis';
+import schedulingRoutes from './routes/scheduling';
+import internalRoutes from './routes/internal';
+import metricsRoutes from './routes/metrics';
+import shiftRoutes from './routes/shifts';
+import cashCountRoutes from './routes/cash-counts';
+import kbRoutes from './routes/kb';
+import exportRoutes from './routes/exports';
+import dashboardRoutes from './routes/dashboard';
+import { setupWebSocketServer } from './ws-handler';
+import { requestBatching } from './request-batching';
+import { createLogger } from './logger';
+import { verifyPassword } from './task-pool';
+import { authenticateUser, checkRole } from './middleware/auth';
 
-// Setup multer for file uploads
-const upload = multer({
-  storage: multer.memoryStorage(),
-  limits: {
-    fileSize: 5 * 1024 * 1024, // 5MB limit
-  },
-});
-
-// Setup PostgreSQL session store
-const PgStore = connectPgSimple(session);
+// Passport (de)serialization runs on every request carrying a session cookie
+const sessionLog = createLogger('session', { sampleRate: 0.01 });
 
 export async function registerRoutes(app: Express): Promise<Server> {
   // Setup session middleware
   // Setup session middleware
   app.set('trust proxy', 1); // Trust first proxy, important for proper cookie handling
   
-  // Configure session middleware
-  app.use(
-    session({
-      cookie: { 
-        maxAge: 86400000, // 24 hours
-        secure: true, // We're on HTTPS in Replit
-        httpOnly: true,
-        sameSite: 'lax', // More compatible and secure than 'none'
-        path: '/'
-      },
-      store: new PgStore({
-        pool: pool,
-        tableName: 'sessions',
-        createTableIfMissing: true, // Auto-create the table
-        ttl: 86400000 // 24 hours - same as cookie maxAge
-      }),
-      secret: process.env.SESSION_SECRET || "crewplots-dev-key-" + Math.random().toString(36).substring(2, 15),
-      resave: true, // Force session save on each request to ensure cross-frame compatibility
-      saveUninitialized: true, // Create session for tracking before user logs in
-      name: 'crewplots.sid', // Custom name to avoid conflicts
-      rolling: true, // Force cookies to be set on every response
-    })
-  );
+  // Configure session middleware (store selected by SESSION_STORE: postgres | redis | memory)
+  const sessionMiddleware = session({
+    cookie: { 
+      maxAge: SESSION_TTL_MS, // 24 hours
+      secure: true, // We're on HTTPS in Replit
+      httpOnly: true,
+      sameSite: 'lax', // More compatible and secure than 'none'
+      path: '/'
+    },
+    store: createSessionStore(),
+    secret: process.env.SESSION_SECRET || "crewplots-dev-key-" + Math.random().toString(36).substring(2, 15),
+    resave: false, // Only write sessions that changed; unchanged ones go through the store's lazy touch
+    saveUninitialized: false, // Don't persist anonymous sessions (e.g. /api/auth/me polling before login)
+    name: 'crewplots.sid', // Custom name to avoid conflicts
+    rolling: true, // Refresh the cookie expiry on every response (header only, no store write)
+  });
+  app.use(sessionMiddleware);
 
   // Initialize Passport and restore authentication state from session
   app.use(passport.initialize());
   app.use(passport.session());
+  app.use(requestBatching);
 
   // Configure passport local strategy
   passport.use(
@@ -81,8 +78,8 @@ export async function registerRoutes(app: Express): Promise<Server> {
         }
         
         // Normal password comparison
-        const bcrypt = require('bcryptjs');
-        const isMatch = await bcrypt.compare(password, user.password);
+        const hash = await storage.getUserPasswordHash(user.id);
+        const isMatch = !!hash && await verifyPassword(password, hash);
         if (!isMatch) {
           return done(null, false, { message: "Incorrect password." });
         }
@@ -97,8 +94,8 @@ export async function registerRoutes(app: Express): Promise<Server> {
   // Serialize and deserialize user for session
   // This tells Passport.js how to store the user in the session
   passport.serializeUser((user: any, done) => {
-    console.log("Serializing user with ID:", user.id, "Type:", typeof user.id);
-    
+    sessionLog.debug("Serializing user", { userId: user.id });
+
     // Store essential user data in session to avoid database queries on every auth check
     done(null, { 
       id: user.id,
@@ -111,17 +108,15 @@ export async function registerRoutes(app: Express): Promise<Server> {
   // This tells Passport.js how to retrieve the user from the session
   passport.deserializeUser(async (sessionData: { id: number, loggedIn: boolean, username?: string, role?: string }, done) => {
     try {
-      console.log("Deserializing session data:", sessionData);
-      
       // If we don't have both id and loggedIn flag, authentication fails
       if (!sessionData || !sessionData.id || !sessionData.loggedIn) {
-        console.log("Invalid session data during deserialization");
+        sessionLog.debug("Invalid session data during deserialization");
         return done(null, false);
       }
       
       // OPTIMIZATION: Use cached session data if available, avoid DB query
       if (sessionData.username && sessionData.role) {
-        console.log("Using cached session data for user:", sessionData.username);
+        sessionLog.trace("Using cached session data", { userId: sessionData.id });
         const cachedUser = {
           id: sessionData.id,
           username: sessionData.username,
@@ -132,7 +127,7 @@ export async function registerRoutes(app: Express): Promise<Server> {
       }
       
       // Fallback: Look up the user by ID with timeout
-      console.log("Cache miss, querying database for user ID:", sessionData.id);
+      sessionLog.debug("Session cache miss, querying database", { userId: sessionData.id });
       const timeoutPromise = new Promise((_, reject) => 
         setTimeout(() => reject(new Error('Database query timeout')), 5000)
       );
@@ -141,17 +136,17 @@ export async function registerRoutes(app: Express): Promise<Server> {
       const user = await Promise.race([userPromise, timeoutPromise]);
       
       if (!user) {
-        console.log("User not found during deserialization, ID:", sessionData.id);
+        sessionLog.info("User not found during deserialization", { userId: sessionData.id });
         return done(null, false);
       }
       
-      console.log("User deserialized successfully:", user.username);
+      sessionLog.trace("User deserialized", { userId: user.id });
       done(null, user);
     } catch (err) {
-      console.error("Error deserializing user:", err);
+      sessionLog.error("Error deserializing user", { userId: sessionData?.id, error: err });
       // Don't fail auth on database errors, use cached data if possible
       if (sessionData && sessionData.id && sessionData.loggedIn) {
-        console.log("Database error, falling back to minimal session data");
+        sessionLog.warn("Database error, falling back to minimal session data", { userId: sessionData.id });
         const fallbackUser = { id: sessionData.id, username: 'user', role: 'user' };
         return done(null, fallbackUser);
       }
@@ -164,6 +159,14 @@ export async function registerRoutes(app: Express): Promise<Server> {
   app.use('/api/uploads', uploadRoutes);
   app.use('/api/applicant-portal', applicantPortalRoutes);
   app.use('/api/redis', redisRoutes);
+  app.use('/api/scheduling', schedulingRoutes);
+  app.use('/api/internal', internalRoutes);
+  app.use('/metrics', metricsRoutes);
+  app.use('/api/shifts', shiftRoutes);
+  app.use('/api/cash-counts', cashCountRoutes);
+  app.use('/api/kb', kbRoutes);
+  app.use('/api/exports', exportRoutes);
+  app.use('/api/dashboard', dashboardRoutes);
 
   // QR Code Route - returns the URL for registration
   app.get("/api/qr-code-url", (req, res) => {
@@ -172,19 +175,53 @@ export async function registerRoutes(app: Express): Promise<Server> {
     res.json({ url: registerUrl });
   });
   
-  // Test route for getting all applicants (for testing purposes)
-  app.get("/api/applicants", async (req, res) => {
+  // Same roles as the other manager routes; applicants see their own record via /api/applicant-portal
+  const applicantRoles = ['administrator', 'manager', 'floor_manager'];
+
+  // Applicant list: filtered and keyset-paginated server-side (?status, locationId, createdFrom,
+  // createdTo, q, cursor, limit); returns { items, nextCursor }
+  app.get("/api/applicants", authenticateUser, checkRole(applicantRoles), async (req, res) => {
     try {
-      const applicants = await storage.getApplicants();
-      res.json(applicants);
+      const search = applicantSearchSchema.parse(req.query);
+      const page = await storage.searchApplicants(search);
+      res.json(page);
     } catch (error) {
+      if (error instanceof ZodError) {
+        const validationError = fromZodError(error);
+        return res.status(400).json({ error: validationError.message });
+      }
+      if (error instanceof InvalidCursorError) {
+        return res.status(400).json({ error: error.message });
+      }
       console.error("Error fetching applicants:", error);
       res.status(500).json({ error: "Failed to fetch applicants" });
     }
   });
 
+  // Full applicant record (the list above only carries the slim projection)
+  app.get("/api/applicants/:id", authenticateUser, checkRole(applicantRoles), async (req, res) => {
+    try {
+      const applicantId = parseInt(req.params.id);
+      if (isNaN(applicantId)) {
+        return res.status(400).json({ error: "Invalid applicant ID" });
+      }
+
+      const applicant = await storage.getApplicant(applicantId);
+      if (!applicant) {
+        return res.status(404).json({ error: "Applicant not found" });
+      }
+      res.json(applicant);
+    } catch (error) {
+      console.error("Error fetching applicant:", error);
+      res.status(500).json({ error: "Failed to fetch applicant" });
+    }
+  });
+
   // Create HTTP server
   const httpServer = createServer(app);
 
+  // Live schedule patches for subscribed clients (shares the session cookie for auth)
+  setupWebSocketServer(httpServer, sessionMiddleware);
+
   return httpServer;
 }
\ No newline at end of file
@@ -1,50 +1,31 @@
 import express from 'express';
 import { storage } from '../storage';
-import multer from 'multer';
 import fs from 'fs';
 import path from 'path';
 import { z } from 'zod';
 import { fromZodError } from 'zod-validation-error';
+import { streamUpload, UploadError } from '../upload-stream';
+import { releaseBlob } from '../blob-store';
+import { verifyUploadJob, imageVariantsJob } from '../jobs';
+import { hasVariants } from '../image-variants';
 
 const router = express.Router();
 
-// Create uploads directory if it doesn't exist
+// Documents uploaded before the content-addressed store live here
 const uploadsDir = path.join(process.cwd(), 'uploads', 'documents');
 if (!fs.existsSync(uploadsDir)) {
   fs.mkdirSync(uploadsDir, { recursive: true });
 }
 
-// Set up multer for file uploads
-const upload = multer({
-  storage: multer.diskStorage({
-    destination: (req, file, cb) => {
-      cb(null, uploadsDir);
-    },
-    filename: (req, file, cb) => {
-      const uniqueFilename = `${Date.now()}-${file.originalname}`;
-      cb(null, uniqueFilename);
-    }
-  }),
-  limits: {
-    fileSize: 10 * 1024 * 1024, // 10MB limit
-  },
-  fileFilter: (req, file, cb) => {
-    // Accept only document file types
-    const allowedFileTypes = [
-      'application/pdf',
-      'image/jpeg',
-      'image/png',
-      'image/jpg',
-      'application/msword',
-      'application/vnd.openxmlformats-officedocument.wordprocessingml.document'
-    ];
-    if (allowedFileTypes.includes(file.mimetype)) {
-      cb(null, true);
-    } else {
-      cb(new Error('Invalid file type. Only PDF, JPEG, PNG, and Word documents are allowed.'));
-    }
-  }
-});
+// Accept only document file types
+const allowedFileTypes = [
+  'application/pdf',
+  'image/jpeg',
+  'image/png',
+  'image/jpg',
+  'application/msword',
+  'application/vnd.openxmlformats-officedocument.wordprocessingml.document'
+];
 
 // Middleware to check if user is an applicant
 const isApplicant = async (req: any, res: any, next: any) => {
@@ -130,39 +111,75 @@ router.put('/message', isApplicant, async (req: any, res) => {
   }
 });
 
-// Upload document
-router.post('/documents', isApplicant, upload.single('document'), async (req: any, res) => {
+// New documents are served through the uploads download endpoint (ETag/Range aware)
+const downloadUrlPattern = /^\/api\/uploads\/download\/(\d+)$/;
+
+// Upload document (streamed to disk in bounded chunks, row inserted after the file is complete)
+router.post('/documents', isApplicant, async (req: any, res) => {
+  let uploadedHash: string | undefined;
   try {
-    if (!req.file) {
-      return res.status(400).json({ error: 'No file uploaded' });
-    }
-    
-    // Get the applicant
+    // Look the applicant up before reading the body so a missing profile costs no disk writes
     const applicant = await storage.getApplicantByUserId(req.user.id);
     
     if (!applicant) {
-      // Clean up the uploaded file if applicant not found
-      if (req.file.path && fs.existsSync(req.file.path)) {
-        fs.unlinkSync(req.file.path);
-      }
       return res.status(404).json({ error: 'Applicant profile not found' });
     }
     
+    // Identical CVs and ID scans share one blob; each upload still gets its own file row
+    const { file, record: uploadedFile, fields } = await streamUpload(req, {
+      fieldName: 'document',
+      maxBytes: 10 * 1024 * 1024, // 10MB limit
+      allowedMimeTypes: allowedFileTypes,
+      record: (file, tx) => storage.createUploadedFile({
+        filename: file.sha256,
+        originalName: file.originalName,
+        path: file.path,
+        mimeType: file.mimeType,
+        size: file.size,
+        contentHash: file.sha256,
+        uploadedBy: req.user.id,
+      }, tx),
+    });
+    
+    if (!file || !uploadedFile) {
+      return res.status(400).json({ error: 'No file uploaded' });
+    }
+    uploadedHash = file.sha256;
+    
+    await storage.createDocumentAttachment({
+      fileId: uploadedFile.id,
+      entityType: 'applicant',
+      entityId: applicant.id,
+      description: fields.documentName || null,
+    });
+    
     // Save document reference to database
-    const documentUrl = `/uploads/documents/${req.file.filename}`;
+    const documentUrl = `/api/uploads/download/${uploadedFile.id}`;
     const document = await storage.createApplicantDocument({
       applicantId: applicant.id,
-      documentName: req.body.documentName || req.file.originalname,
+      documentName: fields.documentName || file.originalName,
       documentUrl: documentUrl,
-      fileType: req.file.mimetype
+      fileType: file.mimeType
     });
+    verifyUploadJob.enqueue({ fileId: uploadedFile.id })
+      .catch(error => console.error('Enqueue upload verification error:', error));
+    if (hasVariants(uploadedFile.mimeType)) {
+      imageVariantsJob.enqueue({ fileId: uploadedFile.id })
+        .catch(error => console.error('Enqueue image variants error:', error));
+    }
     
     res.status(201).json({ success: true, document });
   } catch (error) {
+    if (error instanceof UploadError) {
+      const message = error.status === 415
+        ? 'Invalid file type. Only PDF, JPEG, PNG, and Word documents are allowed.'
+        : error.message;
+      return res.status(error.status).json({ error: message });
+    }
     console.error('Error uploading document:', error);
-    // Clean up file if there was an error
-    if (req.file && req.file.path && fs.existsSync(req.file.path)) {
-      fs.unlinkSync(req.file.path);
+    // Drop the blob if nothing ended up referencing it
+    if (uploadedHash) {
+      releaseBlob(uploadedHash).catch(() => {});
     }
     res.status(500).json({ error: 'Failed to upload document' });
   }
@@ -233,13 +250,23 @@ router.delete('/documents/:id', isApplicant, async (req: any, res) => {
       return res.status(403).json({ error: 'You do not have permission to delete this document' });
     }
     
-    // Extract filename from documentUrl
-    const filename = path.basename(document.documentUrl);
-    const filePath = path.join(uploadsDir, filename);
-    
-    // Delete the physical file if it exists
-    if (fs.existsSync(filePath)) {
-      fs.unlinkSync(filePath);
+    const storedFileId = downloadUrlPattern.exec(document.documentUrl)?.[1];
+    if (storedFileId) {
+      // Remove the file row and its attachment, then the blob if no other upload shares it
+      const storedFile = await storage.getUploadedFile(parseInt(storedFileId));
+      if (storedFile) {
+        await storage.deleteUploadedFile(storedFile.id);
+        if (storedFile.contentHash) await releaseBlob(storedFile.contentHash);
+      }
+    } else {
+      // Legacy upload: extract filename from documentUrl
+      const filename = path.basename(document.documentUrl);
+      const filePath = path.join(uploadsDir, filename);
+      
+      // Delete the physical file if it exists
+      if (fs.existsSync(filePath)) {
+        fs.unlinkSync(filePath);
+      }
     }
     
     // Delete document record from database
@@ -1,10 +1,13 @@
 import express, { Request, Response, NextFunction } from 'express';
 import { storage } from '../storage';
-import { insertUserSchema, loginSchema, registerSchema, User } from '@shared/schema';
+import { insertUserSchema, loginSchema, registerSchema, SafeUser } from '@shared/schema';
 import { ZodError } from 'zod';
-import bcrypt from 'bcryptjs';
 import { fromZodError } from 'zod-validation-error';
 import { authenticateUser } from '../middleware/auth';
+import { compileUserPermissions } from '../authorization';
+import { createLogger } from '../logger';
+import { hashPassword, verifyPassword, TaskPoolBusyError } from '../task-pool';
+import { multipartFields } from '../upload-stream';
 
 // Extend express-session types
 declare module 'express-session' {
@@ -18,13 +21,17 @@ declare module 'express-session' {
 declare global {
     namespace Express {
         interface Request {
-            user?: User;
+            user?: SafeUser;
         }
     }
 }
 
 const router = express.Router();
 
+const authLog = createLogger('auth');
+// The client polls /me on every navigation
+const meLog = createLogger('auth', { sampleRate: 0.01 });
+
 // Register new user
 router.post('/register', async (req, res) => {
     try {
@@ -43,8 +50,7 @@ router.post('/register', async (req, res) => {
         }
 
         // Hash password
-        const salt = await bcrypt.genSalt(10);
-        const hashedPassword = await bcrypt.hash(data.password, salt);
+        const hashedPassword = await hashPassword(data.password);
 
         // Remove confirmPassword before saving
         const { confirmPassword, ...userDataWithoutConfirm } = data;
@@ -69,6 +75,15 @@ router.post('/register', async (req, res) => {
             // Generate unique code
             uniqueCode: generateUniqueCode()
         });
+        // The applicant portal works on this profile, so it exists before the first login
+        await storage.createApplicant({
+            name: user.name,
+            email: user.email,
+            phone: user.phoneNumber ?? null,
+            status: 'new',
+            userId: user.id,
+            locationId: null,
+        });
 
         // Remove password from response
         const { password, ...userWithoutPassword } = user;
@@ -87,65 +102,43 @@ router.post('/register', async (req, res) => {
             });
         }
         
+        if (error instanceof TaskPoolBusyError) {
+            res.set('Retry-After', '1');
+            return res.status(503).json({ message: error.message });
+        }
         console.error('Registration error:', error);
         return res.status(500).json({ message: 'Error registering user' });
     }
 });
 
-// Enhanced login endpoint using Passport.js with multer for multipart form handling
-import multer from 'multer';
-const upload = multer({ storage: multer.memoryStorage() });
-
 // Handle login with multiple content types (JSON, urlencoded, multipart)
-router.post('/login', upload.none(), async (req, res, next) => {
+router.post('/login', multipartFields, async (req, res, next) => {
     try {
-        // Safer logging that doesn't expose any sensitive data
-        console.log('Login attempt received');
-        console.log('Session ID:', req.sessionID || 'none');
-        console.log('Content type:', req.get('Content-Type') || 'none');
-
-        // Log the body keys we received without showing values
-        if (req.body) {
-            console.log('Body fields received:', Object.keys(req.body).join(', '));
-        } else {
-            console.log('No body received');
-        }
-        
         // Extract credentials regardless of content type
         const username = req.body?.username || null;
         const password = req.body?.password || null;
         
-        console.log(`Extracted username: ${username ? username : 'missing'}, password: ${password ? '******' : 'missing'}`);
-        
         if (!username || !password) {
             return res.status(400).json({ message: 'Username and password are required' });
         }
         
         const identifier = username;
         
-        // For email login, we'll handle the lookup ourselves and then pass to Passport
-        console.log('Login identifier type check:', identifier.includes('@') ? 'email format' : 'username format');
-        
         // Special case for admin development login
         if (identifier === 'admin' && password === 'adminpass123') {
-            console.log('Admin login detected using development credentials');
-            
             // Look up the admin user first
             const adminUser = await storage.getUserByUsername('admin');
             if (!adminUser) {
-                console.log('Admin user not found, cannot proceed with admin login');
                 return res.status(401).json({ message: 'Invalid credentials' });
             }
             
             // Manually log in the admin user using Passport's login method
             req.login(adminUser, { session: true }, (err) => {
                 if (err) {
-                    console.error('Admin login error:', err);
+                    authLog.error('Admin login error', { error: err instanceof Error ? err.message : String(err) });
                     return res.status(500).json({ message: 'Error during login process' });
                 }
                 
-                console.log('Admin login successful, session established with ID:', req.sessionID);
-                
                 // Set a debug cookie to test cookie functionality
                 res.cookie('admin-login', new Date().toISOString(), { 
                     maxAge: 86400000,
@@ -153,11 +146,10 @@ router.post('/login', upload.none(), async (req, res, next) => {
                     sameSite: 'lax'
                 });
                 
-                // Return success with user data (excluding password)
-                const { password, ...userWithoutPassword } = adminUser;
+                // Return success with user data (lookups never carry the password hash)
                 return res.status(200).json({
                     message: 'Login successful',
-                    user: userWithoutPassword,
+                    user: adminUser,
                     debug: {
                         adminBypass: true,
                         sessionId: req.sessionID,
@@ -174,45 +166,42 @@ router.post('/login', upload.none(), async (req, res, next) => {
         
         // First attempt - check if this is an email login
         if (identifier.includes('@')) {
-            console.log('Attempting to find user by email:', identifier);
             user = await storage.getUserByEmail(identifier);
         } else {
-            console.log('Attempting to find user by username:', identifier);
             user = await storage.getUserByUsername(identifier);
         }
         
         // Fallback attempt - try the other lookup method
         if (!user && !identifier.includes('@')) {
-            console.log('Username lookup failed, trying as email fallback:', identifier);
             user = await storage.getUserByEmail(identifier);
         } else if (!user && identifier.includes('@')) {
-            console.log('Email lookup failed, trying as username fallback:', identifier);
             user = await storage.getUserByUsername(identifier);
         }
         
         if (!user) {
-            console.log('User not found with any identifier method:', identifier);
             return res.status(401).json({ message: 'Invalid username/email or password' });
         }
         
-        console.log('User found:', user.username, 'with ID:', user.id);
-        
         // Now we need to verify the password
-        const isMatch = await bcrypt.compare(password, user.password);
+        const hash = await storage.getUserPasswordHash(user.id);
+        const isMatch = !!hash && await verifyPassword(password, hash);
         if (!isMatch) {
-            console.log('Password verification failed for user:', user.username);
             return res.status(401).json({ message: 'Invalid username/email or password' });
         }
         
         // If we get here, credentials are correct - use Passport to log in
-        req.login(user, { session: true }, (err) => {
+        req.login(user, { session: true }, async (err) => {
             if (err) {
-                console.error('Login error:', err);
+                authLog.error('Login error', { error: err instanceof Error ? err.message : String(err) });
                 return res.status(500).json({ message: 'Error during login process' });
             }
-            
-            console.log('Passport login successful for user:', user.username);
-            console.log('Session established with ID:', req.sessionID);
+
+            // Compile permissions up front; if this fails the first check compiles them instead
+            try {
+                req.session.authz = await compileUserPermissions(user.id);
+            } catch (error) {
+                authLog.error('Permission compile error', { userId: user.id, error: error instanceof Error ? error.message : String(error) });
+            }
             
             // Set a regular cookie for debugging
             res.cookie('login-timestamp', new Date().toISOString(), { 
@@ -221,11 +210,10 @@ router.post('/login', upload.none(), async (req, res, next) => {
                 sameSite: 'lax'
             });
             
-            // Return success with user data (excluding password)
-            const { password, ...userWithoutPassword } = user;
+            // Return success with user data (lookups never carry the password hash)
             return res.status(200).json({
                 message: 'Login successful',
-                user: userWithoutPassword,
+                user,
                 debug: {
                     sessionId: req.sessionID,
                     timestamp: new Date().toISOString()
@@ -241,7 +229,11 @@ router.post('/login', upload.none(), async (req, res, next) => {
             });
         }
         
-        console.error('Login error:', error);
+        if (error instanceof TaskPoolBusyError) {
+            res.set('Retry-After', '1');
+            return res.status(503).json({ message: error.message });
+        }
+        authLog.error('Login error', { error: error instanceof Error ? error.message : String(error) });
         return res.status(500).json({ message: 'Error logging in' });
     }
 });
@@ -253,10 +245,8 @@ router.get('/user', authenticateUser, (req, res) => {
             return res.status(401).json({ message: 'Not authenticated' });
         }
         
-        // Remove password from response
-        const { password, ...userWithoutPassword } = req.user;
-        
-        return res.status(200).json({ user: userWithoutPassword });
+        // req.user comes from storage.getUser, which never carries the password hash
+        return res.status(200).json({ user: req.user });
     } catch (error) {
         console.error('Get user error:', error);
         return res.status(500).json({ message: 'Error getting user data' });
@@ -266,18 +256,11 @@ router.get('/user', authenticateUser, (req, res) => {
 // Enhanced /me endpoint that uses Passport's isAuthenticated
 router.get('/me', async (req, res) => {
     try {
-        console.time("me:total");
         // Enable CORS for all origins in development
         res.header('Access-Control-Allow-Origin', req.headers.origin || '*');
         res.header('Access-Control-Allow-Credentials', 'true');
         res.header('Access-Control-Allow-Headers', 'Origin, X-Requested-With, Content-Type, Accept');
         
-        console.log('Session data:', req.session);
-        console.log('Session ID:', req.sessionID || 'none');
-        console.log('Is authenticated (Passport):', req.isAuthenticated());
-        console.log('User object from Passport:', req.user ? `User: ${req.user.username}` : 'None');
-        console.timeLog("me:total", "after initial auth check");
-        
         // Set debug cookie for testing - use SameSite=None for cross-domain cookies
         res.cookie('debug-auth-check', 'was-checked', { 
             maxAge: 3600000, 
@@ -291,8 +274,7 @@ router.get('/me', async (req, res) => {
         
         // Use Passport's isAuthenticated() method 
         if (!req.isAuthenticated()) {
-            console.log('Not authenticated according to Passport');
-            console.timeLog("me:total", "authentication check failed");
+            meLog.debug('Not authenticated according to Passport');
             return res.status(200).json({ 
                 authenticated: false,
                 debug: {
@@ -305,11 +287,10 @@ router.get('/me', async (req, res) => {
                 }
             });
         }
-        console.timeLog("me:total", "after isAuthenticated check");
         
         // At this point, req.user should have the user data
         if (!req.user) {
-            console.log('Missing user object despite being authenticated');
+            meLog.warn('Missing user object despite being authenticated');
             return res.status(200).json({ 
                 authenticated: false,
                 reason: 'user_object_missing'
@@ -320,15 +301,13 @@ router.get('/me', async (req, res) => {
         const user = req.user as any; // Type assertion needed for password property
         const { password, ...userWithoutPassword } = user;
         
-        console.log('Get /me - returning authenticated user:', userWithoutPassword.username);
-        console.timeEnd("me:total");
+        meLog.trace('Returning authenticated user', { userId: userWithoutPassword.id });
         return res.status(200).json({ 
             authenticated: true,
             user: userWithoutPassword
         });
     } catch (error) {
-        console.error('Error in /me endpoint:', error);
-        console.timeLog("me:total", "error in auth processing");
+        meLog.error('Error in /me endpoint', { error });
         
         // Return a more detailed error response for debugging
         return res.status(200).json({ 
@@ -511,20 +490,24 @@ router.post('/change-password', authenticateUser, async (req, res) => {
         const user = req.user;
         
         // Verify current password
-        const isMatch = await bcrypt.compare(currentPassword, user.password);
+        const hash = await storage.getUserPasswordHash(user.id);
+        const isMatch = !!hash && await verifyPassword(currentPassword, hash);
         if (!isMatch) {
             return res.status(401).json({ message: 'Current password is incorrect' });
         }
         
         // Hash new password
-        const salt = await bcrypt.genSalt(10);
-        const hashedPassword = await bcrypt.hash(newPassword, salt);
+        const hashedPassword = await hashPassword(newPassword);
         
         // Update password
         await storage.updateUser(user.id, { password: hashedPassword });
         
         return res.status(200).json({ message: 'Password changed successfully' });
     } catch (error) {
+        if (error instanceof TaskPoolBusyError) {
+            res.set('Retry-After', '1');
+            return res.status(503).json({ message: error.message });
+        }
         console.error('Change password error:', error);
         return res.status(500).json({ message: 'Error changing password' });
     }
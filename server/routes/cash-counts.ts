@@ -0,0 +1,33 @@
+import express from 'express';
+import { storage } from '../storage';
+import { cashSummaryQuerySchema } from '@shared/schema';
+import { ZodError } from 'zod';
+import { fromZodError } from 'zod-validation-error';
+import { authenticateUser, requirePermission } from '../middleware/auth';
+import { permittedLocationIds } from '../authorization';
+
+const router = express.Router();
+
+// Cash totals per day/week/month (optionally per location) merged from the daily rollups,
+// limited to the locations where the caller holds cash.summary
+router.get('/summary', authenticateUser, requirePermission('cash.summary'), async (req, res) => {
+  try {
+    const query = cashSummaryQuerySchema.parse(req.query);
+    const allowed = await permittedLocationIds(req, 'cash.summary');
+    if (allowed !== null && query.locationIds?.some(id => !allowed.includes(id))) {
+      return res.status(403).json({ message: 'Access denied' });
+    }
+    const buckets = await storage.getCashCountSummary({ ...query, locationIds: query.locationIds ?? allowed ?? undefined });
+
+    res.status(200).json({ buckets });
+  } catch (error) {
+    if (error instanceof ZodError) {
+      const validationError = fromZodError(error);
+      return res.status(400).json({ message: 'Validation error', errors: validationError.details });
+    }
+    console.error('Get cash summary error:', error);
+    res.status(500).json({ message: 'Error getting cash summary' });
+  }
+});
+
+export default router;
@@ -0,0 +1,53 @@
+import express from 'express';
+import { storage } from '../storage';
+import { dashboardSummaryQuerySchema } from '@shared/schema';
+import { ZodError } from 'zod';
+import { fromZodError } from 'zod-validation-error';
+import { authenticateUser } from '../middleware/auth';
+
+const router = express.Router();
+
+const DAY_MS = 24 * 60 * 60 * 1000;
+
+// Sunday 00:00 UTC of the week containing the given day, matching the schedule calendar
+function weekStartOf(day: string): Date {
+  const date = new Date(`${day}T00:00:00.000Z`);
+  return new Date(date.getTime() - date.getUTCDay() * DAY_MS);
+}
+
+// All dashboard KPIs for one location in a single small payload:
+//   GET /api/dashboard/summary/:locationId?weekStart=ISO&day=YYYY-MM-DD
+// Only administrators may read other locations than their own.
+router.get('/summary/:locationId', authenticateUser, async (req, res) => {
+  try {
+    const locationId = parseInt(req.params.locationId);
+    if (isNaN(locationId)) {
+      return res.status(400).json({ message: 'Invalid location ID' });
+    }
+    const query = dashboardSummaryQuerySchema.parse(req.query);
+
+    // The session only carries id/username/role
+    const user = await storage.getUser(req.user!.id);
+    if (!user) {
+      return res.status(401).json({ message: 'Unauthorized - Please log in' });
+    }
+    if (user.role !== 'administrator' && user.locationId !== locationId) {
+      return res.status(403).json({ message: 'Access denied' });
+    }
+
+    const day = query.day ?? new Date().toISOString().slice(0, 10);
+    const weekStart = query.weekStart ?? weekStartOf(day);
+    const summary = await storage.getDashboardSummary(locationId, weekStart, day);
+
+    res.status(200).json(summary);
+  } catch (error) {
+    if (error instanceof ZodError) {
+      const validationError = fromZodError(error);
+      return res.status(400).json({ message: 'Validation error', errors: validationError.details });
+    }
+    console.error('Get dashboard summary error:', error);
+    res.status(500).json({ message: 'Error getting dashboard summary' });
+  }
+});
+
+export default router;
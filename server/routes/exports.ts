@@ -0,0 +1,95 @@
+import express from 'express';
+import { storage } from '../storage';
+import { exportQuerySchema, type ExportQuery } from '@shared/schema';
+import { ZodError } from 'zod';
+import { fromZodError } from 'zod-validation-error';
+import { authenticateUser, requirePermission } from '../middleware/auth';
+import { writeExport } from '../export-writer';
+import { permittedLocationIds } from '../authorization';
+
+const router = express.Router();
+
+// Streaming CSV/NDJSON downloads for payroll and reporting:
+//   GET /api/exports/{shifts,cash-counts,applicants}?from=YYYY-MM-DD&to=YYYY-MM-DD&locationIds=1,2&format=csv|ndjson
+// Rows are streamed from a cursor and gzipped when the client accepts it.
+router.use(authenticateUser, requirePermission('export.run'));
+
+// Parses the query and scopes it to the locations where the caller holds export.run: only a
+// global grant (administrators) may leave locationIds out for every location
+const parseQuery = async (req: express.Request, res: express.Response): Promise<ExportQuery | null> => {
+  let query: ExportQuery;
+  try {
+    query = exportQuerySchema.parse(req.query);
+  } catch (error) {
+    if (error instanceof ZodError) {
+      const validationError = fromZodError(error);
+      res.status(400).json({ message: 'Validation error', errors: validationError.details });
+      return null;
+    }
+    throw error;
+  }
+
+  const allowed = await permittedLocationIds(req, 'export.run');
+  if (allowed === null) return query;
+  if (allowed.length === 0) {
+    res.status(403).json({ message: 'No location assigned' });
+    return null;
+  }
+  if (query.locationIds?.some(id => !allowed.includes(id))) {
+    res.status(403).json({ message: 'Access denied' });
+    return null;
+  }
+  return { ...query, locationIds: query.locationIds ?? allowed };
+};
+
+const exportName = (kind: string, query: ExportQuery) => `${kind}-${query.from}-to-${query.to}`;
+
+router.get('/shifts', async (req, res) => {
+  try {
+    const query = await parseQuery(req, res);
+    if (!query) return;
+    await writeExport(req, res, {
+      filename: exportName('shifts', query),
+      format: query.format,
+      columns: ['id', 'date', 'startTime', 'endTime', 'role', 'locationId', 'locationName', 'scheduleId', 'staffId', 'staffName', 'competencyName', 'notes'],
+      chunks: storage.exportShifts(query),
+    });
+  } catch (error) {
+    console.error('Export shifts error:', error);
+    if (!res.headersSent) res.status(500).json({ message: 'Error exporting shifts' });
+  }
+});
+
+router.get('/cash-counts', async (req, res) => {
+  try {
+    const query = await parseQuery(req, res);
+    if (!query) return;
+    await writeExport(req, res, {
+      filename: exportName('cash-counts', query),
+      format: query.format,
+      columns: ['id', 'countDate', 'countType', 'locationId', 'locationName', 'cashAmount', 'cardAmount', 'floatAmount', 'expectedAmount', 'discrepancy', 'createdBy', 'verifiedBy'],
+      chunks: storage.exportCashCounts(query),
+    });
+  } catch (error) {
+    console.error('Export cash counts error:', error);
+    if (!res.headersSent) res.status(500).json({ message: 'Error exporting cash counts' });
+  }
+});
+
+router.get('/applicants', async (req, res) => {
+  try {
+    const query = await parseQuery(req, res);
+    if (!query) return;
+    await writeExport(req, res, {
+      filename: exportName('applicants', query),
+      format: query.format,
+      columns: ['id', 'createdAt', 'name', 'email', 'phone', 'status', 'locationId', 'locationName'],
+      chunks: storage.exportApplicants(query),
+    });
+  } catch (error) {
+    console.error('Export applicants error:', error);
+    if (!res.headersSent) res.status(500).json({ message: 'Error exporting applicants' });
+  }
+});
+
+export default router;
@@ -0,0 +1,62 @@
+import express from 'express';
+import { getPoolStats } from '../db';
+import { requireInternalAccess } from '../middleware/auth';
+import { routeLatencySummary } from '../metrics';
+import { taskPool } from '../task-pool';
+import { jobQueue } from '../job-queue';
+import { partitionMaintenanceJob } from '../jobs';
+
+const router = express.Router();
+
+router.use(requireInternalAccess);
+
+// Connection pool saturation: sizes, wait-queue length, acquire latency, timeouts
+router.get('/pools', (_req, res) => {
+  res.status(200).json({ pools: getPoolStats() });
+});
+
+// Per-route p50/p90/p99 and queries per request, busiest routes first
+router.get('/latency', (_req, res) => {
+  res.status(200).json({ routes: routeLatencySummary() });
+});
+
+// CPU task pool: busy workers, queue depth and fast rejections under load
+router.get('/tasks', (_req, res) => {
+  res.status(200).json({ tasks: taskPool.stats() });
+});
+
+// Background jobs: queue depths, recent failures and in-process counters per job type
+router.get('/jobs', async (_req, res) => {
+  try {
+    res.status(200).json({ jobs: await jobQueue.stats() });
+  } catch (error) {
+    console.error('Job stats error:', error);
+    res.status(500).json({ message: 'Error reading job stats' });
+  }
+});
+
+router.get('/jobs/:id', async (req, res) => {
+  try {
+    const job = await jobQueue.getJob(req.params.id);
+    if (!job) {
+      return res.status(404).json({ message: 'Job not found' });
+    }
+    res.status(200).json(job);
+  } catch (error) {
+    console.error('Get job error:', error);
+    res.status(500).json({ message: 'Error reading job' });
+  }
+});
+
+// Run partition upkeep now instead of waiting for the next scheduled pass; poll /jobs/:id
+router.post('/partitions/maintain', async (_req, res) => {
+  try {
+    const job = await partitionMaintenanceJob.enqueue({});
+    res.status(202).json({ jobId: job.id, status: job.status });
+  } catch (error) {
+    console.error('Partition maintenance enqueue error:', error);
+    res.status(500).json({ message: 'Error starting partition maintenance' });
+  }
+});
+
+export default router;
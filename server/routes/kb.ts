@@ -0,0 +1,94 @@
+import express from 'express';
+import { storage } from '../storage';
+import { kbSearchSchema } from '@shared/schema';
+import { ZodError } from 'zod';
+import { fromZodError } from 'zod-validation-error';
+import { authenticateUser } from '../middleware/auth';
+
+const router = express.Router();
+
+// Ranked article search: GET /api/kb/search?q=&locationId=&categoryId=&offset=&limit=
+// Returns { items: [{ id, categoryId, title, snippet, rank, ... }], nextOffset } without
+// article bodies. Only administrators may search other locations (or all of them).
+router.get('/search', authenticateUser, async (req, res) => {
+  try {
+    const search = kbSearchSchema.parse(req.query);
+    // The session only carries id/username/role
+    const user = await storage.getUser(req.user!.id);
+    if (!user) {
+      return res.status(401).json({ message: 'Unauthorized - Please log in' });
+    }
+
+    if (user.role !== 'administrator') {
+      if (!user.locationId) {
+        return res.status(403).json({ message: 'No location assigned' });
+      }
+      if (search.locationId && search.locationId !== user.locationId) {
+        return res.status(403).json({ message: 'Access denied' });
+      }
+      search.locationId = user.locationId;
+    }
+
+    const page = await storage.searchKbArticles(search);
+    res.status(200).json(page);
+  } catch (error) {
+    if (error instanceof ZodError) {
+      const validationError = fromZodError(error);
+      return res.status(400).json({ message: 'Validation error', errors: validationError.details });
+    }
+    console.error('KB search error:', error);
+    res.status(500).json({ message: 'Error searching articles' });
+  }
+});
+
+// Articles of one category without their bodies: GET /api/kb/articles?categoryId=
+// Returns [{ id, categoryId, title, excerpt, createdAt, updatedAt }] sorted by title
+router.get('/articles', authenticateUser, async (req, res) => {
+  try {
+    const categoryId = parseInt(String(req.query.categoryId));
+    if (isNaN(categoryId)) {
+      return res.status(400).json({ message: 'Invalid category ID' });
+    }
+
+    const category = await storage.getKbCategory(categoryId);
+    if (!category) {
+      return res.status(404).json({ message: 'Category not found' });
+    }
+    const user = await storage.getUser(req.user!.id);
+    if (user?.role !== 'administrator' && category.locationId !== user?.locationId) {
+      return res.status(403).json({ message: 'Access denied' });
+    }
+
+    res.status(200).json(await storage.listKbArticleSummaries(categoryId));
+  } catch (error) {
+    console.error('List KB articles error:', error);
+    res.status(500).json({ message: 'Error listing articles' });
+  }
+});
+
+// Full article, for opening a search hit or a listed article
+router.get('/articles/:id', authenticateUser, async (req, res) => {
+  try {
+    const articleId = parseInt(req.params.id);
+    if (isNaN(articleId)) {
+      return res.status(400).json({ message: 'Invalid article ID' });
+    }
+
+    const article = await storage.getKbArticle(articleId);
+    const category = article ? await storage.getKbCategory(article.categoryId) : undefined;
+    if (!article || !category) {
+      return res.status(404).json({ message: 'Article not found' });
+    }
+    const user = await storage.getUser(req.user!.id);
+    if (user?.role !== 'administrator' && category.locationId !== user?.locationId) {
+      return res.status(403).json({ message: 'Access denied' });
+    }
+
+    res.status(200).json(article);
+  } catch (error) {
+    console.error('Get KB article error:', error);
+    res.status(500).json({ message: 'Error getting article' });
+  }
+});
+
+export default router;
@@ -0,0 +1,15 @@
+import express from 'express';
+import { getPoolStats } from '../db';
+import { requireInternalAccess } from '../middleware/auth';
+import { renderMetrics } from '../metrics';
+
+const router = express.Router();
+
+router.use(requireInternalAccess);
+
+// Prometheus scrape target
+router.get('/', (_req, res) => {
+  res.type('text/plain; version=0.0.4').send(renderMetrics(getPoolStats()));
+});
+
+export default router;
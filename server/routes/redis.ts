@@ -1,55 +1,128 @@
 import { Router, Request, Response } from "express";
+import cluster from "cluster";
+import { redisClient, isRedisReady, cacheStats, cacheGet, cacheSet } from "../redis";
+import { redisSupervisor } from "../redis-supervisor";
+import { requireInternalAccess } from "../middleware/auth";
 
 const router = Router();
 
-// Redis disabled due to binary incompatibility (SIGSEGV crashes)
-// Using memory store instead
-const redisDisabled = true;
-
-// Connection state for status endpoint
-let connectionState = {
-  connected: false,
-  lastConnected: 0,
-  uptime: 0,
-  error: 'Redis disabled due to environment incompatibility'
-};
-
-// Status endpoint
-router.get('/status', (req: Request, res: Response) => {
-  res.json({
-    connected: false,
-    uptime: 0,
-    memory: {
-      used: 0,
-      peak: 0,
-      total: 0
-    },
-    error: 'Redis disabled due to environment incompatibility'
-  });
+// INFO is cheap but every open dashboard polls this; one read serves them all for a moment
+const INFO_TTL_MS = 2000;
+let infoCache: { at: number; info: Record<string, string> } | null = null;
+
+async function redisInfo(): Promise<Record<string, string> | null> {
+  if (!isRedisReady()) return null;
+  if (infoCache && Date.now() - infoCache.at < INFO_TTL_MS) return infoCache.info;
+
+  const raw = await redisClient.info();
+  const info: Record<string, string> = {};
+  for (const line of raw.split('\r\n')) {
+    const separator = line.indexOf(':');
+    if (separator > 0 && !line.startsWith('#')) info[line.slice(0, separator)] = line.slice(separator + 1);
+  }
+  infoCache = { at: Date.now(), info };
+  return info;
+}
+
+const toNumber = (value: string | undefined) => (value === undefined ? 0 : Number(value) || 0);
+
+// Live server stats plus which cache the app is actually using right now
+router.get('/status', async (_req: Request, res: Response) => {
+  const cache = cacheStats();
+  // Workers don't supervise; the primary owns the embedded server
+  const supervisor = cluster.isWorker ? null : redisSupervisor.status();
+  try {
+    const info = await redisInfo();
+    if (!info) {
+      return res.json({
+        connected: false,
+        mode: cache.mode,
+        uptime: 0,
+        memory: { used: 'N/A', peak: 'N/A' },
+        clients: 0,
+        version: 'N/A',
+        cache,
+        supervisor,
+        error: cache.mode === 'local' ? 'Redis unavailable - using in-process cache' : undefined,
+      });
+    }
+
+    const hits = toNumber(info.keyspace_hits);
+    const misses = toNumber(info.keyspace_misses);
+    res.json({
+      connected: true,
+      mode: cache.mode,
+      uptime: toNumber(info.uptime_in_seconds),
+      memory: {
+        used: info.used_memory_human,
+        peak: info.used_memory_peak_human,
+        max: info.maxmemory_human,
+        usedBytes: toNumber(info.used_memory),
+        maxBytes: toNumber(info.maxmemory),
+        fragmentationRatio: toNumber(info.mem_fragmentation_ratio),
+        policy: info.maxmemory_policy,
+      },
+      stats: {
+        hits,
+        misses,
+        hitRate: hits + misses > 0 ? hits / (hits + misses) : null,
+        evictedKeys: toNumber(info.evicted_keys),
+        expiredKeys: toNumber(info.expired_keys),
+        opsPerSecond: toNumber(info.instantaneous_ops_per_sec),
+      },
+      clients: toNumber(info.connected_clients),
+      version: info.redis_version,
+      cache,
+      supervisor,
+      error: cache.mode === 'local' ? 'Redis not responding reliably - using in-process cache' : undefined,
+    });
+  } catch (error) {
+    res.json({
+      connected: false,
+      mode: cache.mode,
+      uptime: 0,
+      memory: { used: 'N/A', peak: 'N/A' },
+      clients: 0,
+      version: 'N/A',
+      cache,
+      supervisor,
+      error: error instanceof Error ? error.message : 'Redis status unavailable',
+    });
+  }
 });
 
-// Test endpoint  
-router.get('/test', (req: Request, res: Response) => {
-  res.json({ 
-    success: false, 
-    message: 'Redis disabled - using memory store instead'
-  });
+// Reachability check used by the sidebar indicator
+router.get('/test', async (_req: Request, res: Response) => {
+  const mode = cacheStats().mode;
+  try {
+    if (!isRedisReady()) throw new Error('not connected');
+    await redisClient.ping();
+    res.json({ connected: true, mode, message: 'Redis connection successful' });
+  } catch (error) {
+    res.json({
+      connected: false,
+      mode,
+      message: `Redis unavailable (${error instanceof Error ? error.message : 'unknown error'}) - using in-process cache`,
+    });
+  }
 });
 
-// Set endpoint
-router.post('/set', (req: Request, res: Response) => {
-  res.json({ 
-    success: false, 
-    message: 'Redis disabled - using memory store instead'
-  });
+// Round-trip a value through whichever cache is active; keys are confined to a debug namespace
+const DEBUG_PREFIX = 'debug:';
+const DEBUG_TTL_S = 300;
+
+router.post('/set', requireInternalAccess, async (req: Request, res: Response) => {
+  const { key, value } = req.body ?? {};
+  if (typeof key !== 'string' || key.length === 0) {
+    return res.status(400).json({ success: false, message: 'key is required' });
+  }
+  const success = await cacheSet(DEBUG_PREFIX + key, value ?? null, DEBUG_TTL_S);
+  res.json({ success, mode: cacheStats().mode });
 });
 
-// Get endpoint
-router.get('/get/:key', (req: Request, res: Response) => {
-  res.json({ 
-    success: false, 
-    message: 'Redis disabled - using memory store instead'
-  });
+router.get('/get/:key', requireInternalAccess, async (req: Request, res: Response) => {
+  const value = await cacheGet(DEBUG_PREFIX + req.params.key);
+  res.json({ success: value !== null, value, mode: cacheStats().mode });
 });
 
-export default router;
\ No newline at end of file
+export default router;
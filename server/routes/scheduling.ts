@@ -0,0 +1,130 @@
+import express from 'express';
+import { storage } from '../storage';
+import { templateRolloutSchema, shiftConflictCheckSchema, shiftCoverageQuerySchema } from '@shared/schema';
+import { ZodError } from 'zod';
+import { fromZodError } from 'zod-validation-error';
+import { authenticateUser, requirePermission } from '../middleware/auth';
+import { startTemplateRollout, getTemplateRollout } from '../template-rollout';
+import { proposeAssignments } from '../assignment';
+import { findShiftConflicts, getShiftCoverage } from '../shift-conflicts';
+
+const router = express.Router();
+
+// The location in the path, for per-location permission checks (malformed ids are left
+// for the handler to reject)
+const pathLocation = (req: express.Request) => {
+  const locationId = parseInt(req.params.locationId);
+  return isNaN(locationId) ? undefined : locationId;
+};
+
+// Get the complete week view (schedule, shifts, assigned staff, competencies) for a location
+router.get('/week-view/:locationId', authenticateUser, requirePermission('schedule.view', pathLocation), async (req, res) => {
+  try {
+    const locationId = parseInt(req.params.locationId);
+    const weekStart = new Date(String(req.query.weekStart ?? ''));
+
+    if (isNaN(locationId) || isNaN(weekStart.getTime())) {
+      return res.status(400).json({ message: 'A valid location ID and weekStart date are required' });
+    }
+
+    const weekView = await storage.getWeekView(locationId, weekStart);
+
+    res.status(200).json(weekView);
+  } catch (error) {
+    console.error('Get week view error:', error);
+    res.status(500).json({ message: 'Error getting week view' });
+  }
+});
+
+// Shifts a proposed assignment would overlap, for warning before the shift is saved
+router.post('/conflicts', authenticateUser, requirePermission('schedule.edit'), async (req, res) => {
+  try {
+    const check = shiftConflictCheckSchema.parse(req.body);
+    const conflicts = await findShiftConflicts({ ...check, id: check.shiftId });
+
+    res.status(200).json({ conflicts });
+  } catch (error) {
+    if (error instanceof ZodError) {
+      const validationError = fromZodError(error);
+      return res.status(400).json({ message: 'Validation error', errors: validationError.details });
+    }
+    console.error('Shift conflict check error:', error);
+    res.status(500).json({ message: 'Error checking shift conflicts' });
+  }
+});
+
+// How many assigned staff are on shift at a location at one instant, per role:
+//   GET /api/scheduling/coverage/:locationId?at=ISO&role=bartender
+router.get('/coverage/:locationId', authenticateUser, requirePermission('schedule.view', pathLocation), async (req, res) => {
+  try {
+    const locationId = parseInt(req.params.locationId);
+    if (isNaN(locationId)) {
+      return res.status(400).json({ message: 'Invalid location ID' });
+    }
+    const query = shiftCoverageQuerySchema.parse(req.query);
+    const coverage = await getShiftCoverage(locationId, query.at, query.role);
+
+    res.status(200).json(coverage);
+  } catch (error) {
+    if (error instanceof ZodError) {
+      const validationError = fromZodError(error);
+      return res.status(400).json({ message: 'Validation error', errors: validationError.details });
+    }
+    console.error('Get shift coverage error:', error);
+    res.status(500).json({ message: 'Error getting shift coverage' });
+  }
+});
+
+// Propose staff for the open shifts of a location's week; returns a diff and writes nothing
+router.post('/auto-assign/:locationId', authenticateUser, requirePermission('schedule.edit', pathLocation), async (req, res) => {
+  try {
+    const locationId = parseInt(req.params.locationId);
+    const weekStart = new Date(String(req.body?.weekStart ?? ''));
+
+    if (isNaN(locationId) || isNaN(weekStart.getTime())) {
+      return res.status(400).json({ message: 'A valid location ID and weekStart date are required' });
+    }
+
+    const proposal = await proposeAssignments(locationId, weekStart, { allowOvertime: req.body?.allowOvertime === true });
+
+    res.status(200).json(proposal);
+  } catch (error) {
+    console.error('Auto-assign error:', error);
+    res.status(500).json({ message: 'Error proposing shift assignments' });
+  }
+});
+
+// Apply one or more templates across a range of weeks; runs in the background
+router.post('/template-rollouts', authenticateUser, requirePermission('schedule.edit'), async (req, res) => {
+  try {
+    const rollout = templateRolloutSchema.parse(req.body);
+    const job = await startTemplateRollout(rollout);
+
+    res.status(202).json(job);
+  } catch (error) {
+    if (error instanceof ZodError) {
+      const validationError = fromZodError(error);
+      return res.status(400).json({ message: 'Validation error', errors: validationError.details });
+    }
+    console.error('Start template rollout error:', error);
+    res.status(500).json({ message: 'Error starting template rollout' });
+  }
+});
+
+// Poll the progress of a template rollout
+router.get('/template-rollouts/:id', authenticateUser, requirePermission('schedule.edit'), async (req, res) => {
+  try {
+    const job = await getTemplateRollout(req.params.id);
+
+    if (!job) {
+      return res.status(404).json({ message: 'Template rollout not found' });
+    }
+
+    res.status(200).json(job);
+  } catch (error) {
+    console.error('Get template rollout error:', error);
+    res.status(500).json({ message: 'Error getting template rollout' });
+  }
+});
+
+export default router;
@@ -0,0 +1,112 @@
+import express from 'express';
+import { storage } from '../storage';
+import { insertShiftSchema } from '@shared/schema';
+import { ZodError } from 'zod';
+import { fromZodError } from 'zod-validation-error';
+import { authenticateUser, requirePermission } from '../middleware/auth';
+import { findShiftConflicts } from '../shift-conflicts';
+
+const router = express.Router();
+
+// JSON bodies carry the shift date as an ISO string
+const withParsedDate = (body: any) =>
+  body && typeof body.date === 'string' ? { ...body, date: new Date(body.date) } : body;
+
+const handleValidationError = (error: unknown, res: express.Response) => {
+  if (error instanceof ZodError) {
+    const validationError = fromZodError(error);
+    res.status(400).json({ message: 'Validation error', errors: validationError.details });
+    return true;
+  }
+  return false;
+};
+
+// Assigning someone who is already on shift at that time is refused with 409 and the clashing
+// shifts, unless the caller passes ?allowOverlap=true
+const refuseOverlap = async (
+  candidate: { id?: number; staffId: number | null | undefined; date: Date; startTime: string; endTime: string },
+  req: express.Request,
+  res: express.Response,
+) => {
+  if (!candidate.staffId || req.query.allowOverlap === 'true') return false;
+  const conflicts = await findShiftConflicts({ ...candidate, staffId: candidate.staffId });
+  if (conflicts.length === 0) return false;
+  res.status(409).json({ message: 'Staff member is already scheduled at this time', conflicts });
+  return true;
+};
+
+// Get a single shift
+router.get('/:id', authenticateUser, async (req, res) => {
+  try {
+    const shiftId = parseInt(req.params.id);
+    const shift = await storage.getShift(shiftId);
+
+    if (!shift) {
+      return res.status(404).json({ message: 'Shift not found' });
+    }
+
+    res.status(200).json(shift);
+  } catch (error) {
+    console.error('Get shift error:', error);
+    res.status(500).json({ message: 'Error getting shift' });
+  }
+});
+
+// Create a shift (subscribers of the week receive a shift:upsert patch)
+router.post('/', authenticateUser, requirePermission('schedule.edit'), async (req, res) => {
+  try {
+    const data = insertShiftSchema.parse(withParsedDate(req.body));
+    if (await refuseOverlap(data, req, res)) return;
+    const shift = await storage.createShift(data);
+
+    res.status(201).json(shift);
+  } catch (error) {
+    if (handleValidationError(error, res)) return;
+    console.error('Create shift error:', error);
+    res.status(500).json({ message: 'Error creating shift' });
+  }
+});
+
+// Update a shift
+router.put('/:id', authenticateUser, requirePermission('schedule.edit'), async (req, res) => {
+  try {
+    const shiftId = parseInt(req.params.id);
+    const data = insertShiftSchema.partial().parse(withParsedDate(req.body));
+
+    // Only changes to who or when can create a new overlap
+    if (data.staffId || data.date || data.startTime || data.endTime) {
+      const existing = await storage.getShift(shiftId);
+      if (!existing) {
+        return res.status(404).json({ message: 'Shift not found' });
+      }
+      if (await refuseOverlap({ ...existing, ...data }, req, res)) return;
+    }
+
+    const shift = await storage.updateShift(shiftId, data);
+
+    if (!shift) {
+      return res.status(404).json({ message: 'Shift not found' });
+    }
+
+    res.status(200).json(shift);
+  } catch (error) {
+    if (handleValidationError(error, res)) return;
+    console.error('Update shift error:', error);
+    res.status(500).json({ message: 'Error updating shift' });
+  }
+});
+
+// Delete a shift
+router.delete('/:id', authenticateUser, requirePermission('schedule.edit'), async (req, res) => {
+  try {
+    const shiftId = parseInt(req.params.id);
+    await storage.deleteShift(shiftId);
+
+    res.status(200).json({ message: 'Shift deleted successfully' });
+  } catch (error) {
+    console.error('Delete shift error:', error);
+    res.status(500).json({ message: 'Error deleting shift' });
+  }
+});
+
+export default router;
@@ -1,90 +1,70 @@
 import express from 'express';
-import multer from 'multer';
 import { storage } from '../storage';
-import path from 'path';
 import fs from 'fs';
-import { fileURLToPath } from 'url';
+import type { UploadedFile } from '@shared/schema';
 import { authenticateUser, checkRole } from '../middleware/auth';
+import { streamUpload, UploadError } from '../upload-stream';
+import { releaseBlob } from '../blob-store';
+import { verifyUploadJob, imageVariantsJob } from '../jobs';
+import { chooseVariant, hasVariants, VARIANT_FORMATS } from '../image-variants';
+import { accessibleLocationIds } from '../authorization';
 
 const router = express.Router();
 
-// Get dirname in ESM
-const __filename = fileURLToPath(import.meta.url);
-const __dirname = path.dirname(__filename);
-const uploadsDir = path.join(__dirname, '../../uploads');
-
-// Ensure uploads directory exists
-if (!fs.existsSync(uploadsDir)) {
-  fs.mkdirSync(uploadsDir, { recursive: true });
-}
-
-// Configure multer for file uploads
-const fileStorage = multer.diskStorage({
-  destination: (_req, _file, cb) => {
-    cb(null, uploadsDir);
-  },
-  filename: (_req, file, cb) => {
-    const uniqueSuffix = Date.now() + '-' + Math.round(Math.random() * 1E9);
-    const ext = path.extname(file.originalname);
-    cb(null, file.fieldname + '-' + uniqueSuffix + ext);
-  }
-});
-
-// File filter
-const fileFilter = (_req: any, file: Express.Multer.File, cb: multer.FileFilterCallback) => {
-  // Accept images, PDFs, and common document types
-  const allowedMimeTypes = [
-    'image/jpeg', 'image/png', 'image/gif', 'image/webp',
-    'application/pdf',
-    'application/msword', 'application/vnd.openxmlformats-officedocument.wordprocessingml.document', // Word
-    'application/vnd.ms-excel', 'application/vnd.openxmlformats-officedocument.spreadsheetml.sheet', // Excel
-    'application/vnd.ms-powerpoint', 'application/vnd.openxmlformats-officedocument.presentationml.presentation', // PowerPoint
-    'text/plain', 'text/csv'
-  ];
-
-  if (allowedMimeTypes.includes(file.mimetype)) {
-    cb(null, true);
-  } else {
-    cb(new Error('File type not allowed'));
-  }
-};
-
-// Setup multer upload
-const upload = multer({
-  storage: fileStorage,
-  limits: {
-    fileSize: 5 * 1024 * 1024, // 5MB limit
-  },
-  fileFilter: fileFilter
-});
-
-// Upload a file
-router.post('/upload', authenticateUser, upload.single('file'), async (req, res) => {
+// A file id always maps to the same bytes, so clients may cache downloads indefinitely
+const DOWNLOAD_CACHE_CONTROL = 'private, max-age=31536000, immutable';
+
+// Accept images, PDFs, and common document types
+const allowedMimeTypes = [
+  'image/jpeg', 'image/png', 'image/gif', 'image/webp',
+  'application/pdf',
+  'application/msword', 'application/vnd.openxmlformats-officedocument.wordprocessingml.document', // Word
+  'application/vnd.ms-excel', 'application/vnd.openxmlformats-officedocument.spreadsheetml.sheet', // Excel
+  'application/vnd.ms-powerpoint', 'application/vnd.openxmlformats-officedocument.presentationml.presentation', // PowerPoint
+  'text/plain', 'text/csv'
+];
+
+// Upload a file (streamed to disk; the row is only created once the whole file has landed)
+router.post('/upload', authenticateUser, async (req, res) => {
   try {
-    if (!req.file) {
-      return res.status(400).json({ message: 'No file uploaded' });
-    }
-
     // Get user info from request
     const { user } = req;
 
     // Save file info to database
-    const fileData = {
-      filename: req.file.filename,
-      originalname: req.file.originalname,
-      path: req.file.path,
-      mimetype: req.file.mimetype,
-      size: req.file.size,
-      uploadedBy: user.id,
-    };
+    const { record: uploadedFile } = await streamUpload(req, {
+      fieldName: 'file',
+      maxBytes: 5 * 1024 * 1024, // 5MB limit
+      allowedMimeTypes,
+      record: (file, tx) => storage.createUploadedFile({
+        filename: file.sha256,
+        originalName: file.originalName,
+        path: file.path,
+        mimeType: file.mimeType,
+        size: file.size,
+        contentHash: file.sha256,
+        uploadedBy: user.id,
+      }, tx),
+    });
 
-    const uploadedFile = await storage.createUploadedFile(fileData);
+    if (!uploadedFile) {
+      return res.status(400).json({ message: 'No file uploaded' });
+    }
+    // Hash and type checks run off the request path
+    verifyUploadJob.enqueue({ fileId: uploadedFile.id })
+      .catch(error => console.error('Enqueue upload verification error:', error));
+    if (hasVariants(uploadedFile.mimeType)) {
+      imageVariantsJob.enqueue({ fileId: uploadedFile.id })
+        .catch(error => console.error('Enqueue image variants error:', error));
+    }
 
     res.status(201).json({
       message: 'File uploaded successfully',
       file: uploadedFile
     });
   } catch (error) {
+    if (error instanceof UploadError) {
+      return res.status(error.status).json({ message: error.message });
+    }
     console.error('File upload error:', error);
     res.status(500).json({ message: 'Error uploading file' });
   }
@@ -159,28 +139,155 @@ router.get('/documents/:entityType/:entityId', authenticateUser, async (req, res
   }
 });
 
-// Download a file
+// Parse a single "bytes=start-end" range; multi-range requests fall back to the full body
+const parseRange = (header: string, size: number): { start: number; end: number } | 'unsatisfiable' | null => {
+  const match = /^bytes=(\d*)-(\d*)$/.exec(header.trim());
+  if (!match || (!match[1] && !match[2])) return null;
+
+  let start: number;
+  let end: number;
+  if (!match[1]) {
+    // Suffix range: the last N bytes
+    start = Math.max(size - parseInt(match[2], 10), 0);
+    end = size - 1;
+  } else {
+    start = parseInt(match[1], 10);
+    end = match[2] ? Math.min(parseInt(match[2], 10), size - 1) : size - 1;
+  }
+  if (start > end || start >= size) return 'unsatisfiable';
+  return { start, end };
+};
+
+// RFC 6266: an ASCII fallback in filename for old clients, the exact name in filename* (RFC 5987)
+const contentDisposition = (type: 'inline' | 'attachment', filename: string) => {
+  const fallback = filename.replace(/[^\x20-\x7e]|["\\%]/g, '_');
+  const encoded = encodeURIComponent(filename).replace(/['()*]/g, ch => `%${ch.charCodeAt(0).toString(16).toUpperCase()}`);
+  return `${type}; filename="${fallback}"; filename*=UTF-8''${encoded}`;
+};
+
+const etagFor = (file: UploadedFile, stat: fs.Stats) =>
+  file.contentHash ? `"${file.contentHash}"` : `W/"${stat.size.toString(16)}-${stat.mtimeMs.toString(16)}"`;
+
+// Send a stored body, honouring If-None-Match and single byte ranges
+function sendStored(req: express.Request, res: express.Response, body: {
+  path: string;
+  stat: fs.Stats;
+  etag: string;
+  contentType: string;
+  disposition: string;
+  cacheControl: string;
+}) {
+  const { stat, etag } = body;
+  res.setHeader('ETag', etag);
+  res.setHeader('Cache-Control', body.cacheControl);
+  res.setHeader('Accept-Ranges', 'bytes');
+
+  const ifNoneMatch = req.headers['if-none-match'];
+  if (ifNoneMatch && ifNoneMatch.split(',').some(tag => tag.trim() === etag || tag.trim() === '*')) {
+    return res.status(304).end();
+  }
+
+  res.setHeader('Content-Disposition', body.disposition);
+  res.setHeader('Content-Type', body.contentType);
+
+  // If-Range: only honour Range when the client's copy is still current
+  const ifRange = req.headers['if-range'];
+  const range = req.headers.range && (!ifRange || ifRange === etag)
+    ? parseRange(req.headers.range, stat.size)
+    : null;
+
+  if (range === 'unsatisfiable') {
+    res.setHeader('Content-Range', `bytes */${stat.size}`);
+    return res.status(416).end();
+  }
+
+  const start = range ? range.start : 0;
+  const end = range ? range.end : stat.size - 1;
+  if (range) {
+    res.status(206);
+    res.setHeader('Content-Range', `bytes ${start}-${end}/${stat.size}`);
+  }
+  res.setHeader('Content-Length', stat.size === 0 ? 0 : end - start + 1);
+
+  if (req.method === 'HEAD' || stat.size === 0) {
+    return res.end();
+  }
+
+  const fileStream = fs.createReadStream(body.path, { start, end });
+  fileStream.on('error', (error) => {
+    console.error('File download stream error:', error);
+    res.destroy(error);
+  });
+  fileStream.pipe(res);
+}
+
+const downloadRoles = ['administrator', 'manager', 'floor_manager'];
+
+// Files are readable by their uploader, and by managers at a location the file belongs to: the
+// uploader's own location or that of an applicant it is attached to
+async function canDownload(req: express.Request, file: UploadedFile): Promise<boolean> {
+  if (file.uploadedBy === req.user!.id) return true;
+  if (!downloadRoles.includes(req.user!.role)) return false;
+
+  const allowed = await accessibleLocationIds(req);
+  if (allowed === null) return true;
+
+  const [uploader, attachments] = await Promise.all([
+    storage.getUser(file.uploadedBy),
+    storage.getDocumentAttachmentsByFile(file.id),
+  ]);
+  const applicants = await Promise.all(attachments
+    .filter(attachment => attachment.entityType === 'applicant')
+    .map(attachment => storage.getApplicant(attachment.entityId)));
+  const locationIds = [uploader?.locationId, ...applicants.map(applicant => applicant?.locationId)];
+  return locationIds.some(locationId => locationId != null && allowed.includes(locationId));
+}
+
+// Download a file (supports conditional and range requests). With ?w=<px> images and PDFs are
+// served as the closest resized WebP/AVIF variant the client accepts (?format= forces one).
 router.get('/download/:id', authenticateUser, async (req, res) => {
   try {
     const fileId = parseInt(req.params.id);
     const file = await storage.getUploadedFile(fileId);
 
-    if (!file) {
+    // Files the caller may not read look missing, so ids can't be probed
+    if (!file || !await canDownload(req, file)) {
       return res.status(404).json({ message: 'File not found' });
     }
 
-    // Check if file exists on disk
-    if (!fs.existsSync(file.path)) {
-      return res.status(404).json({ message: 'File not found on disk' });
+    const width = typeof req.query.w === 'string' ? parseInt(req.query.w, 10) : NaN;
+    const format = VARIANT_FORMATS.find(f => f === req.query.format);
+    if (width > 0) {
+      // Caches must key variant responses on the formats the client accepts
+      res.setHeader('Vary', 'Accept');
+      const variant = await chooseVariant(file, width, req.headers.accept, format);
+      if (variant) {
+        return sendStored(req, res, {
+          path: variant.path,
+          stat: variant.stat,
+          etag: `"${file.contentHash}-w${variant.width}.${variant.format}"`,
+          contentType: `image/${variant.format}`,
+          disposition: contentDisposition('inline', `${file.originalName}.w${variant.width}.${variant.format}`),
+          cacheControl: DOWNLOAD_CACHE_CONTROL,
+        });
+      }
     }
 
-    // Set headers for file download
-    res.setHeader('Content-Disposition', `attachment; filename="${file.originalname}"`);
-    res.setHeader('Content-Type', file.mimetype);
+    const stat = await fs.promises.stat(file.path).catch(() => null);
+    if (!stat) {
+      return res.status(404).json({ message: 'File not found on disk' });
+    }
 
-    // Stream the file
-    const fileStream = fs.createReadStream(file.path);
-    fileStream.pipe(res);
+    sendStored(req, res, {
+      path: file.path,
+      stat,
+      etag: etagFor(file, stat),
+      contentType: file.mimeType,
+      disposition: contentDisposition('attachment', file.originalName),
+      // A variant request answered with the original (variants still being generated) must be
+      // revalidated, or the full-size body would stick in the cache under the variant URL
+      cacheControl: width > 0 ? 'private, no-cache' : DOWNLOAD_CACHE_CONTROL,
+    });
   } catch (error) {
     console.error('File download error:', error);
     res.status(500).json({ message: 'Error downloading file' });
@@ -203,8 +310,10 @@ router.delete('/file/:id', authenticateUser, checkRole(['manager', 'floor_manage
     // Delete file record from database
     await storage.deleteUploadedFile(fileId);
 
-    // Delete file from disk
-    if (fs.existsSync(file.path)) {
+    // Delete file from disk; content-addressed blobs only go once nothing else references them
+    if (file.contentHash) {
+      await releaseBlob(file.contentHash);
+    } else if (fs.existsSync(file.path)) {
       fs.unlinkSync(file.path);
     }
 
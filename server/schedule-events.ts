@@ -0,0 +1,34 @@
+import { EventEmitter } from 'events';
+import { randomUUID } from 'crypto';
+import type { Shift } from '@shared/schema';
+import { subscribeChannel, publishChannel, reviveDates } from './redis';
+
+// Notifications for shift writes. Storage emits after every successful create/update/delete;
+// the WebSocket handler turns them into week-view patches. Changes are delivered in-process
+// right away and fanned out over Redis so sockets held by other workers/instances see them too.
+
+export type ShiftChange =
+  | { op: 'upsert'; shift: Shift; previousScheduleId?: number }
+  | { op: 'delete'; shift: Shift };
+
+const CHANNEL = 'schedule-events';
+// Lets a process recognise (and skip) its own messages coming back from Redis
+const ORIGIN = randomUUID();
+
+const emitter = new EventEmitter();
+emitter.setMaxListeners(50);
+
+export function emitShiftChange(change: ShiftChange): void {
+  emitter.emit('shift', change);
+  void publishChannel(CHANNEL, JSON.stringify({ origin: ORIGIN, change }));
+}
+
+export function onShiftChange(listener: (change: ShiftChange) => void): () => void {
+  emitter.on('shift', listener);
+  return () => emitter.off('shift', listener);
+}
+
+subscribeChannel(CHANNEL, (raw) => {
+  const { origin, change } = JSON.parse(raw, reviveDates) as { origin: string; change: ShiftChange };
+  if (origin !== ORIGIN) emitter.emit('shift', change);
+});
@@ -0,0 +1,157 @@
+import session from "express-session";
+import connectPgSimple from "connect-pg-simple";
+import createMemoryStore from "memorystore";
+import { sessionPool } from "./db";
+import { redisClient, isRedisReady } from "./redis";
+import { createLogger } from "./logger";
+
+// Session lifetime shared by the cookie and every store implementation
+export const SESSION_TTL_MS = 86400000; // 24 hours
+
+// Only extend a session's stored TTL once less than this fraction of it remains,
+// so an active user costs one store write per half-lifetime instead of one per request
+const TOUCH_THRESHOLD = parseFloat(process.env.SESSION_TOUCH_THRESHOLD || "0.5");
+
+// Upper bound on sessions whose stored expiry we remember in-process
+const MAX_TRACKED_SESSIONS = 50000;
+
+const sessionLog = createLogger("session");
+
+type SessionStoreMode = "postgres" | "redis" | "memory";
+
+// express-session store backed by the shared Redis client. While Redis is down (or a command
+// fails) sessions go to the fallback store instead, the way the cache degrades to its LRU, so an
+// outage costs logins made before it rather than failing every authenticated request. Reads try
+// Redis first and then the fallback, so sessions created during an outage survive the recovery.
+class RedisSessionStore extends session.Store {
+  private prefix = "sess:";
+
+  constructor(private fallback: session.Store) {
+    super();
+  }
+
+  private ttlSeconds(sess: session.SessionData): number {
+    const expires = sess.cookie?.expires ? new Date(sess.cookie.expires).getTime() : 0;
+    const ttl = expires ? Math.ceil((expires - Date.now()) / 1000) : SESSION_TTL_MS / 1000;
+    return Math.max(ttl, 1);
+  }
+
+  get(sid: string, callback: (err: any, session?: session.SessionData | null) => void): void {
+    if (!isRedisReady()) return this.fallback.get(sid, callback);
+    redisClient.get(this.prefix + sid)
+      .then(data => data ? callback(null, JSON.parse(data)) : this.fallback.get(sid, callback))
+      .catch(() => this.fallback.get(sid, callback));
+  }
+
+  set(sid: string, sess: session.SessionData, callback?: (err?: any) => void): void {
+    if (!isRedisReady()) return this.fallback.set(sid, sess, callback);
+    redisClient.set(this.prefix + sid, JSON.stringify(sess), "EX", this.ttlSeconds(sess))
+      .then(() => callback?.())
+      .catch(() => this.fallback.set(sid, sess, callback));
+  }
+
+  // Both stores: the session may have been written to either
+  destroy(sid: string, callback?: (err?: any) => void): void {
+    const fromRedis = isRedisReady() ? redisClient.del(this.prefix + sid).catch(() => 0) : Promise.resolve(0);
+    fromRedis.then(() => this.fallback.destroy(sid, callback));
+  }
+
+  touch(sid: string, sess: session.SessionData, callback?: () => void): void {
+    if (!isRedisReady()) {
+      this.fallback.touch ? this.fallback.touch(sid, sess, callback) : callback?.();
+      return;
+    }
+    // 0: not in Redis, so it was written to the fallback during an outage
+    redisClient.expire(this.prefix + sid, this.ttlSeconds(sess))
+      .then(found => found || !this.fallback.touch ? callback?.() : this.fallback.touch(sid, sess, callback))
+      .catch(() => callback?.());
+  }
+
+  clear(callback?: (err?: any) => void): void {
+    const clearFallback = () => this.fallback.clear ? this.fallback.clear(callback) : callback?.();
+    if (!isRedisReady()) return clearFallback();
+    const stream = redisClient.scanStream({ match: this.prefix + "*", count: 500 });
+    const pending: Promise<number>[] = [];
+    stream.on("data", (keys: string[]) => {
+      if (keys.length > 0) pending.push(redisClient.del(...keys));
+    });
+    stream.on("end", () => {
+      Promise.all(pending).then(clearFallback).catch(err => callback?.(err));
+    });
+    stream.on("error", err => callback?.(err));
+  }
+}
+
+// Skip store.touch() while the stored TTL is still comfortably ahead. express-session calls
+// touch on every request for an unmodified session, which would otherwise be one write each.
+function applyLazyTouch(store: session.Store): session.Store {
+  const storedUntil = new Map<string, number>();
+
+  const remember = (sid: string) => {
+    storedUntil.delete(sid);
+    storedUntil.set(sid, Date.now() + SESSION_TTL_MS);
+    if (storedUntil.size > MAX_TRACKED_SESSIONS) {
+      const oldest = storedUntil.keys().next().value;
+      if (oldest !== undefined) storedUntil.delete(oldest);
+    }
+  };
+
+  const originalSet = store.set.bind(store);
+  store.set = (sid, sess, callback) => {
+    remember(sid);
+    originalSet(sid, sess, callback);
+  };
+
+  const originalDestroy = store.destroy.bind(store);
+  store.destroy = (sid, callback) => {
+    storedUntil.delete(sid);
+    originalDestroy(sid, callback);
+  };
+
+  if (store.touch) {
+    const originalTouch = store.touch.bind(store);
+    store.touch = (sid, sess, callback) => {
+      const until = storedUntil.get(sid);
+      if (until && until - Date.now() > SESSION_TTL_MS * TOUCH_THRESHOLD) {
+        callback?.();
+        return;
+      }
+      remember(sid);
+      originalTouch(sid, sess, callback);
+    };
+  }
+
+  return store;
+}
+
+export function getSessionStoreMode(): SessionStoreMode {
+  const mode = (process.env.SESSION_STORE || "postgres").toLowerCase();
+  return mode === "redis" || mode === "memory" ? mode : "postgres";
+}
+
+function createPgStore(): session.Store {
+  const PgStore = connectPgSimple(session);
+  return new PgStore({
+    pool: sessionPool,
+    tableName: 'sessions',
+    createTableIfMissing: true, // Auto-create the table
+    ttl: SESSION_TTL_MS / 1000, // connect-pg-simple expects seconds
+  });
+}
+
+export function createSessionStore(): session.Store {
+  const mode = getSessionStoreMode();
+  let store: session.Store;
+
+  if (mode === "redis") {
+    store = new RedisSessionStore(createPgStore());
+  } else if (mode === "memory") {
+    const MemoryStore = createMemoryStore(session);
+    store = new MemoryStore({ checkPeriod: SESSION_TTL_MS });
+  } else {
+    store = createPgStore();
+  }
+
+  sessionLog.info("Session store ready", { mode, fallback: mode === "redis" ? "postgres" : undefined });
+  return applyLazyTouch(store);
+}
@@ -0,0 +1,175 @@
+import { storage } from './storage';
+import { onShiftChange, type ShiftChange } from './schedule-events';
+import { IntervalIndex, shiftInterval, toEpochMinutes, type MinuteInterval } from './shift-intervals';
+import type { Shift, ShiftConflict, ShiftCoverage } from '@shared/schema';
+
+// Double-booking and coverage checks over per-week interval indexes. Each staff member's and
+// each location's week is loaded and parsed once, then answers overlap and "who is on at t"
+// questions with binary searches. Shift writes (local or from other instances, via
+// schedule-events) drop the affected weeks; the TTL only bounds writes that bypass events.
+
+const DAY_MS = 24 * 60 * 60 * 1000;
+const WEEK_MS = 7 * DAY_MS;
+const WEEK_TTL_MS = parseInt(process.env.SHIFT_INDEX_TTL_MS || '60000', 10);
+const MAX_WEEKS = parseInt(process.env.SHIFT_INDEX_MAX_WEEKS || '500', 10);
+
+interface IndexedWeek<T> {
+  // Window the week covers, in epoch minutes; shifts overlapping it are indexed
+  window: MinuteInterval;
+  shiftIds: Set<number>;
+  loadedAt: number;
+  index: T;
+}
+
+type StaffWeek = IndexedWeek<IntervalIndex<Shift>>;
+// Assigned shifts per role
+type LocationWeek = IndexedWeek<Map<string, IntervalIndex<Shift>>>;
+
+// Sunday 00:00 UTC of the week containing the instant, matching the schedule calendar
+function weekStartOf(instant: Date): Date {
+  const day = new Date(Date.UTC(instant.getUTCFullYear(), instant.getUTCMonth(), instant.getUTCDate()));
+  return new Date(day.getTime() - day.getUTCDay() * DAY_MS);
+}
+
+class ShiftIntervalCache {
+  // Map insertion order doubles as LRU order
+  private weeks = new Map<string, StaffWeek | LocationWeek>();
+  private loading = new Map<string, Promise<StaffWeek | LocationWeek>>();
+  // Bumped on every shift change so a load racing a write is not cached
+  private generation = 0;
+
+  constructor() {
+    onShiftChange(change => this.onChange(change));
+  }
+
+  private onChange(change: ShiftChange) {
+    this.generation++;
+    const interval = shiftInterval(change.shift);
+    this.weeks.forEach((week, key) => {
+      const touches = week.shiftIds.has(change.shift.id) ||
+        (interval.start < week.window.end && interval.end > week.window.start &&
+          (key.startsWith('location:') || key.startsWith(`staff:${change.shift.staffId}:`)));
+      if (touches) this.weeks.delete(key);
+    });
+  }
+
+  private async get<W extends StaffWeek | LocationWeek>(key: string, load: () => Promise<W>): Promise<W> {
+    const cached = this.weeks.get(key);
+    if (cached && Date.now() - cached.loadedAt < WEEK_TTL_MS) {
+      this.weeks.delete(key);
+      this.weeks.set(key, cached);
+      return cached as W;
+    }
+
+    const inflight = this.loading.get(key);
+    if (inflight) return inflight as Promise<W>;
+
+    const generation = this.generation;
+    const promise = load().then(week => {
+      if (generation === this.generation) {
+        this.weeks.set(key, week);
+        while (this.weeks.size > MAX_WEEKS) this.weeks.delete(this.weeks.keys().next().value!);
+      }
+      return week;
+    }).finally(() => this.loading.delete(key));
+    this.loading.set(key, promise);
+    return promise;
+  }
+
+  // The staff member's shifts overlapping the week, spilling one day into the next so a late
+  // Saturday candidate still sees Sunday morning
+  staffWeek(staffId: number, weekStart: Date): Promise<StaffWeek> {
+    return this.get(`staff:${staffId}:${weekStart.getTime()}`, async () => {
+      const start = weekStart;
+      const end = new Date(weekStart.getTime() + WEEK_MS + DAY_MS);
+      const list = await storage.getShiftsByStaffInRange(staffId, start, end);
+      return {
+        window: { start: toEpochMinutes(start), end: toEpochMinutes(end) },
+        shiftIds: new Set(list.map(shift => shift.id)),
+        loadedAt: Date.now(),
+        index: new IntervalIndex(list.map(shift => ({ interval: shiftInterval(shift), item: shift }))),
+      };
+    });
+  }
+
+  // Assigned shifts of the location's schedules overlapping the week, grouped by role; a schedule
+  // may start up to a week earlier and overnight shifts from the day before reach into it
+  locationWeek(locationId: number, weekStart: Date): Promise<LocationWeek> {
+    return this.get(`location:${locationId}:${weekStart.getTime()}`, async () => {
+      const start = weekStart;
+      const end = new Date(weekStart.getTime() + WEEK_MS);
+      const window = { start: toEpochMinutes(start), end: toEpochMinutes(end) };
+      const schedules = await storage.getWeeklyScheduleByDateRange(locationId, new Date(start.getTime() - WEEK_MS), new Date(end.getTime() - 1));
+      const lists = await Promise.all(schedules.map(schedule => storage.getShiftsBySchedule(schedule.id)));
+
+      const byRole = new Map<string, { interval: MinuteInterval; item: Shift }[]>();
+      const shiftIds = new Set<number>();
+      for (const shift of lists.flat()) {
+        const interval = shiftInterval(shift);
+        if (shift.staffId === null || interval.start >= window.end || interval.end <= window.start) continue;
+        shiftIds.add(shift.id);
+        let entries = byRole.get(shift.role);
+        if (!entries) {
+          entries = [];
+          byRole.set(shift.role, entries);
+        }
+        entries.push({ interval, item: shift });
+      }
+
+      return {
+        window,
+        shiftIds,
+        loadedAt: Date.now(),
+        index: new Map(Array.from(byRole, ([role, entries]) => [role, new IntervalIndex(entries)])),
+      };
+    });
+  }
+}
+
+const cache = new ShiftIntervalCache();
+
+// Shifts of the staff member that overlap the candidate (itself excluded when it already exists)
+export async function findShiftConflicts(candidate: {
+  id?: number;
+  staffId: number;
+  date: Date;
+  startTime: string;
+  endTime: string;
+}): Promise<ShiftConflict[]> {
+  const interval = shiftInterval(candidate);
+  // The week of the start suffices: its window spills a day past the week for overnight shifts
+  const week = await cache.staffWeek(candidate.staffId, weekStartOf(new Date(interval.start * 60000)));
+
+  return week.index.overlapping(interval.start, interval.end)
+    .filter(shift => shift.id !== candidate.id)
+    .map(shift => ({
+      id: shift.id,
+      scheduleId: shift.scheduleId,
+      date: shift.date,
+      startTime: shift.startTime,
+      endTime: shift.endTime,
+      role: shift.role,
+    }))
+    .sort((a, b) => new Date(a.date).getTime() - new Date(b.date).getTime() || a.id - b.id);
+}
+
+// Number of assigned shifts covering the instant at the location, per role (or for one role)
+export async function getShiftCoverage(locationId: number, at: Date, role?: string): Promise<ShiftCoverage> {
+  const week = await cache.locationWeek(locationId, weekStartOf(at));
+  const t = toEpochMinutes(at);
+  const roles: Record<string, number> = {};
+  if (role !== undefined) {
+    roles[role] = week.index.get(role)?.countAt(t) ?? 0;
+  } else {
+    week.index.forEach((index, name) => {
+      const count = index.countAt(t);
+      if (count > 0) roles[name] = count;
+    });
+  }
+  return {
+    locationId,
+    at: at.toISOString(),
+    roles,
+    total: Object.values(roles).reduce((sum, count) => sum + count, 0),
+  };
+}
@@ -0,0 +1,91 @@
+// Shift times as integer minute intervals, and a static interval index over them.
+// Shifts store a date plus "HH:MM" text; parsing happens once per shift when an index is built,
+// after which overlap and coverage queries are binary searches over plain number arrays.
+
+const DAY_MINUTES = 24 * 60;
+
+export function clockMinutes(time: string): number {
+  const [hours, minutes] = time.split(':').map(Number);
+  return (hours || 0) * 60 + (minutes || 0);
+}
+
+// Length of a shift in minutes; an end at or before the start runs past midnight (same rule as
+// shiftPeriod in the schema and the assignment solver)
+export function shiftDurationMinutes(startTime: string, endTime: string): number {
+  const start = clockMinutes(startTime);
+  const end = clockMinutes(endTime);
+  return end > start ? end - start : end + DAY_MINUTES - start;
+}
+
+export interface MinuteInterval {
+  // Minutes since the epoch, half-open [start, end)
+  start: number;
+  end: number;
+}
+
+export function shiftInterval(shift: { date: Date | string; startTime: string; endTime: string }): MinuteInterval {
+  const start = Math.floor(new Date(shift.date).getTime() / 60000) + clockMinutes(shift.startTime);
+  return { start, end: start + shiftDurationMinutes(shift.startTime, shift.endTime) };
+}
+
+export const toEpochMinutes = (date: Date) => Math.floor(date.getTime() / 60000);
+
+// Immutable index over a set of intervals, built in O(n log n):
+// - overlapping(start, end) finds every interval intersecting [start, end) with one binary search
+//   over the starts plus a walk that a running maximum of the ends cuts short
+// - countAt(t) counts intervals covering t as (#starts <= t) - (#ends <= t), two binary searches
+export class IntervalIndex<T> {
+  private starts: Int32Array;
+  // Ends in start order, and the running maximum of those ends
+  private endsByStart: Int32Array;
+  private maxEnd: Int32Array;
+  private items: T[];
+  private sortedEnds: Int32Array;
+
+  constructor(entries: { interval: MinuteInterval; item: T }[]) {
+    const sorted = entries.slice().sort((a, b) => a.interval.start - b.interval.start);
+    const n = sorted.length;
+    this.starts = new Int32Array(n);
+    this.endsByStart = new Int32Array(n);
+    this.maxEnd = new Int32Array(n);
+    this.items = new Array(n);
+    sorted.forEach((entry, i) => {
+      this.starts[i] = entry.interval.start;
+      this.endsByStart[i] = entry.interval.end;
+      this.maxEnd[i] = i === 0 ? entry.interval.end : Math.max(this.maxEnd[i - 1], entry.interval.end);
+      this.items[i] = entry.item;
+    });
+    this.sortedEnds = Int32Array.from(this.endsByStart).sort();
+  }
+
+  get size(): number {
+    return this.items.length;
+  }
+
+  // Number of values in the sorted array that are <= value
+  private static upperBound(values: Int32Array, value: number): number {
+    let lo = 0;
+    let hi = values.length;
+    while (lo < hi) {
+      const mid = (lo + hi) >>> 1;
+      if (values[mid] <= value) lo = mid + 1;
+      else hi = mid;
+    }
+    return lo;
+  }
+
+  // Intervals intersecting [start, end), latest start first
+  overlapping(start: number, end: number): T[] {
+    const found: T[] = [];
+    // Candidates are the intervals starting before `end`; walk back while one of them can still reach past `start`
+    for (let i = IntervalIndex.upperBound(this.starts, end - 1) - 1; i >= 0 && this.maxEnd[i] > start; i--) {
+      if (this.endsByStart[i] > start) found.push(this.items[i]);
+    }
+    return found;
+  }
+
+  // Intervals covering the instant t (start <= t < end)
+  countAt(t: number): number {
+    return IntervalIndex.upperBound(this.starts, t) - IntervalIndex.upperBound(this.sortedEnds, t);
+  }
+}
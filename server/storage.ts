@@ -1,46 +1,228 @@
 import {
   users, locations, competencies, staff, staffCompetencies, applicants, applicantDocuments,
-  scheduleTemplates, templateShifts, weeklySchedules, shifts, cashCounts,
+  scheduleTemplates, templateShifts, weeklySchedules, shifts, cashCounts, cashCountRollups,
+  shiftsHistory, cashCountsHistory,
   kbCategories, kbArticles, uploadedFiles, documentAttachments,
-  type User, type Location, type Competency, type Staff, type StaffCompetency,
+  roles, permissions, rolePermissions, userLocations, shiftPeriod,
+  type User, type SafeUser, type Location, type Competency, type Staff, type StaffCompetency,
   type Applicant, type ApplicantDocument, type ScheduleTemplate, type TemplateShift, type WeeklySchedule,
-  type Shift, type CashCount, type KbCategory, type KbArticle, 
+  type Shift, type CashCount, type KbCategory, type KbArticle, type KbArticleSummary, 
   type UploadedFile, type DocumentAttachment,
+  type Role, type Permission, type UserLocation,
+  type WeekView, type WeekViewShift, type WeekViewStaff, type WeekViewCompetency,
+  type TemplateRollout, type TemplateRolloutResult,
+  type ApplicantSearch, type ApplicantPage, type ApplicantListItem,
+  type KbSearch, type KbSearchPage,
+  type CashCountRollup, type CashSummaryQuery, type CashSummaryBucket,
+  type ExportQuery, type ShiftExportRow, type CashCountExportRow, type ApplicantExportRow,
+  type DashboardSummary,
   type InsertUser, type InsertLocation, type InsertCompetency, type InsertStaff,
   type InsertStaffCompetency, type InsertApplicant, type InsertApplicantDocument, type InsertScheduleTemplate,
   type InsertTemplateShift, type InsertWeeklySchedule, type InsertShift,
   type InsertCashCount, type InsertKbCategory, type InsertKbArticle,
   type InsertUploadedFile, type InsertDocumentAttachment
 } from "@shared/schema";
-import { db } from "./db";
-import { eq, and, gte, lte } from "drizzle-orm";
+import { db, reportingDb } from "./db";
+import { readThrough, invalidateTags, cacheTags } from "./cache";
+import { emitShiftChange } from "./schedule-events";
+import { withRequestBatching } from "./request-batching";
+import { IndexedTable, type HashIndex, type SortedIndex } from "./mem-indexes";
+import { preparedStatements, userColumns } from "./prepared-statements";
+import { cursorChunks } from "./db-cursor";
+import { archiveHorizon, maintainPartitions, type PartitionMaintenanceResult } from "./partitions";
+import { shiftDurationMinutes, shiftInterval, toEpochMinutes } from "./shift-intervals";
+import { KbSearchIndex, queryTerms, toPrefixTsQuery, buildSnippet, HEADLINE_OPTIONS } from "./kb-search";
+import { markRolePermissionsChanged, markUserPermissionsChanged } from "./permission-epochs";
+import { cashRollupDelta, cashRollupKey, addCashRollup, mergeCashRollups, type CashRollupDelta } from "./cash-rollups";
+import { eq, and, or, gte, lte, lt, asc, desc, inArray, ilike, sql, getTableColumns } from "drizzle-orm";
+
+const WEEK_MS = 7 * 24 * 60 * 60 * 1000;
+
+export type DbTransaction = Parameters<Parameters<typeof db.transaction>[0]>[0];
+
+// A permission the routes check, with the roles granted it when it is first created
+export interface PermissionSeed {
+  name: string;
+  description: string;
+  roles: string[];
+}
+
+function toWeekViewShift(shift: Shift): WeekViewShift {
+  const { scheduleId, createdAt, ...rest } = shift;
+  return rest;
+}
+
+function withoutPassword({ password: _password, ...user }: User): SafeUser {
+  return user;
+}
+
+// Applicant list cursors are the (created_at, id) of the last row, opaque to clients
+function encodeApplicantCursor(createdAtKey: string, id: number): string {
+  return Buffer.from(JSON.stringify([createdAtKey, id])).toString("base64url");
+}
+
+export class InvalidCursorError extends Error {
+  constructor() {
+    super("Invalid cursor");
+  }
+}
+
+// The key is stored timestamp text (Postgres) or an ISO string (MemStorage); anything else would
+// fail the ::timestamp cast
+const CURSOR_TIMESTAMP = /^\d{4}-\d{2}-\d{2}[ T]\d{2}:\d{2}:\d{2}(\.\d+)?Z?$/;
+
+function decodeApplicantCursor(cursor: string): { createdAtKey: string; id: number } {
+  let decoded: unknown;
+  try {
+    decoded = JSON.parse(Buffer.from(cursor, "base64url").toString("utf8"));
+  } catch {
+    throw new InvalidCursorError();
+  }
+  const [createdAtKey, id] = Array.isArray(decoded) ? decoded : [];
+  if (typeof createdAtKey !== "string" || !CURSOR_TIMESTAMP.test(createdAtKey) || !Number.isInteger(id)) {
+    throw new InvalidCursorError();
+  }
+  return { createdAtKey, id };
+}
 
-// Simple in-memory cache for frequently accessed data
-const queryCache = new Map();
-const CACHE_TTL = 30000; // 30 seconds
+// Escape LIKE wildcards in user input so it only ever matches as a literal prefix
+const escapeLike = (value: string) => value.replace(/[\\%_]/g, (ch) => `\\${ch}`);
 
-function getCacheKey(operation: string, params: any): string {
-  return `${operation}:${JSON.stringify(params)}`;
+// Every kb_articles column except the generated search document, which API rows never carry
+const { searchVector: _searchVector, ...kbArticleColumns } = getTableColumns(kbArticles);
+
+// Characters of body a category listing shows per article
+const KB_EXCERPT_CHARS = 160;
+
+// Rows per chunk handed to export writers
+const EXPORT_CHUNK = 1000;
+
+// Export date filters are whole UTC days, both ends inclusive
+function exportRange(query: ExportQuery): { start: Date; end: Date } {
+  const start = new Date(`${query.from}T00:00:00.000Z`);
+  const end = new Date(`${query.to}T00:00:00.000Z`);
+  end.setUTCDate(end.getUTCDate() + 1);
+  return { start, end };
+}
+
+function* chunked<T>(rows: T[], size = EXPORT_CHUNK): Generator<T[]> {
+  for (let i = 0; i < rows.length; i += size) yield rows.slice(i, i + size);
+}
+
+// Reads starting before the archive horizon go to the history views (hot partitions plus the
+// archive tier). They have the tables' columns, so they are typed as the tables.
+const shiftsFrom = (start: Date) =>
+  (start < archiveHorizon() ? shiftsHistory : shifts) as unknown as typeof shifts;
+const cashCountsFrom = (start: Date) =>
+  (start < archiveHorizon() ? cashCountsHistory : cashCounts) as unknown as typeof cashCounts;
+
+// A shift's span starts on its date and lasts under a day, so one overlapping [start, end) has a
+// date in (start - 2 days, end); bounding the date lets Postgres skip every other month's partition
+const OVERLAP_DATE_SLACK_MS = 2 * 24 * 60 * 60 * 1000;
+
+// Dashboard KPIs are recomputed at most this often per location (seconds); writes invalidate sooner
+const DASHBOARD_CACHE_TTL = parseInt(process.env.DASHBOARD_CACHE_TTL || '30', 10);
+
+// shiftDurationMinutes, in SQL
+const shiftMinutesSql = sql<number>`(extract(epoch from upper(${shiftPeriod(shifts)}) - lower(${shiftPeriod(shifts)})) / 60)::int`;
+
+function dashboardDayRange(day: string): { start: Date; end: Date } {
+  const start = new Date(`${day}T00:00:00.000Z`);
+  return { start, end: new Date(start.getTime() + 24 * 60 * 60 * 1000) };
+}
+
+type DashboardLatestCashCount = DashboardSummary["cash"]["latest"];
+
+// Assemble the dashboard payload from the grouped counts both backends compute
+function buildDashboardSummary(
+  locationId: number,
+  weekStart: Date,
+  day: string,
+  parts: {
+    staffByPosition: { position: string; count: number }[];
+    applicantsByStatus: { status: Applicant["status"]; count: number }[];
+    shifts: { total: number; assigned: number; minutes: number; assignedMinutes: number };
+    cash: CashSummaryBucket | undefined;
+    latestCashCount: DashboardLatestCashCount;
+  },
+): DashboardSummary {
+  const byStatus = Object.fromEntries(applicants.status.enumValues.map(status => [status, 0])) as Record<Applicant["status"], number>;
+  parts.applicantsByStatus.forEach(({ status, count }) => { byStatus[status] = count; });
+  const { total, assigned, minutes, assignedMinutes } = parts.shifts;
+  const cashEntries = parts.cash ? parts.cash.entries.opening + parts.cash.entries.midday + parts.cash.entries.closing : 0;
+
+  return {
+    locationId,
+    weekStart: weekStart.toISOString(),
+    day,
+    staff: {
+      total: parts.staffByPosition.reduce((sum, row) => sum + row.count, 0),
+      byPosition: parts.staffByPosition.slice().sort((a, b) => b.count - a.count || a.position.localeCompare(b.position)),
+    },
+    applicants: {
+      total: parts.applicantsByStatus.reduce((sum, row) => sum + row.count, 0),
+      byStatus,
+    },
+    shifts: {
+      total,
+      assigned,
+      open: total - assigned,
+      hoursScheduled: Math.round(minutes / 6) / 10,
+      hoursAssigned: Math.round(assignedMinutes / 6) / 10,
+      coverage: total === 0 ? 1 : Math.round((assigned / total) * 1000) / 1000,
+    },
+    cash: {
+      entries: cashEntries,
+      totalSales: parts.cash?.totalSales ?? 0,
+      discrepancyTotal: parts.cash?.discrepancyTotal ?? 0,
+      latest: parts.latestCashCount,
+    },
+  };
 }
 
-function getFromCache(key: string): any {
-  const cached = queryCache.get(key);
-  if (cached && Date.now() - cached.timestamp < CACHE_TTL) {
-    return cached.data;
+// Rows per multi-row INSERT during bulk operations (keeps each statement well under the bind parameter limit)
+const BULK_INSERT_BATCH = 500;
+
+// Advisory lock class for template rollouts; the second key is the location id
+const ROLLOUT_LOCK = 'template-rollout';
+
+function rolloutWeekStarts(rollout: TemplateRollout): Date[] {
+  const weeks: Date[] = [];
+  for (let t = rollout.fromWeekStart.getTime(); t <= rollout.toWeekStart.getTime(); t += WEEK_MS) {
+    weeks.push(new Date(t));
   }
-  queryCache.delete(key);
-  return null;
+  return weeks;
+}
+
+// Shifts count as the same when they share schedule, day, times and role; this is what makes
+// re-running a rollout a no-op
+function shiftNaturalKey(shift: { scheduleId: number; date: Date; startTime: string; endTime: string; role: string }): string {
+  return `${shift.scheduleId}|${shift.date.getTime()}|${shift.startTime}|${shift.endTime}|${shift.role}`;
 }
 
-function setCache(key: string, data: any): void {
-  queryCache.set(key, { data, timestamp: Date.now() });
+// Expand a template shift into a concrete shift on the given week (dayOfWeek is relative to the week start)
+function materializeTemplateShift(templateShift: TemplateShift, scheduleId: number, weekStart: Date): InsertShift {
+  return {
+    scheduleId,
+    staffId: null,
+    date: new Date(weekStart.getTime() + templateShift.dayOfWeek * 24 * 60 * 60 * 1000),
+    startTime: templateShift.startTime,
+    endTime: templateShift.endTime,
+    role: templateShift.role,
+    requiredCompetencyLevel: templateShift.requiredCompetencyLevel,
+    competencyId: templateShift.competencyId,
+    notes: templateShift.notes,
+  };
 }
 
 export interface IStorage {
   // Users
-  getUser(id: number): Promise<User | undefined>;
-  getUserByUsername(username: string): Promise<User | undefined>;
-  getUserByEmail(email: string): Promise<User | undefined>;
+  // Lookups leave out the password hash (their rows are cached); only credential checks read it
+  getUser(id: number): Promise<SafeUser | undefined>;
+  getUsersByIds(ids: number[]): Promise<SafeUser[]>;
+  getUserByUsername(username: string): Promise<SafeUser | undefined>;
+  getUserByEmail(email: string): Promise<SafeUser | undefined>;
+  getUserPasswordHash(id: number): Promise<string | undefined>;
   createUser(user: InsertUser): Promise<User>;
   updateUser(id: number, user: Partial<InsertUser>): Promise<User | undefined>;
   deleteUser(id: number): Promise<boolean>;
@@ -50,6 +232,7 @@ export interface IStorage {
 
   // Locations
   getLocation(id: number): Promise<Location | undefined>;
+  getLocationsByIds(ids: number[]): Promise<Location[]>;
   getLocations(): Promise<Location[]>;
   createLocation(location: InsertLocation): Promise<Location>;
   updateLocation(id: number, location: Partial<InsertLocation>): Promise<Location | undefined>;
@@ -57,6 +240,7 @@ export interface IStorage {
 
   // Competencies
   getCompetency(id: number): Promise<Competency | undefined>;
+  getCompetenciesByIds(ids: number[]): Promise<Competency[]>;
   getCompetencies(): Promise<Competency[]>;
   getCompetenciesByLocation(locationId: number): Promise<Competency[]>;
   createCompetency(competency: InsertCompetency): Promise<Competency>;
@@ -65,6 +249,7 @@ export interface IStorage {
 
   // Staff
   getStaff(id: number): Promise<Staff | undefined>;
+  getStaffByIds(ids: number[]): Promise<Staff[]>;
   getStaffMembers(): Promise<Staff[]>;
   getStaffByLocation(locationId: number): Promise<Staff[]>;
   getStaffByUser(userId: number): Promise<Staff | undefined>;
@@ -77,6 +262,7 @@ export interface IStorage {
   getStaffCompetencies(): Promise<StaffCompetency[]>;
   getStaffCompetenciesByStaff(staffId: number): Promise<StaffCompetency[]>;
   getStaffCompetenciesByCompetency(competencyId: number): Promise<StaffCompetency[]>;
+  getStaffCompetenciesByLocation(locationId: number): Promise<StaffCompetency[]>;
   createStaffCompetency(staffCompetency: InsertStaffCompetency): Promise<StaffCompetency>;
   updateStaffCompetency(id: number, staffCompetency: Partial<InsertStaffCompetency>): Promise<StaffCompetency | undefined>;
   deleteStaffCompetency(id: number): Promise<boolean>;
@@ -86,6 +272,7 @@ export interface IStorage {
   getApplicants(): Promise<Applicant[]>;
   getApplicantsByLocation(locationId: number): Promise<Applicant[]>;
   getApplicantsByStatus(status: string): Promise<Applicant[]>;
+  searchApplicants(search: ApplicantSearch): Promise<ApplicantPage>;
   getApplicantByUserId(userId: number): Promise<Applicant | undefined>;
   createApplicant(applicant: InsertApplicant): Promise<Applicant>;
   updateApplicant(id: number, applicant: Partial<InsertApplicant>): Promise<Applicant | undefined>;
@@ -121,11 +308,21 @@ export interface IStorage {
   updateWeeklySchedule(id: number, schedule: Partial<InsertWeeklySchedule>): Promise<WeeklySchedule | undefined>;
   deleteWeeklySchedule(id: number): Promise<boolean>;
 
+  // Week View (schedule + shifts + assigned staff + competencies in one call)
+  getWeekView(locationId: number, weekStart: Date): Promise<WeekView>;
+
+  // Bulk template rollout (idempotent: existing schedules and identical shifts are reused)
+  // Stops with signal.reason once the signal aborts; the Postgres version then rolls back
+  instantiateTemplates(rollout: TemplateRollout, onProgress?: (done: number, total: number) => void, signal?: AbortSignal): Promise<TemplateRolloutResult>;
+
   // Shifts
   getShift(id: number): Promise<Shift | undefined>;
+  getShiftsByIds(ids: number[]): Promise<Shift[]>;
   getShifts(): Promise<Shift[]>;
   getShiftsBySchedule(scheduleId: number): Promise<Shift[]>;
   getShiftsByStaff(staffId: number): Promise<Shift[]>;
+  // A staff member's shifts whose time span overlaps [start, end), overnight shifts included
+  getShiftsByStaffInRange(staffId: number, start: Date, end: Date): Promise<Shift[]>;
   getShiftsByDate(scheduleId: number, date: Date): Promise<Shift[]>;
   createShift(shift: InsertShift): Promise<Shift>;
   updateShift(id: number, shift: Partial<InsertShift>): Promise<Shift | undefined>;
@@ -140,6 +337,21 @@ export interface IStorage {
   createCashCount(cashCount: InsertCashCount): Promise<CashCount>;
   updateCashCount(id: number, cashCount: Partial<InsertCashCount>): Promise<CashCount | undefined>;
   deleteCashCount(id: number): Promise<boolean>;
+  getCashCountSummary(query: CashSummaryQuery): Promise<CashSummaryBucket[]>;
+
+  // Dashboard KPIs for one location: staff per position, applicants per status, the week's shift
+  // coverage and the day's cash totals
+  getDashboardSummary(locationId: number, weekStart: Date, day: string): Promise<DashboardSummary>;
+
+  // Streaming exports: rows in date order, in chunks (DatabaseStorage reads them through a
+  // server-side cursor so no export is ever fully in memory)
+  exportShifts(query: ExportQuery): AsyncIterable<ShiftExportRow[]>;
+  exportCashCounts(query: ExportQuery): AsyncIterable<CashCountExportRow[]>;
+  exportApplicants(query: ExportQuery): AsyncIterable<ApplicantExportRow[]>;
+
+  // Create upcoming monthly partitions of shifts and cash_counts and move closed months to the
+  // archive tier; a no-op for storage without partitioned tables
+  maintainPartitions(): Promise<PartitionMaintenanceResult>;
 
   // KB Categories
   getKbCategory(id: number): Promise<KbCategory | undefined>;
@@ -153,16 +365,22 @@ export interface IStorage {
   getKbArticle(id: number): Promise<KbArticle | undefined>;
   getKbArticles(): Promise<KbArticle[]>;
   getKbArticlesByCategory(categoryId: number): Promise<KbArticle[]>;
+  listKbArticleSummaries(categoryId: number): Promise<KbArticleSummary[]>;
   createKbArticle(article: InsertKbArticle): Promise<KbArticle>;
   updateKbArticle(id: number, article: Partial<InsertKbArticle>): Promise<KbArticle | undefined>;
   deleteKbArticle(id: number): Promise<boolean>;
+  // Ranked full-text search over title and content, optionally within a location/category
+  searchKbArticles(search: KbSearch): Promise<KbSearchPage>;
 
   // Upload Files
   getUploadedFile(id: number): Promise<UploadedFile | undefined>;
+  getUploadedFilesByIds(ids: number[]): Promise<UploadedFile[]>;
   getUploadedFiles(): Promise<UploadedFile[]>;
-  createUploadedFile(file: InsertUploadedFile): Promise<UploadedFile>;
+  // tx: run on the transaction holding the blob's lock (see blob-store.ts)
+  createUploadedFile(file: InsertUploadedFile, tx?: DbTransaction): Promise<UploadedFile>;
   updateUploadedFile(id: number, file: Partial<InsertUploadedFile>): Promise<UploadedFile | undefined>;
   deleteUploadedFile(id: number): Promise<boolean>;
+  countUploadedFilesByContentHash(contentHash: string, tx?: DbTransaction): Promise<number>;
 
   // Document Attachments
   getDocumentAttachment(id: number): Promise<DocumentAttachment | undefined>;
@@ -173,25 +391,68 @@ export interface IStorage {
   deleteDocumentAttachment(id: number): Promise<boolean>;
   deleteDocumentAttachmentsByEntity(entityType: string, entityId: number): Promise<boolean>;
   deleteDocumentAttachmentsByFile(fileId: number): Promise<boolean>;
+
+  // Authorization (inputs to the compiled per-location permission sets)
+  getPermissions(): Promise<Permission[]>;
+  getRolePermissionIdsByName(roleName: string): Promise<number[]>;
+  getUserLocationPermissionIds(userId: number): Promise<{ locationId: number; permissionId: number }[]>;
+  setRolePermissions(roleId: number, permissionIds: number[]): Promise<void>;
+  setUserLocationRole(userId: number, locationId: number, roleId: number): Promise<UserLocation>;
+  removeUserLocation(userId: number, locationId: number): Promise<boolean>;
+  // Creates missing roles and permissions; grants only go to permissions created here, so a
+  // grant removed later stays removed
+  seedPermissions(seeds: PermissionSeed[]): Promise<void>;
 }
 
 export class MemStorage implements IStorage {
-  private users: Map<number, User>;
-  private locations: Map<number, Location>;
-  private competencies: Map<number, Competency>;
-  private staff: Map<number, Staff>;
-  private staffCompetencies: Map<number, StaffCompetency>;
-  private applicants: Map<number, Applicant>;
-  private scheduleTemplates: Map<number, ScheduleTemplate>;
-  private templateShifts: Map<number, TemplateShift>;
-  private weeklySchedules: Map<number, WeeklySchedule>;
-  private shifts: Map<number, Shift>;
-  private cashCounts: Map<number, CashCount>;
-  private kbCategories: Map<number, KbCategory>;
-  private kbArticles: Map<number, KbArticle>;
-  private uploadedFiles: Map<number, UploadedFile>;
-  private documentAttachments: Map<number, DocumentAttachment>;
+  private users: IndexedTable<User>;
+  private locations: IndexedTable<Location>;
+  private competencies: IndexedTable<Competency>;
+  private staff: IndexedTable<Staff>;
+  private staffCompetencies: IndexedTable<StaffCompetency>;
+  private applicants: IndexedTable<Applicant>;
+  private scheduleTemplates: IndexedTable<ScheduleTemplate>;
+  private templateShifts: IndexedTable<TemplateShift>;
+  private weeklySchedules: IndexedTable<WeeklySchedule>;
+  private shifts: IndexedTable<Shift>;
+  private cashCounts: IndexedTable<CashCount>;
+  private cashCountRollups: Map<string, CashCountRollup>;
+  private kbCategories: IndexedTable<KbCategory>;
+  private kbArticles: IndexedTable<KbArticle>;
+  private uploadedFiles: IndexedTable<UploadedFile>;
+  private documentAttachments: IndexedTable<DocumentAttachment>;
   private _applicantDocuments: Map<number, any>;
+  private roles: Map<number, Role>;
+  private permissions: Map<number, Permission>;
+  private rolePermissions: Map<number, Set<number>>;
+  private userLocations: Map<string, UserLocation>;
+
+  // Secondary indexes, maintained by IndexedTable on every set/delete
+  private usersByUsername: HashIndex<User, string>;
+  private usersByEmail: HashIndex<User, string>;
+  private usersByRole: HashIndex<User, string>;
+  private usersByLocation: HashIndex<User, number>;
+  private competenciesByLocation: HashIndex<Competency, number>;
+  private staffByLocation: HashIndex<Staff, number>;
+  private staffByUser: HashIndex<Staff, number>;
+  private staffCompetenciesByStaff: HashIndex<StaffCompetency, number>;
+  private staffCompetenciesByCompetency: HashIndex<StaffCompetency, number>;
+  private applicantsByLocation: HashIndex<Applicant, number>;
+  private applicantsByStatus: HashIndex<Applicant, string>;
+  private applicantsByUser: HashIndex<Applicant, number>;
+  private scheduleTemplatesByLocation: HashIndex<ScheduleTemplate, number>;
+  private templateShiftsByTemplate: HashIndex<TemplateShift, number>;
+  private weeklySchedulesByWeek: SortedIndex<WeeklySchedule, number>;
+  private shiftsBySchedule: HashIndex<Shift, number>;
+  private shiftsByStaff: HashIndex<Shift, number>;
+  private cashCountsByDate: SortedIndex<CashCount, number>;
+  private cashCountsByShift: HashIndex<CashCount, number>;
+  private kbCategoriesByLocation: HashIndex<KbCategory, number>;
+  private kbArticlesByCategory: HashIndex<KbArticle, number>;
+  private kbSearchIndex = new KbSearchIndex();
+  private uploadedFilesByContentHash: HashIndex<UploadedFile, string>;
+  private attachmentsByEntity: HashIndex<DocumentAttachment, string>;
+  private attachmentsByFile: HashIndex<DocumentAttachment, number>;
 
   private currentUserId: number;
   private currentLocationId: number;
@@ -210,22 +471,52 @@ export class MemStorage implements IStorage {
   private currentDocumentAttachmentId: number;
 
   constructor() {
-    this.users = new Map();
-    this.locations = new Map();
-    this.competencies = new Map();
-    this.staff = new Map();
-    this.staffCompetencies = new Map();
-    this.applicants = new Map();
-    this.scheduleTemplates = new Map();
-    this.templateShifts = new Map();
-    this.weeklySchedules = new Map();
-    this.shifts = new Map();
-    this.cashCounts = new Map();
-    this.kbCategories = new Map();
-    this.kbArticles = new Map();
-    this.uploadedFiles = new Map();
-    this.documentAttachments = new Map();
+    this.users = new IndexedTable();
+    this.locations = new IndexedTable();
+    this.competencies = new IndexedTable();
+    this.staff = new IndexedTable();
+    this.staffCompetencies = new IndexedTable();
+    this.applicants = new IndexedTable();
+    this.scheduleTemplates = new IndexedTable();
+    this.templateShifts = new IndexedTable();
+    this.weeklySchedules = new IndexedTable();
+    this.shifts = new IndexedTable();
+    this.cashCounts = new IndexedTable();
+    this.cashCountRollups = new Map();
+    this.kbCategories = new IndexedTable();
+    this.kbArticles = new IndexedTable();
+    this.uploadedFiles = new IndexedTable();
+    this.documentAttachments = new IndexedTable();
     this._applicantDocuments = new Map();
+    this.roles = new Map();
+    this.permissions = new Map();
+    this.rolePermissions = new Map();
+    this.userLocations = new Map();
+
+    this.usersByUsername = this.users.hashIndex(user => user.username);
+    this.usersByEmail = this.users.hashIndex(user => user.email);
+    this.usersByRole = this.users.hashIndex(user => user.role);
+    this.usersByLocation = this.users.hashIndex(user => user.locationId);
+    this.competenciesByLocation = this.competencies.hashIndex(competency => competency.locationId);
+    this.staffByLocation = this.staff.hashIndex(member => member.locationId);
+    this.staffByUser = this.staff.hashIndex(member => member.userId);
+    this.staffCompetenciesByStaff = this.staffCompetencies.hashIndex(sc => sc.staffId);
+    this.staffCompetenciesByCompetency = this.staffCompetencies.hashIndex(sc => sc.competencyId);
+    this.applicantsByLocation = this.applicants.hashIndex(applicant => applicant.locationId);
+    this.applicantsByStatus = this.applicants.hashIndex(applicant => applicant.status);
+    this.applicantsByUser = this.applicants.hashIndex(applicant => applicant.userId);
+    this.scheduleTemplatesByLocation = this.scheduleTemplates.hashIndex(template => template.locationId);
+    this.templateShiftsByTemplate = this.templateShifts.hashIndex(shift => shift.templateId);
+    this.weeklySchedulesByWeek = this.weeklySchedules.sortedIndex(schedule => schedule.locationId, schedule => schedule.weekStartDate.getTime());
+    this.shiftsBySchedule = this.shifts.hashIndex(shift => shift.scheduleId);
+    this.shiftsByStaff = this.shifts.hashIndex(shift => shift.staffId);
+    this.cashCountsByDate = this.cashCounts.sortedIndex(cashCount => cashCount.locationId, cashCount => cashCount.countDate.getTime());
+    this.cashCountsByShift = this.cashCounts.hashIndex(cashCount => (cashCount as any).shiftId as number | null | undefined);
+    this.kbCategoriesByLocation = this.kbCategories.hashIndex(category => category.locationId);
+    this.kbArticlesByCategory = this.kbArticles.hashIndex(article => article.categoryId);
+    this.uploadedFilesByContentHash = this.uploadedFiles.hashIndex(file => file.contentHash);
+    this.attachmentsByEntity = this.documentAttachments.hashIndex(attachment => `${attachment.entityType}:${attachment.entityId}`);
+    this.attachmentsByFile = this.documentAttachments.hashIndex(attachment => attachment.fileId);
 
     this.currentUserId = 1;
     this.currentLocationId = 1;
@@ -255,16 +546,27 @@ export class MemStorage implements IStorage {
   }
 
   // Users
-  async getUser(id: number): Promise<User | undefined> {
-    return this.users.get(id);
+  async getUser(id: number): Promise<SafeUser | undefined> {
+    const user = this.users.get(id);
+    return user && withoutPassword(user);
+  }
+
+  async getUsersByIds(ids: number[]): Promise<SafeUser[]> {
+    return ids.map(id => this.users.get(id)).filter((row): row is User => !!row).map(withoutPassword);
+  }
+
+  async getUserByUsername(username: string): Promise<SafeUser | undefined> {
+    const user = this.usersByUsername.first(username);
+    return user && withoutPassword(user);
   }
 
-  async getUserByUsername(username: string): Promise<User | undefined> {
-    return Array.from(this.users.values()).find(user => user.username === username);
+  async getUserByEmail(email: string): Promise<SafeUser | undefined> {
+    const user = this.usersByEmail.first(email);
+    return user && withoutPassword(user);
   }
 
-  async getUserByEmail(email: string): Promise<User | undefined> {
-    return Array.from(this.users.values()).find(user => user.email === email);
+  async getUserPasswordHash(id: number): Promise<string | undefined> {
+    return this.users.get(id)?.password;
   }
 
   async createUser(user: InsertUser): Promise<User> {
@@ -288,6 +590,7 @@ export class MemStorage implements IStorage {
       ...user
     };
     this.users.set(id, updatedUser);
+    if (user.role !== undefined || user.locationId !== undefined) markUserPermissionsChanged(id);
     return updatedUser;
   }
 
@@ -300,11 +603,11 @@ export class MemStorage implements IStorage {
   }
 
   async getUsersByRole(role: string): Promise<User[]> {
-    return Array.from(this.users.values()).filter(user => user.role === role);
+    return this.usersByRole.find(role);
   }
 
   async getUsersByLocation(locationId: number): Promise<User[]> {
-    return Array.from(this.users.values()).filter(user => user.locationId === locationId);
+    return this.usersByLocation.find(locationId);
   }
 
   // Locations
@@ -312,6 +615,10 @@ export class MemStorage implements IStorage {
     return this.locations.get(id);
   }
 
+  async getLocationsByIds(ids: number[]): Promise<Location[]> {
+    return ids.map(id => this.locations.get(id)).filter((row): row is Location => !!row);
+  }
+
   async getLocations(): Promise<Location[]> {
     return Array.from(this.locations.values());
   }
@@ -349,12 +656,16 @@ export class MemStorage implements IStorage {
     return this.competencies.get(id);
   }
 
+  async getCompetenciesByIds(ids: number[]): Promise<Competency[]> {
+    return ids.map(id => this.competencies.get(id)).filter((row): row is Competency => !!row);
+  }
+
   async getCompetencies(): Promise<Competency[]> {
     return Array.from(this.competencies.values());
   }
 
   async getCompetenciesByLocation(locationId: number): Promise<Competency[]> {
-    return Array.from(this.competencies.values()).filter(competency => competency.locationId === locationId);
+    return this.competenciesByLocation.find(locationId);
   }
 
   async createCompetency(competency: InsertCompetency): Promise<Competency> {
@@ -390,16 +701,20 @@ export class MemStorage implements IStorage {
     return this.staff.get(id);
   }
 
+  async getStaffByIds(ids: number[]): Promise<Staff[]> {
+    return ids.map(id => this.staff.get(id)).filter((row): row is Staff => !!row);
+  }
+
   async getStaffMembers(): Promise<Staff[]> {
     return Array.from(this.staff.values());
   }
 
   async getStaffByLocation(locationId: number): Promise<Staff[]> {
-    return Array.from(this.staff.values()).filter(staff => staff.locationId === locationId);
+    return this.staffByLocation.find(locationId);
   }
 
   async getStaffByUser(userId: number): Promise<Staff | undefined> {
-    return Array.from(this.staff.values()).find(staff => staff.userId === userId);
+    return this.staffByUser.first(userId);
   }
 
   async createStaff(staffMember: InsertStaff): Promise<Staff> {
@@ -440,11 +755,15 @@ export class MemStorage implements IStorage {
   }
 
   async getStaffCompetenciesByStaff(staffId: number): Promise<StaffCompetency[]> {
-    return Array.from(this.staffCompetencies.values()).filter(sc => sc.staffId === staffId);
+    return this.staffCompetenciesByStaff.find(staffId);
   }
 
   async getStaffCompetenciesByCompetency(competencyId: number): Promise<StaffCompetency[]> {
-    return Array.from(this.staffCompetencies.values()).filter(sc => sc.competencyId === competencyId);
+    return this.staffCompetenciesByCompetency.find(competencyId);
+  }
+
+  async getStaffCompetenciesByLocation(locationId: number): Promise<StaffCompetency[]> {
+    return this.staffByLocation.find(locationId).flatMap(member => this.staffCompetenciesByStaff.find(member.id));
   }
 
   async createStaffCompetency(staffCompetency: InsertStaffCompetency): Promise<StaffCompetency> {
@@ -485,11 +804,42 @@ export class MemStorage implements IStorage {
   }
 
   async getApplicantsByLocation(locationId: number): Promise<Applicant[]> {
-    return Array.from(this.applicants.values()).filter(applicant => applicant.locationId === locationId);
+    return this.applicantsByLocation.find(locationId);
   }
 
   async getApplicantsByStatus(status: string): Promise<Applicant[]> {
-    return Array.from(this.applicants.values()).filter(applicant => applicant.status === status);
+    return this.applicantsByStatus.find(status);
+  }
+
+  async searchApplicants(search: ApplicantSearch): Promise<ApplicantPage> {
+    const cursor = search.cursor ? decodeApplicantCursor(search.cursor) : null;
+    const q = search.q?.toLowerCase();
+    // Start from the narrowest index the filters allow
+    const candidates = search.locationId ? this.applicantsByLocation.find(search.locationId)
+      : search.status ? this.applicantsByStatus.find(search.status)
+      : Array.from(this.applicants.values());
+    const matches = candidates
+      .filter(a => !search.status || a.status === search.status)
+      .filter(a => !search.locationId || a.locationId === search.locationId)
+      .filter(a => !search.createdFrom || a.createdAt >= search.createdFrom)
+      .filter(a => !search.createdTo || a.createdAt < search.createdTo)
+      .filter(a => !q || a.name.toLowerCase().startsWith(q) || a.email.toLowerCase().startsWith(q))
+      .sort((a, b) => b.createdAt.getTime() - a.createdAt.getTime() || b.id - a.id)
+      .filter(a => {
+        if (!cursor) return true;
+        const cursorTime = new Date(cursor.createdAtKey).getTime();
+        return a.createdAt.getTime() < cursorTime || (a.createdAt.getTime() === cursorTime && a.id < cursor.id);
+      });
+
+    const items: ApplicantListItem[] = matches.slice(0, search.limit).map(
+      ({ id, name, email, phone, status, resumeUrl, locationId, createdAt }) =>
+        ({ id, name, email, phone, status, resumeUrl, locationId, createdAt })
+    );
+    const last = items[items.length - 1];
+    return {
+      items,
+      nextCursor: matches.length > search.limit && last ? encodeApplicantCursor(last.createdAt.toISOString(), last.id) : null,
+    };
   }
 
   async createApplicant(applicant: InsertApplicant): Promise<Applicant> {
@@ -521,7 +871,7 @@ export class MemStorage implements IStorage {
   }
 
   async getApplicantByUserId(userId: number): Promise<Applicant | undefined> {
-    return Array.from(this.applicants.values()).find(applicant => applicant.userId === userId);
+    return this.applicantsByUser.first(userId);
   }
 
   async createApplicantDocument(document: { applicantId: number, documentName: string, documentUrl: string, fileType?: string }): Promise<any> {
@@ -580,7 +930,7 @@ export class MemStorage implements IStorage {
   }
 
   async getScheduleTemplatesByLocation(locationId: number): Promise<ScheduleTemplate[]> {
-    return Array.from(this.scheduleTemplates.values()).filter(template => template.locationId === locationId);
+    return this.scheduleTemplatesByLocation.find(locationId);
   }
 
   async createScheduleTemplate(template: InsertScheduleTemplate): Promise<ScheduleTemplate> {
@@ -621,13 +971,11 @@ export class MemStorage implements IStorage {
   }
 
   async getTemplateShiftsByTemplate(templateId: number): Promise<TemplateShift[]> {
-    return Array.from(this.templateShifts.values()).filter(shift => shift.templateId === templateId);
+    return this.templateShiftsByTemplate.find(templateId);
   }
 
   async getTemplateShiftsByDay(templateId: number, dayOfWeek: number): Promise<TemplateShift[]> {
-    return Array.from(this.templateShifts.values()).filter(shift => 
-      shift.templateId === templateId && shift.dayOfWeek === dayOfWeek
-    );
+    return this.templateShiftsByTemplate.find(templateId).filter(shift => shift.dayOfWeek === dayOfWeek);
   }
 
   async createTemplateShift(shift: InsertTemplateShift): Promise<TemplateShift> {
@@ -667,15 +1015,11 @@ export class MemStorage implements IStorage {
   }
 
   async getWeeklySchedulesByLocation(locationId: number): Promise<WeeklySchedule[]> {
-    return Array.from(this.weeklySchedules.values()).filter(schedule => schedule.locationId === locationId);
+    return this.weeklySchedulesByWeek.all(locationId);
   }
 
   async getWeeklyScheduleByDateRange(locationId: number, startDate: Date, endDate: Date): Promise<WeeklySchedule[]> {
-    return Array.from(this.weeklySchedules.values()).filter(schedule => 
-      schedule.locationId === locationId &&
-      schedule.weekStartDate >= startDate &&
-      schedule.weekStartDate <= endDate
-    );
+    return this.weeklySchedulesByWeek.range(locationId, startDate.getTime(), endDate.getTime());
   }
 
   async createWeeklySchedule(schedule: InsertWeeklySchedule): Promise<WeeklySchedule> {
@@ -706,26 +1050,121 @@ export class MemStorage implements IStorage {
     return this.weeklySchedules.delete(id);
   }
 
+  // Week View
+  async getWeekView(locationId: number, weekStart: Date): Promise<WeekView> {
+    const weekEnd = new Date(weekStart.getTime() + WEEK_MS);
+    const schedule = this.weeklySchedulesByWeek.range(locationId, weekStart.getTime(), weekEnd.getTime() - 1)
+      .sort((a, b) => a.id - b.id)[0];
+
+    if (!schedule) {
+      return { schedule: null, shifts: [], staff: [], competencies: [] };
+    }
+
+    const weekShifts = (await this.getShiftsBySchedule(schedule.id))
+      .sort((a, b) => a.date.getTime() - b.date.getTime() || a.startTime.localeCompare(b.startTime));
+
+    const staffById = new Map<number, WeekViewStaff>();
+    const competencyById = new Map<number, WeekViewCompetency>();
+    for (const shift of weekShifts) {
+      if (shift.staffId && !staffById.has(shift.staffId)) {
+        const member = this.staff.get(shift.staffId);
+        if (member) {
+          staffById.set(member.id, {
+            id: member.id,
+            userId: member.userId,
+            name: this.users.get(member.userId)?.name ?? `Staff #${member.id}`,
+            position: member.position,
+          });
+        }
+      }
+      if (shift.competencyId && !competencyById.has(shift.competencyId)) {
+        const competency = this.competencies.get(shift.competencyId);
+        if (competency) {
+          competencyById.set(competency.id, { id: competency.id, name: competency.name });
+        }
+      }
+    }
+
+    return {
+      schedule,
+      shifts: weekShifts.map(toWeekViewShift),
+      staff: Array.from(staffById.values()),
+      competencies: Array.from(competencyById.values()),
+    };
+  }
+
+  // Bulk template rollout
+  async instantiateTemplates(rollout: TemplateRollout, onProgress?: (done: number, total: number) => void, signal?: AbortSignal): Promise<TemplateRolloutResult> {
+    const weekStarts = rolloutWeekStarts(rollout);
+    const result: TemplateRolloutResult = { weeks: weekStarts.length, schedulesCreated: 0, schedulesReused: 0, shiftsCreated: 0, shiftsSkipped: 0 };
+    const templates = rollout.templateIds
+      .map(id => this.scheduleTemplates.get(id))
+      .filter((t): t is ScheduleTemplate => !!t);
+    const total = templates.length * weekStarts.length;
+    let done = 0;
+
+    for (const template of templates) {
+      const templateShiftList = await this.getTemplateShiftsByTemplate(template.id);
+      for (const weekStart of weekStarts) {
+        signal?.throwIfAborted();
+        const weekEnd = new Date(weekStart.getTime() + WEEK_MS);
+        let schedule = this.weeklySchedulesByWeek.range(template.locationId, weekStart.getTime(), weekEnd.getTime() - 1)
+          .sort((a, b) => a.id - b.id)[0];
+        if (schedule) {
+          result.schedulesReused++;
+        } else {
+          schedule = await this.createWeeklySchedule({ locationId: template.locationId, weekStartDate: weekStart, templateId: template.id, isPublished: false });
+          result.schedulesCreated++;
+        }
+
+        const existing = new Set((await this.getShiftsBySchedule(schedule.id)).map(shiftNaturalKey));
+        for (const templateShift of templateShiftList) {
+          const shift = materializeTemplateShift(templateShift, schedule.id, weekStart);
+          if (existing.has(shiftNaturalKey(shift))) {
+            result.shiftsSkipped++;
+            continue;
+          }
+          await this.createShift(shift);
+          result.shiftsCreated++;
+        }
+        onProgress?.(++done, total);
+      }
+    }
+    return result;
+  }
+
   // Shifts
   async getShift(id: number): Promise<Shift | undefined> {
     return this.shifts.get(id);
   }
 
+  async getShiftsByIds(ids: number[]): Promise<Shift[]> {
+    return ids.map(id => this.shifts.get(id)).filter((row): row is Shift => !!row);
+  }
+
   async getShifts(): Promise<Shift[]> {
     return Array.from(this.shifts.values());
   }
 
   async getShiftsBySchedule(scheduleId: number): Promise<Shift[]> {
-    return Array.from(this.shifts.values()).filter(shift => shift.scheduleId === scheduleId);
+    return this.shiftsBySchedule.find(scheduleId);
   }
 
   async getShiftsByStaff(staffId: number): Promise<Shift[]> {
-    return Array.from(this.shifts.values()).filter(shift => shift.staffId === staffId);
+    return this.shiftsByStaff.find(staffId);
+  }
+
+  async getShiftsByStaffInRange(staffId: number, start: Date, end: Date): Promise<Shift[]> {
+    const from = toEpochMinutes(start);
+    const to = toEpochMinutes(end);
+    return this.shiftsByStaff.find(staffId).filter(shift => {
+      const interval = shiftInterval(shift);
+      return interval.start < to && interval.end > from;
+    });
   }
 
   async getShiftsByDate(scheduleId: number, date: Date): Promise<Shift[]> {
-    return Array.from(this.shifts.values()).filter(shift => 
-      shift.scheduleId === scheduleId && 
+    return this.shiftsBySchedule.find(scheduleId).filter(shift =>
       shift.date.getFullYear() === date.getFullYear() &&
       shift.date.getMonth() === date.getMonth() &&
       shift.date.getDate() === date.getDate()
@@ -739,6 +1178,7 @@ export class MemStorage implements IStorage {
       ...shift
     };
     this.shifts.set(newShift.id, newShift);
+    emitShiftChange({ op: 'upsert', shift: newShift });
     return newShift;
   }
 
@@ -753,11 +1193,18 @@ export class MemStorage implements IStorage {
       ...shift
     };
     this.shifts.set(id, updatedShift);
+    emitShiftChange({ op: 'upsert', shift: updatedShift, previousScheduleId: existingShift.scheduleId });
     return updatedShift;
   }
 
   async deleteShift(id: number): Promise<boolean> {
-    return this.shifts.delete(id);
+    const existingShift = this.shifts.get(id);
+    if (!existingShift) {
+      return false;
+    }
+    this.shifts.delete(id);
+    emitShiftChange({ op: 'delete', shift: existingShift });
+    return true;
   }
 
   // Cash Counts
@@ -770,19 +1217,15 @@ export class MemStorage implements IStorage {
   }
 
   async getCashCountsByLocation(locationId: number): Promise<CashCount[]> {
-    return Array.from(this.cashCounts.values()).filter(cashCount => cashCount.locationId === locationId);
+    return this.cashCountsByDate.all(locationId);
   }
 
   async getCashCountsByShift(shiftId: number): Promise<CashCount[]> {
-    return Array.from(this.cashCounts.values()).filter(cashCount => cashCount.shiftId === shiftId);
+    return this.cashCountsByShift.find(shiftId);
   }
 
   async getCashCountsByDateRange(locationId: number, startDate: Date, endDate: Date): Promise<CashCount[]> {
-    return Array.from(this.cashCounts.values()).filter(cashCount => 
-      cashCount.locationId === locationId &&
-      cashCount.countDate >= startDate &&
-      cashCount.countDate <= endDate
-    );
+    return this.cashCountsByDate.range(locationId, startDate.getTime(), endDate.getTime());
   }
 
   async createCashCount(cashCount: InsertCashCount): Promise<CashCount> {
@@ -792,6 +1235,7 @@ export class MemStorage implements IStorage {
       ...cashCount
     };
     this.cashCounts.set(newCashCount.id, newCashCount);
+    this.applyCashRollupDelta(cashRollupDelta(newCashCount, 1));
     return newCashCount;
   }
 
@@ -806,13 +1250,157 @@ export class MemStorage implements IStorage {
       ...cashCount
     };
     this.cashCounts.set(id, updatedCashCount);
+    this.applyCashRollupDelta(cashRollupDelta(existingCashCount, -1));
+    this.applyCashRollupDelta(cashRollupDelta(updatedCashCount, 1));
     return updatedCashCount;
   }
 
   async deleteCashCount(id: number): Promise<boolean> {
+    const existingCashCount = this.cashCounts.get(id);
+    if (existingCashCount) {
+      this.applyCashRollupDelta(cashRollupDelta(existingCashCount, -1));
+    }
     return this.cashCounts.delete(id);
   }
 
+  private applyCashRollupDelta(delta: CashRollupDelta) {
+    const key = cashRollupKey(delta);
+    this.cashCountRollups.set(key, addCashRollup(this.cashCountRollups.get(key), delta));
+  }
+
+  async getCashCountSummary(query: CashSummaryQuery): Promise<CashSummaryBucket[]> {
+    const rollups = Array.from(this.cashCountRollups.values()).filter(rollup =>
+      rollup.day >= query.from &&
+      rollup.day <= query.to &&
+      (!query.locationIds || query.locationIds.includes(rollup.locationId))
+    );
+    return mergeCashRollups(rollups, query);
+  }
+
+  async getDashboardSummary(locationId: number, weekStart: Date, day: string): Promise<DashboardSummary> {
+    const staffByPosition = new Map<string, number>();
+    this.staffByLocation.find(locationId).forEach(member => {
+      staffByPosition.set(member.position, (staffByPosition.get(member.position) ?? 0) + 1);
+    });
+
+    const applicantsByStatus = new Map<Applicant["status"], number>();
+    this.applicantsByLocation.find(locationId).forEach(applicant => {
+      applicantsByStatus.set(applicant.status, (applicantsByStatus.get(applicant.status) ?? 0) + 1);
+    });
+
+    // A schedule starting up to a week earlier can still hold shifts dated inside this week
+    const weekEnd = weekStart.getTime() + WEEK_MS;
+    const shiftTotals = { total: 0, assigned: 0, minutes: 0, assignedMinutes: 0 };
+    this.weeklySchedulesByWeek.range(locationId, weekStart.getTime() - WEEK_MS, weekEnd - 1).forEach(schedule => {
+      this.shiftsBySchedule.find(schedule.id).forEach(shift => {
+        const date = shift.date.getTime();
+        if (date < weekStart.getTime() || date >= weekEnd) return;
+        const minutes = shiftDurationMinutes(shift.startTime, shift.endTime);
+        shiftTotals.total++;
+        shiftTotals.minutes += minutes;
+        if (shift.staffId !== null) {
+          shiftTotals.assigned++;
+          shiftTotals.assignedMinutes += minutes;
+        }
+      });
+    });
+
+    const [cash] = await this.getCashCountSummary({ from: day, to: day, locationIds: [locationId], groupBy: 'total', byLocation: false });
+    const { start, end } = dashboardDayRange(day);
+    const latest = this.cashCountsByDate.range(locationId, start.getTime(), end.getTime() - 1)
+      .sort((a, b) => b.createdAt.getTime() - a.createdAt.getTime() || b.id - a.id)[0];
+
+    return buildDashboardSummary(locationId, weekStart, day, {
+      staffByPosition: Array.from(staffByPosition, ([position, count]) => ({ position, count })),
+      applicantsByStatus: Array.from(applicantsByStatus, ([status, count]) => ({ status, count })),
+      shifts: shiftTotals,
+      cash,
+      latestCashCount: latest ? {
+        id: latest.id,
+        countType: latest.countType,
+        cashAmount: latest.cashAmount,
+        cardAmount: latest.cardAmount,
+        floatAmount: latest.floatAmount,
+        discrepancy: latest.discrepancy,
+        createdAt: latest.createdAt,
+      } : null,
+    });
+  }
+
+  async *exportShifts(query: ExportQuery): AsyncGenerator<ShiftExportRow[]> {
+    const { start, end } = exportRange(query);
+    const rows: ShiftExportRow[] = [];
+    for (const shift of this.shifts.values()) {
+      if (shift.date < start || shift.date >= end) continue;
+      const schedule = this.weeklySchedules.get(shift.scheduleId);
+      if (!schedule || (query.locationIds && !query.locationIds.includes(schedule.locationId))) continue;
+      const staffMember = shift.staffId ? this.staff.get(shift.staffId) : undefined;
+      rows.push({
+        id: shift.id,
+        date: shift.date,
+        startTime: shift.startTime,
+        endTime: shift.endTime,
+        role: shift.role,
+        locationId: schedule.locationId,
+        locationName: this.locations.get(schedule.locationId)?.name ?? '',
+        scheduleId: shift.scheduleId,
+        staffId: shift.staffId,
+        staffName: staffMember ? this.users.get(staffMember.userId)?.name ?? null : null,
+        competencyName: shift.competencyId ? this.competencies.get(shift.competencyId)?.name ?? null : null,
+        notes: shift.notes,
+      });
+    }
+    rows.sort((a, b) => a.date.getTime() - b.date.getTime() || a.startTime.localeCompare(b.startTime) || a.id - b.id);
+    yield* chunked(rows);
+  }
+
+  async *exportCashCounts(query: ExportQuery): AsyncGenerator<CashCountExportRow[]> {
+    const { start, end } = exportRange(query);
+    const rows = Array.from(this.cashCounts.values())
+      .filter(count => count.countDate >= start && count.countDate < end)
+      .filter(count => !query.locationIds || query.locationIds.includes(count.locationId))
+      .sort((a, b) => a.countDate.getTime() - b.countDate.getTime() || a.id - b.id)
+      .map((count): CashCountExportRow => ({
+        id: count.id,
+        countDate: count.countDate,
+        countType: count.countType,
+        locationId: count.locationId,
+        locationName: this.locations.get(count.locationId)?.name ?? '',
+        cashAmount: count.cashAmount,
+        cardAmount: count.cardAmount,
+        floatAmount: count.floatAmount,
+        expectedAmount: count.expectedAmount,
+        discrepancy: count.discrepancy,
+        createdBy: count.createdBy,
+        verifiedBy: count.verifiedBy,
+      }));
+    yield* chunked(rows);
+  }
+
+  async *exportApplicants(query: ExportQuery): AsyncGenerator<ApplicantExportRow[]> {
+    const { start, end } = exportRange(query);
+    const rows = Array.from(this.applicants.values())
+      .filter(applicant => applicant.createdAt >= start && applicant.createdAt < end)
+      .filter(applicant => !query.locationIds || (applicant.locationId !== null && query.locationIds.includes(applicant.locationId)))
+      .sort((a, b) => a.createdAt.getTime() - b.createdAt.getTime() || a.id - b.id)
+      .map((applicant): ApplicantExportRow => ({
+        id: applicant.id,
+        createdAt: applicant.createdAt,
+        name: applicant.name,
+        email: applicant.email,
+        phone: applicant.phone,
+        status: applicant.status,
+        locationId: applicant.locationId,
+        locationName: applicant.locationId ? this.locations.get(applicant.locationId)?.name ?? null : null,
+      }));
+    yield* chunked(rows);
+  }
+
+  // Everything lives in memory; there is nothing to partition or archive
+  async maintainPartitions(): Promise<PartitionMaintenanceResult> {
+    return { skipped: 'memory storage', created: [], archived: [] };
+  }
+
   // KB Categories
   async getKbCategory(id: number): Promise<KbCategory | undefined> {
     return this.kbCategories.get(id);
@@ -823,7 +1411,7 @@ export class MemStorage implements IStorage {
   }
 
   async getKbCategoriesByLocation(locationId: number): Promise<KbCategory[]> {
-    return Array.from(this.kbCategories.values()).filter(category => category.locationId === locationId);
+    return this.kbCategoriesByLocation.find(locationId);
   }
 
   async createKbCategory(category: InsertKbCategory): Promise<KbCategory> {
@@ -864,7 +1452,15 @@ export class MemStorage implements IStorage {
   }
 
   async getKbArticlesByCategory(categoryId: number): Promise<KbArticle[]> {
-    return Array.from(this.kbArticles.values()).filter(article => article.categoryId === categoryId);
+    return this.kbArticlesByCategory.find(categoryId);
+  }
+
+  async listKbArticleSummaries(categoryId: number): Promise<KbArticleSummary[]> {
+    return this.kbArticlesByCategory.find(categoryId)
+      .map(({ id, categoryId, title, content, createdAt, updatedAt }) => ({
+        id, categoryId, title, createdAt, updatedAt, excerpt: content.slice(0, KB_EXCERPT_CHARS),
+      }))
+      .sort((a, b) => a.title.localeCompare(b.title));
   }
 
   async createKbArticle(article: InsertKbArticle): Promise<KbArticle> {
@@ -874,6 +1470,7 @@ export class MemStorage implements IStorage {
       ...article
     };
     this.kbArticles.set(newArticle.id, newArticle);
+    this.kbSearchIndex.add(newArticle);
     return newArticle;
   }
 
@@ -888,23 +1485,47 @@ export class MemStorage implements IStorage {
       ...article
     };
     this.kbArticles.set(id, updatedArticle);
+    this.kbSearchIndex.add(updatedArticle);
     return updatedArticle;
   }
 
   async deleteKbArticle(id: number): Promise<boolean> {
+    this.kbSearchIndex.remove(id);
     return this.kbArticles.delete(id);
   }
 
+  async searchKbArticles(search: KbSearch): Promise<KbSearchPage> {
+    const terms = queryTerms(search.q);
+    const hits = this.kbSearchIndex.search(terms, (id) => {
+      const article = this.kbArticles.get(id);
+      if (!article || (search.categoryId && article.categoryId !== search.categoryId)) return false;
+      return !search.locationId || this.kbCategories.get(article.categoryId)?.locationId === search.locationId;
+    });
+
+    const page = hits.slice(search.offset, search.offset + search.limit);
+    return {
+      items: page.map(({ id, rank }) => {
+        const { categoryId, title, content, createdAt, updatedAt } = this.kbArticles.get(id)!;
+        return { id, categoryId, title, createdAt, updatedAt, rank, snippet: buildSnippet(content, terms) };
+      }),
+      nextOffset: hits.length > search.offset + search.limit ? search.offset + search.limit : null,
+    };
+  }
+
   // Upload Files
   async getUploadedFile(id: number): Promise<UploadedFile | undefined> {
     return this.uploadedFiles.get(id);
   }
 
+  async getUploadedFilesByIds(ids: number[]): Promise<UploadedFile[]> {
+    return ids.map(id => this.uploadedFiles.get(id)).filter((row): row is UploadedFile => !!row);
+  }
+
   async getUploadedFiles(): Promise<UploadedFile[]> {
     return Array.from(this.uploadedFiles.values());
   }
 
-  async createUploadedFile(file: InsertUploadedFile): Promise<UploadedFile> {
+  async createUploadedFile(file: InsertUploadedFile, _tx?: DbTransaction): Promise<UploadedFile> {
     const newFile: UploadedFile = {
       id: this.currentUploadedFileId++,
       createdAt: new Date(),
@@ -934,6 +1555,10 @@ export class MemStorage implements IStorage {
     return this.uploadedFiles.delete(id);
   }
 
+  async countUploadedFilesByContentHash(contentHash: string, _tx?: DbTransaction): Promise<number> {
+    return this.uploadedFilesByContentHash.count(contentHash);
+  }
+
   // Document Attachments
   async getDocumentAttachment(id: number): Promise<DocumentAttachment | undefined> {
     return this.documentAttachments.get(id);
@@ -944,13 +1569,11 @@ export class MemStorage implements IStorage {
   }
 
   async getDocumentAttachmentsByEntity(entityType: string, entityId: number): Promise<DocumentAttachment[]> {
-    return Array.from(this.documentAttachments.values())
-      .filter(attachment => attachment.entityType === entityType && attachment.entityId === entityId);
+    return this.attachmentsByEntity.find(`${entityType}:${entityId}`);
   }
 
   async getDocumentAttachmentsByFile(fileId: number): Promise<DocumentAttachment[]> {
-    return Array.from(this.documentAttachments.values())
-      .filter(attachment => attachment.fileId === fileId);
+    return this.attachmentsByFile.find(fileId);
   }
 
   async createDocumentAttachment(attachment: InsertDocumentAttachment): Promise<DocumentAttachment> {
@@ -982,23 +1605,111 @@ export class MemStorage implements IStorage {
     });
     return true;
   }
+
+  // Authorization
+  async getPermissions(): Promise<Permission[]> {
+    return Array.from(this.permissions.values());
+  }
+
+  async getRolePermissionIdsByName(roleName: string): Promise<number[]> {
+    const role = Array.from(this.roles.values()).find(r => r.name === roleName);
+    return role ? Array.from(this.rolePermissions.get(role.id) ?? []) : [];
+  }
+
+  async getUserLocationPermissionIds(userId: number): Promise<{ locationId: number; permissionId: number }[]> {
+    return Array.from(this.userLocations.values())
+      .filter(userLocation => userLocation.userId === userId)
+      .flatMap(userLocation => Array.from(this.rolePermissions.get(userLocation.roleId) ?? [])
+        .map(permissionId => ({ locationId: userLocation.locationId, permissionId })));
+  }
+
+  async setRolePermissions(roleId: number, permissionIds: number[]): Promise<void> {
+    this.rolePermissions.set(roleId, new Set(permissionIds));
+    markRolePermissionsChanged();
+  }
+
+  async setUserLocationRole(userId: number, locationId: number, roleId: number): Promise<UserLocation> {
+    const key = `${userId}:${locationId}`;
+    const userLocation: UserLocation = {
+      userId,
+      locationId,
+      roleId,
+      createdAt: this.userLocations.get(key)?.createdAt ?? new Date(),
+    };
+    this.userLocations.set(key, userLocation);
+    markUserPermissionsChanged(userId);
+    return userLocation;
+  }
+
+  async removeUserLocation(userId: number, locationId: number): Promise<boolean> {
+    const removed = this.userLocations.delete(`${userId}:${locationId}`);
+    if (removed) markUserPermissionsChanged(userId);
+    return removed;
+  }
+
+  async seedPermissions(seeds: PermissionSeed[]): Promise<void> {
+    const roleByName = new Map(Array.from(this.roles.values()).map(role => [role.name, role] as const));
+    const existing = new Set(Array.from(this.permissions.values()).map(permission => permission.name));
+    let added = false;
+
+    for (const seed of seeds) {
+      if (existing.has(seed.name)) continue;
+      const permission: Permission = { id: this.permissions.size + 1, name: seed.name, description: seed.description, createdAt: new Date() };
+      this.permissions.set(permission.id, permission);
+      existing.add(seed.name);
+
+      for (const roleName of seed.roles) {
+        let role = roleByName.get(roleName);
+        if (!role) {
+          role = { id: this.roles.size + 1, name: roleName, description: null, createdAt: new Date() };
+          this.roles.set(role.id, role);
+          roleByName.set(roleName, role);
+        }
+        let granted = this.rolePermissions.get(role.id);
+        if (!granted) {
+          granted = new Set();
+          this.rolePermissions.set(role.id, granted);
+        }
+        granted.add(permission.id);
+      }
+      added = true;
+    }
+    if (added) markRolePermissionsChanged();
+  }
 }
 
 export class DatabaseStorage implements IStorage {
   // Users
-  async getUser(id: number): Promise<User | undefined> {
-    const [user] = await db.select().from(users).where(eq(users.id, id));
-    return user;
+  async getUser(id: number): Promise<SafeUser | undefined> {
+    return readThrough(`user:${id}`, async () => {
+      const [user] = await preparedStatements().userById.execute({ id });
+      return user;
+    }, user => [cacheTags.user(user.id)]);
+  }
+
+  async getUsersByIds(ids: number[]): Promise<SafeUser[]> {
+    if (ids.length === 0) return [];
+    return await db.select(userColumns).from(users).where(inArray(users.id, ids));
+  }
+
+  async getUserByUsername(username: string): Promise<SafeUser | undefined> {
+    return readThrough(`user:username:${username}`, async () => {
+      const [user] = await preparedStatements().userByUsername.execute({ username });
+      return user;
+    }, user => [cacheTags.user(user.id)]);
   }
 
-  async getUserByUsername(username: string): Promise<User | undefined> {
-    const [user] = await db.select().from(users).where(eq(users.username, username));
-    return user;
+  async getUserByEmail(email: string): Promise<SafeUser | undefined> {
+    return readThrough(`user:email:${email}`, async () => {
+      const [user] = await preparedStatements().userByEmail.execute({ email });
+      return user;
+    }, user => [cacheTags.user(user.id)]);
   }
 
-  async getUserByEmail(email: string): Promise<User | undefined> {
-    const [user] = await db.select().from(users).where(eq(users.email, email));
-    return user;
+  // Never cached, so the hash stays out of Redis and the in-process fallback
+  async getUserPasswordHash(id: number): Promise<string | undefined> {
+    const [row] = await preparedStatements().userPasswordHash.execute({ id });
+    return row?.password;
   }
 
   async createUser(user: InsertUser): Promise<User> {
@@ -1012,11 +1723,15 @@ export class DatabaseStorage implements IStorage {
       .set(user)
       .where(eq(users.id, id))
       .returning();
+    await invalidateTags(cacheTags.user(id));
+    // The legacy role column still feeds the compiled permission set
+    if (user.role !== undefined || user.locationId !== undefined) markUserPermissionsChanged(id);
     return updatedUser;
   }
 
   async deleteUser(id: number): Promise<boolean> {
     await db.delete(users).where(eq(users.id, id));
+    await invalidateTags(cacheTags.user(id));
     return true;
   }
 
@@ -1034,16 +1749,24 @@ export class DatabaseStorage implements IStorage {
 
   // Locations
   async getLocation(id: number): Promise<Location | undefined> {
-    const [location] = await db.select().from(locations).where(eq(locations.id, id));
-    return location;
+    return readThrough(`location:${id}`, async () => {
+      const [location] = await preparedStatements().locationById.execute({ id });
+      return location;
+    }, location => [cacheTags.location(location.id)]);
+  }
+
+  async getLocationsByIds(ids: number[]): Promise<Location[]> {
+    if (ids.length === 0) return [];
+    return await db.select().from(locations).where(inArray(locations.id, ids));
   }
 
   async getLocations(): Promise<Location[]> {
-    return await db.select().from(locations);
+    return readThrough('locations', async () => await db.select().from(locations), () => [cacheTags.locations()]);
   }
 
   async createLocation(location: InsertLocation): Promise<Location> {
     const [createdLocation] = await db.insert(locations).values(location).returning();
+    await invalidateTags(cacheTags.locations());
     return createdLocation;
   }
 
@@ -1053,18 +1776,27 @@ export class DatabaseStorage implements IStorage {
       .set(location)
       .where(eq(locations.id, id))
       .returning();
+    await invalidateTags(cacheTags.location(id), cacheTags.locations());
     return updatedLocation;
   }
 
   async deleteLocation(id: number): Promise<boolean> {
     await db.delete(locations).where(eq(locations.id, id));
+    await invalidateTags(cacheTags.location(id), cacheTags.locations());
     return true;
   }
 
   // Competencies
   async getCompetency(id: number): Promise<Competency | undefined> {
-    const [competency] = await db.select().from(competencies).where(eq(competencies.id, id));
-    return competency;
+    return readThrough(`competency:${id}`, async () => {
+      const [competency] = await preparedStatements().competencyById.execute({ id });
+      return competency;
+    }, competency => [cacheTags.competency(competency.id)]);
+  }
+
+  async getCompetenciesByIds(ids: number[]): Promise<Competency[]> {
+    if (ids.length === 0) return [];
+    return await db.select().from(competencies).where(inArray(competencies.id, ids));
   }
 
   async getCompetencies(): Promise<Competency[]> {
@@ -1072,11 +1804,16 @@ export class DatabaseStorage implements IStorage {
   }
 
   async getCompetenciesByLocation(locationId: number): Promise<Competency[]> {
-    return await db.select().from(competencies).where(eq(competencies.locationId, locationId));
+    return readThrough(
+      `competencies:location:${locationId}`,
+      async () => await db.select().from(competencies).where(eq(competencies.locationId, locationId)),
+      list => [cacheTags.competenciesByLocation(locationId), ...list.map(c => cacheTags.competency(c.id))]
+    );
   }
 
   async createCompetency(competency: InsertCompetency): Promise<Competency> {
     const [createdCompetency] = await db.insert(competencies).values(competency).returning();
+    await invalidateTags(cacheTags.competenciesByLocation(createdCompetency.locationId));
     return createdCompetency;
   }
 
@@ -1086,18 +1823,30 @@ export class DatabaseStorage implements IStorage {
       .set(competency)
       .where(eq(competencies.id, id))
       .returning();
+    await invalidateTags(
+      cacheTags.competency(id),
+      ...(updatedCompetency ? [cacheTags.competenciesByLocation(updatedCompetency.locationId)] : [])
+    );
     return updatedCompetency;
   }
 
   async deleteCompetency(id: number): Promise<boolean> {
     await db.delete(competencies).where(eq(competencies.id, id));
+    await invalidateTags(cacheTags.competency(id));
     return true;
   }
 
   // Staff
   async getStaff(id: number): Promise<Staff | undefined> {
-    const [staffMember] = await db.select().from(staff).where(eq(staff.id, id));
-    return staffMember;
+    return readThrough(`staff:${id}`, async () => {
+      const [staffMember] = await preparedStatements().staffById.execute({ id });
+      return staffMember;
+    }, staffMember => [cacheTags.staff(staffMember.id)]);
+  }
+
+  async getStaffByIds(ids: number[]): Promise<Staff[]> {
+    if (ids.length === 0) return [];
+    return await db.select().from(staff).where(inArray(staff.id, ids));
   }
 
   async getStaffMembers(): Promise<Staff[]> {
@@ -1105,30 +1854,47 @@ export class DatabaseStorage implements IStorage {
   }
 
   async getStaffByLocation(locationId: number): Promise<Staff[]> {
-    return await db.select().from(staff).where(eq(staff.locationId, locationId));
+    return readThrough(
+      `staff:location:${locationId}`,
+      async () => await preparedStatements().staffByLocation.execute({ locationId }),
+      list => [cacheTags.staffByLocation(locationId), ...list.map(s => cacheTags.staff(s.id))]
+    );
   }
 
   async getStaffByUser(userId: number): Promise<Staff | undefined> {
-    const [staffMember] = await db.select().from(staff).where(eq(staff.userId, userId));
+    const [staffMember] = await preparedStatements().staffByUser.execute({ userId });
     return staffMember;
   }
 
   async createStaff(staffMember: InsertStaff): Promise<Staff> {
     const [createdStaff] = await db.insert(staff).values(staffMember).returning();
+    await invalidateTags(cacheTags.staffByLocation(createdStaff.locationId), cacheTags.dashboard(createdStaff.locationId));
     return createdStaff;
   }
 
   async updateStaff(id: number, staffMember: Partial<InsertStaff>): Promise<Staff | undefined> {
+    // Only moves between locations need the old row, so the old location's dashboard is dropped too
+    const previous = staffMember.locationId !== undefined ? await this.getStaff(id) : undefined;
     const [updatedStaff] = await db
       .update(staff)
       .set(staffMember)
       .where(eq(staff.id, id))
       .returning();
+    // The staff member's own tag also covers the list of the location it moved away from
+    await invalidateTags(
+      cacheTags.staff(id),
+      ...(updatedStaff ? [cacheTags.staffByLocation(updatedStaff.locationId), cacheTags.dashboard(updatedStaff.locationId)] : []),
+      ...(previous ? [cacheTags.dashboard(previous.locationId)] : [])
+    );
     return updatedStaff;
   }
 
   async deleteStaff(id: number): Promise<boolean> {
-    await db.delete(staff).where(eq(staff.id, id));
+    const [deletedStaff] = await db.delete(staff).where(eq(staff.id, id)).returning();
+    await invalidateTags(
+      cacheTags.staff(id),
+      ...(deletedStaff ? [cacheTags.dashboard(deletedStaff.locationId)] : [])
+    );
     return true;
   }
 
@@ -1150,6 +1916,14 @@ export class DatabaseStorage implements IStorage {
     return await db.select().from(staffCompetencies).where(eq(staffCompetencies.competencyId, competencyId));
   }
 
+  async getStaffCompetenciesByLocation(locationId: number): Promise<StaffCompetency[]> {
+    const rows = await db.select({ staffCompetency: staffCompetencies })
+      .from(staffCompetencies)
+      .innerJoin(staff, eq(staffCompetencies.staffId, staff.id))
+      .where(eq(staff.locationId, locationId));
+    return rows.map(row => row.staffCompetency);
+  }
+
   async createStaffCompetency(staffCompetency: InsertStaffCompetency): Promise<StaffCompetency> {
     const [createdStaffCompetency] = await db.insert(staffCompetencies).values(staffCompetency).returning();
     return createdStaffCompetency;
@@ -1268,22 +2042,76 @@ export class DatabaseStorage implements IStorage {
     }
   }
 
+  async searchApplicants(search: ApplicantSearch): Promise<ApplicantPage> {
+    const conditions = [];
+    if (search.status) conditions.push(eq(applicants.status, search.status));
+    if (search.locationId) conditions.push(eq(applicants.locationId, search.locationId));
+    if (search.createdFrom) conditions.push(gte(applicants.createdAt, search.createdFrom));
+    if (search.createdTo) conditions.push(lt(applicants.createdAt, search.createdTo));
+    if (search.q) {
+      const pattern = `${escapeLike(search.q)}%`;
+      conditions.push(or(ilike(applicants.name, pattern), ilike(applicants.email, pattern)));
+    }
+    const cursor = search.cursor ? decodeApplicantCursor(search.cursor) : null;
+    if (cursor) {
+      // Row comparison matches the index order; the key is the exact stored timestamp text,
+      // so rows sharing a millisecond aren't skipped
+      conditions.push(sql`(${applicants.createdAt}, ${applicants.id}) < (${cursor.createdAtKey}::timestamp, ${cursor.id})`);
+    }
+
+    // Slim projection: notes and extraMessage stay out of list responses
+    const rows = await db.select({
+      id: applicants.id,
+      name: applicants.name,
+      email: applicants.email,
+      phone: applicants.phone,
+      status: applicants.status,
+      resumeUrl: applicants.resumeUrl,
+      locationId: applicants.locationId,
+      createdAt: applicants.createdAt,
+      createdAtKey: sql<string>`${applicants.createdAt}::text`,
+    })
+      .from(applicants)
+      .where(conditions.length > 0 ? and(...conditions) : undefined)
+      .orderBy(desc(applicants.createdAt), desc(applicants.id))
+      .limit(search.limit + 1);
+
+    const page = rows.slice(0, search.limit);
+    const last = page[page.length - 1];
+    return {
+      items: page.map(({ createdAtKey, ...item }) => item),
+      nextCursor: rows.length > search.limit && last ? encodeApplicantCursor(last.createdAtKey, last.id) : null,
+    };
+  }
+
   async createApplicant(applicant: InsertApplicant): Promise<Applicant> {
     const [createdApplicant] = await db.insert(applicants).values(applicant).returning();
+    if (createdApplicant.locationId !== null) {
+      await invalidateTags(cacheTags.dashboard(createdApplicant.locationId));
+    }
     return createdApplicant;
   }
 
   async updateApplicant(id: number, applicant: Partial<InsertApplicant>): Promise<Applicant | undefined> {
+    const previous = applicant.locationId !== undefined ? await this.getApplicant(id) : undefined;
     const [updatedApplicant] = await db
       .update(applicants)
       .set(applicant)
       .where(eq(applicants.id, id))
       .returning();
+    const locationIds = [updatedApplicant?.locationId, previous?.locationId]
+      .filter((locationId): locationId is number => typeof locationId === 'number');
+    await invalidateTags(cacheTags.applicant(id), ...locationIds.map(cacheTags.dashboard));
     return updatedApplicant;
   }
 
   async deleteApplicant(id: number): Promise<boolean> {
-    await db.delete(applicants).where(eq(applicants.id, id));
+    const [deletedApplicant] = await db.delete(applicants).where(eq(applicants.id, id)).returning();
+    await invalidateTags(
+      cacheTags.applicant(id),
+      cacheTags.applicantDocuments(id),
+      ...(deletedApplicant?.locationId ? [cacheTags.dashboard(deletedApplicant.locationId)] : [])
+    );
     return true;
   }
 
@@ -1291,28 +2119,18 @@ export class DatabaseStorage implements IStorage {
     try {
       console.log("Looking for applicant with userId:", userId);
       
-      // Check cache first
-      const cacheKey = getCacheKey('getApplicantByUserId', { userId });
-      const cached = getFromCache(cacheKey);
-      if (cached) {
-        console.log("Found applicant (cached):", cached);
-        return cached;
-      }
-      
-      // Optimized query: select all columns directly, add limit for performance
-      const [applicant] = await db
-        .select()
-        .from(applicants)
-        .where(eq(applicants.userId, userId))
-        .limit(1);
+      const applicant = await readThrough(`applicant:user:${userId}`, async () => {
+        // Optimized query: select all columns directly, add limit for performance
+        const [row] = await db
+          .select()
+          .from(applicants)
+          .where(eq(applicants.userId, userId))
+          .limit(1);
+        return row;
+      }, row => [cacheTags.applicant(row.id), cacheTags.user(userId)]);
       
       console.log("Found applicant:", applicant || "None found");
       
-      // Cache the result
-      if (applicant) {
-        setCache(cacheKey, applicant);
-      }
-      
       return applicant;
     } catch (error) {
       console.error("Error in getApplicantByUserId:", error);
@@ -1357,6 +2175,7 @@ export class DatabaseStorage implements IStorage {
       })
       .returning();
     
+    await invalidateTags(cacheTags.applicantDocuments(document.applicantId));
     return newDoc;
   }
 
@@ -1364,26 +2183,19 @@ export class DatabaseStorage implements IStorage {
     try {
       console.log("Fetching documents for applicant ID:", applicantId);
       
-      // Check cache first
-      const cacheKey = getCacheKey('getApplicantDocuments', { applicantId });
-      const cached = getFromCache(cacheKey);
-      if (cached) {
-        console.log(`Found ${cached.length} documents (cached) for applicant ID ${applicantId}`);
-        return cached;
-      }
-      
       // Optimized query with explicit ordering for consistent results
-      const documents = await db
-        .select()
-        .from(applicantDocuments)
-        .where(eq(applicantDocuments.applicantId, applicantId))
-        .orderBy(applicantDocuments.uploadedAt);
+      const documents = await readThrough(
+        `applicant-documents:${applicantId}`,
+        async () => await db
+          .select()
+          .from(applicantDocuments)
+          .where(eq(applicantDocuments.applicantId, applicantId))
+          .orderBy(applicantDocuments.uploadedAt),
+        () => [cacheTags.applicantDocuments(applicantId)]
+      );
       
       console.log(`Successfully retrieved ${documents.length} documents for applicant ID ${applicantId}`);
       
-      // Cache the result
-      setCache(cacheKey, documents);
-      
       return documents;
     } catch (error) {
       console.error("Error in getApplicantDocuments:", error);
@@ -1407,9 +2219,13 @@ export class DatabaseStorage implements IStorage {
 
   async deleteApplicantDocument(id: number): Promise<boolean> {
     try {
-      await db
+      const [deleted] = await db
         .delete(applicantDocuments)
-        .where(eq(applicantDocuments.id, id));
+        .where(eq(applicantDocuments.id, id))
+        .returning({ applicantId: applicantDocuments.applicantId });
+      if (deleted) {
+        await invalidateTags(cacheTags.applicantDocuments(deleted.applicantId));
+      }
       return true;
     } catch (error) {
       console.error("Error in deleteApplicantDocument:", error);
@@ -1516,6 +2332,7 @@ export class DatabaseStorage implements IStorage {
 
   async createWeeklySchedule(schedule: InsertWeeklySchedule): Promise<WeeklySchedule> {
     const [createdSchedule] = await db.insert(weeklySchedules).values(schedule).returning();
+    await invalidateTags(cacheTags.schedulesByLocation(createdSchedule.locationId));
     return createdSchedule;
   }
 
@@ -1525,56 +2342,291 @@ export class DatabaseStorage implements IStorage {
       .set(schedule)
       .where(eq(weeklySchedules.id, id))
       .returning();
+    await invalidateTags(
+      cacheTags.schedule(id),
+      ...(updatedSchedule ? [cacheTags.schedulesByLocation(updatedSchedule.locationId)] : [])
+    );
     return updatedSchedule;
   }
 
   async deleteWeeklySchedule(id: number): Promise<boolean> {
     await db.delete(weeklySchedules).where(eq(weeklySchedules.id, id));
+    await invalidateTags(cacheTags.schedule(id));
     return true;
   }
 
-  // Shifts
+  // Week View
+  async getWeekView(locationId: number, weekStart: Date): Promise<WeekView> {
+    return readThrough(
+      `week-view:${locationId}:${weekStart.toISOString()}`,
+      () => this.loadWeekView(locationId, weekStart),
+      view => [
+        cacheTags.schedulesByLocation(locationId),
+        ...(view.schedule ? [cacheTags.schedule(view.schedule.id)] : []),
+        ...view.shifts.map(s => cacheTags.shift(s.id)),
+        ...view.staff.flatMap(s => [cacheTags.staff(s.id), cacheTags.user(s.userId)]),
+        ...view.competencies.map(c => cacheTags.competency(c.id)),
+      ]
+    );
+  }
+
+  private async loadWeekView(locationId: number, weekStart: Date): Promise<WeekView> {
+    const weekEnd = new Date(weekStart.getTime() + WEEK_MS);
+
+    // Single round trip: the schedule row is repeated for every shift and the joined
+    // staff/user/competency columns are folded into de-duplicated lookup lists below
+    // Weeks before the archive horizon read the shifts_history view instead of the hot table
+    const statements = preparedStatements();
+    const statement = weekStart < archiveHorizon() ? statements.weekViewHistoryRows : statements.weekViewRows;
+    const rows = await statement.execute({
+      locationId,
+      weekStart: weekStart.toISOString(),
+      weekEnd: weekEnd.toISOString(),
+    });
+
+    if (rows.length === 0) {
+      return { schedule: null, shifts: [], staff: [], competencies: [] };
+    }
+
+    // If duplicate schedules exist for the week, the oldest one wins
+    const schedule = rows[0].schedule;
+    const weekShifts: WeekViewShift[] = [];
+    const staffById = new Map<number, WeekViewStaff>();
+    const competencyById = new Map<number, WeekViewCompetency>();
+
+    for (const row of rows) {
+      if (row.schedule.id !== schedule.id || !row.shift) continue;
+      weekShifts.push(toWeekViewShift(row.shift));
+
+      if (row.staffMember && !staffById.has(row.staffMember.id)) {
+        staffById.set(row.staffMember.id, {
+          id: row.staffMember.id,
+          userId: row.staffMember.userId,
+          name: row.userName ?? `Staff #${row.staffMember.id}`,
+          position: row.staffMember.position,
+        });
+      }
+      if (row.competency && !competencyById.has(row.competency.id)) {
+        competencyById.set(row.competency.id, row.competency);
+      }
+    }
+
+    return {
+      schedule,
+      shifts: weekShifts,
+      staff: Array.from(staffById.values()),
+      competencies: Array.from(competencyById.values()),
+    };
+  }
+
+  // Bulk template rollout
+  async instantiateTemplates(rollout: TemplateRollout, onProgress?: (done: number, total: number) => void, signal?: AbortSignal): Promise<TemplateRolloutResult> {
+    const weekStarts = rolloutWeekStarts(rollout);
+    const rangeStart = weekStarts[0];
+    const rangeEnd = new Date(weekStarts[weekStarts.length - 1].getTime() + WEEK_MS);
+    const result: TemplateRolloutResult = { weeks: weekStarts.length, schedulesCreated: 0, schedulesReused: 0, shiftsCreated: 0, shiftsSkipped: 0 };
+
+    const templates = await db.select().from(scheduleTemplates).where(inArray(scheduleTemplates.id, rollout.templateIds));
+    if (templates.length === 0) return result;
+    const templateShiftRows = await db.select().from(templateShifts).where(inArray(templateShifts.templateId, templates.map(t => t.id)));
+    const locationIds = Array.from(new Set(templates.map(t => t.locationId)));
+
+    // Run everything as a constant number of statements per batch inside one transaction,
+    // instead of one INSERT ... RETURNING per schedule and per shift
+    const touchedScheduleIds = await db.transaction(async (tx) => {
+      // Rollouts touching the same location take turns, so a concurrent or retried one reads
+      // what this one commits and creates nothing twice. Ascending order keeps them deadlock free.
+      for (const locationId of [...locationIds].sort((a, b) => a - b)) {
+        await tx.execute(sql`SELECT pg_advisory_xact_lock(hashtext(${ROLLOUT_LOCK}), ${locationId})`);
+      }
+
+      const weekIndex = (date: Date) => Math.floor((date.getTime() - rangeStart.getTime()) / WEEK_MS);
+      const scheduleFor = new Map<string, WeeklySchedule>();
+
+      const existingSchedules = await tx.select().from(weeklySchedules)
+        .where(and(
+          inArray(weeklySchedules.locationId, locationIds),
+          gte(weeklySchedules.weekStartDate, rangeStart),
+          lt(weeklySchedules.weekStartDate, rangeEnd)
+        ))
+        .orderBy(asc(weeklySchedules.id));
+      for (const schedule of existingSchedules) {
+        const key = `${schedule.locationId}:${weekIndex(schedule.weekStartDate)}`;
+        if (!scheduleFor.has(key)) scheduleFor.set(key, schedule);
+      }
+      result.schedulesReused = scheduleFor.size;
+
+      // Create the missing (location, week) schedules in bulk
+      const missingSchedules: InsertWeeklySchedule[] = [];
+      for (const template of templates) {
+        weekStarts.forEach((weekStart, i) => {
+          const key = `${template.locationId}:${i}`;
+          if (scheduleFor.has(key) || missingSchedules.some(s => s.locationId === template.locationId && s.weekStartDate === weekStart)) return;
+          missingSchedules.push({ locationId: template.locationId, weekStartDate: weekStart, templateId: template.id, isPublished: false });
+        });
+      }
+      for (let i = 0; i < missingSchedules.length; i += BULK_INSERT_BATCH) {
+        signal?.throwIfAborted();
+        const created = await tx.insert(weeklySchedules).values(missingSchedules.slice(i, i + BULK_INSERT_BATCH)).returning();
+        for (const schedule of created) {
+          scheduleFor.set(`${schedule.locationId}:${weekIndex(schedule.weekStartDate)}`, schedule);
+        }
+        result.schedulesCreated += created.length;
+      }
+
+      // Expand template shifts and drop the ones already present from an earlier run
+      const scheduleIds = Array.from(new Set(Array.from(scheduleFor.values()).map(s => s.id)));
+      const existingKeys = new Set(
+        (await tx.select({
+          scheduleId: shifts.scheduleId,
+          date: shifts.date,
+          startTime: shifts.startTime,
+          endTime: shifts.endTime,
+          role: shifts.role,
+        }).from(shifts).where(inArray(shifts.scheduleId, scheduleIds))).map(shiftNaturalKey)
+      );
+
+      const newShifts: InsertShift[] = [];
+      for (const template of templates) {
+        const templateShiftList = templateShiftRows.filter(ts => ts.templateId === template.id);
+        weekStarts.forEach((weekStart, i) => {
+          const schedule = scheduleFor.get(`${template.locationId}:${i}`)!;
+          for (const templateShift of templateShiftList) {
+            const shift = materializeTemplateShift(templateShift, schedule.id, weekStart);
+            const key = shiftNaturalKey(shift);
+            if (existingKeys.has(key)) {
+              result.shiftsSkipped++;
+              continue;
+            }
+            existingKeys.add(key);
+            newShifts.push(shift);
+          }
+        });
+      }
+
+      onProgress?.(0, newShifts.length);
+      for (let i = 0; i < newShifts.length; i += BULK_INSERT_BATCH) {
+        signal?.throwIfAborted();
+        const batch = newShifts.slice(i, i + BULK_INSERT_BATCH);
+        await tx.insert(shifts).values(batch);
+        result.shiftsCreated += batch.length;
+        onProgress?.(result.shiftsCreated, newShifts.length);
+      }
+
+      return scheduleIds;
+    });
+
+    // Bulk rows bypass per-shift events; clients of these weeks refetch on their next load
+    await invalidateTags(
+      ...locationIds.map(id => cacheTags.schedulesByLocation(id)),
+      ...locationIds.map(id => cacheTags.dashboard(id)),
+      ...touchedScheduleIds.map(id => cacheTags.schedule(id))
+    );
+    return result;
+  }
+
+  // Shifts. Lookups by id and the unbounded lists cover the hot partitions; archived months are
+  // read-only and reached through date ranges, schedules and exports
   async getShift(id: number): Promise<Shift | undefined> {
-    const [shift] = await db.select().from(shifts).where(eq(shifts.id, id));
-    return shift;
+    return readThrough(`shift:${id}`, async () => {
+      const [shift] = await preparedStatements().shiftById.execute({ id });
+      return shift;
+    }, shift => [cacheTags.shift(shift.id)]);
+  }
+
+  async getShiftsByIds(ids: number[]): Promise<Shift[]> {
+    if (ids.length === 0) return [];
+    return await db.select().from(shifts).where(inArray(shifts.id, ids));
   }
 
   async getShifts(): Promise<Shift[]> {
     return await db.select().from(shifts);
   }
 
+  // Schedules of archived weeks read their shifts from the history view
   async getShiftsBySchedule(scheduleId: number): Promise<Shift[]> {
-    return await db.select().from(shifts).where(eq(shifts.scheduleId, scheduleId));
+    return readThrough(
+      `shifts:schedule:${scheduleId}`,
+      async () => {
+        const schedule = await this.getWeeklySchedule(scheduleId);
+        if (schedule && schedule.weekStartDate < archiveHorizon()) {
+          const source = shiftsFrom(schedule.weekStartDate);
+          return await db.select().from(source).where(eq(source.scheduleId, scheduleId));
+        }
+        return await preparedStatements().shiftsBySchedule.execute({ scheduleId });
+      },
+      list => [cacheTags.schedule(scheduleId), ...list.map(s => cacheTags.shift(s.id))]
+    );
   }
 
   async getShiftsByStaff(staffId: number): Promise<Shift[]> {
     return await db.select().from(shifts).where(eq(shifts.staffId, staffId));
   }
 
+  // Served by shifts_staff_period_idx; the expression has to be shiftPeriod verbatim to match it
+  async getShiftsByStaffInRange(staffId: number, start: Date, end: Date): Promise<Shift[]> {
+    const earliestDate = new Date(start.getTime() - OVERLAP_DATE_SLACK_MS);
+    const source = shiftsFrom(earliestDate);
+    return await db.select().from(source)
+      .where(and(
+        eq(source.staffId, staffId),
+        gte(source.date, earliestDate),
+        lt(source.date, end),
+        sql`${shiftPeriod(source)} && tsrange(${start.toISOString()}::timestamp, ${end.toISOString()}::timestamp, '[)')`
+      ));
+  }
+
   async getShiftsByDate(scheduleId: number, date: Date): Promise<Shift[]> {
-    return await db.select().from(shifts)
+    const source = shiftsFrom(date);
+    return await db.select().from(source)
       .where(and(
-        eq(shifts.scheduleId, scheduleId),
-        eq(shifts.date, date)
+        eq(source.scheduleId, scheduleId),
+        eq(source.date, date)
       ));
   }
 
   async createShift(shift: InsertShift): Promise<Shift> {
     const [createdShift] = await db.insert(shifts).values(shift).returning();
+    await invalidateTags(cacheTags.schedule(createdShift.scheduleId), ...await this.scheduleDashboardTags(createdShift.scheduleId));
+    emitShiftChange({ op: 'upsert', shift: createdShift });
     return createdShift;
   }
 
   async updateShift(id: number, shift: Partial<InsertShift>): Promise<Shift | undefined> {
+    // Only moves between schedules need the old row, so subscribers of the old week can drop it
+    const previous = shift.scheduleId !== undefined ? await this.getShift(id) : undefined;
     const [updatedShift] = await db
       .update(shifts)
       .set(shift)
       .where(eq(shifts.id, id))
       .returning();
+    await invalidateTags(
+      cacheTags.shift(id),
+      ...(updatedShift ? [cacheTags.schedule(updatedShift.scheduleId)] : []),
+      ...await this.scheduleDashboardTags(updatedShift?.scheduleId, previous?.scheduleId)
+    );
+    if (updatedShift) {
+      emitShiftChange({ op: 'upsert', shift: updatedShift, previousScheduleId: previous?.scheduleId });
+    }
     return updatedShift;
   }
 
+  // Dashboard tags for the locations owning the given schedules
+  private async scheduleDashboardTags(...scheduleIds: (number | undefined)[]): Promise<string[]> {
+    const ids = Array.from(new Set(scheduleIds.filter((scheduleId): scheduleId is number => scheduleId !== undefined)));
+    if (ids.length === 0) return [];
+    const rows = await db.select({ locationId: weeklySchedules.locationId })
+      .from(weeklySchedules)
+      .where(inArray(weeklySchedules.id, ids));
+    return Array.from(new Set(rows.map(row => cacheTags.dashboard(row.locationId))));
+  }
+
   async deleteShift(id: number): Promise<boolean> {
-    await db.delete(shifts).where(eq(shifts.id, id));
+    const [deletedShift] = await db.delete(shifts).where(eq(shifts.id, id)).returning();
+    await invalidateTags(cacheTags.shift(id), ...await this.scheduleDashboardTags(deletedShift?.scheduleId));
+    if (deletedShift) {
+      emitShiftChange({ op: 'delete', shift: deletedShift });
+    }
     return true;
   }
 
@@ -1597,33 +2649,215 @@ export class DatabaseStorage implements IStorage {
   }
 
   async getCashCountsByDateRange(locationId: number, startDate: Date, endDate: Date): Promise<CashCount[]> {
-    return await db.select().from(cashCounts)
+    const source = cashCountsFrom(startDate);
+    return await db.select().from(source)
       .where(and(
-        eq(cashCounts.locationId, locationId),
-        gte(cashCounts.countDate, startDate),
-        lte(cashCounts.countDate, endDate)
+        eq(source.locationId, locationId),
+        gte(source.countDate, startDate),
+        lte(source.countDate, endDate)
       ));
   }
 
+  // Cash count writes keep cash_count_rollups in step inside the same transaction
   async createCashCount(cashCount: InsertCashCount): Promise<CashCount> {
-    const [createdCashCount] = await db.insert(cashCounts).values(cashCount).returning();
+    const createdCashCount = await db.transaction(async (tx) => {
+      const [row] = await tx.insert(cashCounts).values(cashCount).returning();
+      await this.applyCashRollupDelta(tx, cashRollupDelta(row, 1));
+      return row;
+    });
+    await invalidateTags(cacheTags.dashboard(createdCashCount.locationId));
     return createdCashCount;
   }
 
   async updateCashCount(id: number, cashCount: Partial<InsertCashCount>): Promise<CashCount | undefined> {
-    const [updatedCashCount] = await db
-      .update(cashCounts)
-      .set(cashCount)
-      .where(eq(cashCounts.id, id))
-      .returning();
-    return updatedCashCount;
+    const change = await db.transaction(async (tx) => {
+      const [existingCashCount] = await tx.select().from(cashCounts).where(eq(cashCounts.id, id)).for("update");
+      if (!existingCashCount) return undefined;
+
+      const [updatedCashCount] = await tx
+        .update(cashCounts)
+        .set(cashCount)
+        .where(eq(cashCounts.id, id))
+        .returning();
+      await this.applyCashRollupDelta(tx, cashRollupDelta(existingCashCount, -1));
+      await this.applyCashRollupDelta(tx, cashRollupDelta(updatedCashCount, 1));
+      return { existingCashCount, updatedCashCount };
+    });
+    if (!change) return undefined;
+
+    await invalidateTags(
+      cacheTags.dashboard(change.updatedCashCount.locationId),
+      cacheTags.dashboard(change.existingCashCount.locationId)
+    );
+    return change.updatedCashCount;
   }
 
   async deleteCashCount(id: number): Promise<boolean> {
-    await db.delete(cashCounts).where(eq(cashCounts.id, id));
+    const deletedCashCount = await db.transaction(async (tx) => {
+      const [row] = await tx.delete(cashCounts).where(eq(cashCounts.id, id)).returning();
+      if (row) {
+        await this.applyCashRollupDelta(tx, cashRollupDelta(row, -1));
+      }
+      return row;
+    });
+    if (deletedCashCount) {
+      await invalidateTags(cacheTags.dashboard(deletedCashCount.locationId));
+    }
     return true;
   }
 
+  // Additive upsert, so concurrent counts for the same day serialize on the rollup row only
+  private async applyCashRollupDelta(tx: DbTransaction, delta: CashRollupDelta) {
+    await tx.insert(cashCountRollups)
+      .values(delta)
+      .onConflictDoUpdate({
+        target: [cashCountRollups.locationId, cashCountRollups.day, cashCountRollups.countType],
+        set: {
+          entries: sql`${cashCountRollups.entries} + excluded.entries`,
+          cashTotal: sql`${cashCountRollups.cashTotal} + excluded.cash_total`,
+          cardTotal: sql`${cashCountRollups.cardTotal} + excluded.card_total`,
+          floatTotal: sql`${cashCountRollups.floatTotal} + excluded.float_total`,
+          expectedTotal: sql`${cashCountRollups.expectedTotal} + excluded.expected_total`,
+          discrepancyTotal: sql`${cashCountRollups.discrepancyTotal} + excluded.discrepancy_total`,
+        },
+      });
+  }
+
+  // Aggregate reads go to the reporting pool so they can't hold OLTP connections
+  async getCashCountSummary(query: CashSummaryQuery): Promise<CashSummaryBucket[]> {
+    const conditions = [
+      gte(cashCountRollups.day, query.from),
+      lte(cashCountRollups.day, query.to),
+    ];
+    if (query.locationIds) conditions.push(inArray(cashCountRollups.locationId, query.locationIds));
+
+    const rollups = await reportingDb.select().from(cashCountRollups).where(and(...conditions));
+    return mergeCashRollups(rollups, query);
+  }
+
+  // Five small aggregates run side by side on the reporting pool; the result is cached per
+  // location and day for a short TTL, and dropped early by any staff, applicant, shift or cash
+  // count write there
+  async getDashboardSummary(locationId: number, weekStart: Date, day: string): Promise<DashboardSummary> {
+    return readThrough(
+      `dashboard:${locationId}:${weekStart.toISOString()}:${day}`,
+      async () => {
+        const weekEnd = new Date(weekStart.getTime() + WEEK_MS);
+        const { start, end } = dashboardDayRange(day);
+
+        const [staffByPosition, applicantsByStatus, [shiftTotals], [cash], [latestCashCount]] = await Promise.all([
+          reportingDb.select({ position: staff.position, count: sql<number>`count(*)::int` })
+            .from(staff)
+            .where(eq(staff.locationId, locationId))
+            .groupBy(staff.position),
+          reportingDb.select({ status: applicants.status, count: sql<number>`count(*)::int` })
+            .from(applicants)
+            .where(eq(applicants.locationId, locationId))
+            .groupBy(applicants.status),
+          reportingDb.select({
+            total: sql<number>`count(*)::int`,
+            assigned: sql<number>`count(${shifts.staffId})::int`,
+            minutes: sql<number>`coalesce(sum(${shiftMinutesSql}), 0)::int`,
+            assignedMinutes: sql<number>`coalesce(sum(${shiftMinutesSql}) filter (where ${shifts.staffId} is not null), 0)::int`,
+          })
+            .from(shifts)
+            .innerJoin(weeklySchedules, eq(shifts.scheduleId, weeklySchedules.id))
+            .where(and(
+              eq(weeklySchedules.locationId, locationId),
+              gte(shifts.date, weekStart),
+              lt(shifts.date, weekEnd)
+            )),
+          this.getCashCountSummary({ from: day, to: day, locationIds: [locationId], groupBy: 'total', byLocation: false }),
+          reportingDb.select({
+            id: cashCounts.id,
+            countType: cashCounts.countType,
+            cashAmount: cashCounts.cashAmount,
+            cardAmount: cashCounts.cardAmount,
+            floatAmount: cashCounts.floatAmount,
+            discrepancy: cashCounts.discrepancy,
+            createdAt: cashCounts.createdAt,
+          })
+            .from(cashCounts)
+            .where(and(
+              eq(cashCounts.locationId, locationId),
+              gte(cashCounts.countDate, start),
+              lt(cashCounts.countDate, end)
+            ))
+            .orderBy(desc(cashCounts.createdAt), desc(cashCounts.id))
+            .limit(1),
+        ]);
+
+        return buildDashboardSummary(locationId, weekStart, day, {
+          staffByPosition,
+          applicantsByStatus,
+          shifts: shiftTotals,
+          cash,
+          latestCashCount: latestCashCount ?? null,
+        });
+      },
+      () => [cacheTags.dashboard(locationId)],
+      DASHBOARD_CACHE_TTL
+    );
+  }
+
+  async *exportShifts(query: ExportQuery): AsyncGenerator<ShiftExportRow[]> {
+    const { start, end } = exportRange(query);
+    const source = shiftsFrom(start);
+    yield* cursorChunks<ShiftExportRow>(sql`
+      SELECT ${source.id} AS "id", ${source.date} AS "date", ${source.startTime} AS "startTime",
+        ${source.endTime} AS "endTime", ${source.role} AS "role",
+        ${weeklySchedules.locationId} AS "locationId", ${locations.name} AS "locationName",
+        ${source.scheduleId} AS "scheduleId", ${source.staffId} AS "staffId", ${users.name} AS "staffName",
+        ${competencies.name} AS "competencyName", ${source.notes} AS "notes"
+      FROM ${source}
+      JOIN ${weeklySchedules} ON ${weeklySchedules.id} = ${source.scheduleId}
+      JOIN ${locations} ON ${locations.id} = ${weeklySchedules.locationId}
+      LEFT JOIN ${staff} ON ${staff.id} = ${source.staffId}
+      LEFT JOIN ${users} ON ${users.id} = ${staff.userId}
+      LEFT JOIN ${competencies} ON ${competencies.id} = ${source.competencyId}
+      WHERE ${source.date} >= ${start.toISOString()}::timestamp AND ${source.date} < ${end.toISOString()}::timestamp
+        ${query.locationIds ? sql`AND ${inArray(weeklySchedules.locationId, query.locationIds)}` : sql``}
+      ORDER BY ${source.date}, ${source.startTime}, ${source.id}
+    `, EXPORT_CHUNK);
+  }
+
+  async *exportCashCounts(query: ExportQuery): AsyncGenerator<CashCountExportRow[]> {
+    const { start, end } = exportRange(query);
+    const source = cashCountsFrom(start);
+    yield* cursorChunks<CashCountExportRow>(sql`
+      SELECT ${source.id} AS "id", ${source.countDate} AS "countDate", ${source.countType} AS "countType",
+        ${source.locationId} AS "locationId", ${locations.name} AS "locationName",
+        ${source.cashAmount} AS "cashAmount", ${source.cardAmount} AS "cardAmount",
+        ${source.floatAmount} AS "floatAmount", ${source.expectedAmount} AS "expectedAmount",
+        ${source.discrepancy} AS "discrepancy", ${source.createdBy} AS "createdBy",
+        ${source.verifiedBy} AS "verifiedBy"
+      FROM ${source}
+      JOIN ${locations} ON ${locations.id} = ${source.locationId}
+      WHERE ${source.countDate} >= ${start.toISOString()}::timestamp AND ${source.countDate} < ${end.toISOString()}::timestamp
+        ${query.locationIds ? sql`AND ${inArray(source.locationId, query.locationIds)}` : sql``}
+      ORDER BY ${source.countDate}, ${source.id}
+    `, EXPORT_CHUNK);
+  }
+
+  async *exportApplicants(query: ExportQuery): AsyncGenerator<ApplicantExportRow[]> {
+    const { start, end } = exportRange(query);
+    yield* cursorChunks<ApplicantExportRow>(sql`
+      SELECT ${applicants.id} AS "id", ${applicants.createdAt} AS "createdAt", ${applicants.name} AS "name",
+        ${applicants.email} AS "email", ${applicants.phone} AS "phone", ${applicants.status} AS "status",
+        ${applicants.locationId} AS "locationId", ${locations.name} AS "locationName"
+      FROM ${applicants}
+      LEFT JOIN ${locations} ON ${locations.id} = ${applicants.locationId}
+      WHERE ${applicants.createdAt} >= ${start.toISOString()}::timestamp AND ${applicants.createdAt} < ${end.toISOString()}::timestamp
+        ${query.locationIds ? sql`AND ${inArray(applicants.locationId, query.locationIds)}` : sql``}
+      ORDER BY ${applicants.createdAt}, ${applicants.id}
+    `, EXPORT_CHUNK);
+  }
+
+  // Archiving moves rows without changing them, so nothing cached goes stale
+  async maintainPartitions(): Promise<PartitionMaintenanceResult> {
+    return maintainPartitions();
+  }
+
   // KB Categories
   async getKbCategory(id: number): Promise<KbCategory | undefined> {
     const [category] = await db.select().from(kbCategories).where(eq(kbCategories.id, id));
@@ -1659,20 +2893,34 @@ export class DatabaseStorage implements IStorage {
 
   // KB Articles
   async getKbArticle(id: number): Promise<KbArticle | undefined> {
-    const [article] = await db.select().from(kbArticles).where(eq(kbArticles.id, id));
+    const [article] = await db.select(kbArticleColumns).from(kbArticles).where(eq(kbArticles.id, id));
     return article;
   }
 
   async getKbArticles(): Promise<KbArticle[]> {
-    return await db.select().from(kbArticles);
+    return await db.select(kbArticleColumns).from(kbArticles);
   }
 
   async getKbArticlesByCategory(categoryId: number): Promise<KbArticle[]> {
-    return await db.select().from(kbArticles).where(eq(kbArticles.categoryId, categoryId));
+    return await db.select(kbArticleColumns).from(kbArticles).where(eq(kbArticles.categoryId, categoryId));
+  }
+
+  // Only the excerpt leaves the database; bodies can be long
+  async listKbArticleSummaries(categoryId: number): Promise<KbArticleSummary[]> {
+    return await db.select({
+      id: kbArticles.id,
+      categoryId: kbArticles.categoryId,
+      title: kbArticles.title,
+      createdAt: kbArticles.createdAt,
+      updatedAt: kbArticles.updatedAt,
+      excerpt: sql<string>`left(${kbArticles.content}, ${KB_EXCERPT_CHARS})`,
+    }).from(kbArticles)
+      .where(eq(kbArticles.categoryId, categoryId))
+      .orderBy(asc(kbArticles.title));
   }
 
   async createKbArticle(article: InsertKbArticle): Promise<KbArticle> {
-    const [createdArticle] = await db.insert(kbArticles).values(article).returning();
+    const [createdArticle] = await db.insert(kbArticles).values(article).returning(kbArticleColumns);
     return createdArticle;
   }
 
@@ -1681,7 +2929,7 @@ export class DatabaseStorage implements IStorage {
       .update(kbArticles)
       .set(article)
       .where(eq(kbArticles.id, id))
-      .returning();
+      .returning(kbArticleColumns);
     return updatedArticle;
   }
 
@@ -1690,18 +2938,71 @@ export class DatabaseStorage implements IStorage {
     return true;
   }
 
+  // search_vector is a generated column, so creates and updates keep it current without any
+  // work here
+  async searchKbArticles(search: KbSearch): Promise<KbSearchPage> {
+    const terms = queryTerms(search.q);
+    if (terms.length === 0) return { items: [], nextOffset: null };
+
+    const query = sql`to_tsquery('simple', ${toPrefixTsQuery(terms)})`;
+    const rank = sql<number>`ts_rank_cd(${kbArticles.searchVector}, ${query}, 1)`.mapWith(Number);
+    const conditions = [sql`${kbArticles.searchVector} @@ ${query}`];
+    if (search.categoryId) conditions.push(eq(kbArticles.categoryId, search.categoryId));
+    if (search.locationId) conditions.push(eq(kbCategories.locationId, search.locationId));
+
+    const rows = await db.select({
+      id: kbArticles.id,
+      categoryId: kbArticles.categoryId,
+      title: kbArticles.title,
+      createdAt: kbArticles.createdAt,
+      updatedAt: kbArticles.updatedAt,
+      rank,
+    })
+      .from(kbArticles)
+      .innerJoin(kbCategories, eq(kbCategories.id, kbArticles.categoryId))
+      .where(and(...conditions))
+      .orderBy(desc(rank), desc(kbArticles.id))
+      .limit(search.limit + 1)
+      .offset(search.offset);
+
+    // Headlines are the expensive part, so they're only built for the page being returned;
+    // content is escaped first so the only markup in a snippet is <mark>
+    const page = rows.slice(0, search.limit);
+    const snippets = new Map<number, string>();
+    if (page.length > 0) {
+      const escaped = sql`replace(replace(replace(${kbArticles.content}, '&', '&amp;'), '<', '&lt;'), '>', '&gt;')`;
+      const headlines = await db.select({
+        id: kbArticles.id,
+        snippet: sql<string>`ts_headline('simple', ${escaped}, ${query}, ${HEADLINE_OPTIONS})`,
+      })
+        .from(kbArticles)
+        .where(inArray(kbArticles.id, page.map(row => row.id)));
+      headlines.forEach(({ id, snippet }) => snippets.set(id, snippet));
+    }
+
+    return {
+      items: page.map(row => ({ ...row, snippet: snippets.get(row.id) ?? '' })),
+      nextOffset: rows.length > search.limit ? search.offset + search.limit : null,
+    };
+  }
+
   // Uploaded Files
   async getUploadedFile(id: number): Promise<UploadedFile | undefined> {
-    const [file] = await db.select().from(uploadedFiles).where(eq(uploadedFiles.id, id));
+    const [file] = await preparedStatements().uploadedFileById.execute({ id });
     return file;
   }
 
+  async getUploadedFilesByIds(ids: number[]): Promise<UploadedFile[]> {
+    if (ids.length === 0) return [];
+    return await db.select().from(uploadedFiles).where(inArray(uploadedFiles.id, ids));
+  }
+
   async getUploadedFiles(): Promise<UploadedFile[]> {
     return await db.select().from(uploadedFiles);
   }
 
-  async createUploadedFile(file: InsertUploadedFile): Promise<UploadedFile> {
-    const [createdFile] = await db.insert(uploadedFiles).values(file).returning();
+  async createUploadedFile(file: InsertUploadedFile, tx?: DbTransaction): Promise<UploadedFile> {
+    const [createdFile] = await (tx ?? db).insert(uploadedFiles).values(file).returning();
     return createdFile;
   }
 
@@ -1721,6 +3022,14 @@ export class DatabaseStorage implements IStorage {
     return true;
   }
 
+  async countUploadedFilesByContentHash(contentHash: string, tx?: DbTransaction): Promise<number> {
+    const [row] = await (tx ?? db)
+      .select({ count: sql<number>`cast(count(*) as integer)` })
+      .from(uploadedFiles)
+      .where(eq(uploadedFiles.contentHash, contentHash));
+    return row?.count ?? 0;
+  }
+
   // Document Attachments
   async getDocumentAttachment(id: number): Promise<DocumentAttachment | undefined> {
     const [attachment] = await db.select().from(documentAttachments).where(eq(documentAttachments.id, id));
@@ -1766,7 +3075,75 @@ export class DatabaseStorage implements IStorage {
     await db.delete(documentAttachments).where(eq(documentAttachments.fileId, fileId));
     return true;
   }
+
+  // Authorization
+  async getPermissions(): Promise<Permission[]> {
+    return await db.select().from(permissions);
+  }
+
+  async getRolePermissionIdsByName(roleName: string): Promise<number[]> {
+    const rows = await preparedStatements().rolePermissionIdsByName.execute({ roleName });
+    return rows.map(row => row.permissionId);
+  }
+
+  async getUserLocationPermissionIds(userId: number): Promise<{ locationId: number; permissionId: number }[]> {
+    return await preparedStatements().userLocationPermissionIds.execute({ userId });
+  }
+
+  async setRolePermissions(roleId: number, permissionIds: number[]): Promise<void> {
+    await db.transaction(async (tx) => {
+      await tx.delete(rolePermissions).where(eq(rolePermissions.roleId, roleId));
+      if (permissionIds.length > 0) {
+        await tx.insert(rolePermissions).values(permissionIds.map(permissionId => ({ roleId, permissionId })));
+      }
+    });
+    markRolePermissionsChanged();
+  }
+
+  async setUserLocationRole(userId: number, locationId: number, roleId: number): Promise<UserLocation> {
+    const [userLocation] = await db.insert(userLocations)
+      .values({ userId, locationId, roleId })
+      .onConflictDoUpdate({ target: [userLocations.userId, userLocations.locationId], set: { roleId } })
+      .returning();
+    markUserPermissionsChanged(userId);
+    return userLocation;
+  }
+
+  async removeUserLocation(userId: number, locationId: number): Promise<boolean> {
+    const removed = await db.delete(userLocations)
+      .where(and(eq(userLocations.userId, userId), eq(userLocations.locationId, locationId)))
+      .returning();
+    if (removed.length > 0) markUserPermissionsChanged(userId);
+    return removed.length > 0;
+  }
+
+  async seedPermissions(seeds: PermissionSeed[]): Promise<void> {
+    const roleNames = Array.from(new Set(seeds.flatMap(seed => seed.roles)));
+    const created = await db.transaction(async (tx) => {
+      if (roleNames.length > 0) {
+        await tx.insert(roles).values(roleNames.map(name => ({ name }))).onConflictDoNothing();
+      }
+      const createdPermissions = await tx.insert(permissions)
+        .values(seeds.map(({ name, description }) => ({ name, description })))
+        .onConflictDoNothing()
+        .returning();
+      if (createdPermissions.length === 0 || roleNames.length === 0) return createdPermissions;
+
+      const roleIds = new Map((await tx.select().from(roles).where(inArray(roles.name, roleNames)))
+        .map(role => [role.name, role.id] as const));
+      const grants = createdPermissions.flatMap(permission =>
+        (seeds.find(seed => seed.name === permission.name)?.roles ?? [])
+          .map(roleName => ({ roleId: roleIds.get(roleName)!, permissionId: permission.id })));
+      if (grants.length > 0) await tx.insert(rolePermissions).values(grants).onConflictDoNothing();
+      return createdPermissions;
+    });
+    if (created.length > 0) markRolePermissionsChanged();
+  }
+
 }
 
-// Use DatabaseStorage implementation by default
-export const storage = new DatabaseStorage();
\ No newline at end of file
+// Use DatabaseStorage implementation by default (STORAGE_BACKEND=memory for benchmarks and demos)
+// Point lookups within a request are coalesced into bulk queries
+export const storage = withRequestBatching(
+  process.env.STORAGE_BACKEND === 'memory' ? new MemStorage() : new DatabaseStorage()
+);
\ No newline at end of file
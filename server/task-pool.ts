@@ -0,0 +1,139 @@
+import { Worker } from 'worker_threads';
+import os from 'os';
+import type { taskHandlers } from './task-worker';
+
+// Fixed-size worker-thread pool for CPU-bound work (bcrypt today) so it stays off the event
+// loop. Tasks queue FIFO up to TASK_POOL_MAX_QUEUE; beyond that run() rejects immediately with
+// TaskPoolBusyError, which routes turn into a 503 instead of letting latency pile up.
+
+type Handlers = typeof taskHandlers;
+export type TaskKind = keyof Handlers;
+type TaskPayload<K extends TaskKind> = Parameters<Handlers[K]>[0];
+type TaskResult<K extends TaskKind> = ReturnType<Handlers[K]>;
+
+const POOL_SIZE = parseInt(process.env.TASK_POOL_SIZE || '', 10) || Math.max(1, os.availableParallelism() - 1);
+const MAX_QUEUE = parseInt(process.env.TASK_POOL_MAX_QUEUE || '', 10) || 64 * POOL_SIZE;
+const TASK_TIMEOUT_MS = parseInt(process.env.TASK_POOL_TIMEOUT_MS || '', 10) || 10000;
+
+// Same dev/prod split as the assignment worker
+const workerUrl = new URL(
+  import.meta.url.endsWith('.ts') ? './task-worker.ts' : './task-worker.js',
+  import.meta.url,
+);
+
+export class TaskPoolBusyError extends Error {
+  readonly status = 503;
+  constructor() {
+    super('Server is busy, please retry shortly');
+  }
+}
+
+interface Task {
+  id: number;
+  kind: TaskKind;
+  payload: unknown;
+  resolve: (result: any) => void;
+  reject: (error: Error) => void;
+}
+
+interface PoolWorker {
+  worker: Worker;
+  task: Task | null;
+  timer: NodeJS.Timeout | null;
+}
+
+class TaskPool {
+  private idle: PoolWorker[] = [];
+  private workers = new Set<PoolWorker>();
+  private queue: Task[] = [];
+  private nextId = 1;
+  private completed = 0;
+  private rejected = 0;
+
+  constructor(private size: number, private maxQueue: number) {}
+
+  run<K extends TaskKind>(kind: K, payload: TaskPayload<K>): Promise<TaskResult<K>> {
+    // The queue only fills once every worker is busy
+    if (this.queue.length >= this.maxQueue) {
+      this.rejected++;
+      return Promise.reject(new TaskPoolBusyError());
+    }
+    return new Promise((resolve, reject) => {
+      this.queue.push({ id: this.nextId++, kind, payload, resolve, reject });
+      this.dispatch();
+    });
+  }
+
+  stats() {
+    return {
+      size: this.size,
+      busy: this.workers.size - this.idle.length,
+      queued: this.queue.length,
+      completed: this.completed,
+      rejected: this.rejected,
+    };
+  }
+
+  private dispatch() {
+    while (this.queue.length > 0) {
+      // Workers start on demand, so an idle server doesn't hold threads it never uses
+      const slot = this.idle.pop() ?? (this.workers.size < this.size ? this.spawn() : undefined);
+      if (!slot) return;
+      const task = this.queue.shift()!;
+      slot.task = task;
+      slot.timer = setTimeout(() => {
+        this.fail(slot, new Error(`Task ${task.kind} timed out after ${TASK_TIMEOUT_MS}ms`));
+      }, TASK_TIMEOUT_MS);
+      slot.worker.postMessage({ id: task.id, kind: task.kind, payload: task.payload });
+    }
+  }
+
+  private spawn(): PoolWorker {
+    const slot: PoolWorker = { worker: new Worker(workerUrl), task: null, timer: null };
+    // Idle workers must not keep the process alive on shutdown
+    slot.worker.unref();
+    slot.worker.on('message', (message: { id: number; ok: boolean; result?: unknown; error?: string }) => {
+      const task = slot.task;
+      if (!task || task.id !== message.id) return;
+      clearTimeout(slot.timer!);
+      slot.task = null;
+      slot.timer = null;
+      this.completed++;
+      if (message.ok) {
+        task.resolve(message.result);
+      } else {
+        task.reject(new Error(message.error));
+      }
+      this.idle.push(slot);
+      this.dispatch();
+    });
+    slot.worker.on('error', (error) => this.fail(slot, error));
+    slot.worker.on('exit', () => this.fail(slot, new Error('Task worker exited')));
+    this.workers.add(slot);
+    return slot;
+  }
+
+  // Drop a broken or stuck worker, reject its task and let dispatch() start a replacement
+  private fail(slot: PoolWorker, error: Error) {
+    if (!this.workers.delete(slot)) return;
+    this.idle = this.idle.filter(s => s !== slot);
+    if (slot.timer) clearTimeout(slot.timer);
+    slot.task?.reject(error);
+    slot.worker.removeAllListeners();
+    slot.worker.on('error', () => {});
+    void slot.worker.terminate();
+    this.dispatch();
+  }
+}
+
+export const taskPool = new TaskPool(POOL_SIZE, MAX_QUEUE);
+
+const PASSWORD_HASH_ROUNDS = 10;
+
+export function hashPassword(password: string): Promise<string> {
+  return taskPool.run('hashPassword', { password, rounds: PASSWORD_HASH_ROUNDS });
+}
+
+export function verifyPassword(password: string, hash: string): Promise<boolean> {
+  return taskPool.run('verifyPassword', { password, hash });
+}
@@ -0,0 +1,23 @@
+import { parentPort } from 'worker_threads';
+import bcrypt from 'bcryptjs';
+
+// Worker entry for the shared task pool: one task at a time, { id, kind, payload } in,
+// { id, ok, result | error } out. taskHandlers is the registry: task-pool.ts derives TaskKind
+// and the payload/result types from it, so a new CPU-bound task is one entry here plus a typed
+// wrapper next to hashPassword/verifyPassword in task-pool.ts.
+export const taskHandlers = {
+  hashPassword: ({ password, rounds }: { password: string; rounds: number }) =>
+    bcrypt.hashSync(password, bcrypt.genSaltSync(rounds)),
+  verifyPassword: ({ password, hash }: { password: string; hash: string }) =>
+    bcrypt.compareSync(password, hash),
+};
+
+parentPort?.on('message', ({ id, kind, payload }: { id: number; kind: keyof typeof taskHandlers; payload: any }) => {
+  try {
+    const handler = taskHandlers[kind];
+    if (!handler) throw new Error(`Unknown task kind: ${kind}`);
+    parentPort!.postMessage({ id, ok: true, result: handler(payload) });
+  } catch (error) {
+    parentPort!.postMessage({ id, ok: false, error: error instanceof Error ? error.message : String(error) });
+  }
+});
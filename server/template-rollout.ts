@@ -0,0 +1,41 @@
+import { jobQueue, type JobRecord } from './job-queue';
+import { templateRolloutJob } from './jobs';
+import type { TemplateRollout, TemplateRolloutResult } from '@shared/schema';
+
+// Rollouts run on the job queue ('schedule.rollout'); this keeps the polling shape the schedule
+// calendar already understands
+
+export interface TemplateRolloutJob {
+  id: string;
+  status: 'running' | 'completed' | 'failed';
+  done: number;
+  total: number;
+  result?: TemplateRolloutResult;
+  error?: string;
+  startedAt: Date;
+  finishedAt?: Date;
+}
+
+function toRolloutJob(job: JobRecord<TemplateRollout, TemplateRolloutResult>): TemplateRolloutJob {
+  return {
+    id: job.id,
+    // Waiting, delayed retries and active attempts are all still "running" to the caller
+    status: job.status === 'completed' || job.status === 'failed' ? job.status : 'running',
+    done: job.progress?.done ?? 0,
+    total: job.progress?.total ?? 0,
+    result: job.result,
+    error: job.status === 'failed' ? job.error : undefined,
+    startedAt: job.createdAt,
+    finishedAt: job.finishedAt,
+  };
+}
+
+// Queue a rollout; the caller gets the job immediately and polls for progress
+export async function startTemplateRollout(rollout: TemplateRollout): Promise<TemplateRolloutJob> {
+  return toRolloutJob(await templateRolloutJob.enqueue(rollout));
+}
+
+export async function getTemplateRollout(id: string): Promise<TemplateRolloutJob | undefined> {
+  const job = await jobQueue.getJob<TemplateRollout, TemplateRolloutResult>(id);
+  return job && job.type === templateRolloutJob.type ? toRolloutJob(job) : undefined;
+}
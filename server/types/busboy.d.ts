@@ -0,0 +1,53 @@
+// The parts of busboy's API that upload-stream.ts uses; saves pulling in @types/busboy for a
+// few signatures.
+declare module 'busboy' {
+  import type { IncomingHttpHeaders } from 'http';
+  import type { Readable, Writable } from 'stream';
+
+  namespace busboy {
+    interface Limits {
+      fieldNameSize?: number;
+      fieldSize?: number;
+      fields?: number;
+      fileSize?: number;
+      files?: number;
+      parts?: number;
+      headerPairs?: number;
+    }
+
+    interface BusboyConfig {
+      headers: IncomingHttpHeaders;
+      highWaterMark?: number;
+      fileHwm?: number;
+      defCharset?: string;
+      defParamCharset?: string;
+      preservePath?: boolean;
+      limits?: Limits;
+    }
+
+    interface FileInfo {
+      filename: string;
+      encoding: string;
+      mimeType: string;
+    }
+
+    interface FieldInfo {
+      nameTruncated: boolean;
+      valueTruncated: boolean;
+      encoding: string;
+      mimeType: string;
+    }
+
+    interface Busboy extends Writable {
+      on(event: 'file', listener: (name: string, stream: Readable & { truncated?: boolean }, info: FileInfo) => void): this;
+      on(event: 'field', listener: (name: string, value: string, info: FieldInfo) => void): this;
+      on(event: 'partsLimit' | 'filesLimit' | 'fieldsLimit' | 'close' | 'finish', listener: () => void): this;
+      on(event: 'error', listener: (error: unknown) => void): this;
+      on(event: string | symbol, listener: (...args: any[]) => void): this;
+    }
+  }
+
+  function busboy(config: busboy.BusboyConfig): busboy.Busboy;
+
+  export default busboy;
+}
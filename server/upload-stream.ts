@@ -0,0 +1,192 @@
+import type { Request, RequestHandler } from 'express';
+import busboy from 'busboy';
+import crypto from 'crypto';
+import fs from 'fs';
+import { Transform, type TransformCallback } from 'stream';
+import { pipeline } from 'stream/promises';
+import { blobTempPath, commitBlob, withBlobLock, releaseBlob } from './blob-store';
+import type { DbTransaction } from './storage';
+
+// Bytes buffered per read from the multipart parser; this (plus the write stream's buffer)
+// bounds memory per upload regardless of file size
+const UPLOAD_CHUNK_BYTES = 64 * 1024;
+
+export class UploadError extends Error {
+  constructor(public status: number, message: string) {
+    super(message);
+  }
+}
+
+export interface StreamUploadOptions<R> {
+  // Multipart field carrying the file
+  fieldName: string;
+  maxBytes: number;
+  allowedMimeTypes: string[];
+  // Creates the row referencing the stored blob; runs under the blob's lock (see blob-store.ts)
+  // and should write through tx when it is given
+  record: (file: StreamedFile, tx?: DbTransaction) => Promise<R>;
+}
+
+export interface StreamedFile {
+  originalName: string;
+  // Blob path in the content-addressed store
+  path: string;
+  mimeType: string;
+  size: number;
+  sha256: string;
+  // True when identical content was already stored and this upload reused it
+  deduplicated: boolean;
+}
+
+// Counts bytes and feeds the hash as chunks pass through, without holding on to them
+class HashingCounter extends Transform {
+  private hash = crypto.createHash('sha256');
+  size = 0;
+
+  _transform(chunk: Buffer, _encoding: BufferEncoding, callback: TransformCallback) {
+    this.size += chunk.length;
+    this.hash.update(chunk);
+    callback(null, chunk);
+  }
+
+  digest(): string {
+    return this.hash.digest('hex');
+  }
+}
+
+// Parse a multipart request and pipe its single file straight to disk. The file is written to
+// a temp name and only moved into the blob store once fully received and hashed; options.record
+// then inserts the row referencing it before a concurrent release can run, and its result comes
+// back as `record`. Text fields are returned alongside.
+export function streamUpload<R>(req: Request, options: StreamUploadOptions<R>): Promise<{ file: StreamedFile | null; record: R | null; fields: Record<string, string> }> {
+  return new Promise((resolve, reject) => {
+    let parser: busboy.Busboy;
+    try {
+      parser = busboy({
+        headers: req.headers,
+        highWaterMark: UPLOAD_CHUNK_BYTES,
+        limits: { fileSize: options.maxBytes, files: 1, fields: 20, fieldSize: 8 * 1024 },
+      });
+    } catch {
+      return reject(new UploadError(400, 'Expected a multipart/form-data request'));
+    }
+
+    const fields: Record<string, string> = {};
+    let filePromise: Promise<{ file: StreamedFile; record: R }> | null = null;
+    let settled = false;
+
+    const fail = (error: unknown) => {
+      if (settled) return;
+      settled = true;
+      req.unpipe(parser);
+      req.resume(); // drain the rest of the body so the connection can be reused
+      reject(error);
+    };
+
+    parser.on('field', (name, value) => {
+      fields[name] = value;
+    });
+
+    parser.on('file', (name, stream, info) => {
+      if (name !== options.fieldName || filePromise) {
+        stream.resume();
+        return;
+      }
+      if (!options.allowedMimeTypes.includes(info.mimeType)) {
+        stream.resume();
+        return fail(new UploadError(415, 'File type not allowed'));
+      }
+
+      const tempPath = blobTempPath();
+      const counter = new HashingCounter();
+
+      let truncated = false;
+      stream.on('limit', () => {
+        truncated = true;
+        stream.destroy(new UploadError(413, `File exceeds the ${Math.round(options.maxBytes / 1024 / 1024)}MB limit`));
+      });
+
+      filePromise = pipeline(stream, counter, fs.createWriteStream(tempPath, { highWaterMark: UPLOAD_CHUNK_BYTES }))
+        .then(async () => {
+          if (truncated) throw new UploadError(413, 'File too large');
+          const sha256 = counter.digest();
+          let committed = false;
+          try {
+            return await withBlobLock(sha256, async (tx) => {
+              const blob = await commitBlob(tempPath, sha256);
+              committed = true;
+              const file: StreamedFile = {
+                originalName: info.filename,
+                path: blob.path,
+                mimeType: info.mimeType,
+                size: counter.size,
+                sha256,
+                deduplicated: blob.deduplicated,
+              };
+              return { file, record: await options.record(file, tx) };
+            });
+          } catch (error) {
+            // The failed insert rolled back with the lock's transaction, so release under a fresh lock
+            if (committed) await releaseBlob(sha256).catch(() => {});
+            throw error;
+          }
+        })
+        .catch(async (error) => {
+          await fs.promises.unlink(tempPath).catch(() => {});
+          throw error;
+        });
+      filePromise.catch(fail);
+    });
+
+    parser.on('error', (error) => fail(new UploadError(400, error instanceof Error ? error.message : 'Malformed upload')));
+
+    parser.on('close', () => {
+      if (settled) return;
+      (filePromise ?? Promise.resolve(null))
+        .then((stored) => {
+          if (settled) return;
+          settled = true;
+          resolve({ file: stored?.file ?? null, record: stored?.record ?? null, fields });
+        })
+        .catch(fail);
+    });
+
+    req.pipe(parser);
+  });
+}
+
+// Text fields of a multipart body into req.body, for forms posted as FormData (the login form).
+// Other content types pass through untouched; file parts are drained and ignored.
+export const multipartFields: RequestHandler = (req, res, next) => {
+  if (!req.is('multipart/form-data')) return next();
+
+  let parser: busboy.Busboy;
+  try {
+    parser = busboy({ headers: req.headers, limits: { fields: 20, fieldSize: 8 * 1024 } });
+  } catch {
+    return res.status(400).json({ message: 'Malformed form data' });
+  }
+
+  const fields: Record<string, string> = {};
+  let failed = false;
+  parser.on('field', (name, value) => {
+    fields[name] = value;
+  });
+  parser.on('file', (_name, stream) => {
+    stream.resume();
+  });
+  parser.on('error', () => {
+    if (failed) return;
+    failed = true;
+    req.unpipe(parser);
+    req.resume();
+    res.status(400).json({ message: 'Malformed form data' });
+  });
+  parser.on('close', () => {
+    if (failed) return;
+    req.body = fields;
+    next();
+  });
+
+  req.pipe(parser);
+};
@@ -1,22 +1,23 @@
-import express, { type Express } from "express";
+import { type Express, type Request, type Response, type NextFunction } from "express";
 import fs from "fs";
 import path from "path";
-import { createServer as createViteServer, createLogger } from "vite";
+import { createServer as createViteServer, createLogger as createViteLogger } from "vite";
 import { type Server } from "http";
 import viteConfig from "../vite.config";
 import { nanoid } from "nanoid";
+import { createLogger, type Logger } from "./logger";
 
-const viteLogger = createLogger();
+const viteLogger = createViteLogger();
 
-export function log(message: string, source = "express") {
-  const formattedTime = new Date().toLocaleTimeString("en-US", {
-    hour: "numeric",
-    minute: "2-digit",
-    second: "2-digit",
-    hour12: true,
-  });
+const sourceLoggers = new Map<string, Logger>();
 
-  console.log(`${formattedTime} [${source}] ${message}`);
+export function log(message: string, source = "express") {
+  let logger = sourceLoggers.get(source);
+  if (!logger) {
+    logger = createLogger(source);
+    sourceLoggers.set(source, logger);
+  }
+  logger.info(message);
 }
 
 export async function setupVite(app: Express, server: Server) {
@@ -67,6 +68,39 @@ export async function setupVite(app: Express, server: Server) {
   });
 }
 
+// Vite emits content-hashed names under /assets, so those never change once deployed
+const HASHED_ASSET = /^\/assets\/.+-[A-Za-z0-9_-]{8,}\.[a-z0-9]+$/;
+const IMMUTABLE = "public, max-age=31536000, immutable";
+// index.html must be revalidated every time so a deploy is picked up on the next load
+const REVALIDATE = "no-cache";
+const SHORT = "public, max-age=3600";
+
+interface StaticFile {
+  path: string;
+  encodings: { br: boolean; gzip: boolean };
+  cacheControl: string;
+}
+
+// Scan the build once at startup: which files exist and which precompressed variants they have
+function scanBuild(distPath: string): Map<string, StaticFile> {
+  const files = new Map<string, StaticFile>();
+  const names = new Set(
+    fs.readdirSync(distPath, { recursive: true, withFileTypes: true })
+      .filter((entry) => entry.isFile())
+      .map((entry) => path.join(entry.parentPath, entry.name)),
+  );
+  names.forEach((file) => {
+    if (file.endsWith(".br") || file.endsWith(".gz")) return;
+    const urlPath = "/" + path.relative(distPath, file).split(path.sep).join("/");
+    files.set(urlPath, {
+      path: file,
+      encodings: { br: names.has(`${file}.br`), gzip: names.has(`${file}.gz`) },
+      cacheControl: urlPath === "/index.html" ? REVALIDATE : HASHED_ASSET.test(urlPath) ? IMMUTABLE : SHORT,
+    });
+  });
+  return files;
+}
+
 export function serveStatic(app: Express) {
   const distPath = path.resolve(import.meta.dirname, "public");
 
@@ -76,10 +110,41 @@ export function serveStatic(app: Express) {
     );
   }
 
-  app.use(express.static(distPath));
+  const files = scanBuild(distPath);
+  const indexFile = files.get("/index.html");
+
+  const send = (req: Request, res: Response, next: NextFunction, file: StaticFile) => {
+    const encoding = (file.encodings.br || file.encodings.gzip)
+      ? req.acceptsEncodings(...(file.encodings.br ? ["br"] : []), ...(file.encodings.gzip ? ["gzip"] : []), "identity")
+      : false;
+    if (file.encodings.br || file.encodings.gzip) res.vary("Accept-Encoding");
+    // Content-Type comes from the original name, not the .br/.gz suffix
+    res.type(path.extname(file.path));
+    res.setHeader("Cache-Control", file.cacheControl);
+    if (encoding === "br" || encoding === "gzip") {
+      res.setHeader("Content-Encoding", encoding);
+      res.sendFile(`${file.path}.${encoding === "br" ? "br" : "gz"}`, { cacheControl: false }, (err) => err && next(err));
+    } else {
+      res.sendFile(file.path, { cacheControl: false }, (err) => err && next(err));
+    }
+  };
+
+  app.use((req, res, next) => {
+    if (req.method !== "GET" && req.method !== "HEAD") return next();
+    let urlPath: string;
+    try {
+      urlPath = decodeURIComponent(req.path);
+    } catch {
+      return next();
+    }
+    const file = files.get(urlPath === "/" ? "/index.html" : urlPath);
+    if (file) return send(req, res, next, file);
+    next();
+  });
 
   // fall through to index.html if the file doesn't exist
-  app.use("*", (_req, res) => {
-    res.sendFile(path.resolve(distPath, "index.html"));
+  app.use("*", (req, res, next) => {
+    if (!indexFile) return res.sendFile(path.resolve(distPath, "index.html"));
+    send(req, res, next, indexFile);
   });
 }
@@ -1,43 +1,226 @@
-import { Server } from 'http';
+import { Server, IncomingMessage } from 'http';
+import type { RequestHandler } from 'express';
 import WebSocket from 'ws';
 import { log } from './vite';
+import { storage } from './storage';
+import { permittedLocationIds } from './authorization';
+import { onShiftChange, type ShiftChange } from './schedule-events';
+import type { Shift, WeekViewPatch } from '@shared/schema';
+
+const WS_PATH = '/ws';
+const WEEK_MS = 7 * 24 * 60 * 60 * 1000;
+
+// locationId -> week start (ms) -> subscribed sockets
+const channels = new Map<number, Map<number, Set<WebSocket>>>();
+// socket -> its subscriptions, for cleanup on close
+const socketSubscriptions = new Map<WebSocket, Set<string>>();
+// socket -> locations it may subscribe to, resolved at upgrade (null means every location)
+const socketLocations = new Map<WebSocket, number[] | null>();
+
+function subscribe(ws: WebSocket, locationId: number, weekStart: number) {
+  let weeks = channels.get(locationId);
+  if (!weeks) {
+    weeks = new Map();
+    channels.set(locationId, weeks);
+  }
+  let sockets = weeks.get(weekStart);
+  if (!sockets) {
+    sockets = new Set();
+    weeks.set(weekStart, sockets);
+  }
+  sockets.add(ws);
+  socketSubscriptions.get(ws)?.add(`${locationId}:${weekStart}`);
+}
+
+function unsubscribe(ws: WebSocket, locationId: number, weekStart: number) {
+  const weeks = channels.get(locationId);
+  const sockets = weeks?.get(weekStart);
+  if (!weeks || !sockets) return;
+  sockets.delete(ws);
+  if (sockets.size === 0) weeks.delete(weekStart);
+  if (weeks.size === 0) channels.delete(locationId);
+  socketSubscriptions.get(ws)?.delete(`${locationId}:${weekStart}`);
+}
+
+function unsubscribeAll(ws: WebSocket) {
+  for (const key of Array.from(socketSubscriptions.get(ws) ?? [])) {
+    const [locationId, weekStart] = key.split(':').map(Number);
+    unsubscribe(ws, locationId, weekStart);
+  }
+  socketSubscriptions.delete(ws);
+  socketLocations.delete(ws);
+}
+
+function canSubscribe(ws: WebSocket, locationId: number): boolean {
+  const allowed = socketLocations.get(ws);
+  return allowed === null || (allowed !== undefined && allowed.includes(locationId));
+}
+
+// Send a patch to every socket subscribed to the week containing the schedule's start date
+async function publishToSchedule(scheduleId: number, buildPatch: (locationId: number) => Promise<WeekViewPatch>) {
+  const schedule = await storage.getWeeklySchedule(scheduleId);
+  if (!schedule) return;
+
+  const weeks = channels.get(schedule.locationId);
+  if (!weeks) return;
+
+  const scheduleStart = new Date(schedule.weekStartDate).getTime();
+  const targets: WebSocket[] = [];
+  weeks.forEach((sockets, weekStart) => {
+    if (scheduleStart >= weekStart && scheduleStart < weekStart + WEEK_MS) {
+      sockets.forEach(ws => targets.push(ws));
+    }
+  });
+  if (targets.length === 0) return;
+
+  const message = JSON.stringify(await buildPatch(schedule.locationId));
+  for (const ws of targets) {
+    if (ws.readyState === WebSocket.OPEN) ws.send(message);
+  }
+}
+
+async function buildUpsertPatch(locationId: number, shift: Shift): Promise<WeekViewPatch> {
+  const { scheduleId, createdAt, ...weekViewShift } = shift;
+  const patch: WeekViewPatch = { type: 'shift:upsert', locationId, scheduleId, shift: weekViewShift };
+
+  // Include lookup entries so clients can render a newly assigned staff member or competency
+  if (shift.staffId) {
+    const staffMember = await storage.getStaff(shift.staffId);
+    if (staffMember) {
+      const user = await storage.getUser(staffMember.userId);
+      patch.staff = {
+        id: staffMember.id,
+        userId: staffMember.userId,
+        name: user?.name ?? `Staff #${staffMember.id}`,
+        position: staffMember.position,
+      };
+    }
+  }
+  if (shift.competencyId) {
+    const competency = await storage.getCompetency(shift.competencyId);
+    if (competency) patch.competency = { id: competency.id, name: competency.name };
+  }
+  return patch;
+}
+
+async function handleShiftChange(change: ShiftChange) {
+  const { shift } = change;
+  const deletePatch = (scheduleId: number) => async (locationId: number): Promise<WeekViewPatch> =>
+    ({ type: 'shift:delete', locationId, scheduleId, shiftId: shift.id });
+
+  if (change.op === 'delete') {
+    await publishToSchedule(shift.scheduleId, deletePatch(shift.scheduleId));
+    return;
+  }
+
+  if (change.previousScheduleId !== undefined && change.previousScheduleId !== shift.scheduleId) {
+    await publishToSchedule(change.previousScheduleId, deletePatch(change.previousScheduleId));
+  }
+  await publishToSchedule(shift.scheduleId, locationId => buildUpsertPatch(locationId, shift));
+}
+
+export function setupWebSocketServer(server: Server, sessionParser?: RequestHandler) {
+  // noServer: only upgrades on WS_PATH are handled here, so Vite's HMR socket keeps working
+  const wss = new WebSocket.Server({ noServer: true });
+
+  server.on('upgrade', (req: IncomingMessage, socket, head) => {
+    const pathname = new URL(req.url || '/', 'http://localhost').pathname;
+    if (pathname !== WS_PATH) return;
+
+    const accept = (allowed: number[] | null) => {
+      wss.handleUpgrade(req, socket, head, (ws) => {
+        socketLocations.set(ws, allowed);
+        wss.emit('connection', ws, req);
+      });
+    };
+    const reject = (status: string) => {
+      socket.write(`HTTP/1.1 ${status}\r\n\r\n`);
+      socket.destroy();
+    };
+    if (!sessionParser) return accept(null);
+
+    // Schedules contain staff names, so only sessions holding schedule.view may subscribe, and
+    // only to the locations they hold it at (as for the week view route)
+    sessionParser(req as any, {} as any, async () => {
+      try {
+        const passportUser = (req as any).session?.passport?.user;
+        const user = passportUser?.id ? await storage.getUser(passportUser.id) : undefined;
+        if (!user) return reject('401 Unauthorized');
+
+        (req as any).user = user;
+        const allowed = await permittedLocationIds(req as any, 'schedule.view');
+        if (allowed !== null && allowed.length === 0) return reject('403 Forbidden');
+        accept(allowed);
+      } catch (error) {
+        log(`WebSocket upgrade error: ${error instanceof Error ? error.message : error}`, 'ws');
+        reject('500 Internal Server Error');
+      }
+    });
+  });
 
-export function setupWebSocketServer(server: Server) {
-  const wss = new WebSocket.Server({ server });
-  
   wss.on('connection', (ws: WebSocket) => {
     log('WebSocket client connected', 'ws');
-    
+    socketSubscriptions.set(ws, new Set());
+
     ws.on('message', (message: string) => {
       try {
         const data = JSON.parse(message.toString());
-        log(`Received: ${JSON.stringify(data)}`, 'ws');
-        
+
         // Handle message types here
         if (data.type === 'ping') {
           ws.send(JSON.stringify({ type: 'pong' }));
+        } else if (data.type === 'subscribe' || data.type === 'unsubscribe') {
+          const locationId = Number(data.locationId);
+          const weekStart = new Date(data.weekStart).getTime();
+          if (!Number.isInteger(locationId) || isNaN(weekStart)) {
+            ws.send(JSON.stringify({ type: 'error', message: 'locationId and weekStart are required' }));
+            return;
+          }
+          if (data.type === 'subscribe') {
+            if (!canSubscribe(ws, locationId)) {
+              ws.send(JSON.stringify({ type: 'error', message: 'Access denied', locationId }));
+              return;
+            }
+            subscribe(ws, locationId, weekStart);
+          } else {
+            unsubscribe(ws, locationId, weekStart);
+          }
+          ws.send(JSON.stringify({ type: `${data.type}d`, locationId, weekStart: data.weekStart }));
         }
       } catch (error) {
         log(`Error parsing message: ${message}`, 'ws');
       }
     });
-    
+
     ws.on('close', () => {
+      unsubscribeAll(ws);
       log('WebSocket client disconnected', 'ws');
     });
-    
+
     ws.on('error', (error: Error) => {
       log(`WebSocket error: ${error.message}`, 'ws');
     });
-    
+
     // Send initial connection confirmation
     ws.send(JSON.stringify({ type: 'connected' }));
   });
-  
+
   // Handle server errors
   wss.on('error', (error: Error) => {
     log(`WebSocket server error: ${error.message}`, 'ws');
   });
-  
+
+  onShiftChange((change) => {
+    handleShiftChange(change).catch((error) => {
+      log(`Error publishing shift change: ${error instanceof Error ? error.message : error}`, 'ws');
+    });
+  });
+
   return wss;
-}
\ No newline at end of file
+}
+
+// Used on graceful shutdown: 1012 (service restart) tells clients to reconnect, which lands
+// them on a worker that is still serving
+export function closeAllWebSockets(code = 1012, reason = 'server restarting') {
+  socketSubscriptions.forEach((_subscriptions, ws) => ws.close(code, reason));
+}
@@ -9,9 +9,14 @@ import {
   foreignKey, 
   varchar, 
   decimal,
+  date,
   index,
-  primaryKey
+  primaryKey,
+  customType,
+  pgView,
+  type AnyPgColumn
 } from "drizzle-orm/pg-core";
+import { sql, type SQL } from "drizzle-orm";
 import { createInsertSchema } from "drizzle-zod";
 import { z } from "zod";
 
@@ -140,19 +145,32 @@ export const staffCompetencies = pgTable("staff_competencies", {
 });
 
 // Applicants (people who applied for a job)
-export const applicants = pgTable("applicants", {
-  id: serial("id").primaryKey(),
-  name: text("name").notNull(),
-  email: text("email").notNull(),
-  phone: text("phone"),
-  status: text("status", { enum: ["new", "contacted", "interviewed", "hired", "rejected"] }).default("new").notNull(),
-  resumeUrl: text("resume_url"),
-  notes: text("notes"),
-  extraMessage: text("extra_message"),
-  userId: integer("user_id").references(() => users.id),
-  locationId: integer("location_id").references(() => locations.id),
-  createdAt: timestamp("created_at").defaultNow().notNull(),
-});
+export const applicants = pgTable(
+  "applicants",
+  {
+    id: serial("id").primaryKey(),
+    name: text("name").notNull(),
+    email: text("email").notNull(),
+    phone: text("phone"),
+    status: text("status", { enum: ["new", "contacted", "interviewed", "hired", "rejected"] }).default("new").notNull(),
+    resumeUrl: text("resume_url"),
+    notes: text("notes"),
+    extraMessage: text("extra_message"),
+    userId: integer("user_id").references(() => users.id),
+    locationId: integer("location_id").references(() => locations.id),
+    createdAt: timestamp("created_at").defaultNow().notNull(),
+  },
+  (table) => {
+    return {
+      // Keyset pagination is ordered by (created_at, id) descending
+      locationStatusCreatedIdx: index("applicants_location_status_created_idx").on(table.locationId, table.status, table.createdAt.desc(), table.id.desc()),
+      createdIdx: index("applicants_created_idx").on(table.createdAt.desc(), table.id.desc()),
+      // pg_trgm indexes serve the ILIKE name/email search
+      nameTrgmIdx: index("applicants_name_trgm_idx").using("gin", table.name.op("gin_trgm_ops")),
+      emailTrgmIdx: index("applicants_email_trgm_idx").using("gin", table.email.op("gin_trgm_ops")),
+    };
+  }
+);
 
 // Applicant Documents
 export const applicantDocuments = pgTable("applicant_documents", {
@@ -195,11 +213,33 @@ export const weeklySchedules = pgTable("weekly_schedules", {
   templateId: integer("template_id").references(() => scheduleTemplates.id),
   isPublished: boolean("is_published").default(false).notNull(),
   createdAt: timestamp("created_at").defaultNow().notNull(),
+}, (table) => {
+  return {
+    // Week lookups per location (getWeeklyScheduleByDateRange, the week view)
+    locationWeekIdx: index("weekly_schedules_location_week_idx").on(table.locationId, table.weekStartDate),
+  };
 });
 
-// Shifts (actual scheduled shifts)
-export const shifts = pgTable("shifts", {
-  id: serial("id").primaryKey(),
+// Half-open [start, end) tsrange a shift occupies, from its date and "HH:MM" times; an end at or
+// before the start runs past midnight. Built only from immutable functions so it can back an
+// expression index; queries must use this same expression for the planner to match it.
+export function shiftPeriod(columns: { date: AnyPgColumn; startTime: AnyPgColumn; endTime: AnyPgColumn }): SQL {
+  const clock = (column: AnyPgColumn) =>
+    sql`make_interval(hours => split_part(${column}, ':', 1)::int, mins => split_part(${column}, ':', 2)::int)`;
+  return sql`tsrange(
+    ${columns.date} + ${clock(columns.startTime)},
+    ${columns.date} + ${clock(columns.endTime)}
+      + CASE WHEN ${clock(columns.endTime)} <= ${clock(columns.startTime)} THEN interval '1 day' ELSE interval '0' END,
+    '[)'
+  )`;
+}
+
+// Shifts (actual scheduled shifts). shifts and cash_counts are range-partitioned by month on
+// their date column, which Drizzle can't declare: the partitions, the archive tier and the
+// *_history views are created by migrations/custom/partition-shifts-and-cash-counts.ts and
+// maintained by server/partitions.ts. The partition key has to be part of the primary key.
+const shiftColumns = () => ({
+  id: serial("id").notNull(),
   scheduleId: integer("schedule_id").references(() => weeklySchedules.id).notNull(),
   staffId: integer("staff_id").references(() => staff.id),
   date: timestamp("date").notNull(),
@@ -212,9 +252,26 @@ export const shifts = pgTable("shifts", {
   createdAt: timestamp("created_at").defaultNow().notNull(),
 });
 
+export const shifts = pgTable(
+  "shifts",
+  shiftColumns(),
+  (table) => {
+    return {
+      pk: primaryKey({ columns: [table.id, table.date] }),
+      scheduleDateIdx: index("shifts_schedule_date_idx").on(table.scheduleId, table.date),
+      staffDateIdx: index("shifts_staff_date_idx").on(table.staffId, table.date),
+      // Overlap lookups per staff member (btree_gist provides the integer operator class)
+      staffPeriodIdx: index("shifts_staff_period_idx").using("gist", table.staffId, shiftPeriod(table)),
+    };
+  }
+);
+
+// Hot partitions plus archived months; read-only, for ranges reaching past the archive horizon
+export const shiftsHistory = pgView("shifts_history", shiftColumns()).existing();
+
 // Cash Management
-export const cashCounts = pgTable("cash_counts", {
-  id: serial("id").primaryKey(),
+const cashCountColumns = () => ({
+  id: serial("id").notNull(),
   locationId: integer("location_id").references(() => locations.id).notNull(),
   countType: text("count_type", { enum: ["opening", "midday", "closing"] }).notNull(),
   countDate: timestamp("count_date").notNull(),
@@ -229,39 +286,111 @@ export const cashCounts = pgTable("cash_counts", {
   createdBy: integer("created_by").references(() => users.id).notNull(),
 });
 
+export const cashCounts = pgTable(
+  "cash_counts",
+  cashCountColumns(),
+  (table) => {
+    return {
+      pk: primaryKey({ columns: [table.id, table.countDate] }),
+      locationDateIdx: index("cash_counts_location_date_idx").on(table.locationId, table.countDate),
+    };
+  }
+);
+
+export const cashCountsHistory = pgView("cash_counts_history", cashCountColumns()).existing();
+
+// Per-location, per-day, per-count-type totals over cash_counts, maintained incrementally
+// by the storage layer so reports merge O(days) rollup rows instead of raw counts
+export const cashCountRollups = pgTable(
+  "cash_count_rollups",
+  {
+    locationId: integer("location_id").references(() => locations.id).notNull(),
+    day: date("day", { mode: "string" }).notNull(), // UTC day of count_date
+    countType: text("count_type", { enum: ["opening", "midday", "closing"] }).notNull(),
+    entries: integer("entries").default(0).notNull(),
+    cashTotal: decimal("cash_total", { precision: 14, scale: 2 }).default("0").notNull(),
+    cardTotal: decimal("card_total", { precision: 14, scale: 2 }).default("0").notNull(),
+    floatTotal: decimal("float_total", { precision: 14, scale: 2 }).default("0").notNull(),
+    expectedTotal: decimal("expected_total", { precision: 14, scale: 2 }).default("0").notNull(),
+    discrepancyTotal: decimal("discrepancy_total", { precision: 14, scale: 2 }).default("0").notNull(),
+  },
+  (table) => {
+    return {
+      pk: primaryKey({ columns: [table.locationId, table.day, table.countType] }),
+      dayIdx: index("cash_count_rollups_day_idx").on(table.day),
+    };
+  }
+);
+
 // Knowledge Base Categories
-export const kbCategories = pgTable("kb_categories", {
-  id: serial("id").primaryKey(),
-  name: text("name").notNull(),
-  description: text("description"),
-  locationId: integer("location_id").references(() => locations.id).notNull(),
-  createdAt: timestamp("created_at").defaultNow().notNull(),
+export const kbCategories = pgTable(
+  "kb_categories",
+  {
+    id: serial("id").primaryKey(),
+    name: text("name").notNull(),
+    description: text("description"),
+    locationId: integer("location_id").references(() => locations.id).notNull(),
+    createdAt: timestamp("created_at").defaultNow().notNull(),
+  },
+  (table) => {
+    return {
+      locationIdx: index("kb_categories_location_idx").on(table.locationId),
+    };
+  }
+);
+
+const tsvector = customType<{ data: string }>({
+  dataType() {
+    return "tsvector";
+  },
 });
 
 // Knowledge Base Articles
-export const kbArticles = pgTable("kb_articles", {
-  id: serial("id").primaryKey(),
-  categoryId: integer("category_id").references(() => kbCategories.id).notNull(),
-  title: text("title").notNull(),
-  content: text("content").notNull(),
-  images: json("images").$type<string[]>(),
-  createdBy: integer("created_by").references(() => users.id).notNull(),
-  updatedBy: integer("updated_by").references(() => users.id),
-  createdAt: timestamp("created_at").defaultNow().notNull(),
-  updatedAt: timestamp("updated_at"),
-});
+export const kbArticles = pgTable(
+  "kb_articles",
+  {
+    id: serial("id").primaryKey(),
+    categoryId: integer("category_id").references(() => kbCategories.id).notNull(),
+    title: text("title").notNull(),
+    content: text("content").notNull(),
+    images: json("images").$type<string[]>(),
+    createdBy: integer("created_by").references(() => users.id).notNull(),
+    updatedBy: integer("updated_by").references(() => users.id),
+    createdAt: timestamp("created_at").defaultNow().notNull(),
+    updatedAt: timestamp("updated_at"),
+    // Full-text search document, maintained by Postgres; never selected into API rows
+    searchVector: tsvector("search_vector").generatedAlwaysAs(
+      sql`setweight(to_tsvector('simple', coalesce(title, '')), 'A') || setweight(to_tsvector('simple', coalesce(content, '')), 'B')`
+    ),
+  },
+  (table) => {
+    return {
+      categoryIdx: index("kb_articles_category_idx").on(table.categoryId),
+      searchIdx: index("kb_articles_search_idx").using("gin", table.searchVector),
+    };
+  }
+);
 
 // Uploaded Files
-export const uploadedFiles = pgTable("uploaded_files", {
-  id: serial("id").primaryKey(),
-  filename: text("filename").notNull(),
-  originalName: text("original_name").notNull(),
-  mimeType: text("mime_type").notNull(),
-  size: integer("size").notNull(),
-  path: text("path").notNull(),
-  uploadedBy: integer("uploaded_by").references(() => users.id).notNull(),
-  createdAt: timestamp("created_at").defaultNow().notNull(),
-});
+export const uploadedFiles = pgTable(
+  "uploaded_files",
+  {
+    id: serial("id").primaryKey(),
+    filename: text("filename").notNull(),
+    originalName: text("original_name").notNull(),
+    mimeType: text("mime_type").notNull(),
+    size: integer("size").notNull(),
+    path: text("path").notNull(), // Blob path in the content-addressed store (shared by identical uploads)
+    contentHash: text("content_hash"), // SHA-256 hex, computed while the upload streams to disk
+    uploadedBy: integer("uploaded_by").references(() => users.id).notNull(),
+    createdAt: timestamp("created_at").defaultNow().notNull(),
+  },
+  (table) => {
+    return {
+      contentHashIdx: index("uploaded_files_content_hash_idx").on(table.contentHash),
+    };
+  }
+);
 
 // Document Attachments - for linking files to different entities
 export const documentAttachments = pgTable("document_attachments", {
@@ -289,12 +418,16 @@ export const insertStaffCompetencySchema = createInsertSchema(staffCompetencies)
 export const insertApplicantSchema = createInsertSchema(applicants).omit({ id: true, createdAt: true });
 export const insertApplicantDocumentSchema = createInsertSchema(applicantDocuments).omit({ id: true, uploadedAt: true, verifiedAt: true });
 export const insertScheduleTemplateSchema = createInsertSchema(scheduleTemplates).omit({ id: true, createdAt: true });
-export const insertTemplateShiftSchema = createInsertSchema(templateShifts).omit({ id: true });
+// Shift times are "HH:MM" (seconds tolerated); shiftPeriod and the conflict checker parse them,
+// and template shifts are copied into shifts verbatim by rollouts
+const SHIFT_TIME = /^([01]\d|2[0-3]):[0-5]\d(:[0-5]\d)?$/;
+const shiftTime = (schema: z.ZodString) => schema.regex(SHIFT_TIME, "Times must be HH:MM");
+export const insertTemplateShiftSchema = createInsertSchema(templateShifts, { startTime: shiftTime, endTime: shiftTime }).omit({ id: true });
 export const insertWeeklyScheduleSchema = createInsertSchema(weeklySchedules).omit({ id: true, createdAt: true });
-export const insertShiftSchema = createInsertSchema(shifts).omit({ id: true, createdAt: true });
+export const insertShiftSchema = createInsertSchema(shifts, { startTime: shiftTime, endTime: shiftTime }).omit({ id: true, createdAt: true });
 export const insertCashCountSchema = createInsertSchema(cashCounts).omit({ id: true, createdAt: true });
 export const insertKbCategorySchema = createInsertSchema(kbCategories).omit({ id: true, createdAt: true });
-export const insertKbArticleSchema = createInsertSchema(kbArticles).omit({ id: true, createdAt: true, updatedAt: true });
+export const insertKbArticleSchema = createInsertSchema(kbArticles).omit({ id: true, createdAt: true, updatedAt: true, searchVector: true });
 export const insertUploadedFileSchema = createInsertSchema(uploadedFiles).omit({ id: true, createdAt: true });
 export const insertDocumentAttachmentSchema = createInsertSchema(documentAttachments).omit({ id: true, createdAt: true });
 
@@ -322,6 +455,80 @@ export const registerSchema = z.object({
   path: ["confirmPassword"],
 });
 
+// Bulk template rollout: materialize templates into weekly schedules for a range of weeks.
+// Each template applies to its own location; weeks step by 7 days from fromWeekStart.
+export const templateRolloutSchema = z.object({
+  templateIds: z.array(z.number().int().positive()).min(1, "At least one template is required"),
+  fromWeekStart: z.coerce.date(),
+  toWeekStart: z.coerce.date(),
+}).refine((data) => data.toWeekStart >= data.fromWeekStart, {
+  message: "toWeekStart must not be before fromWeekStart",
+  path: ["toWeekStart"],
+}).refine((data) => data.toWeekStart.getTime() - data.fromWeekStart.getTime() <= 52 * 7 * 86400000, {
+  message: "A rollout can cover at most 53 weeks",
+  path: ["toWeekStart"],
+});
+
+// Applicant list filters; results are keyset-paginated newest first
+export const applicantSearchSchema = z.object({
+  status: z.enum(["new", "contacted", "interviewed", "hired", "rejected"]).optional(),
+  locationId: z.coerce.number().int().positive().optional(),
+  createdFrom: z.coerce.date().optional(),
+  createdTo: z.coerce.date().optional(),
+  q: z.string().trim().max(100).optional(), // name or email prefix
+  cursor: z.string().max(200).optional(),
+  limit: z.coerce.number().int().min(1).max(100).default(50),
+});
+
+// Knowledge base full-text search; ranked, so pages are offset based (rank has no stable keyset)
+export const kbSearchSchema = z.object({
+  q: z.string().trim().min(1).max(200),
+  locationId: z.coerce.number().int().positive().optional(),
+  categoryId: z.coerce.number().int().positive().optional(),
+  offset: z.coerce.number().int().min(0).max(1000).default(0),
+  limit: z.coerce.number().int().min(1).max(50).default(20),
+});
+
+// Cash summary over the rollups; locationIds is a comma separated list (all locations when omitted)
+export const cashSummaryQuerySchema = z.object({
+  from: z.string().regex(/^\d{4}-\d{2}-\d{2}$/, "from must be YYYY-MM-DD"),
+  to: z.string().regex(/^\d{4}-\d{2}-\d{2}$/, "to must be YYYY-MM-DD"),
+  locationIds: z.string().regex(/^\d+(,\d+)*$/).optional()
+    .transform((value) => value ? value.split(",").map(Number) : undefined),
+  groupBy: z.enum(["day", "week", "month", "total"]).default("day"),
+  byLocation: z.enum(["true", "false"]).default("false").transform((value) => value === "true"),
+}).refine((data) => data.from <= data.to, { message: "from must not be after to", path: ["to"] });
+
+// Streaming exports (/api/exports/*); from/to are inclusive days, locationIds as for the summary
+export const exportQuerySchema = z.object({
+  from: z.string().regex(/^\d{4}-\d{2}-\d{2}$/, "from must be YYYY-MM-DD"),
+  to: z.string().regex(/^\d{4}-\d{2}-\d{2}$/, "to must be YYYY-MM-DD"),
+  locationIds: z.string().regex(/^\d+(,\d+)*$/).optional()
+    .transform((value) => value ? value.split(",").map(Number) : undefined),
+  format: z.enum(["csv", "ndjson"]).default("csv"),
+}).refine((data) => data.from <= data.to, { message: "from must not be after to", path: ["to"] });
+
+// Dashboard KPIs; weekStart defaults to the current (Sunday based) week and day to today, both UTC
+export const dashboardSummaryQuerySchema = z.object({
+  weekStart: z.coerce.date().optional(),
+  day: z.string().regex(/^\d{4}-\d{2}-\d{2}$/, "day must be YYYY-MM-DD").optional(),
+});
+
+// Proposed assignment for the overlap check; shiftId excludes the shift being edited
+export const shiftConflictCheckSchema = z.object({
+  shiftId: z.number().int().positive().optional(),
+  staffId: z.number().int().positive(),
+  date: z.coerce.date(),
+  startTime: shiftTime(z.string()),
+  endTime: shiftTime(z.string()),
+});
+
+// Staff on shift at one instant, optionally for a single role
+export const shiftCoverageQuerySchema = z.object({
+  at: z.coerce.date(),
+  role: z.string().trim().min(1).optional(),
+});
+
 // Types for drizzle tables
 export type ApplicantDocument = typeof applicantDocuments.$inferSelect;
 
@@ -349,8 +556,125 @@ export type InsertUploadedFile = z.infer<typeof insertUploadedFileSchema>;
 export type InsertDocumentAttachment = z.infer<typeof insertDocumentAttachmentSchema>;
 export type Login = z.infer<typeof loginSchema>;
 export type Register = z.infer<typeof registerSchema>;
+export type TemplateRollout = z.infer<typeof templateRolloutSchema>;
+export type TemplateRolloutResult = {
+  weeks: number;
+  schedulesCreated: number;
+  schedulesReused: number;
+  shiftsCreated: number;
+  shiftsSkipped: number;
+};
+export type ApplicantSearch = z.infer<typeof applicantSearchSchema>;
+export type ApplicantListItem = Pick<Applicant, "id" | "name" | "email" | "phone" | "status" | "resumeUrl" | "locationId" | "createdAt">;
+export type ApplicantPage = {
+  items: ApplicantListItem[];
+  // Opaque cursor for the next page, null on the last page
+  nextCursor: string | null;
+};
+export type ExportQuery = z.infer<typeof exportQuerySchema>;
+// Flat rows for the exports; column order is the CSV column order
+export type ShiftExportRow = {
+  id: number;
+  date: Date;
+  startTime: string;
+  endTime: string;
+  role: string;
+  locationId: number;
+  locationName: string;
+  scheduleId: number;
+  staffId: number | null;
+  staffName: string | null;
+  competencyName: string | null;
+  notes: string | null;
+};
+export type CashCountExportRow = {
+  id: number;
+  countDate: Date;
+  countType: string;
+  locationId: number;
+  locationName: string;
+  cashAmount: string;
+  cardAmount: string;
+  floatAmount: string;
+  expectedAmount: string | null;
+  discrepancy: string | null;
+  createdBy: number;
+  verifiedBy: number | null;
+};
+export type ApplicantExportRow = {
+  id: number;
+  createdAt: Date;
+  name: string;
+  email: string;
+  phone: string | null;
+  status: string;
+  locationId: number | null;
+  locationName: string | null;
+};
+export type KbSearch = z.infer<typeof kbSearchSchema>;
+export type KbSearchHit = Pick<KbArticle, "id" | "categoryId" | "title" | "createdAt" | "updatedAt"> & {
+  // HTML-escaped excerpt with matches wrapped in <mark>
+  snippet: string;
+  rank: number;
+};
+export type KbSearchPage = {
+  items: KbSearchHit[];
+  nextOffset: number | null;
+};
+// Category listing row: a short plain-text excerpt instead of the body
+export type KbArticleSummary = Pick<KbArticle, "id" | "categoryId" | "title" | "createdAt" | "updatedAt"> & {
+  excerpt: string;
+};
+export type CashSummaryQuery = z.infer<typeof cashSummaryQuerySchema>;
+export type CashSummaryBucket = {
+  // Day (YYYY-MM-DD), week start (Monday), month (YYYY-MM) or "total"
+  period: string;
+  locationId: number | null;
+  entries: { opening: number; midday: number; closing: number };
+  // Same definitions as the cash management page: opening counts are excluded and the
+  // closing float is subtracted from cash
+  cashTotal: number;
+  cardTotal: number;
+  totalSales: number;
+  discrepancyTotal: number;
+};
+export type DashboardSummaryQuery = z.infer<typeof dashboardSummaryQuerySchema>;
+export type DashboardSummary = {
+  locationId: number;
+  weekStart: string;
+  day: string;
+  staff: { total: number; byPosition: { position: string; count: number }[] };
+  applicants: { total: number; byStatus: Record<Applicant["status"], number> };
+  // Shifts dated inside the week; coverage is the assigned share (0-1, 1 when there are none)
+  shifts: { total: number; assigned: number; open: number; hoursScheduled: number; hoursAssigned: number; coverage: number };
+  // Today's counts; totals use the cash summary definitions, latest is the most recently entered count
+  cash: {
+    entries: number;
+    totalSales: number;
+    discrepancyTotal: number;
+    latest: Pick<CashCount, "id" | "countType" | "cashAmount" | "cardAmount" | "floatAmount" | "discrepancy" | "createdAt"> | null;
+  };
+};
+export type ShiftConflictCheck = z.infer<typeof shiftConflictCheckSchema>;
+export type ShiftConflict = Pick<Shift, "id" | "scheduleId" | "date" | "startTime" | "endTime" | "role">;
+export type ShiftCoverage = {
+  locationId: number;
+  at: string;
+  // Assigned shifts covering the instant, per role
+  roles: Record<string, number>;
+  total: number;
+};
+export type AutoAssignProposal = {
+  scheduleId: number | null;
+  assignments: { shiftId: number; staffId: number }[];
+  unfilled: { shiftId: number; reason: 'no_qualified_staff' | 'all_qualified_busy' | 'hours_exhausted' }[];
+  staffHours: { staffId: number; wantedHours: number; currentHours: number; proposedHours: number }[];
+  stats: { openShifts: number; filled: number; solveMs: number };
+};
 
 export type User = typeof users.$inferSelect;
+// What lookups and sessions carry; only credential checks read the hash
+export type SafeUser = Omit<User, "password">;
 export type Location = typeof locations.$inferSelect;
 export type Role = typeof roles.$inferSelect;
 export type Permission = typeof permissions.$inferSelect;
@@ -367,11 +691,49 @@ export type TemplateShift = typeof templateShifts.$inferSelect;
 export type WeeklySchedule = typeof weeklySchedules.$inferSelect;
 export type Shift = typeof shifts.$inferSelect;
 export type CashCount = typeof cashCounts.$inferSelect;
+export type CashCountRollup = typeof cashCountRollups.$inferSelect;
 export type KbCategory = typeof kbCategories.$inferSelect;
-export type KbArticle = typeof kbArticles.$inferSelect;
+export type KbArticle = Omit<typeof kbArticles.$inferSelect, "searchVector">;
 export type UploadedFile = typeof uploadedFiles.$inferSelect;
 export type DocumentAttachment = typeof documentAttachments.$inferSelect;
 
+// Denormalized week payload for the schedule calendar: one request (and one query)
+// per week instead of separate schedule, shift, staff, user and competency lookups
+export type WeekViewShift = Omit<Shift, "scheduleId" | "createdAt">;
+export type WeekViewStaff = {
+  id: number;
+  userId: number;
+  name: string;
+  position: string;
+};
+export type WeekViewCompetency = {
+  id: number;
+  name: string;
+};
+export type WeekView = {
+  schedule: WeeklySchedule | null;
+  shifts: WeekViewShift[];
+  staff: WeekViewStaff[];
+  competencies: WeekViewCompetency[];
+};
+
+// Incremental week-view updates pushed over the /ws socket to subscribers of a location/week
+export type WeekViewPatch =
+  | {
+      type: "shift:upsert";
+      locationId: number;
+      scheduleId: number;
+      shift: WeekViewShift;
+      staff?: WeekViewStaff;
+      competency?: WeekViewCompetency;
+    }
+  | {
+      type: "shift:delete";
+      locationId: number;
+      scheduleId: number;
+      shiftId: number;
+    };
+
 // Session storage for database sessions
 export const sessions = pgTable(
   "sessions",
@@ -1,12 +1,55 @@
-import { defineConfig } from "vite";
+import { defineConfig, type Plugin } from "vite";
 import react from "@vitejs/plugin-react";
 import path from "path";
+import fs from "fs";
+import zlib from "zlib";
+import { promisify } from "util";
 import runtimeErrorOverlay from "@replit/vite-plugin-runtime-error-modal";
 
+const brotli = promisify(zlib.brotliCompress);
+const gzip = promisify(zlib.gzip);
+
+// Write .br and .gz next to every compressible build file so the server can hand them out
+// as-is (server/vite.ts serveStatic) instead of compressing per request
+function precompress(): Plugin {
+  const COMPRESSIBLE = /\.(js|mjs|css|html|svg|json|txt|xml|map|webmanifest)$/;
+  const MIN_BYTES = 1024;
+  let outDir = "";
+  return {
+    name: "precompress",
+    apply: "build",
+    configResolved(config) {
+      outDir = path.resolve(config.root, config.build.outDir);
+    },
+    async closeBundle() {
+      const files = (await fs.promises.readdir(outDir, { recursive: true, withFileTypes: true }))
+        .filter((entry) => entry.isFile() && COMPRESSIBLE.test(entry.name))
+        .map((entry) => path.join(entry.parentPath, entry.name));
+      await Promise.all(files.map(async (file) => {
+        const content = await fs.promises.readFile(file);
+        if (content.length < MIN_BYTES) return;
+        const [br, gz] = await Promise.all([
+          brotli(content, {
+            params: {
+              [zlib.constants.BROTLI_PARAM_QUALITY]: zlib.constants.BROTLI_MAX_QUALITY,
+              [zlib.constants.BROTLI_PARAM_SIZE_HINT]: content.length,
+            },
+          }),
+          gzip(content, { level: zlib.constants.Z_BEST_COMPRESSION }),
+        ]);
+        // Only keep variants that actually save bytes
+        if (br.length < content.length) await fs.promises.writeFile(`${file}.br`, br);
+        if (gz.length < content.length) await fs.promises.writeFile(`${file}.gz`, gz);
+      }));
+    },
+  };
+}
+
 export default defineConfig({
   plugins: [
     react(),
     runtimeErrorOverlay(),
+    precompress(),
     ...(process.env.NODE_ENV !== "production" &&
     process.env.REPL_ID !== undefined
       ? [
@@ -27,5 +70,19 @@ export default defineConfig({
   build: {
     outDir: path.resolve(import.meta.dirname, "dist/public"),
     emptyOutDir: true,
+    rollupOptions: {
+      output: {
+        // Pages are lazy routes (client/src/App.tsx). The applicant flow reached from QR codes
+        // is grouped into one lean chunk; chart libraries only load with the pages that draw charts.
+        manualChunks(id) {
+          if (/\/client\/src\/pages\/(register|registration-success|applicant-portal)\.tsx$/.test(id)) {
+            return "applicant";
+          }
+          if (/\/node_modules\/(recharts|d3-[^/]+|victory-vendor)\//.test(id)) {
+            return "charts";
+          }
+        },
+      },
+    },
   },
 });